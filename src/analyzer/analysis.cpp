@@ -2,6 +2,7 @@
 
 #include "analysis.hpp"
 #include "windows_emulator.hpp"
+#include "stack_trace.hpp"
 #include <utils/lazy_object.hpp>
 
 #ifdef OS_EMSCRIPTEN
@@ -29,11 +30,33 @@ namespace
         };
     }
 
+    void print_stack_trace(const analysis_context& c)
+    {
+        if (!c.settings->stack_traces)
+        {
+            return;
+        }
+
+        auto& win_emu = *c.win_emu;
+        const auto trace = capture_stack_trace(win_emu);
+
+        for (size_t i = 0; i < trace.size(); ++i)
+        {
+            const auto& frame = trace[i];
+            win_emu.log.print(color::dark_gray, "    #%zu 0x%" PRIx64 " %s [%s]\n", i, frame.address,
+                              frame.symbol.c_str(), get_stack_frame_source_name(frame.source));
+        }
+    }
+
     void handle_suspicious_activity(const analysis_context& c, const std::string_view details)
     {
-        const auto rip = c.win_emu->emu().read_instruction_pointer();
-        c.win_emu->log.print(color::pink, "Suspicious: %.*s at 0x%" PRIx64 " (via 0x%" PRIx64 ")\n",
-                             STR_VIEW_VA(details), rip, c.win_emu->process.previous_ip);
+        auto& win_emu = *c.win_emu;
+        const auto rip = win_emu.emu().read_instruction_pointer();
+        const auto symbol = win_emu.symbols.describe(win_emu.mod_manager, rip);
+
+        win_emu.log.print(color::pink, "Suspicious: %.*s at 0x%" PRIx64 " (%s) (via 0x%" PRIx64 ")\n",
+                          STR_VIEW_VA(details), rip, symbol.c_str(), win_emu.process.previous_ip);
+        print_stack_trace(c);
     }
 
     void handle_generic_activity(const analysis_context& c, const std::string_view details)
@@ -68,7 +91,8 @@ namespace
     {
         const auto permission = get_permission_string(operation);
         const auto ip = c.win_emu->emu().read_instruction_pointer();
-        const char* name = c.win_emu->mod_manager.find_name(ip);
+        const auto symbol = c.win_emu->symbols.describe(c.win_emu->mod_manager, ip);
+        const char* name = symbol.c_str();
 
         if (type == memory_violation_type::protection)
         {
@@ -82,6 +106,38 @@ namespace
                                  "Mapping violation: 0x%" PRIx64 " (%" PRIx64 ") - %s at 0x%" PRIx64 " (%s)\n", address,
                                  size, permission.c_str(), ip, name);
         }
+
+        if (const auto* allocation = c.win_emu->heap.find_allocation(address))
+        {
+            const auto caller = c.win_emu->symbols.describe(c.win_emu->mod_manager, allocation->caller);
+            c.win_emu->log.print(color::gray,
+                                 "--> Inside heap block 0x%" PRIx64 " (%" PRIx64 ") allocated at 0x%" PRIx64 " (%s)\n",
+                                 allocation->address, allocation->size, allocation->caller, caller.c_str());
+        }
+
+        print_stack_trace(c);
+    }
+
+    void handle_heap_allocate(const analysis_context& c, const heap_allocation& allocation)
+    {
+        if (!c.settings->verbose_logging)
+        {
+            return;
+        }
+
+        c.win_emu->log.print(color::dark_gray, "--> Heap allocation 0x%" PRIx64 " (%" PRIx64 ") by 0x%" PRIx64 "\n",
+                             allocation.address, allocation.size, allocation.caller);
+    }
+
+    void handle_heap_free(const analysis_context& c, const heap_allocation& allocation)
+    {
+        if (!c.settings->verbose_logging)
+        {
+            return;
+        }
+
+        c.win_emu->log.print(color::dark_gray, "--> Heap free 0x%" PRIx64 " (%" PRIx64 ")\n", allocation.address,
+                             allocation.size);
     }
 
     void handle_ioctrl(const analysis_context& c, const io_device&, const std::u16string_view device_name,
@@ -152,6 +208,52 @@ namespace
         }
     }
 
+    void handle_cpuid(const analysis_context& c, const uint32_t leaf, const uint32_t subleaf)
+    {
+        auto& win_emu = *c.win_emu;
+        const auto rip = win_emu.emu().read_instruction_pointer();
+        const auto* mod = get_module_if_interesting(win_emu.mod_manager, c.settings->modules, rip);
+
+        if (mod)
+        {
+            win_emu.log.print(color::blue, "Executing CPUID instruction with leaf 0x%X:0x%X at 0x%" PRIx64 " (%s)\n",
+                              leaf, subleaf, rip, mod->name.c_str());
+        }
+    }
+
+    void handle_debug_output(const analysis_context& c, const debug_output_message& message)
+    {
+        if (c.settings->silent)
+        {
+            return;
+        }
+
+        auto& log = c.win_emu->log;
+        const auto* source = get_debug_output_source_name(message.source);
+
+        if (message.suppressed_count)
+        {
+            log.print(color::dark_gray, "--> %" PRIu64 " debug messages dropped by the rate limit\n",
+                      message.suppressed_count);
+        }
+
+        if (message.repeat_count)
+        {
+            log.print(color::dark_gray, "--> Last %s message repeated %u times\n", source, message.repeat_count);
+            return;
+        }
+
+        log.print(color::cyan, "--> %s (thread %u): %s\n", source, message.thread_id, message.text.c_str());
+    }
+
+    // Symbols are only looked up where control flow was transferred, not for every
+    // instruction. Sequential instructions are at most 15 bytes apart.
+    bool is_branch_target(const uint64_t address, const uint64_t previous_ip)
+    {
+        constexpr uint64_t max_instruction_length = 15;
+        return address <= previous_ip || address - previous_ip > max_instruction_length;
+    }
+
     void handle_instruction(analysis_context& c, const uint64_t address)
     {
         auto& win_emu = *c.win_emu;
@@ -210,24 +312,40 @@ namespace
             return;
         }
 
+        std::string_view function_name{};
+        std::optional<resolved_symbol> symbol{};
+
         const auto export_entry = binary->address_names.find(address);
-        if (export_entry != binary->address_names.end() &&
-            !c.settings->ignored_functions.contains(export_entry->second))
+        if (export_entry != binary->address_names.end())
+        {
+            function_name = export_entry->second;
+        }
+        else if (c.settings->verbose_logging && is_branch_target(address, win_emu.process.previous_ip))
+        {
+            symbol = win_emu.symbols.resolve(*binary, address);
+            if (symbol && symbol->displacement == 0)
+            {
+                function_name = symbol->name;
+            }
+        }
+
+        if (!function_name.empty() && !c.settings->ignored_functions.contains(function_name))
         {
             const auto rsp = win_emu.emu().read_stack_pointer();
 
             uint64_t return_address{};
             win_emu.emu().try_read_memory(rsp, &return_address, sizeof(return_address));
 
-            const auto* mod_name = win_emu.mod_manager.find_name(return_address);
+            const auto caller = win_emu.symbols.describe(win_emu.mod_manager, return_address);
 
             win_emu.log.print(is_interesting_call ? color::yellow : color::dark_gray,
-                              "Executing function: %s - %s (0x%" PRIx64 ") via (0x%" PRIx64 ") %s\n",
-                              binary->name.c_str(), export_entry->second.c_str(), address, return_address, mod_name);
+                              "Executing function: %s - %.*s (0x%" PRIx64 ") via (0x%" PRIx64 ") %s\n",
+                              binary->name.c_str(), STR_VIEW_VA(function_name), address, return_address,
+                              caller.c_str());
 
             if (is_interesting_call)
             {
-                handle_function_details(c, export_entry->second);
+                handle_function_details(c, function_name);
             }
         }
         else if (address == binary->entry_point)
@@ -307,6 +425,9 @@ void register_analysis_callbacks(analysis_context& c)
     cb.on_memory_violate = make_callback(c, handle_memory_violate);
     cb.on_memory_allocate = make_callback(c, handle_memory_allocate);
 
+    cb.on_heap_allocate = make_callback(c, handle_heap_allocate);
+    cb.on_heap_free = make_callback(c, handle_heap_free);
+
     cb.on_module_load = make_callback(c, handle_module_load);
     cb.on_module_unload = make_callback(c, handle_module_unload);
 
@@ -314,6 +435,8 @@ void register_analysis_callbacks(analysis_context& c)
     cb.on_thread_set_name = make_callback(c, handle_thread_set_name);
 
     cb.on_instruction = make_callback(c, handle_instruction);
+    cb.on_cpuid = make_callback(c, handle_cpuid);
+    cb.on_debug_output = make_callback(c, handle_debug_output);
     cb.on_generic_access = make_callback(c, handle_generic_access);
     cb.on_generic_activity = make_callback(c, handle_generic_activity);
     cb.on_suspicious_activity = make_callback(c, handle_suspicious_activity);
@@ -338,4 +461,58 @@ mapped_module* get_module_if_interesting(module_manager& manager, const string_s
     }
 
     return nullptr;
-}
\ No newline at end of file
+}
+
+void print_heap_report(windows_emulator& win_emu, const size_t top_callers)
+{
+    struct caller_summary
+    {
+        uint64_t caller{};
+        uint64_t allocations{};
+        uint64_t bytes{};
+    };
+
+    const auto& allocations = win_emu.heap.get_allocations();
+    const auto& statistics = win_emu.heap.get_statistics();
+
+    std::unordered_map<uint64_t, caller_summary> callers{};
+    uint64_t live_bytes{};
+
+    for (const auto& allocation : allocations | std::views::values)
+    {
+        auto& summary = callers[allocation.caller];
+        summary.caller = allocation.caller;
+        ++summary.allocations;
+        summary.bytes += allocation.size;
+
+        live_bytes += allocation.size;
+    }
+
+    win_emu.log.print(color::cyan,
+                      "Heap: %" PRIu64 " allocations, %" PRIu64 " reallocations, %" PRIu64 " frees, %" PRIu64
+                      " bytes allocated\n",
+                      statistics.allocations, statistics.reallocations, statistics.frees, statistics.allocated_bytes);
+    win_emu.log.print(color::cyan, "Live heap blocks at exit: %zu (%" PRIu64 " bytes)\n", allocations.size(),
+                      live_bytes);
+
+    std::vector<caller_summary> sorted_callers{};
+    sorted_callers.reserve(callers.size());
+
+    for (const auto& summary : callers | std::views::values)
+    {
+        sorted_callers.push_back(summary);
+    }
+
+    std::ranges::sort(sorted_callers, [](const caller_summary& a, const caller_summary& b) {
+        return a.bytes > b.bytes; //
+    });
+
+    for (size_t i = 0; i < std::min(top_callers, sorted_callers.size()); ++i)
+    {
+        const auto& summary = sorted_callers[i];
+        const auto symbol = win_emu.symbols.describe(win_emu.mod_manager, summary.caller);
+
+        win_emu.log.print(color::gray, "  %10" PRIu64 " bytes in %6" PRIu64 " blocks from 0x%" PRIx64 " (%s)\n",
+                          summary.bytes, summary.allocations, summary.caller, symbol.c_str());
+    }
+}
@@ -15,6 +15,7 @@ struct analysis_settings
     bool verbose_logging{false};
     bool silent{false};
     bool buffer_stdout{false};
+    bool stack_traces{false};
 
     string_set modules{};
     string_set ignored_functions{};
@@ -30,4 +31,7 @@ struct analysis_context
 };
 
 void register_analysis_callbacks(analysis_context& c);
-mapped_module* get_module_if_interesting(module_manager& manager, const string_set& modules, uint64_t address);
\ No newline at end of file
+mapped_module* get_module_if_interesting(module_manager& manager, const string_set& modules, uint64_t address);
+
+// Summarizes heap statistics and the live allocations grouped by their caller
+void print_heap_report(windows_emulator& win_emu, size_t top_callers = 10);
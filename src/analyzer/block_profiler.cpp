@@ -0,0 +1,618 @@
+#include "std_include.hpp"
+#include "block_profiler.hpp"
+
+#include <windows_emulator.hpp>
+#include <address_utils.hpp>
+
+#include <numeric>
+#include <algorithm>
+
+namespace
+{
+    constexpr size_t max_instruction_length = 15;
+    constexpr size_t max_block_size = 0x4000;
+
+    struct decoded_instruction
+    {
+        size_t length{};
+        instruction_class type{instruction_class::general};
+    };
+
+    struct byte_cursor
+    {
+        std::span<const uint8_t> code{};
+        size_t offset{};
+        bool failed{false};
+
+        uint8_t peek() const
+        {
+            return this->offset < this->code.size() ? this->code[this->offset] : 0;
+        }
+
+        uint8_t next()
+        {
+            if (this->offset >= this->code.size())
+            {
+                this->failed = true;
+                return 0;
+            }
+
+            return this->code[this->offset++];
+        }
+
+        void skip(const size_t count)
+        {
+            if (this->code.size() - this->offset < count)
+            {
+                this->failed = true;
+                this->offset = this->code.size();
+                return;
+            }
+
+            this->offset += count;
+        }
+    };
+
+    void skip_memory_operand(byte_cursor& cursor, const uint8_t modrm)
+    {
+        const auto mod = modrm >> 6;
+        const auto rm = modrm & 7;
+
+        if (mod == 3)
+        {
+            return;
+        }
+
+        if (rm == 4)
+        {
+            const auto sib = cursor.next();
+            if (mod == 0 && (sib & 7) == 5)
+            {
+                cursor.skip(4);
+            }
+        }
+        else if (mod == 0 && rm == 5)
+        {
+            cursor.skip(4);
+        }
+
+        if (mod == 1)
+        {
+            cursor.skip(1);
+        }
+        else if (mod == 2)
+        {
+            cursor.skip(4);
+        }
+    }
+
+    uint8_t read_modrm(byte_cursor& cursor)
+    {
+        const auto modrm = cursor.next();
+        skip_memory_operand(cursor, modrm);
+        return modrm;
+    }
+
+    bool is_vex_immediate_opcode(const uint8_t map, const uint8_t opcode)
+    {
+        if (map == 3)
+        {
+            return true;
+        }
+
+        return map == 1 && ((opcode >= 0x70 && opcode <= 0x73) || (opcode >= 0xC4 && opcode <= 0xC6) || opcode == 0xC2);
+    }
+
+    instruction_class decode_vex(byte_cursor& cursor, const uint8_t escape)
+    {
+        uint8_t map = 1;
+
+        if (escape == 0xC5)
+        {
+            cursor.skip(1);
+        }
+        else if (escape == 0xC4)
+        {
+            map = cursor.next() & 0x1F;
+            cursor.skip(1);
+        }
+        else
+        {
+            map = cursor.next() & 0x7;
+            cursor.skip(2);
+        }
+
+        const auto opcode = cursor.next();
+
+        // vzeroupper/vzeroall
+        if (map != 1 || opcode != 0x77)
+        {
+            (void)read_modrm(cursor);
+        }
+
+        if (is_vex_immediate_opcode(map, opcode))
+        {
+            cursor.skip(1);
+        }
+
+        return instruction_class::avx;
+    }
+
+    instruction_class decode_two_byte(byte_cursor& cursor)
+    {
+        const auto opcode = cursor.next();
+
+        if (opcode == 0x38 || opcode == 0x3A)
+        {
+            const auto opcode3 = cursor.next();
+            (void)read_modrm(cursor);
+
+            if (opcode == 0x3A)
+            {
+                cursor.skip(1);
+            }
+
+            // movbe and crc32
+            if (opcode == 0x38 && opcode3 >= 0xF0)
+            {
+                return instruction_class::general;
+            }
+
+            return instruction_class::sse;
+        }
+
+        if (opcode >= 0x80 && opcode <= 0x8F)
+        {
+            cursor.skip(4);
+            return instruction_class::branch;
+        }
+
+        const auto has_modrm = !(opcode == 0x05 || opcode == 0x06 || opcode == 0x07 || opcode == 0x08 ||
+                                 opcode == 0x09 || opcode == 0x0B || opcode == 0x0E || opcode == 0x77 ||
+                                 (opcode >= 0x30 && opcode <= 0x37) || (opcode >= 0xA0 && opcode <= 0xA2) ||
+                                 (opcode >= 0xA8 && opcode <= 0xAA) || (opcode >= 0xC8 && opcode <= 0xCF));
+
+        if (has_modrm)
+        {
+            (void)read_modrm(cursor);
+        }
+
+        const auto has_immediate = (opcode >= 0x70 && opcode <= 0x73) || opcode == 0xA4 || opcode == 0xAC ||
+                                   opcode == 0xBA || opcode == 0xC2 || (opcode >= 0xC4 && opcode <= 0xC6);
+
+        if (has_immediate)
+        {
+            cursor.skip(1);
+        }
+
+        if (opcode == 0x05 || opcode == 0x34)
+        {
+            return instruction_class::syscall;
+        }
+
+        if ((opcode >= 0x10 && opcode <= 0x17) || (opcode >= 0x28 && opcode <= 0x2F) ||
+            (opcode >= 0x50 && opcode <= 0x7F) || (opcode >= 0xC2 && opcode <= 0xC6) || opcode >= 0xD0)
+        {
+            return instruction_class::sse;
+        }
+
+        return instruction_class::general;
+    }
+
+    instruction_class decode_one_byte(byte_cursor& cursor, const uint8_t opcode, const bool operand_size_override,
+                                      const bool address_size_override, const bool rex_w)
+    {
+        const size_t immediate_size = operand_size_override ? 2 : 4;
+
+        if (opcode < 0x40)
+        {
+            const auto low = opcode & 7;
+            if (low < 4)
+            {
+                (void)read_modrm(cursor);
+            }
+            else if (low == 4)
+            {
+                cursor.skip(1);
+            }
+            else if (low == 5)
+            {
+                cursor.skip(immediate_size);
+            }
+
+            return instruction_class::general;
+        }
+
+        if ((opcode >= 0x6C && opcode <= 0x6F) || (opcode >= 0xA4 && opcode <= 0xA7) ||
+            (opcode >= 0xAA && opcode <= 0xAF))
+        {
+            return instruction_class::string;
+        }
+
+        if ((opcode >= 0x70 && opcode <= 0x7F) || (opcode >= 0xE0 && opcode <= 0xE3) || opcode == 0xEB)
+        {
+            cursor.skip(1);
+            return instruction_class::branch;
+        }
+
+        if (opcode >= 0xD8 && opcode <= 0xDF)
+        {
+            (void)read_modrm(cursor);
+            return instruction_class::x87;
+        }
+
+        if (opcode >= 0xB0 && opcode <= 0xB7)
+        {
+            cursor.skip(1);
+            return instruction_class::general;
+        }
+
+        if (opcode >= 0xB8 && opcode <= 0xBF)
+        {
+            cursor.skip(rex_w ? 8 : immediate_size);
+            return instruction_class::general;
+        }
+
+        if (opcode >= 0xA0 && opcode <= 0xA3)
+        {
+            cursor.skip(address_size_override ? 4 : 8);
+            return instruction_class::general;
+        }
+
+        if (opcode == 0x86 || opcode == 0x87)
+        {
+            // xchg with a memory operand is implicitly locked
+            const auto modrm = read_modrm(cursor);
+            return (modrm >> 6) != 3 ? instruction_class::locked : instruction_class::general;
+        }
+
+        if (opcode == 0xF6 || opcode == 0xF7)
+        {
+            const auto modrm = read_modrm(cursor);
+            if (((modrm >> 3) & 7) < 2)
+            {
+                cursor.skip(opcode == 0xF6 ? 1 : immediate_size);
+            }
+
+            return instruction_class::general;
+        }
+
+        if (opcode == 0xFF)
+        {
+            const auto reg = (read_modrm(cursor) >> 3) & 7;
+            return reg >= 2 && reg <= 5 ? instruction_class::branch : instruction_class::general;
+        }
+
+        switch (opcode)
+        {
+        case 0x63:
+        case 0x84:
+        case 0x85:
+        case 0x88:
+        case 0x89:
+        case 0x8A:
+        case 0x8B:
+        case 0x8C:
+        case 0x8D:
+        case 0x8E:
+        case 0x8F:
+        case 0xD0:
+        case 0xD1:
+        case 0xD2:
+        case 0xD3:
+        case 0xFE:
+            (void)read_modrm(cursor);
+            return instruction_class::general;
+
+        case 0x69:
+        case 0x81:
+        case 0xC7:
+            (void)read_modrm(cursor);
+            cursor.skip(immediate_size);
+            return instruction_class::general;
+
+        case 0x6B:
+        case 0x80:
+        case 0x83:
+        case 0xC0:
+        case 0xC1:
+        case 0xC6:
+            (void)read_modrm(cursor);
+            cursor.skip(1);
+            return instruction_class::general;
+
+        case 0x68:
+        case 0xA9:
+            cursor.skip(immediate_size);
+            return instruction_class::general;
+
+        case 0x6A:
+        case 0xA8:
+        case 0xE4:
+        case 0xE5:
+        case 0xE6:
+        case 0xE7:
+            cursor.skip(1);
+            return instruction_class::general;
+
+        case 0xC8:
+            cursor.skip(3);
+            return instruction_class::general;
+
+        case 0xC2:
+        case 0xCA:
+            cursor.skip(2);
+            return instruction_class::branch;
+
+        case 0xC3:
+        case 0xCB:
+        case 0xCF:
+            return instruction_class::branch;
+
+        case 0xE8:
+        case 0xE9:
+            cursor.skip(4);
+            return instruction_class::branch;
+
+        case 0xCD:
+            cursor.skip(1);
+            return instruction_class::syscall;
+
+        case 0x9B:
+            return instruction_class::x87;
+
+        default:
+            return instruction_class::general;
+        }
+    }
+
+    std::optional<decoded_instruction> decode_instruction(const std::span<const uint8_t> code)
+    {
+        byte_cursor cursor{.code = code.subspan(0, std::min(code.size(), max_instruction_length))};
+
+        bool lock = false;
+        bool operand_size_override = false;
+        bool address_size_override = false;
+        bool rex_w = false;
+
+        while (!cursor.failed)
+        {
+            const auto prefix = cursor.peek();
+
+            if (prefix == 0xF0)
+            {
+                lock = true;
+            }
+            else if (prefix == 0x66)
+            {
+                operand_size_override = true;
+            }
+            else if (prefix == 0x67)
+            {
+                address_size_override = true;
+            }
+            else if (prefix != 0xF2 && prefix != 0xF3 && prefix != 0x2E && prefix != 0x36 && prefix != 0x3E &&
+                     prefix != 0x26 && prefix != 0x64 && prefix != 0x65)
+            {
+                break;
+            }
+
+            cursor.skip(1);
+        }
+
+        if ((cursor.peek() & 0xF0) == 0x40)
+        {
+            rex_w = (cursor.next() & 0x8) != 0;
+        }
+
+        const auto opcode = cursor.next();
+        instruction_class type{};
+
+        if (opcode == 0x0F)
+        {
+            type = decode_two_byte(cursor);
+        }
+        else if (opcode == 0xC4 || opcode == 0xC5 || opcode == 0x62)
+        {
+            type = decode_vex(cursor, opcode);
+        }
+        else
+        {
+            type = decode_one_byte(cursor, opcode, operand_size_override, address_size_override, rex_w);
+        }
+
+        if (cursor.failed)
+        {
+            return std::nullopt;
+        }
+
+        return decoded_instruction{
+            .length = cursor.offset,
+            .type = lock ? instruction_class::locked : type,
+        };
+    }
+
+    std::vector<uint8_t> read_block_code(const x86_64_emulator& emu, const uint64_t address, const size_t size)
+    {
+        std::vector<uint8_t> code{};
+        code.resize(size);
+
+        if (emu.try_read_memory(address, code.data(), code.size()))
+        {
+            return code;
+        }
+
+        // The estimated size may reach into an unmapped page
+        code.resize(std::min(size, static_cast<size_t>(page_align_up(address + 1) - address)));
+
+        if (!emu.try_read_memory(address, code.data(), code.size()))
+        {
+            code.clear();
+        }
+
+        return code;
+    }
+}
+
+block_profiler::block_profiler(windows_emulator& win_emu)
+    : win_emu_(&win_emu)
+{
+    auto* hook = win_emu.emu().hook_basic_block([this](const basic_block& block) {
+        this->handle_block(block); //
+    });
+
+    this->hook_ = scoped_hook(win_emu.emu(), hook);
+}
+
+void block_profiler::handle_block(const basic_block& block)
+{
+    const block_key key{
+        .address = block.address,
+        .size = block.size,
+        .instruction_count = block.instruction_count,
+    };
+
+    auto entry = this->blocks_.find(key);
+    if (entry == this->blocks_.end())
+    {
+        entry = this->blocks_.emplace(key, this->summarize_block(block)).first;
+    }
+
+    ++entry->second.executions;
+}
+
+block_summary block_profiler::summarize_block(const basic_block& block) const
+{
+    block_summary summary{};
+    summary.address = block.address;
+
+    const auto* mod = this->win_emu_->mod_manager.find_by_address(block.address);
+    summary.module = mod ? mod->name : "<unknown>";
+
+    // Backends report either the block size or its instruction count
+    const auto code_size = block.size ? block.size : block.instruction_count * max_instruction_length;
+    const auto code = read_block_code(this->win_emu_->emu(), block.address, std::min(code_size, max_block_size));
+
+    size_t offset = 0;
+    size_t decoded = 0;
+
+    while (offset < code.size() && (block.size || decoded < block.instruction_count))
+    {
+        const auto instruction = decode_instruction(std::span(code).subspan(offset));
+        if (!instruction)
+        {
+            break;
+        }
+
+        ++summary.instruction_mix[static_cast<size_t>(instruction->type)];
+        offset += instruction->length;
+        ++decoded;
+    }
+
+    summary.size = block.size ? block.size : offset;
+    summary.instruction_count = block.instruction_count ? block.instruction_count : decoded;
+
+    return summary;
+}
+
+void block_profiler::print_report(const size_t hottest_blocks) const
+{
+    struct module_profile
+    {
+        std::string_view name{};
+        uint64_t instructions{};
+        std::vector<const block_summary*> blocks{};
+    };
+
+    constexpr auto class_count = static_cast<size_t>(instruction_class::count);
+
+    std::array<uint64_t, class_count> instruction_mix{};
+    std::unordered_map<std::string_view, module_profile> modules{};
+    uint64_t total_instructions{};
+
+    for (const auto& block : this->blocks_ | std::views::values)
+    {
+        auto& profile = modules[block.module];
+        profile.name = block.module;
+        profile.instructions += block.executions * block.instruction_count;
+        profile.blocks.push_back(&block);
+
+        total_instructions += block.executions * block.instruction_count;
+
+        for (size_t i = 0; i < class_count; ++i)
+        {
+            instruction_mix[i] += block.executions * block.instruction_mix[i];
+        }
+    }
+
+    auto& log = this->win_emu_->log;
+
+    log.print(color::cyan, "Block profile: %zu unique blocks, %" PRIu64 " instructions executed\n",
+              this->blocks_.size(), total_instructions);
+
+    const auto decoded_instructions = std::max<uint64_t>(
+        std::accumulate(instruction_mix.begin(), instruction_mix.end(), static_cast<uint64_t>(0)), 1);
+
+    log.print(color::cyan, "Instruction mix:\n");
+
+    for (size_t i = 0; i < class_count; ++i)
+    {
+        log.print(color::gray, "  %-8s %12" PRIu64 " (%5.2f%%)\n",
+                  get_instruction_class_name(static_cast<instruction_class>(i)), instruction_mix[i],
+                  100.0 * static_cast<double>(instruction_mix[i]) / static_cast<double>(decoded_instructions));
+    }
+
+    std::vector<module_profile*> sorted_modules{};
+    sorted_modules.reserve(modules.size());
+
+    for (auto& profile : modules | std::views::values)
+    {
+        sorted_modules.push_back(&profile);
+    }
+
+    std::ranges::sort(sorted_modules, std::greater{}, &module_profile::instructions);
+
+    for (auto* profile : sorted_modules)
+    {
+        log.print(color::cyan, "%.*s: %" PRIu64 " instructions in %zu blocks\n", static_cast<int>(profile->name.size()),
+                  profile->name.data(), profile->instructions, profile->blocks.size());
+
+        const auto count = std::min(hottest_blocks, profile->blocks.size());
+        std::ranges::partial_sort(profile->blocks, profile->blocks.begin() + static_cast<ptrdiff_t>(count),
+                                  std::greater{}, &block_summary::executions);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const auto& block = *profile->blocks[i];
+            const auto symbol = this->win_emu_->symbols.describe(this->win_emu_->mod_manager, block.address);
+
+            log.print(color::gray, "  0x%" PRIx64 " %-40s %10" PRIu64 " x %zu instructions\n", block.address,
+                      symbol.c_str(), block.executions, block.instruction_count);
+        }
+    }
+}
+
+const char* get_instruction_class_name(const instruction_class c)
+{
+    switch (c)
+    {
+    case instruction_class::general:
+        return "general";
+    case instruction_class::branch:
+        return "branch";
+    case instruction_class::string:
+        return "string";
+    case instruction_class::x87:
+        return "x87";
+    case instruction_class::sse:
+        return "sse";
+    case instruction_class::avx:
+        return "avx";
+    case instruction_class::syscall:
+        return "syscall";
+    case instruction_class::locked:
+        return "locked";
+    default:
+        return "?";
+    }
+}
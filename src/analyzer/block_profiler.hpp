@@ -0,0 +1,67 @@
+#pragma once
+
+#include <scoped_hook.hpp>
+
+class windows_emulator;
+
+enum class instruction_class : uint8_t
+{
+    general,
+    branch,
+    string,
+    x87,
+    sse,
+    avx,
+    syscall,
+    locked,
+    count,
+};
+
+struct block_summary
+{
+    uint64_t address{};
+    size_t size{};
+    size_t instruction_count{};
+    std::string module{};
+    std::array<uint32_t, static_cast<size_t>(instruction_class::count)> instruction_mix{};
+    uint64_t executions{};
+};
+
+// Counts basic block executions through the backend block hook.
+// Each unique block is decoded once, the hot path only bumps a counter.
+class block_profiler
+{
+  public:
+    block_profiler(windows_emulator& win_emu);
+
+    void print_report(size_t hottest_blocks = 10) const;
+
+  private:
+    // Code rewritten into a block of another size at the same address is summarized again
+    struct block_key
+    {
+        uint64_t address{};
+        size_t size{};
+        size_t instruction_count{};
+
+        bool operator==(const block_key&) const = default;
+    };
+
+    struct block_key_hash
+    {
+        size_t operator()(const block_key& key) const noexcept
+        {
+            return std::hash<uint64_t>{}(key.address ^ (static_cast<uint64_t>(key.size) << 32) ^
+                                         (static_cast<uint64_t>(key.instruction_count) << 48));
+        }
+    };
+
+    windows_emulator* win_emu_{};
+    scoped_hook hook_{};
+    std::unordered_map<block_key, block_summary, block_key_hash> blocks_{};
+
+    void handle_block(const basic_block& block);
+    block_summary summarize_block(const basic_block& block) const;
+};
+
+const char* get_instruction_class_name(instruction_class c);
@@ -8,7 +8,9 @@
 #include "object_watching.hpp"
 #include "snapshot.hpp"
 #include "analysis.hpp"
+#include "block_profiler.hpp"
 
+#include <utils/io.hpp>
 #include <utils/finally.hpp>
 #include <utils/interupt_handler.hpp>
 
@@ -24,10 +26,24 @@ namespace
     {
         mutable bool use_gdb{false};
         bool log_executable_access{false};
+        bool native_function_lookup{false};
+        bool fast_memory_queries{false};
+        bool profile_blocks{false};
+        bool file_overlay{false};
+        bool heap_tracking{false};
         std::filesystem::path dump{};
+        std::filesystem::path dropped_files{};
         std::filesystem::path minidump_path{};
         std::string registry_path{"./registry"};
+        std::filesystem::path registry_delta{};
+        std::string cpu_profile{"default"};
+        uint32_t debug_output_rate{1000};
+        std::filesystem::path stdin_file{};
+        console_mode console_input_mode{console_mode::line};
         std::string emulation_root{};
+        std::filesystem::path symbol_directory{};
+        std::vector<std::filesystem::path> plugins{};
+        std::vector<syscall_fault_rule> syscall_faults{};
         std::unordered_map<windows_path, std::filesystem::path> path_mappings{};
     };
 
@@ -230,11 +246,38 @@ namespace
         return wide_args;
     }
 
+    std::optional<std::string> read_console_input(const analysis_options& options)
+    {
+        if (options.stdin_file.empty())
+        {
+            return std::nullopt;
+        }
+
+        std::vector<std::byte> data{};
+        if (!utils::io::read_file(options.stdin_file, &data))
+        {
+            throw std::runtime_error("Failed to read stdin file: " + options.stdin_file.string());
+        }
+
+        return std::string(reinterpret_cast<const char*>(data.data()), data.size());
+    }
+
     emulator_settings create_emulator_settings(const analysis_options& options)
     {
         return {
+            .use_native_function_lookup = options.native_function_lookup,
+            .use_fast_memory_queries = options.fast_memory_queries,
+            .use_file_overlay = options.file_overlay || !options.dropped_files.empty(),
+            .track_heap_allocations = options.heap_tracking,
+            .cpu_profile = options.cpu_profile,
+            .max_debug_messages_per_second = options.debug_output_rate,
+            .console_input = read_console_input(options),
+            .console_input_mode = options.console_input_mode,
+            .syscall_faults = options.syscall_faults,
             .emulation_root = options.emulation_root,
             .registry_directory = options.registry_path,
+            .registry_delta = options.registry_delta,
+            .symbol_directory = options.symbol_directory,
             .path_mappings = options.path_mappings,
         };
     }
@@ -296,27 +339,58 @@ namespace
 
         win_emu->log.log("Using emulator: %s\n", win_emu->emu().get_name().c_str());
 
-        register_analysis_callbacks(context);
-        watch_system_objects(*win_emu, options.modules, options.verbose_logging);
-
-        const auto& exe = *win_emu->mod_manager.executable;
+        std::optional<block_profiler> profiler{};
+        if (options.profile_blocks)
+        {
+            profiler.emplace(*win_emu);
+        }
 
-        const auto concise_logging = !options.verbose_logging;
+        const auto _ = utils::finally([&] {
+            if (profiler && !options.silent)
+            {
+                win_emu->log.disable_output(false);
+                profiler->print_report();
+            }
+        });
 
-        win_emu->emu().hook_instruction(x86_hookable_instructions::cpuid, [&] {
-            const auto rip = win_emu->emu().read_instruction_pointer();
-            auto* mod = get_module_if_interesting(win_emu->mod_manager, options.modules, rip);
+        const auto heap_report = utils::finally([&] {
+            if (options.heap_tracking && !options.silent)
+            {
+                win_emu->log.disable_output(false);
+                print_heap_report(*win_emu);
+            }
+        });
 
-            if (mod)
+        const auto export_dropped_files = utils::finally([&] {
+            const auto* overlay = win_emu->file_sys.overlay();
+            if (overlay && !options.dropped_files.empty())
             {
-                const auto leaf = win_emu->emu().reg<uint32_t>(x86_register::eax);
-                win_emu->log.print(color::blue, "Executing CPUID instruction with leaf 0x%X at 0x%" PRIx64 " (%s)\n",
-                                   leaf, rip, mod->name.c_str());
+                const auto count = overlay->export_files(options.dropped_files);
+                win_emu->log.log("Exported %zu dropped files to %s\n", count, options.dropped_files.string().c_str());
             }
+        });
 
-            return instruction_hook_continuation::run_instruction;
+        const auto save_registry_delta = utils::finally([&] {
+            if (!options.registry_delta.empty() && !win_emu->registry.save_overlay(options.registry_delta))
+            {
+                win_emu->log.error("Failed to save registry delta to %s\n", options.registry_delta.string().c_str());
+            }
         });
 
+        register_analysis_callbacks(context);
+
+        for (const auto& plugin_file : options.plugins)
+        {
+            const auto& plugin = win_emu->plugins.load(plugin_file);
+            win_emu->log.log("Loaded plugin: %s\n", std::string(plugin.get_name()).c_str());
+        }
+
+        watch_system_objects(*win_emu, options.modules, options.verbose_logging);
+
+        const auto& exe = *win_emu->mod_manager.executable;
+
+        const auto concise_logging = !options.verbose_logging;
+
         if (options.log_executable_access)
         {
             for (const auto& section : exe.sections)
@@ -401,13 +475,28 @@ namespace
         printf("  -b, --buffer              Buffer stdout\n");
         printf("  -c, --concise             Concise logging\n");
         printf("  -x, --exec                Log r/w access to executable memory\n");
+        printf("  -t, --stack-traces        Print guest stack traces for violations and suspicious activity\n");
         printf("  -m, --module <module>     Specify module to track\n");
         printf("  -e, --emulation <path>    Set emulation root path\n");
         printf("  -a, --snapshot <path>     Load snapshot dump from path\n");
         printf("  --minidump <path>         Load minidump from path\n");
+        printf("  --fast-unwind             Answer RtlLookupFunctionEntry natively\n");
+        printf("  --fast-vquery             Answer sequential NtQueryVirtualMemory sweeps natively\n");
+        printf("  --cpu-profile <name>      Guest CPU features: fast-emulation, default, modern, avx512\n");
+        printf("  --debug-rate <n>          Max. guest debug messages per second, 0 for no limit (default: 1000)\n");
+        printf("  --stdin <path>            Feed the contents of path to the guest's stdin\n");
+        printf("  --console-mode <mode>     Guest stdin mode: raw, line, cooked (default: line)\n");
+        printf("  --profile                 Report hot blocks and instruction mix at exit\n");
+        printf("  --plugin <path>           Load an analysis plugin from a shared library (repeatable)\n");
+        printf("  --heap                    Track guest heap allocations, report live blocks at exit\n");
+        printf("  --fault <spec>            Fail a syscall, <name>[:<status>[:<call>[:<count>]]] (repeatable)\n");
+        printf("  -o, --overlay             Keep guest file modifications in memory\n");
+        printf("  --dropped-files <path>    Export files written by the guest to path (implies -o)\n");
         printf("  -i, --ignore <funcs>      Comma-separated list of functions to ignore\n");
         printf("  -p, --path <src> <dst>    Map Windows path to host path\n");
-        printf("  -r, --registry <path>     Set registry path (default: ./registry)\n\n");
+        printf("  -r, --registry <path>     Set registry path (default: ./registry)\n");
+        printf("  --registry-delta <path>   Load guest registry changes from path and save them back at exit\n");
+        printf("  -y, --symbols <path>      Load PDBs from a local symbol directory\n\n");
         printf("Examples:\n");
         printf("  analyzer -v -e path/to/root myapp.exe\n");
         printf("  analyzer -e path/to/root -p c:/analysis-sample.exe /path/to/sample.exe c:/analysis-sample.exe\n");
@@ -488,6 +577,100 @@ namespace
                 arg_it = args.erase(arg_it);
                 options.minidump_path = args[0];
             }
+            else if (arg == "-t" || arg == "--stack-traces")
+            {
+                options.stack_traces = true;
+            }
+            else if (arg == "--profile")
+            {
+                options.profile_blocks = true;
+            }
+            else if (arg == "--fast-unwind")
+            {
+                options.native_function_lookup = true;
+            }
+            else if (arg == "--fast-vquery")
+            {
+                options.fast_memory_queries = true;
+            }
+            else if (arg == "--cpu-profile")
+            {
+                if (args.size() < 2)
+                {
+                    throw std::runtime_error("No profile provided after --cpu-profile");
+                }
+                arg_it = args.erase(arg_it);
+                options.cpu_profile = args[0];
+            }
+            else if (arg == "--debug-rate")
+            {
+                if (args.size() < 2)
+                {
+                    throw std::runtime_error("No rate provided after --debug-rate");
+                }
+                arg_it = args.erase(arg_it);
+                options.debug_output_rate = static_cast<uint32_t>(std::stoul(std::string(args[0])));
+            }
+            else if (arg == "--stdin")
+            {
+                if (args.size() < 2)
+                {
+                    throw std::runtime_error("No path provided after --stdin");
+                }
+                arg_it = args.erase(arg_it);
+                options.stdin_file = args[0];
+            }
+            else if (arg == "--console-mode")
+            {
+                if (args.size() < 2)
+                {
+                    throw std::runtime_error("No mode provided after --console-mode");
+                }
+                arg_it = args.erase(arg_it);
+
+                const auto mode = get_console_mode(args[0]);
+                if (!mode)
+                {
+                    throw std::runtime_error("Unknown console mode: " + std::string(args[0]));
+                }
+
+                options.console_input_mode = *mode;
+            }
+            else if (arg == "--plugin")
+            {
+                if (args.size() < 2)
+                {
+                    throw std::runtime_error("No path provided after --plugin");
+                }
+                arg_it = args.erase(arg_it);
+                options.plugins.emplace_back(args[0]);
+            }
+            else if (arg == "--heap")
+            {
+                options.heap_tracking = true;
+            }
+            else if (arg == "--fault")
+            {
+                if (args.size() < 2)
+                {
+                    throw std::runtime_error("No specification provided after --fault");
+                }
+                arg_it = args.erase(arg_it);
+                options.syscall_faults.push_back(parse_syscall_fault_rule(args[0]));
+            }
+            else if (arg == "-o" || arg == "--overlay")
+            {
+                options.file_overlay = true;
+            }
+            else if (arg == "--dropped-files")
+            {
+                if (args.size() < 2)
+                {
+                    throw std::runtime_error("No path provided after --dropped-files");
+                }
+                arg_it = args.erase(arg_it);
+                options.dropped_files = args[0];
+            }
             else if (arg == "-i" || arg == "--ignore")
             {
                 if (args.size() < 2)
@@ -519,6 +702,24 @@ namespace
                 arg_it = args.erase(arg_it);
                 options.registry_path = args[0];
             }
+            else if (arg == "--registry-delta")
+            {
+                if (args.size() < 2)
+                {
+                    throw std::runtime_error("No delta path provided after --registry-delta");
+                }
+                arg_it = args.erase(arg_it);
+                options.registry_delta = args[0];
+            }
+            else if (arg == "-y" || arg == "--symbols")
+            {
+                if (args.size() < 2)
+                {
+                    throw std::runtime_error("No symbol path provided after -y/--symbols");
+                }
+                arg_it = args.erase(arg_it);
+                options.symbol_directory = args[0];
+            }
             else
             {
                 break;
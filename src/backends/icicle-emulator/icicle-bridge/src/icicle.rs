@@ -39,6 +39,10 @@ fn map_permissions(foreign_permissions: u8) -> u8 {
     return permissions;
 }
 
+// Software interrupt values raised by the patched CPUID and XGETBV definitions
+const CPUID_TRAP: u64 = 0xA20F;
+const XGETBV_TRAP: u64 = 0xD0010F;
+
 #[repr(u8)]
 #[allow(dead_code)]
 #[derive(PartialEq)]
@@ -51,6 +55,8 @@ enum HookType {
     Violation,
     Interrupt,
     Block,
+    Cpuid,
+    Xgetbv,
     Unknown,
 }
 
@@ -243,6 +249,8 @@ pub struct IcicleEmulator {
     vm: icicle_vm::Vm,
     reg: registers::X86RegisterNodes,
     syscall_hooks: HookContainer<dyn Fn()>,
+    cpuid_hooks: HookContainer<dyn Fn()>,
+    xgetbv_hooks: HookContainer<dyn Fn()>,
     interrupt_hooks: HookContainer<dyn Fn(i32)>,
     violation_hooks: HookContainer<dyn Fn(u64, u8, bool) -> bool>,
     execution_hooks: Rc<RefCell<ExecutionHooks>>,
@@ -327,6 +335,8 @@ impl IcicleEmulator {
             reg: registers::X86RegisterNodes::new(&virtual_machine.cpu.arch),
             vm: virtual_machine,
             syscall_hooks: HookContainer::new(),
+            cpuid_hooks: HookContainer::new(),
+            xgetbv_hooks: HookContainer::new(),
             interrupt_hooks: HookContainer::new(),
             violation_hooks: HookContainer::new(),
             execution_hooks: exec_hooks,
@@ -407,7 +417,31 @@ impl IcicleEmulator {
         return continue_execution;
     }
 
+    fn handle_trapped_instruction(&mut self, hook_type: HookType, length: u64) -> bool {
+        let hooks = if hook_type == HookType::Cpuid {
+            &self.cpuid_hooks
+        } else {
+            &self.xgetbv_hooks
+        };
+
+        for (_key, func) in hooks.get_hooks() {
+            func();
+        }
+
+        self.vm.cpu.write_pc(self.vm.cpu.read_pc() + length);
+        return true;
+    }
+
     fn handle_syscall(&mut self, value: u64) -> bool {
+        // See the CPUID and XGETBV definitions in ia.sinc
+        if value == CPUID_TRAP {
+            return self.handle_trapped_instruction(HookType::Cpuid, 2);
+        }
+
+        if value == XGETBV_TRAP {
+            return self.handle_trapped_instruction(HookType::Xgetbv, 3);
+        }
+
         if value != 0 {
             return self.handle_interrupt(value as i32);
         }
@@ -456,6 +490,16 @@ impl IcicleEmulator {
         return qualify_hook_id(hook_id, HookType::Syscall);
     }
 
+    pub fn add_cpuid_hook(&mut self, callback: Box<dyn Fn()>) -> u32 {
+        let hook_id = self.cpuid_hooks.add_hook(callback);
+        return qualify_hook_id(hook_id, HookType::Cpuid);
+    }
+
+    pub fn add_xgetbv_hook(&mut self, callback: Box<dyn Fn()>) -> u32 {
+        let hook_id = self.xgetbv_hooks.add_hook(callback);
+        return qualify_hook_id(hook_id, HookType::Xgetbv);
+    }
+
     pub fn add_interrupt_hook(&mut self, callback: Box<dyn Fn(i32)>) -> u32 {
         let hook_id = self.interrupt_hooks.add_hook(callback);
         return qualify_hook_id(hook_id, HookType::Interrupt);
@@ -498,6 +542,8 @@ impl IcicleEmulator {
 
         match hook_type {
             HookType::Syscall => self.syscall_hooks.remove_hook(hook_id),
+            HookType::Cpuid => self.cpuid_hooks.remove_hook(hook_id),
+            HookType::Xgetbv => self.xgetbv_hooks.remove_hook(hook_id),
             HookType::Violation => self.violation_hooks.remove_hook(hook_id),
             HookType::Interrupt => self.interrupt_hooks.remove_hook(hook_id),
             HookType::ExecuteGeneric => self
@@ -31,6 +31,8 @@ extern "C"
     uint32_t icicle_create_snapshot(icicle_emulator*);
     void icicle_restore_snapshot(icicle_emulator*, uint32_t id);
     uint32_t icicle_add_syscall_hook(icicle_emulator*, raw_func* callback, void* data);
+    uint32_t icicle_add_cpuid_hook(icicle_emulator*, raw_func* callback, void* data);
+    uint32_t icicle_add_xgetbv_hook(icicle_emulator*, raw_func* callback, void* data);
     uint32_t icicle_add_interrupt_hook(icicle_emulator*, interrupt_func* callback, void* data);
     uint32_t icicle_add_block_hook(icicle_emulator*, block_func* callback, void* data);
     uint32_t icicle_add_execution_hook(icicle_emulator*, uint64_t address, ptr_func* callback, void* data);
@@ -230,7 +232,24 @@ namespace icicle
 
         emulator_hook* hook_instruction(int instruction_type, instruction_hook_callback callback) override
         {
-            if (static_cast<x86_hookable_instructions>(instruction_type) != x86_hookable_instructions::syscall)
+            // CPUID and XGETBV have no native implementation in the bridge,
+            // their hooks always have to provide the result
+            const auto inst_type = static_cast<x86_hookable_instructions>(instruction_type);
+            const auto add_hook = [&] {
+                switch (inst_type)
+                {
+                case x86_hookable_instructions::syscall:
+                    return &icicle_add_syscall_hook;
+                case x86_hookable_instructions::cpuid:
+                    return &icicle_add_cpuid_hook;
+                case x86_hookable_instructions::xgetbv:
+                    return &icicle_add_xgetbv_hook;
+                default:
+                    return static_cast<decltype(&icicle_add_syscall_hook)>(nullptr);
+                }
+            }();
+
+            if (!add_hook)
             {
                 // TODO
                 return nullptr;
@@ -244,7 +263,7 @@ namespace icicle
                 (void)func(); //
             };
 
-            const auto id = icicle_add_syscall_hook(this->emu_, invoker, ptr);
+            const auto id = add_hook(this->emu_, invoker, ptr);
             this->hooks_[id] = std::move(obj);
 
             return wrap_hook(id);
@@ -374,11 +374,17 @@ namespace unicorn
 
             emulator_hook* hook_instruction(const int instruction_type, instruction_hook_callback callback) override
             {
+                const auto inst_type = static_cast<x86_hookable_instructions>(instruction_type);
+
+                if (inst_type == x86_hookable_instructions::xgetbv)
+                {
+                    // Unicorn can't hook XGETBV. Without CR4.OSXSAVE it raises #UD instead.
+                    return nullptr;
+                }
+
                 unicorn_hook hook{*this};
                 auto container = std::make_unique<hook_container>();
 
-                const auto inst_type = static_cast<x86_hookable_instructions>(instruction_type);
-
                 if (inst_type == x86_hookable_instructions::invalid)
                 {
                     function_wrapper<int, uc_engine*> wrapper([c = std::move(callback)](uc_engine*) {
@@ -6,6 +6,7 @@
 #define DEVICE_TYPE              DWORD
 
 #define FILE_DEVICE_DISK         0x00000007
+#define FILE_DEVICE_NAMED_PIPE   0x00000011
 #define FILE_DEVICE_CONSOLE      0x00000050
 
 #define FILE_SUPERSEDE           0x00000000
@@ -60,6 +61,44 @@
 #define FILE_NON_DIRECTORY_FILE        0x00000040
 #define FILE_CREATE_TREE_CONNECTION    0x00000080
 
+#define FILE_DELETE_ON_CLOSE           0x00001000
+
+#define FILE_CREATED                   0x00000002
+
+#ifndef OS_WINDOWS
+#define FSCTL_PIPE_ASSIGN_EVENT 0x00110000
+#define FSCTL_PIPE_DISCONNECT   0x00110004
+#define FSCTL_PIPE_LISTEN       0x00110008
+#define FSCTL_PIPE_PEEK         0x0011400C
+#define FSCTL_PIPE_QUERY_EVENT  0x00110010
+#define FSCTL_PIPE_TRANSCEIVE   0x0011C017
+#define FSCTL_PIPE_WAIT         0x00110018
+#define FSCTL_PIPE_IMPERSONATE  0x0011001C
+#endif
+
+#define FILE_PIPE_BYTE_STREAM_TYPE     0x00000000
+#define FILE_PIPE_MESSAGE_TYPE         0x00000001
+
+#define FILE_PIPE_BYTE_STREAM_MODE     0x00000000
+#define FILE_PIPE_MESSAGE_MODE         0x00000001
+
+#define FILE_PIPE_INBOUND              0x00000000
+#define FILE_PIPE_OUTBOUND             0x00000001
+#define FILE_PIPE_FULL_DUPLEX          0x00000002
+
+#define FILE_PIPE_UNLIMITED_INSTANCES  0xFFFFFFFF
+
+#define FILE_PIPE_QUEUE_OPERATION      0x00000000
+#define FILE_PIPE_COMPLETE_OPERATION   0x00000001
+
+#define FILE_PIPE_DISCONNECTED_STATE   0x00000001
+#define FILE_PIPE_LISTENING_STATE      0x00000002
+#define FILE_PIPE_CONNECTED_STATE      0x00000003
+#define FILE_PIPE_CLOSING_STATE        0x00000004
+
+#define FILE_PIPE_CLIENT_END           0x00000000
+#define FILE_PIPE_SERVER_END           0x00000001
+
 #define FILE_ATTRIBUTE_NORMAL          0x00000080
 #define FILE_ATTRIBUTE_DIRECTORY       0x00000010
 
@@ -310,6 +349,43 @@ typedef struct _FILE_FS_DEVICE_INFORMATION
     ULONG Characteristics;
 } FILE_FS_DEVICE_INFORMATION, *PFILE_FS_DEVICE_INFORMATION;
 
+typedef struct _FILE_PIPE_INFORMATION
+{
+    ULONG ReadMode;
+    ULONG CompletionMode;
+} FILE_PIPE_INFORMATION, *PFILE_PIPE_INFORMATION;
+
+typedef struct _FILE_PIPE_LOCAL_INFORMATION
+{
+    ULONG NamedPipeType;
+    ULONG NamedPipeConfiguration;
+    ULONG MaximumInstances;
+    ULONG CurrentInstances;
+    ULONG InboundQuota;
+    ULONG ReadDataAvailable;
+    ULONG OutboundQuota;
+    ULONG WriteQuotaAvailable;
+    ULONG NamedPipeState;
+    ULONG NamedPipeEnd;
+} FILE_PIPE_LOCAL_INFORMATION, *PFILE_PIPE_LOCAL_INFORMATION;
+
+typedef struct _FILE_PIPE_PEEK_BUFFER
+{
+    ULONG NamedPipeState;
+    ULONG ReadDataAvailable;
+    ULONG NumberOfMessages;
+    ULONG MessageLength;
+    CHAR Data[1];
+} FILE_PIPE_PEEK_BUFFER, *PFILE_PIPE_PEEK_BUFFER;
+
+typedef struct _FILE_PIPE_WAIT_FOR_BUFFER
+{
+    LARGE_INTEGER Timeout;
+    ULONG NameLength;
+    BOOLEAN TimeoutSpecified;
+    char16_t Name[1];
+} FILE_PIPE_WAIT_FOR_BUFFER, *PFILE_PIPE_WAIT_FOR_BUFFER;
+
 typedef struct _FILE_POSITION_INFORMATION
 {
     LARGE_INTEGER CurrentByteOffset;
@@ -413,6 +489,20 @@ typedef struct _FILE_RENAME_INFORMATION
     char16_t FileName[1];
 } FILE_RENAME_INFORMATION, *PFILE_RENAME_INFORMATION;
 
+#ifndef FILE_DISPOSITION_DELETE
+#define FILE_DISPOSITION_DELETE 0x00000001
+#endif
+
+typedef struct _FILE_DISPOSITION_INFORMATION
+{
+    BOOLEAN DeleteFile;
+} FILE_DISPOSITION_INFORMATION, *PFILE_DISPOSITION_INFORMATION;
+
+typedef struct _FILE_DISPOSITION_INFORMATION_EX
+{
+    ULONG Flags;
+} FILE_DISPOSITION_INFORMATION_EX, *PFILE_DISPOSITION_INFORMATION_EX;
+
 #ifndef OS_WINDOWS
 typedef struct _FILE_ID_128
 {
@@ -16,6 +16,7 @@ using NTSTATUS = std::uint32_t;
 #define STATUS_ACCESS_VIOLATION       ((NTSTATUS)0xC0000005L)
 #define STATUS_INVALID_HANDLE         ((NTSTATUS)0xC0000008L)
 #define STATUS_INVALID_PARAMETER      ((NTSTATUS)0xC000000DL)
+#define STATUS_NO_MEMORY              ((NTSTATUS)0xC0000017L)
 #define STATUS_ILLEGAL_INSTRUCTION    ((NTSTATUS)0xC000001DL)
 #define STATUS_INTEGER_DIVIDE_BY_ZERO ((NTSTATUS)0xC0000094L)
 #endif
@@ -32,17 +33,37 @@ using NTSTATUS = std::uint32_t;
 
 #define STATUS_UNSUCCESSFUL               ((NTSTATUS)0xC0000001L)
 #define STATUS_INFO_LENGTH_MISMATCH       ((NTSTATUS)0xC0000004L)
+#define STATUS_INVALID_DEVICE_REQUEST     ((NTSTATUS)0xC0000010L)
 #define STATUS_ACCESS_DENIED              ((NTSTATUS)0xC0000022L)
 #define STATUS_BUFFER_TOO_SMALL           ((NTSTATUS)0xC0000023L)
+#define STATUS_OBJECT_NAME_INVALID        ((NTSTATUS)0xC0000033L)
 #define STATUS_OBJECT_NAME_NOT_FOUND      ((NTSTATUS)0xC0000034L)
+#define STATUS_OBJECT_NAME_COLLISION      ((NTSTATUS)0xC0000035L)
 #define STATUS_MUTANT_NOT_OWNED           ((NTSTATUS)0xC0000046L)
 #define STATUS_SEMAPHORE_LIMIT_EXCEEDED   ((NTSTATUS)0xC0000047L)
 #define STATUS_NO_TOKEN                   ((NTSTATUS)0xC000007CL)
 #define STATUS_FILE_INVALID               ((NTSTATUS)0xC0000098L)
+#define STATUS_INSUFFICIENT_RESOURCES     ((NTSTATUS)0xC000009AL)
 #define STATUS_MEMORY_NOT_ALLOCATED       ((NTSTATUS)0xC00000A0L)
+#define STATUS_INSTANCE_NOT_AVAILABLE     ((NTSTATUS)0xC00000ABL)
+#define STATUS_PIPE_NOT_AVAILABLE         ((NTSTATUS)0xC00000ACL)
+#define STATUS_INVALID_PIPE_STATE         ((NTSTATUS)0xC00000ADL)
+#define STATUS_PIPE_BUSY                  ((NTSTATUS)0xC00000AEL)
+#define STATUS_ILLEGAL_FUNCTION           ((NTSTATUS)0xC00000AFL)
+#define STATUS_PIPE_DISCONNECTED          ((NTSTATUS)0xC00000B0L)
+#define STATUS_PIPE_CLOSING               ((NTSTATUS)0xC00000B1L)
+#define STATUS_PIPE_CONNECTED             ((NTSTATUS)0xC00000B2L)
+#define STATUS_PIPE_LISTENING             ((NTSTATUS)0xC00000B3L)
+#define STATUS_IO_TIMEOUT                 ((NTSTATUS)0xC00000B5L)
 #define STATUS_FILE_IS_A_DIRECTORY        ((NTSTATUS)0xC00000BAL)
 #define STATUS_NOT_SUPPORTED              ((NTSTATUS)0xC00000BBL)
+#define STATUS_PIPE_EMPTY                 ((NTSTATUS)0xC00000D9L)
+#define STATUS_UNEXPECTED_IO_ERROR        ((NTSTATUS)0xC00000E9L)
+#define STATUS_CANCELLED                  ((NTSTATUS)0xC0000120L)
+#define STATUS_CANNOT_DELETE              ((NTSTATUS)0xC0000121L)
+#define STATUS_FILE_DELETED               ((NTSTATUS)0xC0000123L)
 #define STATUS_INVALID_ADDRESS            ((NTSTATUS)0xC0000141L)
+#define STATUS_PIPE_BROKEN                ((NTSTATUS)0xC000014BL)
 #define STATUS_CONNECTION_RESET           ((NTSTATUS)0xC000020DL)
 #define STATUS_NOT_FOUND                  ((NTSTATUS)0xC0000225L)
 #define STATUS_CONNECTION_REFUSED         ((NTSTATUS)0xC0000236L)
@@ -8,6 +8,41 @@ typedef enum _EVENT_TYPE
     SynchronizationEvent
 } EVENT_TYPE;
 
+typedef enum _TIMER_TYPE
+{
+    NotificationTimer,
+    SynchronizationTimer
+} TIMER_TYPE;
+
+typedef enum _TIMER_INFORMATION_CLASS
+{
+    TimerBasicInformation,
+} TIMER_INFORMATION_CLASS;
+
+typedef enum _TIMER_SET_INFORMATION_CLASS
+{
+    TimerSetCoalescableTimer,
+    MaxTimerInfoClass
+} TIMER_SET_INFORMATION_CLASS;
+
+typedef struct _TIMER_BASIC_INFORMATION
+{
+    LARGE_INTEGER RemainingTime;
+    BOOLEAN TimerState;
+} TIMER_BASIC_INFORMATION;
+
+template <typename Traits>
+struct TIMER_SET_COALESCABLE_TIMER_INFO
+{
+    LARGE_INTEGER DueTime;
+    EMULATOR_CAST(typename Traits::PVOID, PTIMER_APC_ROUTINE) TimerApcRoutine;
+    EMULATOR_CAST(typename Traits::PVOID, PVOID) TimerContext;
+    EMULATOR_CAST(typename Traits::PVOID, PCOUNTED_REASON_CONTEXT) WakeContext;
+    ULONG Period;
+    ULONG TolerableDelay;
+    EMULATOR_CAST(typename Traits::PVOID, PBOOLEAN) PreviousState;
+};
+
 typedef enum _WAIT_TYPE
 {
     WaitAll,
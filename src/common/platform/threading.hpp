@@ -118,4 +118,33 @@ typedef enum _QUEUE_USER_APC_FLAGS
 } QUEUE_USER_APC_FLAGS;
 #endif
 
+typedef enum _WORKERFACTORYINFOCLASS
+{
+    WorkerFactoryTimeout,          // LARGE_INTEGER
+    WorkerFactoryRetryTimeout,     // LARGE_INTEGER
+    WorkerFactoryIdleTimeout,      // s: LARGE_INTEGER
+    WorkerFactoryBindingCount,     // s: ULONG
+    WorkerFactoryThreadMinimum,    // s: ULONG
+    WorkerFactoryThreadMaximum,    // s: ULONG
+    WorkerFactoryPaused,           // ULONG or BOOLEAN
+    WorkerFactoryBasicInformation, // q: WORKER_FACTORY_BASIC_INFORMATION
+    WorkerFactoryAdjustThreadGoal,
+    WorkerFactoryCallbackType,
+    WorkerFactoryStackInformation,      // 10
+    WorkerFactoryThreadBasePriority,    // s: ULONG
+    WorkerFactoryTimeoutWaiters,        // s: ULONG, since THRESHOLD
+    WorkerFactoryFlags,                 // s: ULONG
+    WorkerFactoryThreadSoftMaximum,     // s: ULONG
+    WorkerFactoryThreadCpuSets,         // since REDSTONE5
+    MaxWorkerFactoryInfoClass
+} WORKERFACTORYINFOCLASS;
+
+template <typename Traits>
+struct FILE_IO_COMPLETION_INFORMATION
+{
+    typename Traits::PVOID KeyContext;
+    typename Traits::PVOID ApcContext;
+    IO_STATUS_BLOCK<Traits> IoStatusBlock;
+};
+
 // NOLINTEND(modernize-use-using,cppcoreguidelines-avoid-c-arrays,hicpp-avoid-c-arrays,modernize-avoid-c-arrays)
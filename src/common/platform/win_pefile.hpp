@@ -51,6 +51,8 @@
 #define IMAGE_REL_BASED_DIR64                 10
 #define IMAGE_REL_BASED_HIGH3ADJ              11
 
+#define IMAGE_DEBUG_TYPE_CODEVIEW             2
+
 #define IMAGE_DLLCHARACTERISTICS_DYNAMIC_BASE 0x0040
 #define IMAGE_FILE_DLL                        0x2000
 
@@ -283,6 +285,18 @@ typedef struct _IMAGE_BASE_RELOCATION
     // WORD TypeOffset[1];
 } IMAGE_BASE_RELOCATION, *PIMAGE_BASE_RELOCATION;
 
+typedef struct _IMAGE_DEBUG_DIRECTORY
+{
+    DWORD Characteristics;
+    DWORD TimeDateStamp;
+    WORD MajorVersion;
+    WORD MinorVersion;
+    DWORD Type;
+    DWORD SizeOfData;
+    DWORD AddressOfRawData;
+    DWORD PointerToRawData;
+} IMAGE_DEBUG_DIRECTORY, *PIMAGE_DEBUG_DIRECTORY;
+
 #endif
 
 template <typename Traits>
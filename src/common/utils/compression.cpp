@@ -81,14 +81,15 @@ namespace utils::compression
             return buffer;
         }
 
-        std::vector<std::byte> compress(const std::span<const std::byte> data)
+        std::vector<std::byte> compress(const std::span<const std::byte> data, const level compression_level)
         {
             std::vector<std::byte> result{};
             auto length = compressBound(static_cast<uLong>(data.size()));
             result.resize(length);
 
             if (compress2(reinterpret_cast<Bytef*>(result.data()), &length, reinterpret_cast<const Bytef*>(data.data()),
-                          static_cast<uLong>(data.size()), Z_BEST_COMPRESSION) != Z_OK)
+                          static_cast<uLong>(data.size()),
+                          compression_level == level::fastest ? Z_BEST_SPEED : Z_BEST_COMPRESSION) != Z_OK)
             {
                 return {};
             }
@@ -8,7 +8,14 @@ namespace utils::compression
     namespace zlib
     {
         constexpr unsigned int ZCHUNK_SIZE = 16384u;
-        std::vector<std::byte> compress(std::span<const std::byte> data);
+
+        enum class level
+        {
+            fastest,
+            best,
+        };
+
+        std::vector<std::byte> compress(std::span<const std::byte> data, level compression_level = level::best);
         std::vector<std::byte> decompress(std::span<const std::byte> data);
     }
 }
@@ -1,6 +1,11 @@
 #pragma once
 
+#include <cstdint>
+#include <vector>
 #include <functional>
+#include <algorithm>
+
+#include "finally.hpp"
 
 namespace utils
 {
@@ -53,4 +58,172 @@ namespace utils
             return static_cast<bool>(func);
         }
     };
+
+    using subscription_id = uint64_t;
+
+    template <typename Signature>
+    class callback_list;
+
+    // Event with any number of subscribers. Assigning a function sets the primary subscriber, which keeps
+    // the optional_function style of single consumers working, further consumers use subscribe().
+    // For non-void results, the first one that differs from a value initialized result is returned,
+    // but all subscribers are invoked. Checking the list for emptiness is cheap, so callers can skip
+    // building event data nobody receives.
+    template <typename Ret, typename... Args>
+    class callback_list<Ret(Args...)>
+    {
+        using function = std::function<Ret(Args...)>;
+
+        struct subscriber
+        {
+            subscription_id id{};
+            function func{};
+        };
+
+        function primary_{};
+        subscription_id next_id_{1};
+        size_t subscriber_count_{0};
+
+        // Subscriptions changed while the list is being invoked are only applied once the outermost
+        // invocation returns, so neither the running function nor the vector under iteration is touched
+        mutable std::vector<subscriber> subscribers_{};
+        mutable std::vector<subscriber> pending_{};
+        mutable size_t dispatch_depth_{0};
+        mutable bool has_removed_{false};
+
+        void apply_pending_changes() const
+        {
+            if (this->has_removed_)
+            {
+                std::erase_if(this->subscribers_, [](const subscriber& s) { return s.id == 0; });
+                this->has_removed_ = false;
+            }
+
+            for (auto& s : this->pending_)
+            {
+                this->subscribers_.push_back(std::move(s));
+            }
+
+            this->pending_.clear();
+        }
+
+        template <typename Invoker>
+        void dispatch(const Invoker& invoke) const
+        {
+            ++this->dispatch_depth_;
+            const auto _ = finally([this] {
+                if (--this->dispatch_depth_ == 0)
+                {
+                    this->apply_pending_changes();
+                }
+            });
+
+            if (this->primary_)
+            {
+                invoke(this->primary_);
+            }
+
+            // Subscribers added during the invocation are not called until the next one
+            const auto count = this->subscribers_.size();
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (this->subscribers_[i].id != 0)
+                {
+                    invoke(this->subscribers_[i].func);
+                }
+            }
+        }
+
+      public:
+        callback_list() = default;
+
+        template <typename F>
+            requires(std::is_invocable_r_v<Ret, F, Args...>)
+        callback_list(F&& f)
+            : primary_(std::forward<F>(f))
+        {
+        }
+
+        template <typename F>
+            requires(std::is_invocable_r_v<Ret, F, Args...>)
+        callback_list& operator=(F&& f)
+        {
+            primary_ = std::forward<F>(f);
+            return *this;
+        }
+
+        // Clears the primary subscriber only, 'callbacks.on_x = {}' leaves other subscriptions intact
+        callback_list& operator=(std::nullptr_t)
+        {
+            primary_ = {};
+            return *this;
+        }
+
+        template <typename F>
+            requires(std::is_invocable_r_v<Ret, F, Args...>)
+        subscription_id subscribe(F&& f)
+        {
+            const auto id = next_id_++;
+            auto& target = dispatch_depth_ == 0 ? subscribers_ : pending_;
+            target.push_back({id, function(std::forward<F>(f))});
+            ++subscriber_count_;
+            return id;
+        }
+
+        void unsubscribe(const subscription_id id)
+        {
+            const auto matches = [id](const subscriber& s) { return s.id == id; };
+
+            if (std::erase_if(pending_, matches) != 0)
+            {
+                --subscriber_count_;
+                return;
+            }
+
+            const auto entry = std::ranges::find_if(subscribers_, matches);
+            if (entry == subscribers_.end())
+            {
+                return;
+            }
+
+            --subscriber_count_;
+
+            if (dispatch_depth_ == 0)
+            {
+                subscribers_.erase(entry);
+                return;
+            }
+
+            // The function may be running right now, it is destroyed once the invocation returns
+            entry->id = 0;
+            has_removed_ = true;
+        }
+
+        Ret operator()(Args... args) const
+        {
+            if constexpr (std::is_void_v<Ret>)
+            {
+                this->dispatch([&](const function& func) { func(args...); });
+            }
+            else
+            {
+                Ret result{};
+
+                this->dispatch([&](const function& func) {
+                    auto value = func(args...);
+                    if (result == Ret{})
+                    {
+                        result = std::move(value);
+                    }
+                });
+
+                return result;
+            }
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return static_cast<bool>(primary_) || subscriber_count_ != 0;
+        }
+    };
 }
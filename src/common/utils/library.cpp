@@ -0,0 +1,77 @@
+#include "library.hpp"
+#include <stdexcept>
+#include <utility>
+
+#include "win.hpp"
+
+#ifndef _WIN32
+#include <dlfcn.h>
+#endif
+
+namespace utils
+{
+    library::library(const std::filesystem::path& file)
+    {
+#ifdef _WIN32
+        this->handle_ = LoadLibraryW(file.wstring().c_str());
+#else
+        this->handle_ = dlopen(file.string().c_str(), RTLD_NOW | RTLD_LOCAL);
+#endif
+
+        if (!this->handle_)
+        {
+            throw std::runtime_error("Failed to load library: " + file.string());
+        }
+    }
+
+    library::~library()
+    {
+        this->release();
+    }
+
+    library::library(library&& obj) noexcept
+        : handle_(std::exchange(obj.handle_, nullptr))
+    {
+    }
+
+    library& library::operator=(library&& obj) noexcept
+    {
+        if (this != &obj)
+        {
+            this->release();
+            this->handle_ = std::exchange(obj.handle_, nullptr);
+        }
+
+        return *this;
+    }
+
+    void* library::get_proc(const std::string& name) const
+    {
+        if (!this->handle_)
+        {
+            return nullptr;
+        }
+
+#ifdef _WIN32
+        return reinterpret_cast<void*>(GetProcAddress(static_cast<HMODULE>(this->handle_), name.c_str()));
+#else
+        return dlsym(this->handle_, name.c_str());
+#endif
+    }
+
+    void library::release()
+    {
+        if (!this->handle_)
+        {
+            return;
+        }
+
+#ifdef _WIN32
+        FreeLibrary(static_cast<HMODULE>(this->handle_));
+#else
+        dlclose(this->handle_);
+#endif
+
+        this->handle_ = nullptr;
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+#include <filesystem>
+
+namespace utils
+{
+    // Shared library loaded at runtime, unloaded when the object is destroyed
+    class library
+    {
+      public:
+        library() = default;
+        explicit library(const std::filesystem::path& file);
+        ~library();
+
+        library(library&& obj) noexcept;
+        library& operator=(library&& obj) noexcept;
+
+        library(const library&) = delete;
+        library& operator=(const library&) = delete;
+
+        void* get_proc(const std::string& name) const;
+
+        template <typename T>
+        T get(const std::string& name) const
+        {
+            return reinterpret_cast<T>(this->get_proc(name));
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return this->handle_ != nullptr;
+        }
+
+      private:
+        void* handle_{};
+
+        void release();
+    };
+}
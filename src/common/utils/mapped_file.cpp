@@ -0,0 +1,107 @@
+#include "mapped_file.hpp"
+#include <utility>
+
+#include "win.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace utils
+{
+    mapped_file::mapped_file(const std::filesystem::path& file)
+    {
+#ifdef _WIN32
+        const auto file_handle = CreateFileW(file.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                             OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file_handle == INVALID_HANDLE_VALUE)
+        {
+            return;
+        }
+
+        LARGE_INTEGER size{};
+        const auto mapping = GetFileSizeEx(file_handle, &size) && size.QuadPart > 0
+                                 ? CreateFileMappingW(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr)
+                                 : nullptr;
+
+        CloseHandle(file_handle);
+
+        if (!mapping)
+        {
+            return;
+        }
+
+        // The view keeps the mapping alive
+        const auto* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+
+        if (view)
+        {
+            this->data_ = static_cast<const std::byte*>(view);
+            this->size_ = static_cast<size_t>(size.QuadPart);
+        }
+#else
+        const auto fd = open(file.string().c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            return;
+        }
+
+        struct stat file_stat{};
+        auto* view = fstat(fd, &file_stat) == 0 && file_stat.st_size > 0
+                         ? mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_PRIVATE, fd, 0)
+                         : MAP_FAILED;
+
+        close(fd);
+
+        if (view != MAP_FAILED)
+        {
+            this->data_ = static_cast<const std::byte*>(view);
+            this->size_ = static_cast<size_t>(file_stat.st_size);
+        }
+#endif
+    }
+
+    mapped_file::~mapped_file()
+    {
+        this->release();
+    }
+
+    mapped_file::mapped_file(mapped_file&& obj) noexcept
+        : data_(std::exchange(obj.data_, nullptr)),
+          size_(std::exchange(obj.size_, 0))
+    {
+    }
+
+    mapped_file& mapped_file::operator=(mapped_file&& obj) noexcept
+    {
+        if (this != &obj)
+        {
+            this->release();
+            this->data_ = std::exchange(obj.data_, nullptr);
+            this->size_ = std::exchange(obj.size_, 0);
+        }
+
+        return *this;
+    }
+
+    void mapped_file::release()
+    {
+        if (!this->data_)
+        {
+            return;
+        }
+
+#ifdef _WIN32
+        UnmapViewOfFile(this->data_);
+#else
+        munmap(const_cast<std::byte*>(this->data_), this->size_);
+#endif
+
+        this->data_ = nullptr;
+        this->size_ = 0;
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <span>
+#include <cstddef>
+#include <filesystem>
+
+namespace utils
+{
+    // Read-only view of a file mapped into memory, unmapped when the object is destroyed.
+    // Opening fails for missing or empty files, which leaves the object empty.
+    class mapped_file
+    {
+      public:
+        mapped_file() = default;
+        explicit mapped_file(const std::filesystem::path& file);
+        ~mapped_file();
+
+        mapped_file(mapped_file&& obj) noexcept;
+        mapped_file& operator=(mapped_file&& obj) noexcept;
+
+        mapped_file(const mapped_file&) = delete;
+        mapped_file& operator=(const mapped_file&) = delete;
+
+        std::span<const std::byte> get_data() const
+        {
+            return {this->data_, this->size_};
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return this->data_ != nullptr;
+        }
+
+      private:
+        const std::byte* data_{};
+        size_t size_{};
+
+        void release();
+    };
+}
@@ -50,6 +50,7 @@ enum class x86_hookable_instructions
     cpuid,
     rdtsc,
     rdtscp,
+    xgetbv,
 };
 
 // --[x86_64]-------------------------------------------------------------------------
@@ -1,6 +1,7 @@
 #include "std_include.hpp"
 
 #include <windows_emulator.hpp>
+#include <stack_trace.hpp>
 #include <fuzzer.hpp>
 
 #include <utils/finally.hpp>
@@ -14,9 +15,13 @@
 #endif
 
 bool use_gdb = false;
+bool use_fault_injection = false;
 
 namespace
 {
+    // Leading input bytes that decide which syscalls fail when fault injection is enabled
+    constexpr size_t FAULT_INPUT_SIZE = 32;
+
     std::unique_ptr<x86_64_emulator> create_emulator_backend()
     {
 #if MOMO_ENABLE_RUST_CODE
@@ -26,7 +31,7 @@ namespace
 #endif
     }
 
-    void run_emulation(windows_emulator& win_emu)
+    void run_emulation(windows_emulator& win_emu, const std::function<void(NTSTATUS)>& on_exception = {})
     {
         bool has_exception = false;
         const auto _ = utils::finally([&] {
@@ -35,7 +40,12 @@ namespace
 
         try
         {
-            win_emu.callbacks.on_exception = [&] {
+            win_emu.callbacks.on_exception = [&](const NTSTATUS exception_code) {
+                if (!has_exception && on_exception)
+                {
+                    on_exception(exception_code);
+                }
+
                 has_exception = true;
                 win_emu.stop();
             };
@@ -68,6 +78,43 @@ namespace
         run_emulation(win_emu);
     }
 
+    fuzzer::crash_signature capture_crash_signature(windows_emulator& win_emu, const NTSTATUS exception_code)
+    {
+        fuzzer::crash_signature signature{};
+        signature.exception_code = exception_code;
+
+        const auto address = win_emu.emu().read_instruction_pointer();
+        signature.offset = address;
+
+        if (const auto* mod = win_emu.mod_manager.find_by_address(address))
+        {
+            signature.module = mod->name;
+            signature.offset = address - mod->image_base;
+        }
+
+        // Module-relative frames keep the hash independent of where modules were mapped
+        uint64_t stack_hash = 0;
+        const auto combine = [&](const uint64_t value) {
+            stack_hash ^= std::hash<uint64_t>{}(value) + 0x9e3779b9 + (stack_hash << 6) + (stack_hash >> 2);
+        };
+
+        for (const auto& frame : capture_stack_trace(win_emu, 8))
+        {
+            if (frame.module)
+            {
+                combine(std::hash<std::string>{}(frame.module->name));
+                combine(frame.address - frame.module->image_base);
+            }
+            else
+            {
+                combine(frame.address);
+            }
+        }
+
+        signature.stack_hash = stack_hash;
+        return signature;
+    }
+
     struct fuzzer_executer : fuzzer::executer
     {
         windows_emulator emu{create_emulator_backend()};
@@ -75,6 +122,13 @@ namespace
         std::unordered_set<uint64_t> visited_blocks{};
         const std::function<fuzzer::coverage_functor>* handler{nullptr};
 
+        // Access violations are dispatched to the guest first, so the
+        // unhandled exception is reported from within ntdll afterwards.
+        // Violations the guest handled are dropped once it continues.
+        std::optional<fuzzer::crash_signature> pending_violation{};
+        uint32_t violation_thread{};
+        std::optional<fuzzer::crash_signature> crash{};
+
         fuzzer_executer(const std::span<const std::byte> data)
             : emulator_data(data)
         {
@@ -85,6 +139,22 @@ namespace
                 }
             });
 
+            emu.callbacks.on_memory_violate = [&](uint64_t, uint64_t, memory_operation, memory_violation_type) {
+                this->pending_violation = capture_crash_signature(this->emu, STATUS_ACCESS_VIOLATION);
+                this->violation_thread = this->emu.current_thread().id;
+            };
+
+            // KiUserExceptionDispatcher continues through NtContinue once a handler took the exception
+            emu.callbacks.on_syscall = [&](uint32_t, const std::string_view name) {
+                if (this->pending_violation && this->emu.current_thread().id == this->violation_thread &&
+                    (name == "NtContinue" || name == "NtContinueEx"))
+                {
+                    this->pending_violation = std::nullopt;
+                }
+
+                return instruction_hook_continuation::run_instruction;
+            };
+
             utils::buffer_deserializer deserializer{emulator_data};
             emu.deserialize(deserializer);
             emu.save_snapshot();
@@ -108,20 +178,40 @@ namespace
             // printf("Input size: %zd\n", data.size());
             this->handler = &coverage_handler;
             this->visited_blocks.clear();
+            this->pending_violation = std::nullopt;
+            this->crash = std::nullopt;
 
             restore_emulator();
 
+            auto input = data;
+            if (use_fault_injection)
+            {
+                const auto fault_input_size = std::min(input.size(), FAULT_INPUT_SIZE);
+                emu.faults.set_fault_input(input.first(fault_input_size));
+                input = input.subspan(fault_input_size);
+            }
+
             const auto memory = emu.memory.allocate_memory(
-                static_cast<size_t>(page_align_up(std::max(data.size(), static_cast<size_t>(1)))),
+                static_cast<size_t>(page_align_up(std::max(input.size(), static_cast<size_t>(1)))),
                 memory_permission::read_write);
-            emu.emu().write_memory(memory, data.data(), data.size());
+            emu.emu().write_memory(memory, input.data(), input.size());
 
             emu.emu().reg(x86_register::rcx, memory);
-            emu.emu().reg<uint64_t>(x86_register::rdx, data.size());
+            emu.emu().reg<uint64_t>(x86_register::rdx, input.size());
 
             try
             {
-                run_emulation(emu);
+                run_emulation(emu, [&](const NTSTATUS exception_code) {
+                    if (this->pending_violation && this->pending_violation->exception_code == exception_code)
+                    {
+                        this->crash = this->pending_violation;
+                    }
+                    else
+                    {
+                        this->crash = capture_crash_signature(this->emu, exception_code);
+                    }
+                });
+
                 return fuzzer::execution_result::success;
             }
             catch (...)
@@ -129,6 +219,11 @@ namespace
                 return fuzzer::execution_result::error;
             }
         }
+
+        std::optional<fuzzer::crash_signature> get_crash_signature() override
+        {
+            return this->crash;
+        }
     };
 
     struct my_fuzzing_handler : fuzzer::fuzzing_handler
@@ -185,16 +280,28 @@ namespace
         }
 
         // setvbuf(stdout, nullptr, _IOFBF, 0x10000);
-        if (argc > 2 && argv[1] == "-d"s)
+        int arg_index = 1;
+        for (; arg_index < argc - 1; ++arg_index)
         {
-            use_gdb = true;
+            if (argv[arg_index] == "-d"s)
+            {
+                use_gdb = true;
+            }
+            else if (argv[arg_index] == "-f"s)
+            {
+                use_fault_injection = true;
+            }
+            else
+            {
+                break;
+            }
         }
 
         try
         {
             do
             {
-                run(argv[use_gdb ? 2 : 1]);
+                run(argv[arg_index]);
             } while (use_gdb);
 
             return 0;
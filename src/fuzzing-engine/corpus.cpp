@@ -0,0 +1,150 @@
+#include "corpus.hpp"
+#include <cstdio>
+#include <cinttypes>
+#include <algorithm>
+
+#include "hash.hpp"
+
+#include <utils/io.hpp>
+#include <utils/string.hpp>
+
+namespace fuzzer
+{
+    coverage_map::coverage_map()
+        : seen_(std::make_unique<std::atomic_bool[]>(SIZE))
+    {
+    }
+
+    uint32_t coverage_map::get_index(const uint64_t address)
+    {
+        constexpr uint64_t golden_ratio = 0x9E3779B97F4A7C15;
+        return static_cast<uint32_t>((address * golden_ratio) >> (64 - 16));
+    }
+
+    bool coverage_map::add(const uint32_t index)
+    {
+        auto& entry = this->seen_[index % SIZE];
+        if (entry.load(std::memory_order_relaxed))
+        {
+            return false;
+        }
+
+        return !entry.exchange(true, std::memory_order_relaxed);
+    }
+
+    corpus::corpus(std::filesystem::path directory)
+        : directory_(std::move(directory))
+    {
+        this->load_seeds();
+    }
+
+    corpus::~corpus()
+    {
+        auto* current = this->head_.load();
+
+        while (current)
+        {
+            auto* next = current->next;
+            delete current;
+            current = next;
+        }
+    }
+
+    double corpus::get_average_score() const
+    {
+        const auto count = this->size_.load();
+        if (count == 0)
+        {
+            return 0.0;
+        }
+
+        return static_cast<double>(this->total_score_.load()) / static_cast<double>(count);
+    }
+
+    void corpus::publish(seed entry)
+    {
+        this->store_seed(entry);
+        this->push(std::move(entry));
+    }
+
+    void corpus::push(seed entry)
+    {
+        const auto score = entry.stats.score;
+
+        auto* new_node = new node{};
+        new_node->entry = std::move(entry);
+        new_node->next = this->head_.load(std::memory_order_relaxed);
+
+        do
+        {
+            new_node->sequence = new_node->next ? new_node->next->sequence + 1 : 1;
+        } while (!this->head_.compare_exchange_weak(new_node->next, new_node, std::memory_order_release,
+                                                    std::memory_order_relaxed));
+
+        ++this->size_;
+        this->total_score_ += score;
+
+        auto highest = this->highest_score_.load(std::memory_order_relaxed);
+        while (score > highest && !this->highest_score_.compare_exchange_weak(highest, score))
+        {
+        }
+    }
+
+    size_t corpus::sync(const size_t sequence, const std::function<void(const seed&)>& handler) const
+    {
+        std::vector<const node*> new_nodes{};
+
+        for (const auto* current = this->head_.load(std::memory_order_acquire);
+             current && current->sequence > sequence; current = current->next)
+        {
+            new_nodes.push_back(current);
+        }
+
+        for (auto i = new_nodes.rbegin(); i != new_nodes.rend(); ++i)
+        {
+            handler((*i)->entry);
+        }
+
+        return new_nodes.empty() ? sequence : new_nodes.front()->sequence;
+    }
+
+    void corpus::load_seeds()
+    {
+        if (this->directory_.empty() || !utils::io::directory_exists(this->directory_))
+        {
+            return;
+        }
+
+        for (const auto& file : utils::io::list_files(this->directory_))
+        {
+            std::vector<std::byte> data{};
+            if (!utils::io::read_file(file, &data))
+            {
+                continue;
+            }
+
+            seed entry{};
+            entry.data.resize(data.size());
+            std::ranges::transform(data, entry.data.begin(), [](const std::byte b) {
+                return static_cast<uint8_t>(b); //
+            });
+
+            this->push(std::move(entry));
+        }
+
+        printf("Loaded %zu seeds from %s\n", this->size_.load(), this->directory_.string().c_str());
+    }
+
+    void corpus::store_seed(const seed& entry) const
+    {
+        if (this->directory_.empty())
+        {
+            return;
+        }
+
+        const auto data = std::as_bytes(std::span(entry.data));
+        const auto name = utils::string::va("%016" PRIx64 ".bin", hash_data(data));
+
+        utils::io::write_file(this->directory_ / name, data);
+    }
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <span>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <filesystem>
+
+namespace fuzzer
+{
+    using input_score = uint64_t;
+
+    struct seed_stats
+    {
+        // Number of unique blocks reached
+        input_score score{};
+        uint64_t execution_time{};
+        uint32_t depth{};
+        // Unique block indices
+        std::vector<uint32_t> blocks{};
+    };
+
+    struct seed
+    {
+        std::vector<uint8_t> data{};
+        seed_stats stats{};
+
+        // Seeds loaded from disk have to be executed once before they can be scheduled
+        bool calibrated{};
+    };
+
+    // Process-wide record of which blocks were ever hit.
+    // Workers only read it on the hot path, so the shared cache lines stay clean.
+    class coverage_map
+    {
+      public:
+        static constexpr size_t SIZE = 1 << 16;
+
+        coverage_map();
+
+        static uint32_t get_index(uint64_t address);
+
+        // Returns true if the block was never seen before
+        bool add(uint32_t index);
+
+      private:
+        std::unique_ptr<std::atomic_bool[]> seen_{};
+    };
+
+    // Unbounded, append-only seed list. Seeds are published through a
+    // lock-free push and picked up by workers through periodic syncs.
+    // Published seeds are persisted to the corpus directory.
+    class corpus
+    {
+      public:
+        corpus(std::filesystem::path directory);
+        ~corpus();
+
+        corpus(const corpus&) = delete;
+        corpus& operator=(const corpus&) = delete;
+
+        void publish(seed entry);
+
+        // Calls the handler for every seed newer than sequence and returns the newest sequence
+        size_t sync(size_t sequence, const std::function<void(const seed&)>& handler) const;
+
+        coverage_map& get_coverage()
+        {
+            return this->coverage_;
+        }
+
+        size_t size() const
+        {
+            return this->size_;
+        }
+
+        input_score get_highest_score() const
+        {
+            return this->highest_score_;
+        }
+
+        double get_average_score() const;
+
+      private:
+        struct node
+        {
+            seed entry{};
+            size_t sequence{};
+            node* next{};
+        };
+
+        std::filesystem::path directory_{};
+        coverage_map coverage_{};
+        std::atomic<node*> head_{nullptr};
+
+        std::atomic_size_t size_{0};
+        std::atomic_uint64_t total_score_{0};
+        std::atomic_uint64_t highest_score_{0};
+
+        void push(seed entry);
+        void load_seeds();
+        void store_seed(const seed& entry) const;
+    };
+}
@@ -0,0 +1,183 @@
+#include "crash_triage.hpp"
+#include <cstdio>
+#include <cinttypes>
+#include <algorithm>
+
+#include "hash.hpp"
+
+#include <utils/io.hpp>
+#include <utils/string.hpp>
+
+namespace fuzzer
+{
+    namespace
+    {
+        size_t get_initial_chunk_size(const std::span<const uint8_t> input)
+        {
+            return (input.size() + 1) / 2;
+        }
+
+        void reset_minimization(crash_bucket& bucket)
+        {
+            bucket.chunk_size = get_initial_chunk_size(bucket.smallest_input);
+            bucket.offset = 0;
+        }
+
+        std::optional<minimization_candidate> make_candidate(crash_bucket& bucket)
+        {
+            while (bucket.chunk_size > 0 && bucket.offset >= bucket.smallest_input.size())
+            {
+                bucket.chunk_size /= 2;
+                bucket.offset = 0;
+            }
+
+            if (bucket.chunk_size == 0)
+            {
+                return std::nullopt;
+            }
+
+            const auto& input = bucket.smallest_input;
+            const auto end = std::min(input.size(), bucket.offset + bucket.chunk_size);
+
+            minimization_candidate candidate{};
+            candidate.bucket_id = bucket.id;
+            candidate.offset = bucket.offset;
+            candidate.data.reserve(input.size() - (end - bucket.offset));
+            candidate.data.insert(candidate.data.end(), input.begin(),
+                                  input.begin() + static_cast<ptrdiff_t>(bucket.offset));
+            candidate.data.insert(candidate.data.end(), input.begin() + static_cast<ptrdiff_t>(end), input.end());
+
+            bucket.offset += bucket.chunk_size;
+
+            return candidate;
+        }
+    }
+
+    std::string get_crash_bucket_id(const crash_signature& signature)
+    {
+        uint64_t hash = FNV_OFFSET_BASIS;
+        hash_data(hash, std::as_bytes(std::span(signature.module)));
+        hash_value(hash, signature.offset);
+        hash_value(hash, signature.exception_code);
+        hash_value(hash, signature.stack_hash);
+
+        return utils::string::va("%016" PRIx64, hash);
+    }
+
+    crash_triage::crash_triage(std::filesystem::path directory)
+        : directory_(std::move(directory))
+    {
+    }
+
+    bool crash_triage::add_crash(const std::span<const uint8_t> input, const crash_signature& signature)
+    {
+        std::unique_lock lock{this->mutex_};
+
+        auto id = get_crash_bucket_id(signature);
+        const auto entry = this->buckets_.find(id);
+
+        if (entry != this->buckets_.end())
+        {
+            auto& bucket = entry->second;
+            ++bucket.hits;
+
+            if (input.size() < bucket.smallest_input.size())
+            {
+                bucket.smallest_input.assign(input.begin(), input.end());
+                reset_minimization(bucket);
+                this->store_bucket_file(bucket, ".min.bin", bucket.smallest_input);
+            }
+
+            return false;
+        }
+
+        auto& bucket = this->buckets_[id];
+        bucket.id = std::move(id);
+        bucket.signature = signature;
+        bucket.hits = 1;
+        bucket.smallest_input.assign(input.begin(), input.end());
+        reset_minimization(bucket);
+
+        this->store_bucket_file(bucket, ".bin", input);
+        this->store_bucket_description(bucket);
+
+        return true;
+    }
+
+    std::optional<minimization_candidate> crash_triage::get_minimization_candidate()
+    {
+        std::unique_lock lock{this->mutex_};
+
+        auto entry = this->buckets_.upper_bound(this->last_minimized_bucket_);
+
+        for (size_t i = 0; i < this->buckets_.size(); ++i, ++entry)
+        {
+            if (entry == this->buckets_.end())
+            {
+                entry = this->buckets_.begin();
+            }
+
+            auto candidate = make_candidate(entry->second);
+            if (candidate)
+            {
+                this->last_minimized_bucket_ = entry->first;
+                return candidate;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    void crash_triage::report_minimization_result(const minimization_candidate& candidate,
+                                                  const std::optional<crash_signature>& signature)
+    {
+        std::unique_lock lock{this->mutex_};
+
+        const auto entry = this->buckets_.find(candidate.bucket_id);
+        if (entry == this->buckets_.end())
+        {
+            return;
+        }
+
+        auto& bucket = entry->second;
+        if (!signature || *signature != bucket.signature || candidate.data.size() >= bucket.smallest_input.size())
+        {
+            return;
+        }
+
+        // The removed chunk is gone, so the same offset now covers the next one
+        bucket.smallest_input = candidate.data;
+        bucket.offset = std::min(bucket.offset, candidate.offset);
+        bucket.chunk_size = std::max<size_t>(bucket.chunk_size, 1);
+
+        this->store_bucket_file(bucket, ".min.bin", bucket.smallest_input);
+    }
+
+    size_t crash_triage::get_bucket_count()
+    {
+        std::unique_lock lock{this->mutex_};
+        return this->buckets_.size();
+    }
+
+    void crash_triage::store_bucket_file(const crash_bucket& bucket, const std::string_view extension,
+                                         const std::span<const uint8_t> data)
+    {
+        const auto file = this->directory_ / (bucket.id + std::string(extension));
+        if (!utils::io::write_file(file, std::as_bytes(data)))
+        {
+            printf("Failed to store crash file: %s\n", file.string().c_str());
+        }
+    }
+
+    void crash_triage::store_bucket_description(const crash_bucket& bucket)
+    {
+        const auto& signature = bucket.signature;
+        const std::string description = utils::string::va(
+            "Module: %s\nOffset: 0x%" PRIx64 "\nException: 0x%08X\nStack hash: %016" PRIx64 "\n",
+            signature.module.empty() ? "<unknown>" : signature.module.c_str(), signature.offset,
+            signature.exception_code, signature.stack_hash);
+
+        const auto file = this->directory_ / (bucket.id + ".txt");
+        utils::io::write_file(file, std::as_bytes(std::span(description)));
+    }
+}
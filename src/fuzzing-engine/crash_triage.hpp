@@ -0,0 +1,58 @@
+#pragma once
+#include <map>
+#include <mutex>
+#include <vector>
+#include <optional>
+#include <filesystem>
+
+#include "fuzzer.hpp"
+
+namespace fuzzer
+{
+    struct crash_bucket
+    {
+        std::string id{};
+        crash_signature signature{};
+        size_t hits{};
+        std::vector<uint8_t> smallest_input{};
+
+        size_t chunk_size{};
+        size_t offset{};
+    };
+
+    struct minimization_candidate
+    {
+        std::string bucket_id{};
+        size_t offset{};
+        std::vector<uint8_t> data{};
+    };
+
+    // Persists crashing inputs, deduplicated by crash signature.
+    // Each bucket is minimised by removing chunks of decreasing size, as long as
+    // the reduced input still reproduces the same signature.
+    class crash_triage
+    {
+      public:
+        crash_triage(std::filesystem::path directory);
+
+        // Returns true if the crash opened a new bucket
+        bool add_crash(std::span<const uint8_t> input, const crash_signature& signature);
+
+        std::optional<minimization_candidate> get_minimization_candidate();
+        void report_minimization_result(const minimization_candidate& candidate,
+                                        const std::optional<crash_signature>& signature);
+
+        size_t get_bucket_count();
+
+      private:
+        std::mutex mutex_{};
+        std::filesystem::path directory_{};
+        std::map<std::string, crash_bucket> buckets_{};
+        std::string last_minimized_bucket_{};
+
+        void store_bucket_file(const crash_bucket& bucket, std::string_view extension, std::span<const uint8_t> data);
+        void store_bucket_description(const crash_bucket& bucket);
+    };
+
+    std::string get_crash_bucket_id(const crash_signature& signature);
+}
@@ -1,6 +1,8 @@
 #include "fuzzer.hpp"
 #include <cinttypes>
 
+#include "corpus.hpp"
+#include "crash_triage.hpp"
 #include "input_generator.hpp"
 
 #include <utils/timer.hpp>
@@ -11,12 +13,18 @@ namespace fuzzer
 {
     namespace
     {
+        // Minimisation takes at most one in this many executions, so fuzzing keeps going on every worker
+        // while candidates are queued, even with a single one
+        constexpr uint64_t MINIMIZATION_SHARE = 4;
+
         class fuzzing_context
         {
           public:
-            fuzzing_context(input_generator& generator, fuzzing_handler& handler)
-                : generator(generator),
-                  handler(handler)
+            fuzzing_context(corpus& shared_corpus, fuzzing_handler& handler)
+                : shared_corpus(shared_corpus),
+                  handler(handler),
+                  triage(handler.get_crash_directory()),
+                  format(handler.get_input_format())
             {
             }
 
@@ -41,10 +49,15 @@ namespace fuzzer
                 return true;
             }
 
-            input_generator& generator;
+            corpus& shared_corpus;
             fuzzing_handler& handler;
+            crash_triage triage;
+            std::shared_ptr<input_format> format{};
             std::atomic_uint64_t executions{0};
 
+            std::atomic_uint64_t total_executions{0};
+            std::atomic_uint64_t minimization_executions{0};
+
           private:
             std::atomic_bool stop_{false};
         };
@@ -92,39 +105,84 @@ namespace fuzzer
             return data;
         }
 
-        void print_crash(const std::span<const uint8_t> input)
+        void print_crash(const std::span<const uint8_t> input, const crash_signature& signature)
         {
-            std::string text = utils::string::va("\nFound crash for input (length %zu):\n", input.size());
+            std::string text = utils::string::va(
+                "\nFound new crash %s at %s+0x%" PRIx64 " (exception 0x%08X) for input (length %zu):\n",
+                get_crash_bucket_id(signature).c_str(), signature.module.c_str(), signature.offset,
+                signature.exception_code, input.size());
             text += format_binary_data(input);
 
             printf("%.*s\n", static_cast<int>(text.size()), text.c_str());
         }
 
-        void perform_fuzzing_iteration(fuzzing_context& context, executer& executer)
+        crash_signature get_crash_signature(executer& executer)
+        {
+            return executer.get_crash_signature().value_or(crash_signature{});
+        }
+
+        void perform_fuzzing_iteration(fuzzing_context& context, input_generator& generator, executer& executer)
         {
             ++context.executions;
-            context.generator.access_input([&](const std::span<const uint8_t> input) {
-                uint64_t score{0};
-                const auto result = executer.execute(input, [&](uint64_t) {
-                    ++score; //
-                });
+            ++context.total_executions;
+            generator.access_input([&](const std::span<const uint8_t> input,
+                                       const std::function<coverage_functor>& coverage_handler) {
+                const auto result = executer.execute(input, coverage_handler);
 
                 if (result == execution_result::error)
                 {
-                    print_crash(input);
+                    const auto signature = get_crash_signature(executer);
+                    if (context.triage.add_crash(input, signature))
+                    {
+                        print_crash(input, signature);
+                    }
                 }
 
-                return score;
+                return result;
             });
         }
 
+        bool perform_minimization_iteration(fuzzing_context& context, executer& executer)
+        {
+            // Workers check the share concurrently, so it can be exceeded by at most one execution per worker
+            if (context.minimization_executions * MINIMIZATION_SHARE >= context.total_executions)
+            {
+                return false;
+            }
+
+            const auto candidate = context.triage.get_minimization_candidate();
+            if (!candidate)
+            {
+                return false;
+            }
+
+            ++context.executions;
+            ++context.total_executions;
+            ++context.minimization_executions;
+
+            std::optional<crash_signature> signature{};
+            const auto result = executer.execute(candidate->data, [](uint64_t) {});
+
+            if (result == execution_result::error)
+            {
+                signature = get_crash_signature(executer);
+            }
+
+            context.triage.report_minimization_result(*candidate, signature);
+            return true;
+        }
+
         void worker(fuzzing_context& context)
         {
             const auto executer = context.handler.make_executer();
+            input_generator generator{context.shared_corpus, context.format.get()};
 
             while (!context.should_stop())
             {
-                perform_fuzzing_iteration(context, *executer);
+                if (!perform_minimization_iteration(context, *executer))
+                {
+                    perform_fuzzing_iteration(context, generator, *executer);
+                }
             }
         }
 
@@ -166,8 +224,8 @@ namespace fuzzer
     void run(fuzzing_handler& handler, const size_t concurrency)
     {
         const utils::timer<> t{};
-        input_generator generator{};
-        fuzzing_context context{generator, handler};
+        corpus shared_corpus{handler.get_corpus_directory()};
+        fuzzing_context context{shared_corpus, handler};
         worker_pool pool{context, concurrency};
 
         while (!context.should_stop())
@@ -175,10 +233,12 @@ namespace fuzzer
             std::this_thread::sleep_for(std::chrono::seconds{1});
 
             const auto executions = context.executions.exchange(0);
-            const auto highest_scorer = context.generator.get_highest_scorer();
-            const auto avg_score = context.generator.get_average_score();
-            printf("Executions/s: %" PRIu64 " - Score: %" PRIx64 " - Avg: %.3f\n", executions, highest_scorer.score,
-                   avg_score);
+            const auto highest_score = shared_corpus.get_highest_score();
+            const auto avg_score = shared_corpus.get_average_score();
+            const auto seeds = shared_corpus.size();
+            const auto crashes = context.triage.get_bucket_count();
+            printf("Executions/s: %" PRIu64 " - Score: %" PRIx64 " - Avg: %.3f - Seeds: %zu - Crashes: %zu\n",
+                   executions, highest_score, avg_score, seeds, crashes);
         }
 
         const auto duration = t.elapsed();
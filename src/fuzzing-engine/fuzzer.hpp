@@ -1,8 +1,11 @@
 #pragma once
 #include <span>
 #include <memory>
+#include <string>
 #include <thread>
 #include <cstdint>
+#include <optional>
+#include <filesystem>
 #include <functional>
 
 namespace fuzzer
@@ -15,24 +18,58 @@ namespace fuzzer
         error,
     };
 
+    struct crash_signature
+    {
+        std::string module{};
+        uint64_t offset{};
+        uint32_t exception_code{};
+        uint64_t stack_hash{};
+
+        bool operator==(const crash_signature&) const = default;
+    };
+
     struct executer
     {
         virtual ~executer() = default;
 
         virtual execution_result execute(std::span<const uint8_t> data,
                                          const std::function<coverage_functor>& coverage_handler) = 0;
+
+        // Describes the crash of the last execution that returned an error
+        virtual std::optional<crash_signature> get_crash_signature()
+        {
+            return std::nullopt;
+        }
     };
 
+    struct input_format;
+
     struct fuzzing_handler
     {
         virtual ~fuzzing_handler() = default;
 
         virtual std::unique_ptr<executer> make_executer() = 0;
 
+        // Optional description of the input structure, see input_format.hpp
+        virtual std::shared_ptr<input_format> get_input_format()
+        {
+            return nullptr;
+        }
+
         virtual bool stop()
         {
             return false;
         }
+
+        virtual std::filesystem::path get_crash_directory()
+        {
+            return "crashes";
+        }
+
+        virtual std::filesystem::path get_corpus_directory()
+        {
+            return "corpus";
+        }
     };
 
     void run(fuzzing_handler& handler, size_t concurrency = std::thread::hardware_concurrency());
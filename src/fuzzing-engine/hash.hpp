@@ -0,0 +1,32 @@
+#pragma once
+#include <span>
+#include <cstdint>
+#include <cstddef>
+
+namespace fuzzer
+{
+    constexpr uint64_t FNV_OFFSET_BASIS = 0xCBF29CE484222325;
+    constexpr uint64_t FNV_PRIME = 0x100000001B3;
+
+    inline void hash_data(uint64_t& hash, const std::span<const std::byte> data)
+    {
+        for (const auto value : data)
+        {
+            hash ^= static_cast<uint64_t>(value);
+            hash *= FNV_PRIME;
+        }
+    }
+
+    template <typename T>
+    void hash_value(uint64_t& hash, const T& value)
+    {
+        hash_data(hash, std::as_bytes(std::span(&value, 1)));
+    }
+
+    inline uint64_t hash_data(const std::span<const std::byte> data)
+    {
+        uint64_t hash = FNV_OFFSET_BASIS;
+        hash_data(hash, data);
+        return hash;
+    }
+}
@@ -0,0 +1,740 @@
+#include "input_format.hpp"
+
+#include <set>
+#include <array>
+#include <tuple>
+#include <iterator>
+#include <optional>
+#include <algorithm>
+#include <stdexcept>
+
+namespace fuzzer
+{
+    namespace
+    {
+        constexpr size_t MAX_GRAMMAR_DEPTH = 12;
+        constexpr size_t MAX_GENERATED_BYTES = 64;
+        constexpr size_t MAX_GRAMMAR_PARSE_BYTES = 0x1000;
+
+        constexpr std::array<uint64_t, 14> INTERESTING_VALUES{
+            0,      1,      0x7F,       0x80,       0xFF,       0x7FFF,             0x8000,
+            0xFFFF, 0x7FFFFFFF, 0x80000000, 0xFFFFFFFF, 0x7FFFFFFFFFFFFFFF, 0x8000000000000000, ~0ULL,
+        };
+
+        uint64_t read_integer(const std::span<const uint8_t> data, const bool big_endian)
+        {
+            uint64_t value = 0;
+
+            for (size_t i = 0; i < data.size() && i < sizeof(value); ++i)
+            {
+                const auto index = big_endian ? i : data.size() - i - 1;
+                value = (value << 8) | data[index];
+            }
+
+            return value;
+        }
+
+        void write_integer(std::vector<uint8_t>& data, const size_t size, uint64_t value, const bool big_endian)
+        {
+            data.assign(size, 0);
+
+            for (size_t i = 0; i < size && i < sizeof(value); ++i)
+            {
+                const auto index = big_endian ? size - i - 1 : i;
+                data[index] = static_cast<uint8_t>(value);
+                value >>= 8;
+            }
+        }
+
+        uint64_t get_integer_value(random_generator& rng, const uint64_t current)
+        {
+            switch (rng.get(4U))
+            {
+            case 0:
+            case 1:
+                return INTERESTING_VALUES[rng.get(INTERESTING_VALUES.size())];
+            case 2: {
+                const auto delta = static_cast<uint64_t>(rng.get_geometric<uint32_t>() + 1);
+                return rng.get<bool>() ? current + delta : current - delta;
+            }
+            default:
+                return rng.get<uint64_t>();
+            }
+        }
+
+        std::vector<uint8_t> generate_bytes(random_generator& rng, const size_t min_size, const size_t max_size)
+        {
+            const auto limit = std::min(max_size, min_size + MAX_GENERATED_BYTES);
+            const auto size = limit > min_size ? rng.get(min_size, limit + 1) : min_size;
+
+            std::vector<uint8_t> data(size);
+            rng.fill(data);
+            return data;
+        }
+
+        size_t count_nonterminals(const grammar_alternative& alternative)
+        {
+            return static_cast<size_t>(std::ranges::count_if(alternative, [](const grammar_symbol& symbol) {
+                return !symbol.terminal; //
+            }));
+        }
+
+        using grammar_rules = std::map<std::string, std::vector<grammar_alternative>>;
+        using grammar_rule = grammar_rules::value_type;
+
+        // Earley parser, it accepts every context-free grammar, including left recursive and
+        // ambiguous ones. Recognition collects every span a rule derives, a single derivation
+        // tree of the whole input is then extracted from those spans.
+        class earley_parser
+        {
+          public:
+            earley_parser(const grammar_rules& rules, const std::string_view text)
+                : rules_(rules),
+                  text_(text),
+                  sets_(text.size() + 1),
+                  seen_(text.size() + 1)
+            {
+                this->compute_nullable_rules();
+            }
+
+            std::vector<grammar_derivation> parse(const std::string& start_rule)
+            {
+                const auto* start = this->find_rule(start_rule);
+                if (!start)
+                {
+                    return {};
+                }
+
+                this->predict(start, 0);
+
+                for (size_t position = 0; position < this->sets_.size(); ++position)
+                {
+                    // Processing adds items to the current set, so it is indexed
+                    for (size_t i = 0; i < this->sets_[position].size(); ++i)
+                    {
+                        this->process(this->sets_[position][i], position);
+                    }
+                }
+
+                std::vector<grammar_derivation> derivations{};
+                if (!this->derive(start, 0, this->text_.size(), 0, derivations))
+                {
+                    return {};
+                }
+
+                return derivations;
+            }
+
+          private:
+            struct item
+            {
+                const grammar_rule* rule{};
+                size_t alternative{};
+                size_t dot{};
+                size_t origin{};
+
+                auto operator<=>(const item&) const = default;
+            };
+
+            using span = std::tuple<const grammar_rule*, size_t, size_t>;
+
+            const grammar_rules& rules_;
+            std::string_view text_{};
+
+            std::vector<std::vector<item>> sets_{};
+            std::vector<std::set<item>> seen_{};
+            std::set<const grammar_rule*> nullable_{};
+
+            std::set<span> completed_{};
+            std::set<span> active_{};
+
+            const grammar_rule* find_rule(const std::string& name) const
+            {
+                const auto entry = this->rules_.find(name);
+                if (entry == this->rules_.end())
+                {
+                    throw std::runtime_error("Unknown grammar rule: " + name);
+                }
+
+                return &*entry;
+            }
+
+            bool is_nullable(const grammar_symbol& symbol) const
+            {
+                return symbol.terminal ? symbol.value.empty() : this->nullable_.contains(this->find_rule(symbol.value));
+            }
+
+            void compute_nullable_rules()
+            {
+                bool changed = true;
+                while (changed)
+                {
+                    changed = false;
+
+                    for (const auto& rule : this->rules_)
+                    {
+                        if (this->nullable_.contains(&rule))
+                        {
+                            continue;
+                        }
+
+                        const auto is_nullable_alternative = [this](const grammar_alternative& alternative) {
+                            return std::ranges::all_of(alternative, [this](const grammar_symbol& symbol) {
+                                return this->is_nullable(symbol); //
+                            });
+                        };
+
+                        if (std::ranges::any_of(rule.second, is_nullable_alternative))
+                        {
+                            this->nullable_.insert(&rule);
+                            changed = true;
+                        }
+                    }
+                }
+            }
+
+            void add(const item& entry, const size_t position)
+            {
+                if (this->seen_[position].insert(entry).second)
+                {
+                    this->sets_[position].push_back(entry);
+                }
+            }
+
+            void predict(const grammar_rule* rule, const size_t position)
+            {
+                for (size_t i = 0; i < rule->second.size(); ++i)
+                {
+                    this->add({.rule = rule, .alternative = i, .dot = 0, .origin = position}, position);
+                }
+            }
+
+            void process(const item entry, const size_t position)
+            {
+                const auto& alternative = entry.rule->second[entry.alternative];
+
+                auto next = entry;
+                ++next.dot;
+
+                if (entry.dot == alternative.size())
+                {
+                    this->complete(entry, position);
+                    return;
+                }
+
+                const auto& symbol = alternative[entry.dot];
+                if (symbol.terminal)
+                {
+                    if (this->text_.substr(position).starts_with(symbol.value))
+                    {
+                        this->add(next, position + symbol.value.size());
+                    }
+
+                    return;
+                }
+
+                const auto* rule = this->find_rule(symbol.value);
+                this->predict(rule, position);
+
+                // Nullable rules complete within this set, possibly before this item was added
+                if (this->nullable_.contains(rule))
+                {
+                    this->add(next, position);
+                }
+            }
+
+            void complete(const item& entry, const size_t position)
+            {
+                this->completed_.emplace(entry.rule, entry.origin, position);
+
+                auto& origin_set = this->sets_[entry.origin];
+
+                for (size_t i = 0; i < origin_set.size(); ++i)
+                {
+                    const auto waiting = origin_set[i];
+                    const auto& alternative = waiting.rule->second[waiting.alternative];
+
+                    if (waiting.dot < alternative.size() && !alternative[waiting.dot].terminal &&
+                        alternative[waiting.dot].value == entry.rule->first)
+                    {
+                        auto next = waiting;
+                        ++next.dot;
+                        this->add(next, position);
+                    }
+                }
+            }
+
+            bool derive(const grammar_rule* rule, const size_t start, const size_t end, const size_t depth,
+                        std::vector<grammar_derivation>& derivations)
+            {
+                const span current{rule, start, end};
+                if (!this->active_.insert(current).second)
+                {
+                    return false;
+                }
+
+                bool success = false;
+                for (const auto& alternative : rule->second)
+                {
+                    std::vector<span> children{};
+                    std::set<std::pair<size_t, size_t>> failed{};
+
+                    if (!this->find_split(alternative, 0, start, end, children, failed))
+                    {
+                        continue;
+                    }
+
+                    const auto count = derivations.size();
+                    success = std::ranges::all_of(children, [&](const span& child) {
+                        const auto& [child_rule, child_start, child_end] = child;
+                        return this->derive(child_rule, child_start, child_end, depth + 1, derivations);
+                    });
+
+                    if (success)
+                    {
+                        derivations.push_back({
+                            .rule = &rule->first,
+                            .start = start,
+                            .end = end,
+                            .depth = depth,
+                        });
+
+                        break;
+                    }
+
+                    derivations.resize(count);
+                }
+
+                this->active_.erase(current);
+                return success;
+            }
+
+            // Splits the text between the symbols of an alternative using the recognized spans only,
+            // children are derived once a complete split is found
+            bool find_split(const grammar_alternative& alternative, const size_t index, const size_t position,
+                            const size_t end, std::vector<span>& children, std::set<std::pair<size_t, size_t>>& failed)
+            {
+                if (index == alternative.size())
+                {
+                    return position == end;
+                }
+
+                if (failed.contains({index, position}))
+                {
+                    return false;
+                }
+
+                const auto& symbol = alternative[index];
+
+                if (symbol.terminal)
+                {
+                    if (this->text_.substr(position, end - position).starts_with(symbol.value) &&
+                        this->find_split(alternative, index + 1, position + symbol.value.size(), end, children,
+                                         failed))
+                    {
+                        return true;
+                    }
+                }
+                else
+                {
+                    const auto* rule = this->find_rule(symbol.value);
+
+                    const auto first = this->completed_.lower_bound({rule, position, 0});
+
+                    for (auto entry = first; entry != this->completed_.end(); ++entry)
+                    {
+                        const auto& [entry_rule, entry_start, entry_end] = *entry;
+                        if (entry_rule != rule || entry_start != position || entry_end > end)
+                        {
+                            break;
+                        }
+
+                        // Spans being derived right now would form a cycle
+                        if (this->active_.contains(*entry))
+                        {
+                            continue;
+                        }
+
+                        children.push_back(*entry);
+
+                        if (this->find_split(alternative, index + 1, entry_end, end, children, failed))
+                        {
+                            return true;
+                        }
+
+                        children.pop_back();
+                    }
+                }
+
+                failed.emplace(index, position);
+                return false;
+            }
+        };
+    }
+
+    void mutate_bytes(random_generator& rng, std::vector<uint8_t>& input)
+    {
+        if (input.empty() || rng.get(3) == 0)
+        {
+            const auto new_bytes = rng.get_geometric<size_t>() + 1;
+            input.resize(input.size() + new_bytes);
+        }
+        else if (rng.get(10) == 0)
+        {
+            const auto remove_bytes = rng.get_geometric<size_t>() % input.size();
+            input.resize(input.size() - remove_bytes);
+        }
+
+        const auto mutations = (rng.get_geometric<size_t>() + 1) % input.size();
+
+        for (size_t i = 0; i < mutations; ++i)
+        {
+            const auto index = rng.get<size_t>(input.size());
+            input[index] = rng.get<uint8_t>();
+        }
+    }
+
+    size_t field_schema_format::add_field(schema_field field)
+    {
+        this->fields_.emplace_back(std::move(field));
+        return this->fields_.size() - 1;
+    }
+
+    size_t field_schema_format::add_constant(std::vector<uint8_t> value)
+    {
+        schema_field field{};
+        field.type = field_type::constant;
+        field.size = value.size();
+        field.value = std::move(value);
+
+        return this->add_field(std::move(field));
+    }
+
+    size_t field_schema_format::add_integer(const size_t size, const bool big_endian)
+    {
+        schema_field field{};
+        field.type = field_type::integer;
+        field.size = size;
+        field.big_endian = big_endian;
+
+        return this->add_field(std::move(field));
+    }
+
+    size_t field_schema_format::add_bytes(const size_t min_size, const size_t max_size)
+    {
+        schema_field field{};
+        field.type = field_type::bytes;
+        field.min_size = min_size;
+        field.max_size = std::max(min_size, max_size);
+
+        return this->add_field(std::move(field));
+    }
+
+    size_t field_schema_format::add_length(const size_t size, const size_t target, const bool big_endian)
+    {
+        if (target <= this->fields_.size())
+        {
+            throw std::runtime_error("Length fields must describe a later field");
+        }
+
+        schema_field field{};
+        field.type = field_type::length;
+        field.size = size;
+        field.target = target;
+        field.big_endian = big_endian;
+
+        return this->add_field(std::move(field));
+    }
+
+    std::vector<field_schema_format::field_value> field_schema_format::parse(const std::span<const uint8_t> input) const
+    {
+        std::vector<field_value> values(this->fields_.size());
+        std::vector<std::optional<uint64_t>> lengths(this->fields_.size());
+
+        size_t offset = 0;
+        const auto take = [&](const uint64_t count) {
+            const auto size = static_cast<size_t>(std::min<uint64_t>(count, input.size() - offset));
+            const auto data = input.subspan(offset, size);
+            offset += size;
+
+            return std::vector<uint8_t>(data.begin(), data.end());
+        };
+
+        for (size_t i = 0; i < this->fields_.size(); ++i)
+        {
+            const auto& field = this->fields_[i];
+            auto& value = values[i].data;
+
+            switch (field.type)
+            {
+            case field_type::constant:
+                value = field.value;
+                offset += std::min(field.value.size(), input.size() - offset);
+                break;
+
+            case field_type::integer:
+                value = take(field.size);
+                value.resize(field.size);
+                break;
+
+            case field_type::length:
+                value = take(field.size);
+                value.resize(field.size);
+
+                if (field.target < lengths.size())
+                {
+                    lengths[field.target] = read_integer(value, field.big_endian);
+                }
+                break;
+
+            case field_type::bytes:
+                value = take(std::min<uint64_t>(lengths[i].value_or(input.size()), field.max_size));
+                break;
+            }
+        }
+
+        return values;
+    }
+
+    std::vector<uint8_t> field_schema_format::serialize(std::vector<field_value>& values) const
+    {
+        std::vector<uint8_t> output{};
+
+        for (size_t i = 0; i < this->fields_.size(); ++i)
+        {
+            const auto& field = this->fields_[i];
+            if (field.type == field_type::length && !values[i].keep && field.target < values.size())
+            {
+                write_integer(values[i].data, field.size, values[field.target].data.size(), field.big_endian);
+            }
+        }
+
+        for (const auto& value : values)
+        {
+            output.insert(output.end(), value.data.begin(), value.data.end());
+        }
+
+        return output;
+    }
+
+    void field_schema_format::mutate_field(random_generator& rng, const size_t index, field_value& value) const
+    {
+        const auto& field = this->fields_[index];
+
+        switch (field.type)
+        {
+        case field_type::integer:
+        case field_type::length:
+            write_integer(value.data, field.size,
+                          get_integer_value(rng, read_integer(value.data, field.big_endian)), field.big_endian);
+            value.keep = field.type == field_type::length;
+            break;
+
+        case field_type::bytes:
+            mutate_bytes(rng, value.data);
+            value.data.resize(std::clamp(value.data.size(), field.min_size, field.max_size));
+            break;
+
+        case field_type::constant:
+            break;
+        }
+    }
+
+    std::vector<uint8_t> field_schema_format::generate(random_generator& rng) const
+    {
+        std::vector<field_value> values(this->fields_.size());
+
+        for (size_t i = 0; i < this->fields_.size(); ++i)
+        {
+            const auto& field = this->fields_[i];
+            auto& value = values[i].data;
+
+            switch (field.type)
+            {
+            case field_type::constant:
+                value = field.value;
+                break;
+
+            case field_type::integer:
+                write_integer(value, field.size, get_integer_value(rng, 0), field.big_endian);
+                break;
+
+            case field_type::length:
+                break;
+
+            case field_type::bytes:
+                value = generate_bytes(rng, field.min_size, field.max_size);
+                break;
+            }
+        }
+
+        return this->serialize(values);
+    }
+
+    void field_schema_format::mutate(random_generator& rng, std::vector<uint8_t>& input) const
+    {
+        // Corrupting lengths is rarely useful, so the schema stays intact most of the time
+        const auto include_lengths = rng.get(16) == 0;
+
+        std::vector<size_t> candidates{};
+        for (size_t i = 0; i < this->fields_.size(); ++i)
+        {
+            const auto type = this->fields_[i].type;
+            if (type == field_type::integer || type == field_type::bytes ||
+                (type == field_type::length && include_lengths))
+            {
+                candidates.push_back(i);
+            }
+        }
+
+        if (input.empty() || candidates.empty())
+        {
+            input = this->generate(rng);
+            return;
+        }
+
+        auto values = this->parse(input);
+        const auto mutations = rng.get_geometric<size_t>() + 1;
+
+        for (size_t i = 0; i < mutations; ++i)
+        {
+            const auto index = candidates[rng.get(candidates.size())];
+            this->mutate_field(rng, index, values[index]);
+        }
+
+        input = this->serialize(values);
+    }
+
+    grammar_symbol terminal(std::string value)
+    {
+        return {.value = std::move(value), .terminal = true};
+    }
+
+    grammar_symbol nonterminal(std::string name)
+    {
+        return {.value = std::move(name), .terminal = false};
+    }
+
+    grammar_format::grammar_format(std::string start_rule)
+        : start_rule_(std::move(start_rule))
+    {
+    }
+
+    void grammar_format::add_rule(std::string name, std::vector<grammar_alternative> alternatives)
+    {
+        if (alternatives.empty())
+        {
+            throw std::runtime_error("Grammar rule without alternatives: " + name);
+        }
+
+        this->rules_[std::move(name)] = std::move(alternatives);
+    }
+
+    void grammar_format::expand(random_generator& rng, const std::string& rule, const size_t depth,
+                                std::string& output) const
+    {
+        const auto entry = this->rules_.find(rule);
+        if (entry == this->rules_.end())
+        {
+            throw std::runtime_error("Unknown grammar rule: " + rule);
+        }
+
+        const auto& alternatives = entry->second;
+        const auto* alternative = &alternatives[rng.get(alternatives.size())];
+
+        // Past the depth limit, derivations are steered towards terminating alternatives
+        if (depth >= MAX_GRAMMAR_DEPTH)
+        {
+            alternative = &*std::ranges::min_element(alternatives, {}, count_nonterminals);
+        }
+
+        for (const auto& symbol : *alternative)
+        {
+            if (symbol.terminal)
+            {
+                output += symbol.value;
+            }
+            else
+            {
+                this->expand(rng, symbol.value, depth + 1, output);
+            }
+        }
+    }
+
+    std::string grammar_format::expand(random_generator& rng, const std::string& rule, const size_t depth) const
+    {
+        std::string output{};
+        this->expand(rng, rule, depth, output);
+        return output;
+    }
+
+    std::vector<uint8_t> grammar_format::generate(random_generator& rng) const
+    {
+        const auto text = this->expand(rng, this->start_rule_, 0);
+        return {text.begin(), text.end()};
+    }
+
+    std::vector<grammar_derivation> grammar_format::parse(const std::string_view text) const
+    {
+        earley_parser parser{this->rules_, text};
+        return parser.parse(this->start_rule_);
+    }
+
+    void grammar_format::mutate(random_generator& rng, std::vector<uint8_t>& input) const
+    {
+        if (input.empty() || input.size() > MAX_GRAMMAR_PARSE_BYTES || this->rules_.empty() || rng.get(4) == 0)
+        {
+            input = this->generate(rng);
+            return;
+        }
+
+        const std::string_view text(reinterpret_cast<const char*>(input.data()), input.size());
+
+        // Inputs outside the grammar, like seeds from disk, can not be mutated structurally
+        const auto derivations = this->parse(text);
+        if (derivations.empty())
+        {
+            input = this->generate(rng);
+            return;
+        }
+
+        const auto& target = derivations[rng.get(derivations.size())];
+
+        std::string replacement{};
+        bool spliced = false;
+
+        // Reusing a derivation from the input keeps structures that already proved interesting
+        if (rng.get<bool>())
+        {
+            std::vector<const grammar_derivation*> donors{};
+
+            for (const auto& derivation : derivations)
+            {
+                if (derivation.rule == target.rule && &derivation != &target)
+                {
+                    donors.push_back(&derivation);
+                }
+            }
+
+            if (!donors.empty())
+            {
+                const auto* donor = donors[rng.get(donors.size())];
+                replacement = text.substr(donor->start, donor->end - donor->start);
+                spliced = true;
+            }
+        }
+
+        if (!spliced)
+        {
+            replacement = this->expand(rng, *target.rule, target.depth);
+        }
+
+        std::vector<uint8_t> output{};
+        output.reserve(input.size() - (target.end - target.start) + replacement.size());
+        output.insert(output.end(), input.begin(), input.begin() + static_cast<ptrdiff_t>(target.start));
+        output.insert(output.end(), replacement.begin(), replacement.end());
+        output.insert(output.end(), input.begin() + static_cast<ptrdiff_t>(target.end), input.end());
+
+        input = std::move(output);
+    }
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+#include "random_generator.hpp"
+
+namespace fuzzer
+{
+    void mutate_bytes(random_generator& rng, std::vector<uint8_t>& input);
+
+    // Describes the structure of inputs a harness accepts.
+    // Implementations are shared between all workers and must not keep mutable state.
+    struct input_format
+    {
+        virtual ~input_format() = default;
+
+        virtual std::vector<uint8_t> generate(random_generator& rng) const = 0;
+        virtual void mutate(random_generator& rng, std::vector<uint8_t>& input) const = 0;
+    };
+
+    enum class field_type
+    {
+        constant,
+        integer,
+        length,
+        bytes,
+    };
+
+    struct schema_field
+    {
+        field_type type{};
+        size_t size{};
+        bool big_endian{};
+
+        std::vector<uint8_t> value{};
+
+        size_t min_size{};
+        size_t max_size{};
+        size_t target{};
+    };
+
+    // Flat sequence of fields. Length fields always describe the size of a later
+    // bytes field, they are fixed up after every mutation unless the mutation
+    // deliberately corrupted them.
+    class field_schema_format : public input_format
+    {
+      public:
+        size_t add_constant(std::vector<uint8_t> value);
+        size_t add_integer(size_t size, bool big_endian = false);
+        size_t add_bytes(size_t min_size, size_t max_size);
+        size_t add_length(size_t size, size_t target, bool big_endian = false);
+
+        std::vector<uint8_t> generate(random_generator& rng) const override;
+        void mutate(random_generator& rng, std::vector<uint8_t>& input) const override;
+
+      private:
+        struct field_value
+        {
+            std::vector<uint8_t> data{};
+            bool keep{};
+        };
+
+        std::vector<schema_field> fields_{};
+
+        size_t add_field(schema_field field);
+        std::vector<field_value> parse(std::span<const uint8_t> input) const;
+        std::vector<uint8_t> serialize(std::vector<field_value>& values) const;
+        void mutate_field(random_generator& rng, size_t index, field_value& value) const;
+    };
+
+    struct grammar_symbol
+    {
+        std::string value{};
+        bool terminal{};
+    };
+
+    using grammar_alternative = std::vector<grammar_symbol>;
+
+    grammar_symbol terminal(std::string value);
+    grammar_symbol nonterminal(std::string name);
+
+    // Part of the input derived from a single rule, depth is its distance from the start rule
+    struct grammar_derivation
+    {
+        const std::string* rule{};
+        size_t start{};
+        size_t end{};
+        size_t depth{};
+    };
+
+    // Context-free grammar. Mutations parse the input and replace the derivation
+    // of one rule with a fresh derivation of the same rule, or with another
+    // derivation of that rule found in the input.
+    class grammar_format : public input_format
+    {
+      public:
+        grammar_format(std::string start_rule);
+
+        void add_rule(std::string name, std::vector<grammar_alternative> alternatives);
+
+        std::vector<uint8_t> generate(random_generator& rng) const override;
+        void mutate(random_generator& rng, std::vector<uint8_t>& input) const override;
+
+      private:
+        std::string start_rule_{};
+        std::map<std::string, std::vector<grammar_alternative>> rules_{};
+
+        std::string expand(random_generator& rng, const std::string& rule, size_t depth) const;
+        void expand(random_generator& rng, const std::string& rule, size_t depth, std::string& output) const;
+        std::vector<grammar_derivation> parse(std::string_view text) const;
+    };
+}
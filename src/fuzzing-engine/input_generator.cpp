@@ -1,126 +1,309 @@
 #include "input_generator.hpp"
 
-#include <cassert>
+#include <chrono>
+#include <limits>
+#include <algorithm>
 
 namespace fuzzer
 {
     namespace
     {
-        constexpr size_t MAX_TOP_SCORER = 20;
+        constexpr size_t SYNC_INTERVAL = 256;
+        constexpr double BASE_ENERGY = 16.0;
+        constexpr double MAX_ENERGY = 1024.0;
 
-        void mutate_input(random_generator& rng, std::vector<uint8_t>& input)
+        double get_speed_factor(const uint64_t execution_time, const double average_time)
         {
-            if (input.empty() || rng.get(3) == 0)
+            const auto time = static_cast<double>(std::max<uint64_t>(execution_time, 1));
+
+            if (time * 4 <= average_time)
+            {
+                return 3.0;
+            }
+
+            if (time * 2 <= average_time)
+            {
+                return 2.0;
+            }
+
+            if (time * 4 <= average_time * 3)
+            {
+                return 1.5;
+            }
+
+            if (time >= average_time * 10)
+            {
+                return 0.1;
+            }
+
+            if (time >= average_time * 4)
+            {
+                return 0.25;
+            }
+
+            if (time >= average_time * 2)
+            {
+                return 0.5;
+            }
+
+            return 1.0;
+        }
+
+        double get_coverage_factor(const input_score score, const double average_score)
+        {
+            const auto value = static_cast<double>(score);
+
+            if (value * 0.3 > average_score)
+            {
+                return 3.0;
+            }
+
+            if (value * 0.5 > average_score)
+            {
+                return 2.0;
+            }
+
+            if (value * 0.75 > average_score)
+            {
+                return 1.5;
+            }
+
+            if (value * 3 < average_score)
+            {
+                return 0.25;
+            }
+
+            if (value * 2 < average_score)
+            {
+                return 0.5;
+            }
+
+            if (value * 1.5 < average_score)
+            {
+                return 0.75;
+            }
+
+            return 1.0;
+        }
+
+        double get_depth_factor(const uint32_t depth)
+        {
+            if (depth <= 3)
+            {
+                return 1.0;
+            }
+
+            if (depth <= 7)
+            {
+                return 2.0;
+            }
+
+            if (depth <= 13)
+            {
+                return 3.0;
+            }
+
+            if (depth <= 25)
             {
-                const auto new_bytes = rng.get_geometric<size_t>() + 1;
-                input.resize(input.size() + new_bytes);
+                return 4.0;
             }
-            else if (rng.get(10) == 0)
+
+            return 5.0;
+        }
+
+        double get_rarity_factor(const uint32_t rarest_hits)
+        {
+            if (rarest_hits <= 16)
             {
-                const auto remove_bytes = rng.get_geometric<size_t>() % input.size();
-                input.resize(input.size() - remove_bytes);
+                return 4.0;
             }
 
-            const auto mutations = (rng.get_geometric<size_t>() + 1) % input.size();
+            if (rarest_hits <= 128)
+            {
+                return 2.0;
+            }
 
-            for (size_t i = 0; i < mutations; ++i)
+            if (rarest_hits <= 1024)
             {
-                const auto index = rng.get<size_t>(input.size());
-                input[index] = rng.get<uint8_t>();
+                return 1.0;
             }
+
+            return 0.5;
         }
     }
 
-    input_generator::input_generator() = default;
+    input_generator::input_generator(corpus& corpus, const input_format* format)
+        : corpus_(&corpus),
+          format_(format),
+          block_hits_(coverage_map::SIZE, 0),
+          current_hits_(coverage_map::SIZE, false)
+    {
+    }
 
-    std::vector<uint8_t> input_generator::generate_next_input()
+    execution_result input_generator::access_input(const std::function<input_handler>& handler)
     {
-        std::vector<uint8_t> input{};
-        std::unique_lock lock{this->mutex_};
+        if (this->queue_.empty() || ++this->executions_since_sync_ >= SYNC_INTERVAL)
+        {
+            this->sync();
+        }
 
-        if (!this->top_scorer_.empty())
+        if (this->queue_.empty())
         {
-            const auto index = this->rng.get<size_t>() % this->top_scorer_.size();
-            input = this->top_scorer_[index].data;
+            return this->fuzz_input({}, 0, handler);
         }
 
-        mutate_input(this->rng, input);
+        if (this->remaining_energy_ == 0)
+        {
+            this->select_next_entry();
+        }
 
-        return input;
+        auto& entry = this->queue_[this->current_entry_];
+        if (!entry.calibrated)
+        {
+            return this->calibrate(entry, handler);
+        }
+
+        --this->remaining_energy_;
+        ++entry.fuzz_count;
+
+        return this->fuzz_input(entry.entry->data, entry.stats.depth + 1, handler);
     }
 
-    void input_generator::access_input(const std::function<input_handler>& handler)
+    void input_generator::sync()
     {
-        auto next_input = this->generate_next_input();
-        const auto score = handler(next_input);
+        this->executions_since_sync_ = 0;
+        this->synced_sequence_ = this->corpus_->sync(this->synced_sequence_, [this](const seed& s) {
+            queue_entry entry{};
+            entry.entry = &s;
+            entry.calibrated = s.calibrated;
 
-        input_entry e{};
-        e.data = std::move(next_input);
-        e.score = score;
+            if (entry.calibrated)
+            {
+                entry.stats = s.stats;
+                this->add_calibrated_entry(entry.stats);
+            }
 
-        this->store_input_entry(std::move(e));
+            this->queue_.emplace_back(std::move(entry));
+        });
     }
 
-    input_entry input_generator::get_highest_scorer()
+    void input_generator::select_next_entry()
     {
-        std::unique_lock lock{this->mutex_};
-        return this->highest_scorer_;
+        this->current_entry_ = (this->current_entry_ + 1) % this->queue_.size();
+
+        const auto& entry = this->queue_[this->current_entry_];
+        this->remaining_energy_ = entry.calibrated ? this->calculate_energy(entry) : 0;
     }
 
-    double input_generator::get_average_score()
+    size_t input_generator::calculate_energy(const queue_entry& entry) const
     {
-        std::unique_lock lock{this->mutex_};
+        const auto entries = static_cast<double>(std::max<size_t>(this->calibrated_entries_, 1));
+        const auto average_time = static_cast<double>(this->total_execution_time_) / entries;
+        const auto average_score = static_cast<double>(this->total_score_) / entries;
 
-        if (this->top_scorer_.empty())
+        auto rarest_hits = std::numeric_limits<uint32_t>::max();
+        for (const auto block : entry.stats.blocks)
         {
-            return 0.0;
+            rarest_hits = std::min(rarest_hits, this->block_hits_[block]);
         }
 
-        double score{0.0};
-        for (const auto& e : this->top_scorer_)
+        auto energy = BASE_ENERGY;
+        energy *= get_speed_factor(entry.stats.execution_time, average_time);
+        energy *= get_coverage_factor(entry.stats.score, average_score);
+        energy *= get_depth_factor(entry.stats.depth);
+        energy *= entry.stats.blocks.empty() ? 1.0 : get_rarity_factor(rarest_hits);
+
+        return static_cast<size_t>(std::clamp(energy, 1.0, MAX_ENERGY));
+    }
+
+    execution_result input_generator::execute(const std::span<const uint8_t> data,
+                                              const std::function<input_handler>& handler, seed_stats& stats,
+                                              bool& has_new_coverage)
+    {
+        for (const auto block : this->current_blocks_)
         {
-            score += static_cast<double>(e.score);
+            this->current_hits_[block] = false;
         }
 
-        return score / static_cast<double>(this->top_scorer_.size());
+        this->current_blocks_.clear();
+        auto& coverage = this->corpus_->get_coverage();
+
+        const auto start = std::chrono::steady_clock::now();
+
+        const auto result = handler(data, [&](const uint64_t address) {
+            const auto index = coverage_map::get_index(address);
+            if (this->current_hits_[index])
+            {
+                return;
+            }
+
+            this->current_hits_[index] = true;
+            this->current_blocks_.push_back(index);
+
+            ++this->block_hits_[index];
+            has_new_coverage |= coverage.add(index);
+        });
+
+        const auto duration = std::chrono::steady_clock::now() - start;
+
+        stats.score = this->current_blocks_.size();
+        stats.execution_time =
+            static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+
+        return result;
     }
 
-    void input_generator::store_input_entry(input_entry entry)
+    execution_result input_generator::fuzz_input(std::vector<uint8_t> data, const uint32_t depth,
+                                                 const std::function<input_handler>& handler)
     {
-        std::unique_lock lock{this->mutex_};
-
-        if (entry.score < this->lowest_score && this->rng.get(40) != 0)
+        if (this->format_)
         {
-            return;
+            this->format_->mutate(this->rng, data);
         }
-
-        if (entry.score > this->highest_scorer_.score)
+        else
         {
-            this->highest_scorer_ = entry;
+            mutate_bytes(this->rng, data);
         }
 
-        if (this->top_scorer_.size() < MAX_TOP_SCORER)
+        seed_stats stats{};
+        stats.depth = depth;
+        bool has_new_coverage = false;
+
+        const auto result = this->execute(data, handler, stats, has_new_coverage);
+
+        if (has_new_coverage && result == execution_result::success)
         {
-            this->top_scorer_.emplace_back(std::move(entry));
-            return;
+            stats.blocks = this->current_blocks_;
+
+            seed new_seed{};
+            new_seed.data = std::move(data);
+            new_seed.stats = std::move(stats);
+            new_seed.calibrated = true;
+
+            this->corpus_->publish(std::move(new_seed));
         }
 
-        const auto insert_at_random = this->rng.get(10) == 0;
-        const auto index =
-            insert_at_random ? (this->rng.get<size_t>() % this->top_scorer_.size()) : this->lowest_scorer;
+        return result;
+    }
 
-        this->top_scorer_[index] = std::move(entry);
+    execution_result input_generator::calibrate(queue_entry& entry, const std::function<input_handler>& handler)
+    {
+        bool has_new_coverage = false;
+        const auto result = this->execute(entry.entry->data, handler, entry.stats, has_new_coverage);
 
-        this->lowest_score = this->top_scorer_[0].score;
-        this->lowest_scorer = 0;
+        entry.stats.blocks = this->current_blocks_;
+        entry.calibrated = true;
 
-        for (size_t i = 1; i < this->top_scorer_.size(); ++i)
-        {
-            if (this->top_scorer_[i].score < this->lowest_score)
-            {
-                this->lowest_score = this->top_scorer_[i].score;
-                this->lowest_scorer = i;
-            }
-        }
+        this->add_calibrated_entry(entry.stats);
+        this->remaining_energy_ = this->calculate_energy(entry);
+
+        return result;
+    }
+
+    void input_generator::add_calibrated_entry(const seed_stats& stats)
+    {
+        ++this->calibrated_entries_;
+        this->total_score_ += stats.score;
+        this->total_execution_time_ += stats.execution_time;
     }
 }
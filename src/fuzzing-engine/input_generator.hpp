@@ -1,44 +1,67 @@
 #pragma once
-#include <mutex>
 #include <vector>
-#include <optional>
 #include <functional>
 
+#include "corpus.hpp"
+#include "fuzzer.hpp"
+#include "input_format.hpp"
 #include "random_generator.hpp"
 
 namespace fuzzer
 {
-    using input_score = uint64_t;
-    using input_handler = input_score(std::span<const uint8_t>);
-
-    struct input_entry
-    {
-        std::vector<uint8_t> data{};
-        input_score score{};
-    };
+    using input_handler = execution_result(std::span<const uint8_t> data,
+                                           const std::function<coverage_functor>& coverage_handler);
 
+    // Owned by a single worker. Seeds are scheduled from a local queue and
+    // mutated as often as their energy allows, following an AFL-style power schedule.
+    // Without an input format, inputs are mutated as plain bytes.
     class input_generator
     {
       public:
-        input_generator();
-
-        void access_input(const std::function<input_handler>& handler);
+        input_generator(corpus& corpus, const input_format* format = nullptr);
 
-        input_entry get_highest_scorer();
-        double get_average_score();
+        execution_result access_input(const std::function<input_handler>& handler);
 
       private:
-        std::mutex mutex_{};
+        struct queue_entry
+        {
+            const seed* entry{};
+            seed_stats stats{};
+            bool calibrated{};
+            size_t fuzz_count{};
+        };
+
+        corpus* corpus_{};
+        const input_format* format_{};
         random_generator rng{};
 
-        std::vector<input_entry> top_scorer_{};
-        input_score lowest_score{0};
-        size_t lowest_scorer{0};
+        std::vector<queue_entry> queue_{};
+        size_t current_entry_{};
+        size_t remaining_energy_{};
+
+        size_t synced_sequence_{};
+        size_t executions_since_sync_{};
+
+        uint64_t total_execution_time_{};
+        input_score total_score_{};
+        size_t calibrated_entries_{};
+
+        // Number of executions that reached a block
+        std::vector<uint32_t> block_hits_{};
 
-        input_entry highest_scorer_{};
+        // Unique blocks of the current execution, the bitmap deduplicates them
+        std::vector<uint32_t> current_blocks_{};
+        std::vector<bool> current_hits_{};
 
-        std::vector<uint8_t> generate_next_input();
+        void sync();
+        void select_next_entry();
+        size_t calculate_energy(const queue_entry& entry) const;
 
-        void store_input_entry(input_entry entry);
+        execution_result execute(std::span<const uint8_t> data, const std::function<input_handler>& handler,
+                                 seed_stats& stats, bool& has_new_coverage);
+        execution_result fuzz_input(std::vector<uint8_t> data, uint32_t depth,
+                                    const std::function<input_handler>& handler);
+        execution_result calibrate(queue_entry& entry, const std::function<input_handler>& handler);
+        void add_calibrated_entry(const seed_stats& stats);
     };
 }
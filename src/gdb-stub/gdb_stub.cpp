@@ -128,6 +128,26 @@ namespace gdb_stub
             }
         }
 
+        void process_monitor_command(const debugging_context& c, const std::string_view payload)
+        {
+            const auto command_data = utils::string::from_hex_string(payload);
+            const std::string_view command(reinterpret_cast<const char*>(command_data.data()), command_data.size());
+
+            const auto output = c.handler.run_monitor_command(command);
+            if (!output)
+            {
+                c.connection.send_reply({});
+            }
+            else if (output->empty())
+            {
+                c.connection.send_reply("OK");
+            }
+            else
+            {
+                c.connection.send_reply(utils::string::to_hex_string(output->data(), output->size()));
+            }
+        }
+
         void process_query(const debugging_context& c, const std::string_view payload)
         {
             const auto [name, args] = split_string(payload, ':');
@@ -148,6 +168,10 @@ namespace gdb_stub
             {
                 c.connection.send_reply("OK");
             }
+            else if (name.starts_with("Rcmd,"))
+            {
+                process_monitor_command(c, name.substr(5));
+            }
             else if (name == "C")
             {
                 const auto thread_id = c.handler.get_current_thread_id();
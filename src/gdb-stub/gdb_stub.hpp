@@ -51,6 +51,13 @@ namespace gdb_stub
 
         virtual std::optional<uint32_t> get_exit_code() = 0;
 
+        // Handles 'monitor' commands. Returns nullopt for unsupported commands.
+        virtual std::optional<std::string> run_monitor_command(const std::string_view command)
+        {
+            (void)command;
+            return std::nullopt;
+        }
+
         virtual bool should_stop()
         {
             return false;
@@ -0,0 +1,142 @@
+#include <cstdio>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#define WIN32_LEAN_AND_MEAN
+
+#ifdef __MINGW64__
+#include <windows.h>
+#else
+#include <Windows.h>
+#endif
+
+// Exercises the CRT routines that select their implementation based on the CPU features.
+// Run it under the analyzer with different --cpu-profile values to compare the code paths
+// the guest ends up on, e.g. 'analyzer --cpu-profile fast-emulation -e root c:/benchmark-sample.exe'.
+
+namespace
+{
+    constexpr size_t BUFFER_SIZE = 0x10000;
+    constexpr size_t ITERATIONS = 64;
+
+    // Volatile so that the workloads can't be folded away
+    volatile size_t sink = 0;
+
+    struct buffers
+    {
+        std::vector<char> source = std::vector<char>(BUFFER_SIZE, 'a');
+        std::vector<char> destination = std::vector<char>(BUFFER_SIZE, 'b');
+
+        buffers()
+        {
+            this->source.back() = '\0';
+            this->destination.back() = '\0';
+        }
+    };
+
+    size_t run_memcpy(buffers& b, const size_t size)
+    {
+        memcpy(b.destination.data(), b.source.data(), size);
+        return static_cast<uint8_t>(b.destination[size / 2]);
+    }
+
+    size_t run_memmove(buffers& b, const size_t size)
+    {
+        memmove(b.destination.data() + 1, b.destination.data(), size - 1);
+        return static_cast<uint8_t>(b.destination[size / 2]);
+    }
+
+    size_t run_memset(buffers& b, const size_t size)
+    {
+        memset(b.destination.data(), static_cast<int>(size & 0x7F), size - 1);
+        return static_cast<uint8_t>(b.destination[size / 2]);
+    }
+
+    size_t run_memcmp(buffers& b, const size_t size)
+    {
+        return static_cast<size_t>(memcmp(b.source.data(), b.destination.data(), size) != 0);
+    }
+
+    size_t run_memchr(buffers& b, const size_t size)
+    {
+        const auto* result = memchr(b.source.data(), 'z', size);
+        return result ? 1 : 0;
+    }
+
+    size_t run_strlen(buffers& b, const size_t)
+    {
+        return strlen(b.source.data());
+    }
+
+    size_t run_strchr(buffers& b, const size_t)
+    {
+        const auto* result = strchr(b.source.data(), 'z');
+        return result ? 1 : 0;
+    }
+
+    struct workload
+    {
+        const char* name{};
+        size_t (*function)(buffers& b, size_t size){};
+    };
+
+    // Called through a volatile table, so that the compiler can't inline the routines
+    volatile workload workloads[] = {
+        {"memcpy", run_memcpy}, {"memmove", run_memmove}, {"memset", run_memset}, {"memcmp", run_memcmp},
+        {"memchr", run_memchr}, {"strlen", run_strlen},   {"strchr", run_strchr},
+    };
+
+    void print_features()
+    {
+        constexpr DWORD pf_sse4_2 = 38;
+        constexpr DWORD pf_avx = 39;
+        constexpr DWORD pf_avx2 = 40;
+        constexpr DWORD pf_avx512f = 41;
+        constexpr DWORD pf_erms = 42;
+
+        printf("Features: SSE4.2=%d AVX=%d AVX2=%d AVX512F=%d ERMS=%d\n", !!IsProcessorFeaturePresent(pf_sse4_2),
+               !!IsProcessorFeaturePresent(pf_avx), !!IsProcessorFeaturePresent(pf_avx2),
+               !!IsProcessorFeaturePresent(pf_avx512f), !!IsProcessorFeaturePresent(pf_erms));
+    }
+}
+
+int main(const int argc, const char*[])
+{
+    print_features();
+
+    buffers b{};
+
+    // Depends on the command line, so the sizes aren't compile time constants
+    const auto size = BUFFER_SIZE - static_cast<size_t>(argc);
+
+    std::chrono::steady_clock::duration total{};
+
+    for (const auto& entry : workloads)
+    {
+        const auto* name = entry.name;
+        auto* function = entry.function;
+
+        const auto start = std::chrono::steady_clock::now();
+
+        for (size_t i = 0; i < ITERATIONS; ++i)
+        {
+            sink = sink + function(b, size);
+        }
+
+        const auto duration = std::chrono::steady_clock::now() - start;
+        total += duration;
+
+        printf("%-8s %8lld us\n", name,
+               static_cast<long long>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count()));
+    }
+
+    printf("%-8s %8lld us\n", "total",
+           static_cast<long long>(std::chrono::duration_cast<std::chrono::microseconds>(total).count()));
+
+    return 0;
+}
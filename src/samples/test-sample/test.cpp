@@ -437,6 +437,80 @@ namespace
         return true;
     }
 
+    bool test_registry_writes()
+    {
+        HKEY key{};
+        DWORD disposition{};
+        if (RegCreateKeyExA(HKEY_LOCAL_MACHINE, R"(SOFTWARE\SogenTest)", 0, nullptr, 0, KEY_ALL_ACCESS, nullptr, &key,
+                            &disposition) != ERROR_SUCCESS)
+        {
+            return false;
+        }
+
+        constexpr char data[] = "Value";
+        const auto set_result =
+            RegSetValueExA(key, "Name", 0, REG_SZ, reinterpret_cast<const uint8_t*>(data), sizeof(data));
+
+        RegCloseKey(key);
+
+        if (disposition != REG_CREATED_NEW_KEY || set_result != ERROR_SUCCESS)
+        {
+            return false;
+        }
+
+        // Written values are visible to queries and enumerations
+        const auto value = read_registry_string(HKEY_LOCAL_MACHINE, R"(SOFTWARE\SogenTest)", "Name");
+        if (!value || *value != "Value")
+        {
+            return false;
+        }
+
+        const auto values = get_all_registry_values(HKEY_LOCAL_MACHINE, R"(SOFTWARE\SogenTest)");
+        if (!values || values->size() != 1 || values->front() != "Name")
+        {
+            return false;
+        }
+
+        const auto keys = get_all_registry_keys(HKEY_LOCAL_MACHINE, "SOFTWARE");
+        if (!keys)
+        {
+            return false;
+        }
+
+        bool found_key = false;
+        for (const auto& key_name : *keys)
+        {
+            if (key_name == "SogenTest")
+            {
+                found_key = true;
+                break;
+            }
+        }
+        if (!found_key)
+        {
+            return false;
+        }
+
+        if (RegDeleteKeyValueA(HKEY_LOCAL_MACHINE, R"(SOFTWARE\SogenTest)", "Name") != ERROR_SUCCESS ||
+            read_registry_string(HKEY_LOCAL_MACHINE, R"(SOFTWARE\SogenTest)", "Name"))
+        {
+            return false;
+        }
+
+        if (RegDeleteKeyA(HKEY_LOCAL_MACHINE, R"(SOFTWARE\SogenTest)") != ERROR_SUCCESS)
+        {
+            return false;
+        }
+
+        if (RegOpenKeyExA(HKEY_LOCAL_MACHINE, R"(SOFTWARE\SogenTest)", 0, KEY_READ, &key) == ERROR_SUCCESS)
+        {
+            RegCloseKey(key);
+            return false;
+        }
+
+        return true;
+    }
+
     bool test_system_info()
     {
         char sys_dir[MAX_PATH];
@@ -693,6 +767,15 @@ namespace
         printf("Time: %lld\n", std::chrono::duration_cast<std::chrono::nanoseconds>(epoch_time).count());
     }
 
+    void echo_input()
+    {
+        char line[0x100];
+        while (fgets(line, sizeof(line), stdin))
+        {
+            printf("Echo: %s", line);
+        }
+    }
+
     bool test_apis()
     {
         wchar_t buffer[0x100];
@@ -700,6 +783,92 @@ namespace
         return GetComputerNameExW(ComputerNameNetBIOS, buffer, &size);
     }
 
+    bool test_memory_sweep()
+    {
+        auto* allocation = static_cast<uint8_t*>(VirtualAlloc(nullptr, 0x10000, MEM_RESERVE, PAGE_READWRITE));
+        if (!allocation || !VirtualAlloc(allocation + 0x2000, 0x1000, MEM_COMMIT, PAGE_READWRITE))
+        {
+            return false;
+        }
+
+        int found_regions = 0;
+        auto* address = static_cast<uint8_t*>(nullptr);
+        MEMORY_BASIC_INFORMATION info{};
+
+        while (VirtualQuery(address, &info, sizeof(info)) == sizeof(info))
+        {
+            const auto* base = static_cast<uint8_t*>(info.BaseAddress);
+            if (info.AllocationBase == allocation)
+            {
+                const auto expected_state = base == allocation + 0x2000 ? MEM_COMMIT : MEM_RESERVE;
+                found_regions += info.State == expected_state ? 1 : 100;
+            }
+
+            address = static_cast<uint8_t*>(info.BaseAddress) + info.RegionSize;
+        }
+
+        VirtualFree(allocation, 0, MEM_RELEASE);
+
+        // Reserved head, committed page and reserved tail
+        return found_regions == 3;
+    }
+
+    uint64_t read_xcr0()
+    {
+#ifdef __MINGW64__
+        uint32_t eax{};
+        uint32_t edx{};
+        __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        return (static_cast<uint64_t>(edx) << 32) | eax;
+#else
+        return _xgetbv(0);
+#endif
+    }
+
+    bool test_cpu_features()
+    {
+        constexpr DWORD pf_sse4_2 = 38;
+        constexpr DWORD pf_avx = 39;
+        constexpr DWORD pf_avx2 = 40;
+        constexpr DWORD pf_erms = 42;
+
+        int info[4]{};
+        __cpuid(info, 0);
+        const auto max_leaf = info[0];
+
+        __cpuid(info, 1);
+        const auto ecx = static_cast<uint32_t>(info[2]);
+        const auto edx = static_cast<uint32_t>(info[3]);
+
+        uint32_t ebx7 = 0;
+        if (max_leaf >= 7)
+        {
+            __cpuidex(info, 7, 0);
+            ebx7 = static_cast<uint32_t>(info[1]);
+        }
+
+        const auto has = [](const uint32_t value, const int bit) {
+            return ((value >> bit) & 1) != 0; //
+        };
+        const auto os_avx = has(ecx, 27) && has(ecx, 28) && (read_xcr0() & 6) == 6;
+
+        // Runtime dispatchers consult either source, so they have to agree
+        return !!IsProcessorFeaturePresent(PF_XMMI64_INSTRUCTIONS_AVAILABLE) == has(edx, 26) &&
+               !!IsProcessorFeaturePresent(PF_SSE3_INSTRUCTIONS_AVAILABLE) == has(ecx, 0) &&
+               !!IsProcessorFeaturePresent(PF_COMPARE_EXCHANGE128) == has(ecx, 13) &&
+               !!IsProcessorFeaturePresent(pf_sse4_2) == has(ecx, 20) &&
+               !!IsProcessorFeaturePresent(pf_avx) == os_avx &&
+               !!IsProcessorFeaturePresent(pf_avx2) == (os_avx && has(ebx7, 5)) &&
+               !!IsProcessorFeaturePresent(pf_erms) == has(ebx7, 9);
+    }
+
+    bool test_debug_output()
+    {
+        // Checked by the emulator tests through the debug output callback
+        OutputDebugStringA("Sogen debug output\n");
+        return true;
+    }
+
     bool test_apc()
     {
         int executions = 0;
@@ -721,6 +890,159 @@ namespace
         SleepEx(1, TRUE);
         return executions == 2;
     }
+
+    bool test_waitable_timer()
+    {
+        const auto timer = CreateWaitableTimerW(nullptr, FALSE, nullptr);
+        if (!timer)
+        {
+            return false;
+        }
+
+        int executions = 0;
+        auto* completion_routine = +[](void* param, DWORD, DWORD) {
+            *static_cast<int*>(param) += 1; //
+        };
+
+        LARGE_INTEGER due_time{};
+        due_time.QuadPart = -10 * 10000; // 10ms
+
+        auto success = SetWaitableTimer(timer, &due_time, 0, nullptr, nullptr, FALSE) &&
+                       WaitForSingleObject(timer, 0) == WAIT_TIMEOUT &&
+                       WaitForSingleObject(timer, 5000) == WAIT_OBJECT_0 &&
+                       WaitForSingleObject(timer, 0) == WAIT_TIMEOUT; // Auto-reset after the wait
+
+        success = success && SetWaitableTimer(timer, &due_time, 5, completion_routine, &executions, FALSE);
+
+        for (int i = 0; success && i < 100 && executions < 2; ++i)
+        {
+            SleepEx(100, TRUE);
+        }
+
+        success = success && executions >= 2 && CancelWaitableTimer(timer);
+
+        CloseHandle(timer);
+        return success;
+    }
+
+    bool test_thread_pool()
+    {
+        std::atomic_int executions{0};
+        auto* callback = +[](PTP_CALLBACK_INSTANCE, void* context, PTP_WORK) {
+            static_cast<std::atomic_int*>(context)->fetch_add(1); //
+        };
+
+        const auto work = CreateThreadpoolWork(callback, &executions, nullptr);
+        if (!work)
+        {
+            return false;
+        }
+
+        for (int i = 0; i < 10; ++i)
+        {
+            SubmitThreadpoolWork(work);
+        }
+
+        WaitForThreadpoolWorkCallbacks(work, FALSE);
+        CloseThreadpoolWork(work);
+
+        return executions == 10;
+    }
+
+    bool test_anonymous_pipe()
+    {
+        HANDLE read_pipe{};
+        HANDLE write_pipe{};
+        if (!CreatePipe(&read_pipe, &write_pipe, nullptr, 0))
+        {
+            puts("Failed to create pipe");
+            return false;
+        }
+
+        constexpr std::string_view send_data = "Hello Pipe";
+
+        DWORD written{};
+        if (!WriteFile(write_pipe, send_data.data(), static_cast<DWORD>(send_data.size()), &written, nullptr))
+        {
+            puts("Failed to write to pipe");
+            return false;
+        }
+
+        char buffer[100] = {};
+        DWORD read{};
+        if (!ReadFile(read_pipe, buffer, sizeof(buffer), &read, nullptr))
+        {
+            puts("Failed to read from pipe");
+            return false;
+        }
+
+        CloseHandle(write_pipe);
+
+        DWORD broken_read{};
+        const auto broken = !ReadFile(read_pipe, buffer, sizeof(buffer), &broken_read, nullptr) &&
+                            GetLastError() == ERROR_BROKEN_PIPE;
+
+        CloseHandle(read_pipe);
+
+        return broken && written == send_data.size() && std::string_view(buffer, read) == send_data;
+    }
+
+    bool test_named_pipe()
+    {
+        constexpr auto pipe_name = R"(\\.\pipe\sogen-test)";
+
+        const auto server = CreateNamedPipeA(pipe_name, PIPE_ACCESS_DUPLEX,
+                                             PIPE_TYPE_MESSAGE | PIPE_READMODE_MESSAGE | PIPE_WAIT, 1, 0x100, 0x100, 0,
+                                             nullptr);
+        if (server == INVALID_HANDLE_VALUE)
+        {
+            puts("Failed to create named pipe");
+            return false;
+        }
+
+        std::string reply{};
+
+        std::thread client_thread([&] {
+            const auto client =
+                CreateFileA(pipe_name, GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+            if (client == INVALID_HANDLE_VALUE)
+            {
+                return;
+            }
+
+            DWORD count{};
+            WriteFile(client, "ping", 4, &count, nullptr);
+
+            char buffer[16] = {};
+            if (ReadFile(client, buffer, sizeof(buffer), &count, nullptr))
+            {
+                reply.assign(buffer, count);
+            }
+
+            CloseHandle(client);
+        });
+
+        const auto connected = ConnectNamedPipe(server, nullptr) || GetLastError() == ERROR_PIPE_CONNECTED;
+
+        // Reading a message in parts reports the remainder through ERROR_MORE_DATA
+        char buffer[16] = {};
+        DWORD first_part{};
+        const auto more_data = !ReadFile(server, buffer, 2, &first_part, nullptr) && GetLastError() == ERROR_MORE_DATA;
+
+        DWORD second_part{};
+        ReadFile(server, buffer + first_part, sizeof(buffer) - first_part, &second_part, nullptr);
+
+        DWORD written{};
+        WriteFile(server, "pong", 4, &written, nullptr);
+
+        client_thread.join();
+
+        DisconnectNamedPipe(server);
+        CloseHandle(server);
+
+        return connected && more_data && std::string_view(buffer, first_part + second_part) == "ping" &&
+               reply == "pong";
+    }
 }
 
 #define RUN_TEST(func, name)                 \
@@ -739,6 +1061,12 @@ int main(const int argc, const char* argv[])
         return 0;
     }
 
+    if (argc == 2 && argv[1] == "-echo"sv)
+    {
+        echo_input();
+        return 0;
+    }
+
     bool valid = true;
 
     RUN_TEST(test_io, "I/O")
@@ -746,6 +1074,7 @@ int main(const int argc, const char* argv[])
     RUN_TEST(test_apis, "APIs")
     RUN_TEST(test_working_directory, "Working Directory")
     RUN_TEST(test_registry, "Registry")
+    RUN_TEST(test_registry_writes, "Registry Writes")
     RUN_TEST(test_system_info, "System Info")
     RUN_TEST(test_time_zone, "Time Zone")
     RUN_TEST(test_threads, "Threads")
@@ -761,6 +1090,13 @@ int main(const int argc, const char* argv[])
     RUN_TEST(test_tls, "TLS")
     RUN_TEST(test_socket, "Socket")
     RUN_TEST(test_apc, "APC")
+    RUN_TEST(test_memory_sweep, "Memory Sweep")
+    RUN_TEST(test_cpu_features, "CPU Features")
+    RUN_TEST(test_debug_output, "Debug Output")
+    RUN_TEST(test_waitable_timer, "Waitable Timer")
+    RUN_TEST(test_thread_pool, "Thread Pool")
+    RUN_TEST(test_anonymous_pipe, "Anonymous Pipe")
+    RUN_TEST(test_named_pipe, "Named Pipe")
 
     return valid ? 0 : 1;
 }
@@ -0,0 +1,375 @@
+"""ctypes bindings for the sogen C API (sogen.h).
+
+The shared library is looked up in SOGEN_LIBRARY, or next to this file.
+"""
+
+import ctypes
+import enum
+import os
+import sys
+
+API_VERSION = 1
+
+
+class Status(enum.IntEnum):
+    OK = 0
+    ERROR = 1
+    INVALID_ARGUMENT = 2
+    MEMORY_ACCESS_FAILED = 3
+
+
+class RunState(enum.IntEnum):
+    EXITED = 0
+    INSTRUCTION_BUDGET = 1
+    TIME_BUDGET = 2
+    STOPPED = 3
+
+
+class Register(enum.IntEnum):
+    RAX = 0
+    RBX = 1
+    RCX = 2
+    RDX = 3
+    RSI = 4
+    RDI = 5
+    RBP = 6
+    RSP = 7
+    R8 = 8
+    R9 = 9
+    R10 = 10
+    R11 = 11
+    R12 = 12
+    R13 = 13
+    R14 = 14
+    R15 = 15
+    RIP = 16
+    RFLAGS = 17
+    FS_BASE = 18
+    GS_BASE = 19
+
+
+class Permission(enum.IntFlag):
+    NONE = 0
+    READ = 1
+    WRITE = 2
+    EXEC = 4
+
+
+class MemoryEvent(enum.IntEnum):
+    ALLOCATE = 0
+    PROTECT = 1
+    VIOLATION = 2
+
+
+class Continuation(enum.IntEnum):
+    CONTINUE = 0
+    SKIP = 1
+
+
+class SogenError(RuntimeError):
+    def __init__(self, status, message):
+        super().__init__(f"{Status(status).name}: {message}")
+        self.status = Status(status)
+
+
+class _Settings(ctypes.Structure):
+    _fields_ = [
+        ("struct_size", ctypes.c_size_t),
+        ("emulation_root", ctypes.c_char_p),
+        ("registry_directory", ctypes.c_char_p),
+        ("application", ctypes.c_char_p),
+        ("working_directory", ctypes.c_char_p),
+        ("arguments", ctypes.POINTER(ctypes.c_char_p)),
+        ("argument_count", ctypes.c_size_t),
+        ("cpu_profile", ctypes.c_char_p),
+        ("disable_logging", ctypes.c_int),
+        ("use_relative_time", ctypes.c_int),
+        ("console_input", ctypes.c_char_p),
+        ("console_input_size", ctypes.c_size_t),
+    ]
+
+
+_SYSCALL_CALLBACK = ctypes.CFUNCTYPE(ctypes.c_int, ctypes.c_void_p, ctypes.c_uint32, ctypes.c_char_p)
+_ACCESS_CALLBACK = ctypes.CFUNCTYPE(None, ctypes.c_void_p, ctypes.c_char_p, ctypes.c_char_p)
+_MEMORY_CALLBACK = ctypes.CFUNCTYPE(None, ctypes.c_void_p, ctypes.c_int, ctypes.c_uint64, ctypes.c_uint64,
+                                    ctypes.c_uint32, ctypes.c_uint32)
+_OUTPUT_CALLBACK = ctypes.CFUNCTYPE(None, ctypes.c_void_p, ctypes.POINTER(ctypes.c_char), ctypes.c_size_t)
+
+
+def _default_library_path():
+    if sys.platform == "win32":
+        name = "sogen.dll"
+    elif sys.platform == "darwin":
+        name = "libsogen.dylib"
+    else:
+        name = "libsogen.so"
+
+    return os.path.join(os.path.dirname(os.path.abspath(__file__)), name)
+
+
+def _declare(lib, name, restype, *argtypes):
+    function = getattr(lib, name)
+    function.restype = restype
+    function.argtypes = list(argtypes)
+
+
+def _load_library(path=None):
+    lib = ctypes.CDLL(path or os.environ.get("SOGEN_LIBRARY") or _default_library_path())
+
+    p = ctypes.c_void_p
+    status = ctypes.c_int
+
+    _declare(lib, "sogen_get_api_version", ctypes.c_int)
+    _declare(lib, "sogen_settings_init", None, ctypes.POINTER(_Settings))
+    _declare(lib, "sogen_create", status, ctypes.POINTER(_Settings), ctypes.POINTER(p))
+    _declare(lib, "sogen_destroy", None, p)
+    _declare(lib, "sogen_get_last_error", ctypes.c_char_p, p)
+    _declare(lib, "sogen_run", status, p, ctypes.c_uint64, ctypes.c_uint32, ctypes.POINTER(ctypes.c_int))
+    _declare(lib, "sogen_stop", None, p)
+    _declare(lib, "sogen_get_executed_instructions", ctypes.c_uint64, p)
+    _declare(lib, "sogen_get_exit_status", ctypes.c_int, p, ctypes.POINTER(ctypes.c_uint32))
+    _declare(lib, "sogen_set_syscall_callback", None, p, _SYSCALL_CALLBACK, p)
+    _declare(lib, "sogen_set_access_callback", None, p, _ACCESS_CALLBACK, p)
+    _declare(lib, "sogen_set_memory_callback", None, p, _MEMORY_CALLBACK, p)
+    _declare(lib, "sogen_set_stdout_callback", None, p, _OUTPUT_CALLBACK, p)
+    _declare(lib, "sogen_push_console_input", status, p, ctypes.c_char_p, ctypes.c_size_t, ctypes.c_int)
+    _declare(lib, "sogen_add_memory_file", status, p, ctypes.c_char_p, ctypes.c_char_p, ctypes.c_size_t)
+    _declare(lib, "sogen_park", status, p)
+    _declare(lib, "sogen_read_memory", status, p, ctypes.c_uint64, p, ctypes.c_size_t)
+    _declare(lib, "sogen_write_memory", status, p, ctypes.c_uint64, p, ctypes.c_size_t)
+    _declare(lib, "sogen_allocate_memory", status, p, ctypes.c_size_t, ctypes.c_uint32,
+             ctypes.POINTER(ctypes.c_uint64))
+    _declare(lib, "sogen_read_register", status, p, ctypes.c_int, ctypes.POINTER(ctypes.c_uint64))
+    _declare(lib, "sogen_write_register", status, p, ctypes.c_int, ctypes.c_uint64)
+    _declare(lib, "sogen_save_snapshot", status, p, ctypes.POINTER(p))
+    _declare(lib, "sogen_restore_snapshot", status, p, p)
+    _declare(lib, "sogen_free_snapshot", None, p)
+    _declare(lib, "sogen_snapshot_get_data", p, p, ctypes.POINTER(ctypes.c_size_t))
+    _declare(lib, "sogen_snapshot_from_data", status, p, ctypes.c_size_t, ctypes.POINTER(p))
+
+    version = lib.sogen_get_api_version()
+    if version != API_VERSION:
+        raise RuntimeError(f"Unsupported sogen API version {version} (needed: {API_VERSION})")
+
+    return lib
+
+
+_lib = None
+
+
+def library(path=None):
+    global _lib
+    if _lib is None:
+        _lib = _load_library(path)
+    return _lib
+
+
+def _encode(value):
+    return value.encode("utf-8") if value is not None else None
+
+
+class Snapshot:
+    """Complete emulator state held in host memory."""
+
+    def __init__(self, handle):
+        self._handle = handle
+
+    @classmethod
+    def from_bytes(cls, data):
+        handle = ctypes.c_void_p()
+        status = library().sogen_snapshot_from_data(data, len(data), ctypes.byref(handle))
+        if status != Status.OK:
+            raise SogenError(status, "Failed to create snapshot")
+        return cls(handle)
+
+    def to_bytes(self):
+        size = ctypes.c_size_t()
+        data = library().sogen_snapshot_get_data(self._handle, ctypes.byref(size))
+        return ctypes.string_at(data, size.value) if size.value else b""
+
+    def close(self):
+        if self._handle:
+            library().sogen_free_snapshot(self._handle)
+            self._handle = None
+
+    def __del__(self):
+        self.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *_):
+        self.close()
+
+
+class Emulator:
+    def __init__(self, emulation_root=None, application=None, arguments=(), working_directory=None,
+                 registry_directory=None, cpu_profile=None, disable_logging=True, use_relative_time=False,
+                 stdin=None, files=None):
+        lib = library()
+
+        settings = _Settings()
+        lib.sogen_settings_init(ctypes.byref(settings))
+
+        # Keep the encoded strings alive until sogen_create returns
+        encoded_arguments = [_encode(a) for a in arguments]
+        argument_array = (ctypes.c_char_p * max(len(encoded_arguments), 1))(*encoded_arguments)
+
+        settings.emulation_root = _encode(emulation_root)
+        settings.registry_directory = _encode(registry_directory)
+        settings.application = _encode(application)
+        settings.working_directory = _encode(working_directory)
+        settings.arguments = argument_array
+        settings.argument_count = len(encoded_arguments)
+        settings.cpu_profile = _encode(cpu_profile)
+        settings.disable_logging = int(disable_logging)
+        settings.use_relative_time = int(use_relative_time)
+
+        if stdin is not None:
+            settings.console_input = stdin
+            settings.console_input_size = len(stdin)
+
+        self._handle = ctypes.c_void_p()
+        self._callbacks = {}
+
+        status = lib.sogen_create(ctypes.byref(settings), ctypes.byref(self._handle))
+        if status != Status.OK:
+            raise SogenError(status, lib.sogen_get_last_error(None).decode("utf-8", "replace"))
+
+        try:
+            for path, data in (files or {}).items():
+                self.add_file(path, data)
+        except SogenError:
+            self.close()
+            raise
+
+    def close(self):
+        if self._handle:
+            library().sogen_destroy(self._handle)
+            self._handle = None
+            self._callbacks.clear()
+
+    def __del__(self):
+        self.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *_):
+        self.close()
+
+    def _check(self, status):
+        if status != Status.OK:
+            raise SogenError(status, library().sogen_get_last_error(self._handle).decode("utf-8", "replace"))
+
+    def run(self, instruction_budget=0, time_budget_ms=0):
+        state = ctypes.c_int()
+        self._check(library().sogen_run(self._handle, instruction_budget, time_budget_ms, ctypes.byref(state)))
+        return RunState(state.value)
+
+    def stop(self):
+        library().sogen_stop(self._handle)
+
+    @property
+    def executed_instructions(self):
+        return library().sogen_get_executed_instructions(self._handle)
+
+    @property
+    def exit_status(self):
+        status = ctypes.c_uint32()
+        if not library().sogen_get_exit_status(self._handle, ctypes.byref(status)):
+            return None
+        return status.value
+
+    def push_stdin(self, data, close=False):
+        self._check(library().sogen_push_console_input(self._handle, data, len(data), int(close)))
+
+    def add_file(self, path, data):
+        """Serves data under a guest path without staging it in the emulation root."""
+        self._check(library().sogen_add_memory_file(self._handle, _encode(path), data, len(data)))
+
+    def park(self):
+        """Compresses guest memory while idle, the next run or memory access restores it."""
+        self._check(library().sogen_park(self._handle))
+
+    def read_memory(self, address, size):
+        buffer = ctypes.create_string_buffer(size)
+        self._check(library().sogen_read_memory(self._handle, address, buffer, size))
+        return buffer.raw
+
+    def write_memory(self, address, data):
+        self._check(library().sogen_write_memory(self._handle, address, data, len(data)))
+
+    def allocate_memory(self, size, permissions=Permission.READ | Permission.WRITE):
+        address = ctypes.c_uint64()
+        self._check(library().sogen_allocate_memory(self._handle, size, int(permissions), ctypes.byref(address)))
+        return address.value
+
+    def read_register(self, reg):
+        value = ctypes.c_uint64()
+        self._check(library().sogen_read_register(self._handle, int(reg), ctypes.byref(value)))
+        return value.value
+
+    def write_register(self, reg, value):
+        self._check(library().sogen_write_register(self._handle, int(reg), value))
+
+    def save_snapshot(self):
+        handle = ctypes.c_void_p()
+        self._check(library().sogen_save_snapshot(self._handle, ctypes.byref(handle)))
+        return Snapshot(handle)
+
+    def restore_snapshot(self, snapshot):
+        self._check(library().sogen_restore_snapshot(self._handle, snapshot._handle))
+
+    # Callbacks run on the emulation thread. Exceptions can't cross the C boundary,
+    # so they are printed and the emulation continues.
+
+    def on_syscall(self, function):
+        """function(syscall_id, name) -> Continuation or None"""
+        def wrapper(_, syscall_id, name):
+            try:
+                result = function(syscall_id, name.decode("utf-8", "replace"))
+                return int(result) if result is not None else Continuation.CONTINUE
+            except Exception:  # pylint: disable=broad-except
+                sys.excepthook(*sys.exc_info())
+                return Continuation.CONTINUE
+
+        self._set_callback("syscall", library().sogen_set_syscall_callback, _SYSCALL_CALLBACK, function, wrapper)
+
+    def on_access(self, function):
+        """function(type, name)"""
+        def wrapper(_, access_type, name):
+            self._invoke(function, access_type.decode("utf-8", "replace"), name.decode("utf-8", "replace"))
+
+        self._set_callback("access", library().sogen_set_access_callback, _ACCESS_CALLBACK, function, wrapper)
+
+    def on_memory(self, function):
+        """function(event, address, length, permissions, flags)"""
+        def wrapper(_, event, address, length, permissions, flags):
+            self._invoke(function, MemoryEvent(event), address, length, Permission(permissions), flags)
+
+        self._set_callback("memory", library().sogen_set_memory_callback, _MEMORY_CALLBACK, function, wrapper)
+
+    def on_stdout(self, function):
+        """function(data: bytes)"""
+        def wrapper(_, data, length):
+            self._invoke(function, ctypes.string_at(data, length))
+
+        self._set_callback("stdout", library().sogen_set_stdout_callback, _OUTPUT_CALLBACK, function, wrapper)
+
+    @staticmethod
+    def _invoke(function, *args):
+        try:
+            function(*args)
+        except Exception:  # pylint: disable=broad-except
+            sys.excepthook(*sys.exc_info())
+
+    def _set_callback(self, name, setter, prototype, function, wrapper):
+        # The ctypes thunk has to outlive its registration
+        thunk = prototype(wrapper) if function else prototype()
+        setter(self._handle, thunk, None)
+
+        if function:
+            self._callbacks[name] = thunk
+        else:
+            self._callbacks.pop(name, None)
@@ -0,0 +1,119 @@
+"""Tests for the Python bindings.
+
+Expects the same environment as the emulator tests: EMULATOR_ROOT pointing to an emulation root
+that contains test-sample.exe, and optionally SOGEN_LIBRARY pointing to the built library.
+CTest runs them as sogen-api-test with SOGEN_LIBRARY set.
+"""
+
+import os
+import unittest
+
+import sogen
+
+EMULATOR_ROOT = os.environ.get("EMULATOR_ROOT")
+APPLICATION = "C:\\test-sample.exe"
+
+
+@unittest.skipUnless(EMULATOR_ROOT, "EMULATOR_ROOT is not set")
+class EmulatorTest(unittest.TestCase):
+    def create_emulator(self):
+        return sogen.Emulator(emulation_root=EMULATOR_ROOT, application=APPLICATION, use_relative_time=True)
+
+    def test_runs_to_completion(self):
+        with self.create_emulator() as emu:
+            output = []
+            emu.on_stdout(output.append)
+
+            self.assertEqual(emu.run(), sogen.RunState.EXITED)
+            self.assertEqual(emu.exit_status, 0)
+            self.assertGreater(emu.executed_instructions, 0)
+
+    def test_scripted_stdin_is_read(self):
+        with sogen.Emulator(emulation_root=EMULATOR_ROOT, application=APPLICATION, arguments=["-echo"],
+                            use_relative_time=True, stdin=b"first\n") as emu:
+            output = []
+            emu.on_stdout(output.append)
+            emu.push_stdin(b"second\n", close=True)
+
+            self.assertEqual(emu.run(), sogen.RunState.EXITED)
+            self.assertEqual(b"".join(output), b"Echo: first\nEcho: second\n")
+
+    def test_application_runs_from_memory(self):
+        with open(os.path.join(EMULATOR_ROOT, "filesys", "c", "test-sample.exe"), "rb") as sample:
+            image = sample.read()
+
+        with sogen.Emulator(emulation_root=EMULATOR_ROOT, application="C:\\memory\\sample.exe",
+                            use_relative_time=True, files={"C:\\memory\\sample.exe": image}) as emu:
+            self.assertEqual(emu.run(), sogen.RunState.EXITED)
+            self.assertEqual(emu.exit_status, 0)
+
+    def test_instruction_budget_is_respected(self):
+        with self.create_emulator() as emu:
+            self.assertEqual(emu.run(instruction_budget=1000), sogen.RunState.INSTRUCTION_BUDGET)
+            self.assertIsNone(emu.exit_status)
+
+    def test_syscalls_are_reported(self):
+        with self.create_emulator() as emu:
+            syscalls = []
+            emu.on_syscall(lambda syscall_id, name: syscalls.append(name))
+
+            emu.run(instruction_budget=200000)
+            self.assertIn("NtAllocateVirtualMemory", syscalls)
+
+    def test_memory_and_registers(self):
+        with self.create_emulator() as emu:
+            emu.run(instruction_budget=1000)
+
+            address = emu.allocate_memory(0x1000)
+            emu.write_memory(address, b"sogen")
+            self.assertEqual(emu.read_memory(address, 5), b"sogen")
+
+            with self.assertRaises(sogen.SogenError) as context:
+                emu.read_memory(0, 4)
+            self.assertEqual(context.exception.status, sogen.Status.MEMORY_ACCESS_FAILED)
+
+            emu.write_register(sogen.Register.RAX, 0x1337)
+            self.assertEqual(emu.read_register(sogen.Register.RAX), 0x1337)
+
+    def test_parked_emulator_resumes(self):
+        with self.create_emulator() as emu:
+            emu.run(instruction_budget=1000)
+            emu.park()
+
+            self.assertEqual(emu.run(), sogen.RunState.EXITED)
+            self.assertEqual(emu.exit_status, 0)
+
+    def test_snapshot_restores_state(self):
+        with self.create_emulator() as emu:
+            emu.run(instruction_budget=1000)
+
+            with emu.save_snapshot() as snapshot:
+                rip = emu.read_register(sogen.Register.RIP)
+                instructions = emu.executed_instructions
+
+                self.assertEqual(emu.run(), sogen.RunState.EXITED)
+
+                emu.restore_snapshot(snapshot)
+                self.assertEqual(emu.read_register(sogen.Register.RIP), rip)
+                self.assertEqual(emu.executed_instructions, instructions)
+                self.assertIsNone(emu.exit_status)
+
+                self.assertEqual(emu.run(), sogen.RunState.EXITED)
+                self.assertEqual(emu.exit_status, 0)
+
+    def test_snapshot_transfers_between_emulators(self):
+        with self.create_emulator() as source, self.create_emulator() as target:
+            source.run(instruction_budget=1000)
+
+            with source.save_snapshot() as snapshot:
+                data = snapshot.to_bytes()
+
+            with sogen.Snapshot.from_bytes(data) as copy:
+                target.restore_snapshot(copy)
+
+            self.assertEqual(target.read_register(sogen.Register.RIP), source.read_register(sogen.Register.RIP))
+            self.assertEqual(target.run(), sogen.RunState.EXITED)
+
+
+if __name__ == "__main__":
+    unittest.main()
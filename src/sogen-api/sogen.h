@@ -0,0 +1,194 @@
+#pragma once
+
+// Stable C interface for embedding the emulator into other processes and languages.
+// All strings are UTF-8. Functions returning sogen_status never throw, the message of
+// the last failure is available through sogen_get_last_error.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+#ifdef SOGEN_API_IMPL
+#define SOGEN_API __declspec(dllexport)
+#else
+#define SOGEN_API __declspec(dllimport)
+#endif
+#else
+#define SOGEN_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// Bumped on incompatible changes. New functions and enum values may be added without a bump.
+#define SOGEN_API_VERSION 1
+
+    typedef struct sogen_emulator sogen_emulator;
+    typedef struct sogen_snapshot sogen_snapshot;
+
+    typedef enum sogen_status
+    {
+        SOGEN_OK = 0,
+        SOGEN_ERROR = 1,
+        SOGEN_INVALID_ARGUMENT = 2,
+        SOGEN_MEMORY_ACCESS_FAILED = 3,
+    } sogen_status;
+
+    typedef enum sogen_run_state
+    {
+        SOGEN_RUN_EXITED = 0,
+        SOGEN_RUN_INSTRUCTION_BUDGET = 1,
+        SOGEN_RUN_TIME_BUDGET = 2,
+        SOGEN_RUN_STOPPED = 3,
+    } sogen_run_state;
+
+    typedef enum sogen_register
+    {
+        SOGEN_REG_RAX = 0,
+        SOGEN_REG_RBX,
+        SOGEN_REG_RCX,
+        SOGEN_REG_RDX,
+        SOGEN_REG_RSI,
+        SOGEN_REG_RDI,
+        SOGEN_REG_RBP,
+        SOGEN_REG_RSP,
+        SOGEN_REG_R8,
+        SOGEN_REG_R9,
+        SOGEN_REG_R10,
+        SOGEN_REG_R11,
+        SOGEN_REG_R12,
+        SOGEN_REG_R13,
+        SOGEN_REG_R14,
+        SOGEN_REG_R15,
+        SOGEN_REG_RIP,
+        SOGEN_REG_RFLAGS,
+        SOGEN_REG_FS_BASE,
+        SOGEN_REG_GS_BASE,
+    } sogen_register;
+
+    // Same bit values as the emulator's memory permissions and operations
+    typedef enum sogen_memory_permission
+    {
+        SOGEN_MEMORY_NONE = 0,
+        SOGEN_MEMORY_READ = 1 << 0,
+        SOGEN_MEMORY_WRITE = 1 << 1,
+        SOGEN_MEMORY_EXEC = 1 << 2,
+    } sogen_memory_permission;
+
+    typedef enum sogen_memory_event
+    {
+        // flags: 1 if the memory was committed, 0 if it was only reserved
+        SOGEN_MEMORY_EVENT_ALLOCATE = 0,
+        // flags: unused
+        SOGEN_MEMORY_EVENT_PROTECT = 1,
+        // permissions: the attempted operation, flags: 1 if the memory was unmapped
+        SOGEN_MEMORY_EVENT_VIOLATION = 2,
+    } sogen_memory_event;
+
+    typedef enum sogen_continuation
+    {
+        SOGEN_CONTINUE = 0,
+        SOGEN_SKIP = 1,
+    } sogen_continuation;
+
+    typedef sogen_continuation (*sogen_syscall_callback)(void* user_data, uint32_t syscall_id,
+                                                         const char* syscall_name);
+    typedef void (*sogen_access_callback)(void* user_data, const char* type, const char* name);
+    typedef void (*sogen_memory_callback)(void* user_data, sogen_memory_event event, uint64_t address,
+                                          uint64_t length, uint32_t permissions, uint32_t flags);
+    typedef void (*sogen_output_callback)(void* user_data, const char* data, size_t length);
+
+    typedef struct sogen_settings
+    {
+        // Set by sogen_settings_init, allows appending fields without breaking older callers
+        size_t struct_size;
+
+        const char* emulation_root;
+        const char* registry_directory;
+
+        // Guest path of the executable. Without one, the process is only created when
+        // restoring a snapshot.
+        const char* application;
+        const char* working_directory;
+        const char* const* arguments;
+        size_t argument_count;
+
+        // NULL selects the default profile
+        const char* cpu_profile;
+
+        int disable_logging;
+        int use_relative_time;
+
+        // Scripted stdin, the guest never blocks on host stdin when set
+        const char* console_input;
+        size_t console_input_size;
+    } sogen_settings;
+
+    SOGEN_API int sogen_get_api_version(void);
+
+    SOGEN_API void sogen_settings_init(sogen_settings* settings);
+
+    // Creation failures are reported through sogen_get_last_error(NULL)
+    SOGEN_API sogen_status sogen_create(const sogen_settings* settings, sogen_emulator** emulator);
+    SOGEN_API void sogen_destroy(sogen_emulator* emulator);
+
+    // The returned string stays valid until the next failing call on the same emulator,
+    // or on the same thread for a NULL emulator.
+    SOGEN_API const char* sogen_get_last_error(const sogen_emulator* emulator);
+
+    // Runs until the process exits or a budget is used up. 0 disables the respective budget.
+    SOGEN_API sogen_status sogen_run(sogen_emulator* emulator, uint64_t instruction_budget, uint32_t time_budget_ms,
+                                     sogen_run_state* state);
+
+    // Can be called from callbacks or from other threads. From callbacks, execution stops right away,
+    // from other threads, it stops at the end of the current time slice.
+    SOGEN_API void sogen_stop(sogen_emulator* emulator);
+
+    SOGEN_API uint64_t sogen_get_executed_instructions(const sogen_emulator* emulator);
+    SOGEN_API int sogen_get_exit_status(const sogen_emulator* emulator, uint32_t* exit_status);
+
+    SOGEN_API void sogen_set_syscall_callback(sogen_emulator* emulator, sogen_syscall_callback callback,
+                                              void* user_data);
+    SOGEN_API void sogen_set_access_callback(sogen_emulator* emulator, sogen_access_callback callback,
+                                             void* user_data);
+    SOGEN_API void sogen_set_memory_callback(sogen_emulator* emulator, sogen_memory_callback callback,
+                                             void* user_data);
+    SOGEN_API void sogen_set_stdout_callback(sogen_emulator* emulator, sogen_output_callback callback,
+                                             void* user_data);
+
+    // Appends to the guest's stdin. Switches stdin to scripted input, closing it makes further reads return EOF.
+    SOGEN_API sogen_status sogen_push_console_input(sogen_emulator* emulator, const char* data, size_t size,
+                                                    int close_input);
+
+    // Serves a copy of the data under an absolute guest path, without touching the emulation root.
+    // Files the process needs at startup, like the application itself, must be added before the first run.
+    SOGEN_API sogen_status sogen_add_memory_file(sogen_emulator* emulator, const char* path, const void* data,
+                                                 size_t size);
+
+    // Compresses the guest memory of an idle emulator and releases it from the backend.
+    // Running the emulator or accessing its memory transparently unparks it.
+    SOGEN_API sogen_status sogen_park(sogen_emulator* emulator);
+
+    SOGEN_API sogen_status sogen_read_memory(sogen_emulator* emulator, uint64_t address, void* data, size_t size);
+    SOGEN_API sogen_status sogen_write_memory(sogen_emulator* emulator, uint64_t address, const void* data,
+                                              size_t size);
+    SOGEN_API sogen_status sogen_allocate_memory(sogen_emulator* emulator, size_t size, uint32_t permissions,
+                                                 uint64_t* address);
+
+    SOGEN_API sogen_status sogen_read_register(sogen_emulator* emulator, sogen_register reg, uint64_t* value);
+    SOGEN_API sogen_status sogen_write_register(sogen_emulator* emulator, sogen_register reg, uint64_t value);
+
+    // Snapshots capture the complete emulator state in host memory and can be restored
+    // any number of times, also into other emulators created with the same settings.
+    SOGEN_API sogen_status sogen_save_snapshot(sogen_emulator* emulator, sogen_snapshot** snapshot);
+    SOGEN_API sogen_status sogen_restore_snapshot(sogen_emulator* emulator, const sogen_snapshot* snapshot);
+    SOGEN_API void sogen_free_snapshot(sogen_snapshot* snapshot);
+
+    SOGEN_API const void* sogen_snapshot_get_data(const sogen_snapshot* snapshot, size_t* size);
+    SOGEN_API sogen_status sogen_snapshot_from_data(const void* data, size_t size, sogen_snapshot** snapshot);
+
+#ifdef __cplusplus
+}
+#endif
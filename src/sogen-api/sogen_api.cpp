@@ -0,0 +1,639 @@
+#include "std_include.hpp"
+
+#define SOGEN_API_IMPL
+#include "sogen.h"
+
+#include <windows_emulator.hpp>
+#include <backend_selection.hpp>
+
+struct sogen_snapshot
+{
+    std::vector<std::byte> data{};
+};
+
+struct sogen_emulator
+{
+    std::unique_ptr<windows_emulator> win_emu{};
+    std::string last_error{};
+    std::atomic_bool timed_out{false};
+    std::atomic<std::thread::id> running_thread{};
+};
+
+namespace
+{
+    thread_local std::string last_creation_error{};
+
+    // Indexed by sogen_register
+    constexpr x86_register REGISTER_MAPPING[] = {
+        x86_register::rax, x86_register::rbx, x86_register::rcx,    x86_register::rdx,     x86_register::rsi,
+        x86_register::rdi, x86_register::rbp, x86_register::rsp,    x86_register::r8,      x86_register::r9,
+        x86_register::r10, x86_register::r11, x86_register::r12,    x86_register::r13,     x86_register::r14,
+        x86_register::r15, x86_register::rip, x86_register::rflags, x86_register::fs_base, x86_register::gs_base,
+    };
+
+    template <typename Function>
+    sogen_status guarded_call(sogen_emulator* emulator, Function&& function)
+    {
+        if (!emulator || !emulator->win_emu)
+        {
+            return SOGEN_INVALID_ARGUMENT;
+        }
+
+        try
+        {
+            return function(*emulator->win_emu);
+        }
+        catch (const std::exception& e)
+        {
+            emulator->last_error = e.what();
+        }
+        catch (...)
+        {
+            emulator->last_error = "Unknown error";
+        }
+
+        return SOGEN_ERROR;
+    }
+
+    std::string to_string_or_empty(const char* value)
+    {
+        return value ? std::string(value) : std::string{};
+    }
+
+    emulator_settings create_emulator_settings(const sogen_settings& settings)
+    {
+        emulator_settings emu_settings{
+            .disable_logging = settings.disable_logging != 0,
+            .use_relative_time = settings.use_relative_time != 0,
+            .emulation_root = to_string_or_empty(settings.emulation_root),
+        };
+
+        if (settings.registry_directory)
+        {
+            emu_settings.registry_directory = settings.registry_directory;
+        }
+
+        if (settings.cpu_profile)
+        {
+            emu_settings.cpu_profile = settings.cpu_profile;
+        }
+
+        if (settings.console_input)
+        {
+            emu_settings.console_input = std::string(settings.console_input, settings.console_input_size);
+        }
+
+        return emu_settings;
+    }
+
+    std::optional<application_settings> create_application_settings(const sogen_settings& settings)
+    {
+        if (!settings.application)
+        {
+            return std::nullopt;
+        }
+
+        application_settings app_settings{
+            .application = std::string_view(settings.application),
+        };
+
+        if (settings.working_directory)
+        {
+            app_settings.working_directory = std::string_view(settings.working_directory);
+        }
+
+        for (size_t i = 0; i < settings.argument_count; ++i)
+        {
+            app_settings.arguments.emplace_back(u8_to_u16(settings.arguments[i] ? settings.arguments[i] : ""));
+        }
+
+        return app_settings;
+    }
+
+    std::unique_ptr<windows_emulator> create_windows_emulator(const sogen_settings& settings)
+    {
+        const auto emu_settings = create_emulator_settings(settings);
+        auto app_settings = create_application_settings(settings);
+
+        if (!app_settings)
+        {
+            return std::make_unique<windows_emulator>(create_x86_64_emulator(), emu_settings);
+        }
+
+        return std::make_unique<windows_emulator>(create_x86_64_emulator(), std::move(*app_settings), emu_settings);
+    }
+
+    // Stops the emulator once the time budget is used up, unless the run ends before.
+    // Backends may only be stopped from the emulating thread, so the stop is only requested
+    // and takes effect at the end of the current time slice.
+    class run_watchdog
+    {
+      public:
+        run_watchdog(sogen_emulator& emulator, const uint32_t time_budget_ms)
+        {
+            if (time_budget_ms == 0)
+            {
+                return;
+            }
+
+            this->thread_ = std::thread([this, &emulator, time_budget_ms] {
+                // Exceptions must not escape the thread, that would terminate the host process
+                try
+                {
+                    std::unique_lock lock{this->mutex_};
+                    const auto finished = this->condition_.wait_for(lock, std::chrono::milliseconds(time_budget_ms),
+                                                                    [this] { return this->finished_; });
+
+                    if (finished)
+                    {
+                        return;
+                    }
+                }
+                catch (...)
+                {
+                }
+
+                emulator.timed_out = true;
+                emulator.win_emu->request_stop();
+            });
+        }
+
+        ~run_watchdog()
+        {
+            if (!this->thread_.joinable())
+            {
+                return;
+            }
+
+            {
+                std::scoped_lock lock{this->mutex_};
+                this->finished_ = true;
+            }
+
+            this->condition_.notify_all();
+            this->thread_.join();
+        }
+
+        run_watchdog(run_watchdog&&) = delete;
+        run_watchdog(const run_watchdog&) = delete;
+        run_watchdog& operator=(run_watchdog&&) = delete;
+        run_watchdog& operator=(const run_watchdog&) = delete;
+
+      private:
+        std::mutex mutex_{};
+        std::condition_variable condition_{};
+        bool finished_{false};
+        std::thread thread_{};
+    };
+}
+
+extern "C"
+{
+    SOGEN_API int sogen_get_api_version(void)
+    {
+        return SOGEN_API_VERSION;
+    }
+
+    SOGEN_API void sogen_settings_init(sogen_settings* settings)
+    {
+        if (settings)
+        {
+            *settings = {};
+            settings->struct_size = sizeof(*settings);
+        }
+    }
+
+    SOGEN_API sogen_status sogen_create(const sogen_settings* settings, sogen_emulator** emulator)
+    {
+        // Settings of older callers end before the fields added since then
+        constexpr auto minimum_size = offsetof(sogen_settings, console_input);
+
+        if (!settings || !emulator || settings->struct_size < minimum_size)
+        {
+            last_creation_error = "Invalid settings";
+            return SOGEN_INVALID_ARGUMENT;
+        }
+
+        *emulator = nullptr;
+
+        sogen_settings full_settings{};
+        memcpy(&full_settings, settings, std::min(settings->struct_size, sizeof(full_settings)));
+
+        try
+        {
+            auto instance = std::make_unique<sogen_emulator>();
+            instance->win_emu = create_windows_emulator(full_settings);
+
+            *emulator = instance.release();
+            return SOGEN_OK;
+        }
+        catch (const std::exception& e)
+        {
+            last_creation_error = e.what();
+        }
+        catch (...)
+        {
+            last_creation_error = "Unknown error";
+        }
+
+        return SOGEN_ERROR;
+    }
+
+    SOGEN_API void sogen_destroy(sogen_emulator* emulator)
+    {
+        delete emulator;
+    }
+
+    SOGEN_API const char* sogen_get_last_error(const sogen_emulator* emulator)
+    {
+        return emulator ? emulator->last_error.c_str() : last_creation_error.c_str();
+    }
+
+    SOGEN_API sogen_status sogen_run(sogen_emulator* emulator, const uint64_t instruction_budget,
+                                     const uint32_t time_budget_ms, sogen_run_state* state)
+    {
+        return guarded_call(emulator, [&](windows_emulator& win_emu) {
+            const auto start_instructions = win_emu.get_executed_instructions();
+            emulator->timed_out = false;
+
+            {
+                emulator->running_thread = std::this_thread::get_id();
+                const auto _ = utils::finally([&] {
+                    emulator->running_thread = std::thread::id{}; //
+                });
+
+                const run_watchdog watchdog{*emulator, time_budget_ms};
+                win_emu.start(static_cast<size_t>(instruction_budget));
+            }
+
+            if (state)
+            {
+                const auto executed = win_emu.get_executed_instructions() - start_instructions;
+
+                if (win_emu.process.exit_status.has_value())
+                {
+                    *state = SOGEN_RUN_EXITED;
+                }
+                else if (emulator->timed_out)
+                {
+                    *state = SOGEN_RUN_TIME_BUDGET;
+                }
+                else if (instruction_budget > 0 && executed >= instruction_budget)
+                {
+                    *state = SOGEN_RUN_INSTRUCTION_BUDGET;
+                }
+                else
+                {
+                    *state = SOGEN_RUN_STOPPED;
+                }
+            }
+
+            return SOGEN_OK;
+        });
+    }
+
+    SOGEN_API void sogen_stop(sogen_emulator* emulator)
+    {
+        if (!emulator || !emulator->win_emu)
+        {
+            return;
+        }
+
+        // Only the thread running the emulator may touch the backend,
+        // other threads request the stop, which takes effect at the end of the current time slice
+        if (emulator->running_thread != std::this_thread::get_id())
+        {
+            emulator->win_emu->request_stop();
+            return;
+        }
+
+        try
+        {
+            emulator->win_emu->stop();
+        }
+        catch (...)
+        {
+            emulator->win_emu->request_stop();
+        }
+    }
+
+    SOGEN_API uint64_t sogen_get_executed_instructions(const sogen_emulator* emulator)
+    {
+        return emulator && emulator->win_emu ? emulator->win_emu->get_executed_instructions() : 0;
+    }
+
+    SOGEN_API int sogen_get_exit_status(const sogen_emulator* emulator, uint32_t* exit_status)
+    {
+        if (!emulator || !emulator->win_emu || !emulator->win_emu->process.exit_status.has_value())
+        {
+            return 0;
+        }
+
+        if (exit_status)
+        {
+            *exit_status = static_cast<uint32_t>(*emulator->win_emu->process.exit_status);
+        }
+
+        return 1;
+    }
+
+    SOGEN_API void sogen_set_syscall_callback(sogen_emulator* emulator, const sogen_syscall_callback callback,
+                                              void* user_data)
+    {
+        if (!emulator || !emulator->win_emu)
+        {
+            return;
+        }
+
+        auto& target = emulator->win_emu->callbacks.on_syscall;
+        if (!callback)
+        {
+            target = {};
+            return;
+        }
+
+        target = [callback, user_data](const uint32_t syscall_id, const std::string_view syscall_name) {
+            const std::string name(syscall_name);
+            return callback(user_data, syscall_id, name.c_str()) == SOGEN_SKIP
+                       ? instruction_hook_continuation::skip_instruction
+                       : instruction_hook_continuation::run_instruction;
+        };
+    }
+
+    SOGEN_API void sogen_set_access_callback(sogen_emulator* emulator, const sogen_access_callback callback,
+                                             void* user_data)
+    {
+        if (!emulator || !emulator->win_emu)
+        {
+            return;
+        }
+
+        auto& target = emulator->win_emu->callbacks.on_generic_access;
+        if (!callback)
+        {
+            target = {};
+            return;
+        }
+
+        target = [callback, user_data](const std::string_view type, const std::u16string_view name) {
+            const std::string type_string(type);
+            const auto name_string = u16_to_u8(name);
+            callback(user_data, type_string.c_str(), name_string.c_str());
+        };
+    }
+
+    SOGEN_API void sogen_set_memory_callback(sogen_emulator* emulator, const sogen_memory_callback callback,
+                                             void* user_data)
+    {
+        if (!emulator || !emulator->win_emu)
+        {
+            return;
+        }
+
+        auto& callbacks = emulator->win_emu->callbacks;
+        if (!callback)
+        {
+            callbacks.on_memory_allocate = {};
+            callbacks.on_memory_protect = {};
+            callbacks.on_memory_violate = {};
+            return;
+        }
+
+        callbacks.on_memory_allocate = [callback, user_data](const uint64_t address, const uint64_t length,
+                                                             const memory_permission permission, const bool commit) {
+            callback(user_data, SOGEN_MEMORY_EVENT_ALLOCATE, address, length, static_cast<uint32_t>(permission),
+                     commit ? 1 : 0);
+        };
+
+        callbacks.on_memory_protect = [callback, user_data](const uint64_t address, const uint64_t length,
+                                                            const memory_permission permission) {
+            callback(user_data, SOGEN_MEMORY_EVENT_PROTECT, address, length, static_cast<uint32_t>(permission), 0);
+        };
+
+        callbacks.on_memory_violate = [callback, user_data](const uint64_t address, const uint64_t length,
+                                                            const memory_operation operation,
+                                                            const memory_violation_type type) {
+            callback(user_data, SOGEN_MEMORY_EVENT_VIOLATION, address, length, static_cast<uint32_t>(operation),
+                     type == memory_violation_type::unmapped ? 1 : 0);
+        };
+    }
+
+    SOGEN_API void sogen_set_stdout_callback(sogen_emulator* emulator, const sogen_output_callback callback,
+                                             void* user_data)
+    {
+        if (!emulator || !emulator->win_emu)
+        {
+            return;
+        }
+
+        auto& target = emulator->win_emu->callbacks.on_stdout;
+        if (!callback)
+        {
+            target = {};
+            return;
+        }
+
+        target = [callback, user_data](const std::string_view data) {
+            callback(user_data, data.data(), data.size()); //
+        };
+    }
+
+    SOGEN_API sogen_status sogen_push_console_input(sogen_emulator* emulator, const char* data, const size_t size,
+                                                    const int close_input)
+    {
+        return guarded_call(emulator, [&](windows_emulator& win_emu) {
+            if (!data && size > 0)
+            {
+                return SOGEN_INVALID_ARGUMENT;
+            }
+
+            win_emu.console.push_input(std::string_view(data ? data : "", size));
+
+            if (close_input)
+            {
+                win_emu.console.close_input();
+            }
+
+            return SOGEN_OK;
+        });
+    }
+
+    SOGEN_API sogen_status sogen_add_memory_file(sogen_emulator* emulator, const char* path, const void* data,
+                                                 const size_t size)
+    {
+        return guarded_call(emulator, [&](windows_emulator& win_emu) {
+            if (!path || (!data && size > 0))
+            {
+                return SOGEN_INVALID_ARGUMENT;
+            }
+
+            const windows_path guest_path = std::string_view(path);
+            if (!guest_path.is_absolute())
+            {
+                return SOGEN_INVALID_ARGUMENT;
+            }
+
+            const auto* bytes = static_cast<const std::byte*>(data);
+            win_emu.file_sys.add_memory_file(guest_path, std::vector<std::byte>(bytes, bytes + size));
+
+            return SOGEN_OK;
+        });
+    }
+
+    SOGEN_API sogen_status sogen_park(sogen_emulator* emulator)
+    {
+        return guarded_call(emulator, [&](windows_emulator& win_emu) {
+            win_emu.park();
+            return SOGEN_OK;
+        });
+    }
+
+    SOGEN_API sogen_status sogen_read_memory(sogen_emulator* emulator, const uint64_t address, void* data,
+                                             const size_t size)
+    {
+        return guarded_call(emulator, [&](windows_emulator& win_emu) {
+            if (!data && size > 0)
+            {
+                return SOGEN_INVALID_ARGUMENT;
+            }
+
+            win_emu.unpark();
+            return win_emu.emu().try_read_memory(address, data, size) ? SOGEN_OK : SOGEN_MEMORY_ACCESS_FAILED;
+        });
+    }
+
+    SOGEN_API sogen_status sogen_write_memory(sogen_emulator* emulator, const uint64_t address, const void* data,
+                                              const size_t size)
+    {
+        return guarded_call(emulator, [&](windows_emulator& win_emu) {
+            if (!data && size > 0)
+            {
+                return SOGEN_INVALID_ARGUMENT;
+            }
+
+            win_emu.unpark();
+
+            try
+            {
+                win_emu.emu().write_memory(address, data, size);
+                return SOGEN_OK;
+            }
+            catch (const std::exception& e)
+            {
+                emulator->last_error = e.what();
+                return SOGEN_MEMORY_ACCESS_FAILED;
+            }
+        });
+    }
+
+    SOGEN_API sogen_status sogen_allocate_memory(sogen_emulator* emulator, const size_t size,
+                                                 const uint32_t permissions, uint64_t* address)
+    {
+        return guarded_call(emulator, [&](windows_emulator& win_emu) {
+            if (!address || size == 0 || (permissions & ~static_cast<uint32_t>(memory_permission::all)) != 0)
+            {
+                return SOGEN_INVALID_ARGUMENT;
+            }
+
+            win_emu.unpark();
+
+            const auto base = win_emu.memory.allocate_memory(size, static_cast<memory_permission>(permissions));
+            if (!base)
+            {
+                return SOGEN_MEMORY_ACCESS_FAILED;
+            }
+
+            *address = base;
+            return SOGEN_OK;
+        });
+    }
+
+    SOGEN_API sogen_status sogen_read_register(sogen_emulator* emulator, const sogen_register reg, uint64_t* value)
+    {
+        return guarded_call(emulator, [&](windows_emulator& win_emu) {
+            if (!value || static_cast<size_t>(reg) >= std::size(REGISTER_MAPPING))
+            {
+                return SOGEN_INVALID_ARGUMENT;
+            }
+
+            *value = win_emu.emu().reg<uint64_t>(REGISTER_MAPPING[reg]);
+            return SOGEN_OK;
+        });
+    }
+
+    SOGEN_API sogen_status sogen_write_register(sogen_emulator* emulator, const sogen_register reg,
+                                               const uint64_t value)
+    {
+        return guarded_call(emulator, [&](windows_emulator& win_emu) {
+            if (static_cast<size_t>(reg) >= std::size(REGISTER_MAPPING))
+            {
+                return SOGEN_INVALID_ARGUMENT;
+            }
+
+            win_emu.emu().reg(REGISTER_MAPPING[reg], value);
+            return SOGEN_OK;
+        });
+    }
+
+    SOGEN_API sogen_status sogen_save_snapshot(sogen_emulator* emulator, sogen_snapshot** snapshot)
+    {
+        return guarded_call(emulator, [&](const windows_emulator& win_emu) {
+            if (!snapshot)
+            {
+                return SOGEN_INVALID_ARGUMENT;
+            }
+
+            utils::buffer_serializer serializer{};
+            win_emu.serialize(serializer);
+
+            *snapshot = new sogen_snapshot{.data = serializer.move_buffer()};
+            return SOGEN_OK;
+        });
+    }
+
+    SOGEN_API sogen_status sogen_restore_snapshot(sogen_emulator* emulator, const sogen_snapshot* snapshot)
+    {
+        return guarded_call(emulator, [&](windows_emulator& win_emu) {
+            if (!snapshot)
+            {
+                return SOGEN_INVALID_ARGUMENT;
+            }
+
+            utils::buffer_deserializer deserializer{snapshot->data};
+            win_emu.deserialize(deserializer);
+            return SOGEN_OK;
+        });
+    }
+
+    SOGEN_API void sogen_free_snapshot(sogen_snapshot* snapshot)
+    {
+        delete snapshot;
+    }
+
+    SOGEN_API const void* sogen_snapshot_get_data(const sogen_snapshot* snapshot, size_t* size)
+    {
+        if (!snapshot)
+        {
+            return nullptr;
+        }
+
+        if (size)
+        {
+            *size = snapshot->data.size();
+        }
+
+        return snapshot->data.data();
+    }
+
+    SOGEN_API sogen_status sogen_snapshot_from_data(const void* data, const size_t size, sogen_snapshot** snapshot)
+    {
+        if ((!data && size > 0) || !snapshot)
+        {
+            return SOGEN_INVALID_ARGUMENT;
+        }
+
+        const auto* bytes = static_cast<const std::byte*>(data);
+        *snapshot = new sogen_snapshot{.data = {bytes, bytes + size}};
+        return SOGEN_OK;
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include <list>
+#include <array>
+#include <deque>
+#include <queue>
+#include <thread>
+#include <ranges>
+#include <atomic>
+#include <vector>
+#include <mutex>
+#include <string>
+#include <chrono>
+#include <memory>
+#include <fstream>
+#include <functional>
+#include <filesystem>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_set>
+#include <condition_variable>
+
+#include <cassert>
+
+#include <platform/platform.hpp>
+
+// NOLINTNEXTLINE(google-global-names-in-headers)
+using namespace std::literals;
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include <console.hpp>
+
+namespace test
+{
+    namespace
+    {
+        struct flat_memory : memory_interface
+        {
+            std::vector<char> data = std::vector<char>(0x100);
+
+            void read_memory(const uint64_t address, void* buffer, const size_t size) const override
+            {
+                if (!this->try_read_memory(address, buffer, size))
+                {
+                    throw std::runtime_error("Invalid read");
+                }
+            }
+
+            bool try_read_memory(const uint64_t address, void* buffer, const size_t size) const override
+            {
+                if (address + size > this->data.size())
+                {
+                    return false;
+                }
+
+                memcpy(buffer, this->data.data() + address, size);
+                return true;
+            }
+
+            void write_memory(const uint64_t address, const void* buffer, const size_t size) override
+            {
+                if (address + size > this->data.size())
+                {
+                    throw std::runtime_error("Invalid write");
+                }
+
+                memcpy(this->data.data() + address, buffer, size);
+            }
+
+            std::string read_input(console_device& console, const size_t length = 0x100)
+            {
+                const auto count = console.read(*this, 0, length);
+                return {this->data.data(), count};
+            }
+
+          private:
+            void map_mmio(uint64_t, size_t, mmio_read_callback, mmio_write_callback) override
+            {
+            }
+
+            void map_memory(uint64_t, size_t, memory_permission) override
+            {
+            }
+
+            void unmap_memory(uint64_t, size_t) override
+            {
+            }
+
+            void apply_memory_protection(uint64_t, size_t, memory_permission) override
+            {
+            }
+        };
+    }
+
+    TEST(ConsoleTest, LineModeReturnsOneLinePerRead)
+    {
+        flat_memory memory{};
+        console_device console{console_mode::line};
+
+        console.push_input("first\nsecond\nrest");
+        console.close_input();
+
+        ASSERT_EQ(memory.read_input(console), "first\n");
+        ASSERT_EQ(memory.read_input(console, 3), "sec");
+        ASSERT_EQ(memory.read_input(console), "ond\n");
+        ASSERT_EQ(memory.read_input(console), "rest");
+        ASSERT_EQ(memory.read_input(console), "");
+    }
+
+    TEST(ConsoleTest, RawModeReturnsAllBufferedInput)
+    {
+        flat_memory memory{};
+        console_device console{console_mode::raw};
+
+        console.push_input("first\nsecond\n");
+        console.close_input();
+
+        ASSERT_EQ(memory.read_input(console), "first\nsecond\n");
+        ASSERT_EQ(console.get_buffered_input(), 0);
+    }
+
+    TEST(ConsoleTest, CookedModeEditsLines)
+    {
+        flat_memory memory{};
+        console_device console{console_mode::cooked};
+
+        console.push_input("tesk\bt\nnext\r\n");
+        console.close_input();
+
+        ASSERT_EQ(memory.read_input(console), "test\r\n");
+        ASSERT_EQ(memory.read_input(console), "next\r\n");
+    }
+
+    TEST(ConsoleTest, OutputIsPassedOnPerLine)
+    {
+        flat_memory memory{};
+        std::vector<std::string> output{};
+
+        console_device console{};
+        console.set_sink([&](const std::string_view data) {
+            output.emplace_back(data); //
+        });
+
+        const std::string_view text = "a\nb\nc";
+        memcpy(memory.data.data(), text.data(), text.size());
+
+        ASSERT_TRUE(console.write(memory, 0, text.size()));
+        ASSERT_EQ(output, std::vector<std::string>{"a\nb\n"});
+
+        ASSERT_FALSE(console.write(memory, memory.data.size(), 1));
+
+        console.flush();
+        ASSERT_EQ(output, (std::vector<std::string>{"a\nb\n", "c"}));
+    }
+}
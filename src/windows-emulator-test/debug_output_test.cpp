@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include <debug_output.hpp>
+
+namespace test
+{
+    namespace
+    {
+        struct manual_clock : utils::clock
+        {
+            steady_time_point now{};
+
+            steady_time_point steady_now() override
+            {
+                return this->now;
+            }
+        };
+
+        debug_output_message make_message(std::string text)
+        {
+            return {
+                .source = debug_output_source::output_debug_string,
+                .thread_id = 1,
+                .text = std::move(text),
+            };
+        }
+    }
+
+    TEST(DebugOutputTest, RepeatedMessagesAreFolded)
+    {
+        manual_clock clock{};
+        std::vector<debug_output_message> messages{};
+
+        debug_output_stream stream{clock, 0};
+        stream.set_sink([&](const debug_output_message& message) {
+            messages.push_back(message); //
+        });
+
+        stream.push(make_message("hello\r\n"));
+        stream.push(make_message("hello\r\n"));
+        stream.push(make_message("hello\r\n"));
+        stream.push(make_message("world"));
+        stream.push(make_message("world"));
+        stream.flush();
+
+        ASSERT_EQ(messages.size(), 4);
+        EXPECT_EQ(messages[0].text, "hello");
+        EXPECT_EQ(messages[0].repeat_count, 0);
+        EXPECT_EQ(messages[1].text, "hello");
+        EXPECT_EQ(messages[1].repeat_count, 2);
+        EXPECT_EQ(messages[2].text, "world");
+        EXPECT_EQ(messages[3].repeat_count, 1);
+        EXPECT_EQ(stream.get_total_messages(), 5);
+    }
+
+    TEST(DebugOutputTest, RateLimitDropsExcessMessages)
+    {
+        manual_clock clock{};
+        std::vector<debug_output_message> messages{};
+
+        debug_output_stream stream{clock, 2};
+        stream.set_sink([&](const debug_output_message& message) {
+            messages.push_back(message); //
+        });
+
+        for (int i = 0; i < 5; ++i)
+        {
+            stream.push(make_message("message " + std::to_string(i)));
+        }
+
+        clock.now += std::chrono::seconds(1);
+        stream.push(make_message("next window"));
+
+        ASSERT_EQ(messages.size(), 3);
+        EXPECT_EQ(messages[1].text, "message 1");
+        EXPECT_EQ(messages[2].text, "next window");
+        EXPECT_EQ(messages[2].suppressed_count, 3);
+        EXPECT_EQ(stream.get_suppressed_messages(), 3);
+    }
+}
@@ -10,6 +10,120 @@ namespace test
         ASSERT_TERMINATED_SUCCESSFULLY(emu);
     }
 
+    TEST(EmulationTest, FileOverlayKeepsWritesInMemory)
+    {
+        auto emu = create_sample_emulator(emulator_settings{
+            .use_relative_time = true,
+            .use_file_overlay = true,
+        });
+
+        emu.start();
+
+        ASSERT_TERMINATED_SUCCESSFULLY(emu);
+
+        const auto* overlay = emu.file_sys.overlay();
+        ASSERT_NE(overlay, nullptr);
+        ASSERT_FALSE(overlay->empty());
+    }
+
+    TEST(EmulationTest, DebugOutputIsCaptured)
+    {
+        std::vector<std::string> messages{};
+
+        emulator_callbacks callbacks{};
+        callbacks.on_debug_output = [&messages](const debug_output_message& message) {
+            messages.push_back(message.text); //
+        };
+
+        auto emu = create_sample_emulator(emulator_settings{.use_relative_time = true}, {}, std::move(callbacks));
+        emu.start();
+
+        ASSERT_TERMINATED_SUCCESSFULLY(emu);
+        ASSERT_NE(std::ranges::find(messages, "Sogen debug output"), messages.end());
+    }
+
+    TEST(EmulationTest, ScriptedConsoleInputIsRead)
+    {
+        std::string output{};
+
+        emulator_callbacks callbacks{};
+        callbacks.on_stdout = [&output](const std::string_view data) {
+            output.append(data); //
+        };
+
+        auto emu = create_sample_emulator(
+            emulator_settings{
+                .use_relative_time = true,
+                .console_input = "first\nsecond\n",
+            },
+            {.echo_input = true}, std::move(callbacks));
+
+        emu.start();
+
+        ASSERT_TERMINATED_SUCCESSFULLY(emu);
+        ASSERT_EQ(output, "Echo: first\nEcho: second\n");
+    }
+
+    TEST(EmulationTest, ApplicationRunsFromMemory)
+    {
+        auto sample = utils::io::read_file(get_emulator_root() / "filesys" / "c" / "test-sample.exe");
+        ASSERT_FALSE(sample.empty());
+
+        emulator_settings settings{
+            .use_relative_time = true,
+        };
+
+        settings.memory_files[R"(C:\memory\test-sample.exe)"] = std::move(sample);
+
+        emulator_callbacks callbacks{};
+        prepare_test_environment(settings, callbacks);
+
+        windows_emulator emu{
+            create_x86_64_emulator(),
+            application_settings{
+                .application = R"(C:\memory\test-sample.exe)",
+                .working_directory = "C:\\",
+            },
+            settings,
+            std::move(callbacks),
+            emulator_interfaces{
+                .socket_factory = network::create_static_socket_factory(),
+            },
+        };
+
+        emu.start();
+
+        ASSERT_TERMINATED_SUCCESSFULLY(emu);
+        ASSERT_EQ(emu.mod_manager.executable->name, "test-sample.exe");
+    }
+
+    TEST(EmulationTest, FastMemoryQueriesAreReported)
+    {
+        const auto count_memory_queries = [](const bool use_fast_memory_queries) {
+            size_t queries = 0;
+
+            emulator_callbacks callbacks{};
+            callbacks.on_syscall.subscribe([&](uint32_t, const std::string_view name) {
+                queries += name == "NtQueryVirtualMemory" ? 1 : 0;
+                return instruction_hook_continuation::run_instruction;
+            });
+
+            auto emu = create_sample_emulator(
+                emulator_settings{
+                    .use_relative_time = true,
+                    .use_fast_memory_queries = use_fast_memory_queries,
+                },
+                {}, std::move(callbacks));
+
+            emu.start();
+
+            EXPECT_TRUE(emu.process.exit_status.has_value());
+            return queries;
+        };
+
+        ASSERT_EQ(count_memory_queries(true), count_memory_queries(false));
+    }
+
     TEST(EmulationTest, CountedEmulationWorks)
     {
         constexpr auto count = 200000;
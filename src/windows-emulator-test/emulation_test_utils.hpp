@@ -48,6 +48,9 @@ namespace test
     struct sample_configuration
     {
         bool print_time{false};
+        bool echo_input{false};
+
+        auto operator<=>(const sample_configuration&) const = default;
     };
 
     inline application_settings get_sample_app_settings(const sample_configuration& config)
@@ -59,24 +62,35 @@ namespace test
             settings.arguments.emplace_back(u"-time");
         }
 
+        if (config.echo_input)
+        {
+            settings.arguments.emplace_back(u"-echo");
+        }
+
         return settings;
     }
 
-    inline windows_emulator create_emulator(emulator_settings settings, emulator_callbacks callbacks = {})
+    // The test file is per process, so tests can run in parallel processes
+    inline void prepare_test_environment(emulator_settings& settings, emulator_callbacks& callbacks)
     {
         const auto is_verbose = enable_verbose_logging();
 
         if (is_verbose)
         {
-            callbacks.on_stdout = [](const std::string_view data) {
+            callbacks.on_stdout.subscribe([](const std::string_view data) {
                 std::cout << data; //
-            };
+            });
         }
 
         settings.emulation_root = get_emulator_root();
 
         settings.path_mappings["C:\\a.txt"] =
             std::filesystem::temp_directory_path() / ("emulator-test-file-" + std::to_string(getpid()) + ".txt");
+    }
+
+    inline windows_emulator create_emulator(emulator_settings settings, emulator_callbacks callbacks = {})
+    {
+        prepare_test_environment(settings, callbacks);
 
         return windows_emulator{
             create_x86_64_emulator(),
@@ -91,19 +105,7 @@ namespace test
     inline windows_emulator create_sample_emulator(emulator_settings settings, const sample_configuration& config = {},
                                                    emulator_callbacks callbacks = {})
     {
-        const auto is_verbose = enable_verbose_logging();
-
-        if (is_verbose)
-        {
-            callbacks.on_stdout = [](const std::string_view data) {
-                std::cout << data; //
-            };
-        }
-
-        settings.emulation_root = get_emulator_root();
-
-        settings.path_mappings["C:\\a.txt"] =
-            std::filesystem::temp_directory_path() / ("emulator-test-file-" + std::to_string(getpid()) + ".txt");
+        prepare_test_environment(settings, callbacks);
 
         return windows_emulator{
             create_x86_64_emulator(),
@@ -134,6 +136,152 @@ namespace test
         return create_emulator(std::move(settings));
     }
 
+    // Mapping the emulation root and setting up the process dominates test time, so the sample is set up once
+    // per configuration and restored from that state. CTest runs every test in its own process and points
+    // EMULATOR_SNAPSHOT_DIR to a directory it empties before each run, the first process that needs a state
+    // stores it there for all others. Without the variable, states are only cached within the process.
+    struct warmed_state_key
+    {
+        sample_configuration config{};
+        bool use_relative_time{true};
+
+        auto operator<=>(const warmed_state_key&) const = default;
+    };
+
+    inline std::optional<std::filesystem::path> get_snapshot_directory()
+    {
+        const auto* env = getenv("EMULATOR_SNAPSHOT_DIR");
+        if (!env || !*env)
+        {
+            return std::nullopt;
+        }
+
+        return std::filesystem::absolute(env);
+    }
+
+    inline std::string get_warmed_state_name(const warmed_state_key& key)
+    {
+        std::string name = "sample";
+        name += key.config.print_time ? "-time" : "";
+        name += key.config.echo_input ? "-echo" : "";
+        name += key.use_relative_time ? "-relative" : "-absolute";
+
+        return name + ".snapshot";
+    }
+
+    inline std::vector<std::byte> create_warmed_state(const warmed_state_key& key)
+    {
+        emulator_settings settings{
+            .use_relative_time = key.use_relative_time,
+        };
+
+        auto emu = create_sample_emulator(std::move(settings), key.config);
+        emu.setup_process_if_necessary();
+
+        utils::buffer_serializer serializer{};
+        emu.serialize(serializer);
+
+        return serializer.move_buffer();
+    }
+
+    // Creating a directory is atomic, so it serves as the lock that elects the process creating the state.
+    // The state is published by renaming a complete file, readers never see a partial one.
+    inline std::vector<std::byte> load_shared_warmed_state(const std::filesystem::path& directory,
+                                                           const warmed_state_key& key)
+    {
+        const auto snapshot = directory / get_warmed_state_name(key);
+
+        auto lock = snapshot;
+        lock += ".lock";
+
+        std::error_code ec{};
+        std::filesystem::create_directories(directory, ec);
+
+        // A process that died while holding the lock must not stall the others forever
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::minutes(2);
+
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+            std::vector<std::byte> state{};
+            if (utils::io::read_file(snapshot, &state) && !state.empty())
+            {
+                return state;
+            }
+
+            if (!std::filesystem::create_directory(lock, ec))
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                continue;
+            }
+
+            const auto _ = utils::finally([&] {
+                std::filesystem::remove(lock, ec); //
+            });
+
+            state = create_warmed_state(key);
+
+            auto temporary = snapshot;
+            temporary += "." + std::to_string(getpid());
+
+            if (utils::io::write_file(temporary, state))
+            {
+                std::filesystem::rename(temporary, snapshot, ec);
+            }
+
+            return state;
+        }
+
+        return create_warmed_state(key);
+    }
+
+    inline const std::vector<std::byte>& get_warmed_sample_state(const warmed_state_key& key)
+    {
+        static std::mutex mutex{};
+        static std::map<warmed_state_key, std::vector<std::byte>> states{};
+
+        const std::scoped_lock lock{mutex};
+
+        auto& state = states[key];
+        if (state.empty())
+        {
+            const auto directory = get_snapshot_directory();
+            state = directory ? load_shared_warmed_state(*directory, key) : create_warmed_state(key);
+        }
+
+        return state;
+    }
+
+    inline std::unique_ptr<windows_emulator> create_warmed_sample_emulator(emulator_settings settings,
+                                                                           const sample_configuration& config = {},
+                                                                           emulator_callbacks callbacks = {})
+    {
+        const auto& state = get_warmed_sample_state({
+            .config = config,
+            .use_relative_time = settings.use_relative_time,
+        });
+
+        prepare_test_environment(settings, callbacks);
+
+        auto emu = std::make_unique<windows_emulator>(create_x86_64_emulator(), settings, std::move(callbacks),
+                                                      emulator_interfaces{
+                                                          .socket_factory = network::create_static_socket_factory(),
+                                                      });
+
+        utils::buffer_deserializer deserializer{state};
+        emu->deserialize(deserializer);
+
+        return emu;
+    }
+
+    inline std::unique_ptr<windows_emulator> create_warmed_sample_emulator(const sample_configuration& config = {})
+    {
+        emulator_settings settings{
+            .use_relative_time = true,
+        };
+
+        return create_warmed_sample_emulator(std::move(settings), config);
+    }
+
     inline void bisect_emulation(windows_emulator& emu)
     {
         utils::buffer_serializer start_state{};
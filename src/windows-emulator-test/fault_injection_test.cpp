@@ -0,0 +1,62 @@
+#include "emulation_test_utils.hpp"
+
+namespace test
+{
+    TEST(FaultInjectionTest, RuleIsParsed)
+    {
+        const auto rule = parse_syscall_fault_rule("NtClose:0xC0000008:3:2");
+
+        ASSERT_EQ(rule.syscall, "NtClose");
+        ASSERT_EQ(rule.action, fault_action::fail);
+        ASSERT_EQ(rule.status, STATUS_INVALID_HANDLE);
+        ASSERT_EQ(rule.first_call, 3);
+        ASSERT_EQ(rule.count, 2);
+    }
+
+    TEST(FaultInjectionTest, RuleDefaultsToTypicalStatus)
+    {
+        const auto rule = parse_syscall_fault_rule("NtAllocateVirtualMemory");
+
+        ASSERT_EQ(rule.status, STATUS_NO_MEMORY);
+        ASSERT_EQ(rule.first_call, 0);
+        ASSERT_EQ(rule.count, 1);
+    }
+
+    TEST(FaultInjectionTest, InvalidRuleIsRejected)
+    {
+        ASSERT_THROW(parse_syscall_fault_rule(""), std::runtime_error);
+        ASSERT_THROW(parse_syscall_fault_rule("NtClose:status"), std::runtime_error);
+        ASSERT_THROW(parse_syscall_fault_rule("NtClose:0:0:1:2"), std::runtime_error);
+    }
+
+    TEST(FaultInjectionTest, ScheduledFaultIsInjectedOnce)
+    {
+        auto emu = create_sample_emulator(emulator_settings{
+            .use_relative_time = true,
+            .syscall_faults =
+                {
+                    syscall_fault_rule{
+                        .syscall = "NtClose",
+                        .status = STATUS_INVALID_HANDLE,
+                    },
+                },
+        });
+
+        emu.start();
+
+        ASSERT_EQ(emu.faults.get_injected_faults(), 1);
+    }
+
+    TEST(FaultInjectionTest, FaultInputIsConsumed)
+    {
+        auto emu = create_sample_emulator();
+
+        // A single zero byte fails the first fallible syscall, exhausted input lets the rest pass
+        constexpr std::array<uint8_t, 1> input{0};
+        emu.faults.set_fault_input(input);
+
+        emu.start();
+
+        ASSERT_EQ(emu.faults.get_injected_faults(), 1);
+    }
+}
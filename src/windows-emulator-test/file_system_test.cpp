@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 
 #include <file_system.hpp>
+#include <windows_objects.hpp>
 
 namespace test
 {
@@ -14,4 +15,88 @@ namespace test
         EXPECT_EQ(current_dir / "a", fs.translate(windows_path('a', {u"b", u"..", u"..", u"b", u"..", u"a.txt"})));
         EXPECT_EQ(current_dir / "a", fs.translate(windows_path('a', {u"..", u"b"})));
     }
+
+    TEST(FileSystemTest, OverlayHidesDeletedLowerEntries)
+    {
+        file_overlay overlay{};
+
+        overlay.create_file(R"(C:\Dir\File.txt)", {std::byte{1}, std::byte{2}});
+        ASSERT_NE(overlay.find(R"(c:\dir\file.TXT)"), nullptr);
+        EXPECT_FALSE(overlay.hides_lower(R"(C:\Dir\Other.txt)"));
+
+        overlay.remove(R"(C:\Dir)");
+        EXPECT_TRUE(overlay.hides_lower(R"(C:\Dir\File.txt)"));
+        EXPECT_TRUE(overlay.hides_lower(R"(C:\Dir\Other.txt)"));
+        EXPECT_EQ(overlay.find(R"(C:\Dir\File.txt)"), nullptr);
+
+        overlay.create_directory(R"(C:\Dir)");
+        overlay.create_file(R"(C:\Dir\New.txt)");
+
+        EXPECT_TRUE(overlay.hides_lower(R"(C:\Dir\Other.txt)"));
+        EXPECT_FALSE(overlay.hides_lower(R"(C:\Dir\New.txt)"));
+
+        const auto children = overlay.get_children(R"(C:\Dir)");
+        ASSERT_EQ(children.size(), 1);
+        EXPECT_EQ(children.front()->path.leaf(), u"New.txt");
+    }
+
+    TEST(FileSystemTest, ConfiguredOverlaySurvivesDeserialization)
+    {
+        const auto current_dir = std::filesystem::current_path();
+
+        const file_system source{current_dir};
+        utils::buffer_serializer serializer{};
+        source.serialize(serializer);
+
+        file_system target{current_dir};
+        target.add_memory_file(R"(C:\memory.bin)", {std::byte{1}});
+
+        utils::buffer_deserializer deserializer{serializer};
+        target.deserialize(deserializer);
+
+        ASSERT_NE(target.overlay(), nullptr);
+        EXPECT_EQ(target.find_overlay_file(R"(C:\memory.bin)"), nullptr);
+    }
+
+    TEST(FileSystemTest, HostFileIsReopenedOnDeserialization)
+    {
+        const auto root = std::filesystem::path(testing::TempDir()) / "emulator-test-reopen";
+        std::filesystem::create_directories(root / "c");
+
+        {
+            std::ofstream stream(root / "c" / "file.txt", std::ios::binary | std::ios::trunc);
+            stream << "0123456789";
+        }
+
+        file_system fs{root};
+
+        // Files opened for writing must not be truncated a second time
+        file source{};
+        source.name = uR"(C:\file.txt)";
+        source.host_mode = u"w+b";
+        source.handle = fopen((root / "c" / "file.txt").string().c_str(), "r+b");
+        ASSERT_TRUE(source.handle);
+        ASSERT_TRUE(source.handle.seek_to(4));
+
+        utils::buffer_serializer serializer{};
+        source.serialize(serializer);
+        source.handle = {};
+
+        utils::buffer_deserializer deserializer{serializer};
+        deserializer.register_factory<file_system_wrapper>([&] {
+            return file_system_wrapper{fs}; //
+        });
+
+        file target{};
+        target.deserialize(deserializer);
+
+        ASSERT_TRUE(target.handle);
+        EXPECT_TRUE(target.is_file());
+        EXPECT_EQ(target.handle.tell(), 4);
+        EXPECT_EQ(target.handle.size(), 10);
+        EXPECT_EQ(fgetc(target.handle), '4');
+
+        target.handle = {};
+        std::filesystem::remove_all(root);
+    }
 }
@@ -0,0 +1,77 @@
+#include "emulation_test_utils.hpp"
+
+namespace test
+{
+    TEST(HeapTrackingTest, AllocationsAreTracked)
+    {
+        emulator_callbacks callbacks{};
+
+        uint64_t allocate_events{0};
+        uint64_t free_events{0};
+
+        callbacks.on_heap_allocate.subscribe([&](const heap_allocation&) {
+            ++allocate_events; //
+        });
+
+        callbacks.on_heap_free.subscribe([&](const heap_allocation&) {
+            ++free_events; //
+        });
+
+        auto emu = create_sample_emulator(
+            emulator_settings{
+                .use_relative_time = true,
+                .track_heap_allocations = true,
+            },
+            {}, std::move(callbacks));
+
+        ASSERT_TRUE(emu.heap.is_active());
+
+        emu.start();
+
+        ASSERT_TERMINATED_SUCCESSFULLY(emu);
+
+        const auto& statistics = emu.heap.get_statistics();
+        ASSERT_GT(statistics.allocations, 0);
+        ASSERT_GT(statistics.frees, 0);
+        ASSERT_EQ(allocate_events, statistics.allocations + statistics.reallocations);
+        ASSERT_GT(free_events, 0);
+    }
+
+    TEST(HeapTrackingTest, AddressIsMappedToOwningAllocation)
+    {
+        auto emu = create_sample_emulator(emulator_settings{
+            .use_relative_time = true,
+            .track_heap_allocations = true,
+        });
+
+        emu.start(500000);
+
+        ASSERT_NOT_TERMINATED(emu);
+
+        const auto& allocations = emu.heap.get_allocations();
+        ASSERT_FALSE(allocations.empty());
+
+        for (const auto& allocation : allocations | std::views::values)
+        {
+            ASSERT_EQ(emu.heap.find_allocation(allocation.address), &allocation);
+            ASSERT_NE(emu.heap.find_allocation(allocation.address + allocation.size), &allocation);
+
+            if (allocation.size > 1)
+            {
+                ASSERT_EQ(emu.heap.find_allocation(allocation.end() - 1), &allocation);
+            }
+
+            ASSERT_NE(emu.mod_manager.find_by_address(allocation.caller), nullptr);
+        }
+    }
+
+    TEST(HeapTrackingTest, TrackingIsDisabledByDefault)
+    {
+        auto emu = create_sample_emulator();
+        emu.start();
+
+        ASSERT_TERMINATED_SUCCESSFULLY(emu);
+        ASSERT_FALSE(emu.heap.is_active());
+        ASSERT_TRUE(emu.heap.get_allocations().empty());
+    }
+}
@@ -0,0 +1,88 @@
+#include "emulation_test_utils.hpp"
+
+namespace test
+{
+    TEST(MemoryDiffTest, UnchangedMemoryHasNoDifferences)
+    {
+        auto emu = create_sample_emulator();
+        emu.start(100000);
+
+        emu.begin_memory_tracking();
+        const auto diff = emu.diff_memory();
+
+        ASSERT_TRUE(diff.pages.empty());
+        ASSERT_EQ(diff.dirty_pages, 0);
+    }
+
+    TEST(MemoryDiffTest, WrittenBytesAreReported)
+    {
+        auto emu = create_sample_emulator();
+        emu.start(100000);
+
+        const auto address = emu.memory.allocate_memory(0x2000, memory_permission::read_write);
+        ASSERT_NE(address, 0);
+
+        emu.begin_memory_tracking(true);
+
+        constexpr std::array<uint8_t, 4> data{0x13, 0x37, 0x13, 0x37};
+        emu.memory.write_memory(address + 0x1010, data.data(), data.size());
+
+        const auto diff = emu.diff_memory(false);
+
+        const auto page = std::ranges::find(diff.pages, address + 0x1000, &changed_page::address);
+        ASSERT_NE(page, diff.pages.end());
+        ASSERT_EQ(page->change, page_change::modified);
+        ASSERT_EQ(page->allocation_base, address);
+        ASSERT_EQ(page->deltas.size(), 1);
+        ASSERT_EQ(page->deltas[0].address, address + 0x1010);
+        ASSERT_EQ(page->deltas[0].new_data.size(), data.size());
+        ASSERT_EQ(page->deltas[0].old_data, std::vector<std::byte>(data.size()));
+
+        ASSERT_EQ(std::ranges::find(diff.pages, address, &changed_page::address), diff.pages.end());
+    }
+
+    TEST(MemoryDiffTest, LayoutChangesAreReported)
+    {
+        auto emu = create_sample_emulator();
+        emu.start(100000);
+
+        const auto address = emu.memory.allocate_memory(0x1000, memory_permission::read_write);
+        emu.begin_memory_tracking();
+
+        const auto other = emu.memory.allocate_memory(0x1000, memory_permission::read);
+        emu.memory.release_memory(address, 0);
+
+        const auto diff = emu.diff_memory();
+
+        const auto released = std::ranges::find(diff.pages, address, &changed_page::address);
+        ASSERT_NE(released, diff.pages.end());
+        ASSERT_EQ(released->change, page_change::decommitted);
+
+        const auto allocated = std::ranges::find(diff.pages, other, &changed_page::address);
+        ASSERT_NE(allocated, diff.pages.end());
+        ASSERT_EQ(allocated->change, page_change::committed);
+    }
+
+    TEST(MemoryDiffTest, GuestChangesAreAnnotated)
+    {
+        auto emu = create_sample_emulator();
+        emu.start(100000);
+
+        emu.begin_memory_tracking();
+        emu.start(100000);
+
+        const auto tracked = emu.diff_memory(false);
+        const auto verified = emu.diff_memory(true);
+
+        ASSERT_FALSE(tracked.pages.empty());
+        ASSERT_GT(tracked.dirty_pages, 0);
+        ASSERT_EQ(tracked.hashed_pages, 0);
+        ASSERT_GE(verified.pages.size(), tracked.pages.size());
+
+        const auto in_module = std::ranges::any_of(verified.pages, [](const changed_page& page) {
+            return !page.module.empty(); //
+        });
+
+        ASSERT_TRUE(in_module);
+    }
+}
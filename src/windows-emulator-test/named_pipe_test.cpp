@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+
+#include <named_pipe.hpp>
+
+namespace test
+{
+    TEST(NamedPipeTest, EmptyMessageOnFreshPipe)
+    {
+        pipe_buffer buffer{};
+        buffer.write({}, true);
+
+        EXPECT_FALSE(buffer.empty());
+        EXPECT_EQ(buffer.size(), 0);
+        EXPECT_EQ(buffer.get_message_count(), 1);
+
+        const std::array data{std::byte{1}, std::byte{2}};
+        buffer.write(data, true);
+
+        std::array<std::byte, 4> output{};
+        bool more_data = false;
+
+        EXPECT_EQ(buffer.read(output, true, more_data), 0);
+        EXPECT_FALSE(more_data);
+        EXPECT_EQ(buffer.get_message_count(), 1);
+
+        EXPECT_EQ(buffer.read(output, true, more_data), data.size());
+        EXPECT_FALSE(more_data);
+        EXPECT_TRUE(buffer.empty());
+
+        // A drained buffer keeps its capacity, but must accept empty writes as well
+        buffer.write({}, true);
+        EXPECT_EQ(buffer.read(output, true, more_data), 0);
+        EXPECT_TRUE(buffer.empty());
+    }
+
+    TEST(NamedPipeTest, TransfersAreSplitAtTheRingBufferEnd)
+    {
+        pipe_buffer buffer{};
+
+        // Moves the head close to the end of the initial 0x1000 byte ring
+        const std::vector<std::byte> filler(0xFF8);
+        std::vector<std::byte> output(filler.size());
+        bool more_data = false;
+
+        buffer.write(filler, false);
+        ASSERT_EQ(buffer.read(output, false, more_data), filler.size());
+
+        std::vector<std::byte> data(0x10);
+        for (size_t i = 0; i < data.size(); ++i)
+        {
+            data[i] = static_cast<std::byte>(i);
+        }
+
+        std::vector<size_t> write_offsets{};
+        buffer.write(data.size(), false, [&](const size_t offset, const std::span<std::byte> target) {
+            write_offsets.push_back(offset);
+            std::copy_n(data.begin() + static_cast<ptrdiff_t>(offset), target.size(), target.begin());
+        });
+
+        EXPECT_EQ(write_offsets, (std::vector<size_t>{0, 8}));
+
+        std::vector<std::byte> received(data.size());
+        std::vector<size_t> read_offsets{};
+
+        const auto count = buffer.read(received.size(), false, more_data,
+                                       [&](const size_t offset, const std::span<const std::byte> part) {
+                                           read_offsets.push_back(offset);
+                                           std::ranges::copy(part, received.begin() + static_cast<ptrdiff_t>(offset));
+                                       });
+
+        EXPECT_EQ(count, data.size());
+        EXPECT_EQ(read_offsets, (std::vector<size_t>{0, 8}));
+        EXPECT_EQ(received, data);
+        EXPECT_TRUE(buffer.empty());
+    }
+}
@@ -0,0 +1,57 @@
+#include "emulation_test_utils.hpp"
+
+namespace test
+{
+    TEST(ParkingTest, ParkedEmulatorResumesOnStart)
+    {
+        auto emu = create_sample_emulator();
+        emu.start(100000);
+
+        ASSERT_NOT_TERMINATED(emu);
+
+        const auto stats = emu.park();
+
+        ASSERT_TRUE(emu.is_parked());
+        ASSERT_GT(stats.original_size, 0);
+        ASSERT_LT(stats.parked_size, stats.original_size);
+        ASSERT_GT(stats.zero_pages + stats.shared_pages, 0);
+
+        emu.start();
+
+        ASSERT_FALSE(emu.is_parked());
+        ASSERT_TERMINATED_SUCCESSFULLY(emu);
+    }
+
+    TEST(ParkingTest, ParkedEmulatorSerializesLikeUnparked)
+    {
+        auto emu = create_sample_emulator();
+        emu.start(100000);
+
+        utils::buffer_serializer before{};
+        emu.serialize(before);
+
+        emu.park();
+
+        utils::buffer_serializer parked{};
+        emu.serialize(parked);
+
+        ASSERT_EQ(before.get_buffer(), parked.get_buffer());
+    }
+
+    TEST(ParkingTest, ReadOnlyPagesAreSharedBetweenEmulators)
+    {
+        auto emu1 = create_sample_emulator();
+        auto emu2 = create_sample_emulator();
+
+        emu1.start(100000);
+        emu2.start(100000);
+
+        emu1.park();
+        const auto pool_size = shared_page_pool::get().size();
+
+        const auto stats = emu2.park();
+
+        ASSERT_GT(stats.shared_pages, 0);
+        ASSERT_LT(shared_page_pool::get().size(), pool_size + stats.shared_pages);
+    }
+}
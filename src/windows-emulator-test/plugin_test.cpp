@@ -0,0 +1,160 @@
+#include "emulation_test_utils.hpp"
+
+namespace test
+{
+    namespace
+    {
+        struct counting_plugin : emulator_plugin
+        {
+            emulator_event subscriptions{};
+
+            size_t syscalls{};
+            size_t module_loads{};
+            size_t instructions{};
+            bool attached{false};
+
+            explicit counting_plugin(const emulator_event events)
+                : subscriptions(events)
+            {
+            }
+
+            std::string_view get_name() const override
+            {
+                return "counting";
+            }
+
+            emulator_event get_subscriptions() const override
+            {
+                return this->subscriptions;
+            }
+
+            void on_attach(windows_emulator&) override
+            {
+                this->attached = true;
+            }
+
+            void on_detach() override
+            {
+                this->attached = false;
+            }
+
+            continuation on_syscall(uint32_t, std::string_view) override
+            {
+                ++this->syscalls;
+                return continuation::run_instruction;
+            }
+
+            void on_module_load(mapped_module&) override
+            {
+                ++this->module_loads;
+            }
+
+            void on_instruction(uint64_t) override
+            {
+                ++this->instructions;
+            }
+        };
+    }
+
+    TEST(PluginTest, CallbackListInvokesAllSubscribers)
+    {
+        size_t primary = 0;
+        size_t secondary = 0;
+
+        utils::callback_list<void(size_t)> list{};
+        ASSERT_FALSE(list);
+
+        list = [&](const size_t value) { primary += value; };
+        const auto id = list.subscribe([&](const size_t value) { secondary += value; });
+        ASSERT_TRUE(list);
+
+        list(2);
+        ASSERT_EQ(primary, 2);
+        ASSERT_EQ(secondary, 2);
+
+        list = {};
+        list(3);
+        ASSERT_EQ(primary, 2);
+        ASSERT_EQ(secondary, 5);
+
+        list.unsubscribe(id);
+        ASSERT_FALSE(list);
+    }
+
+    TEST(PluginTest, CallbackListAllowsChangesWhileInvoked)
+    {
+        size_t first = 0;
+        size_t second = 0;
+        size_t added = 0;
+
+        utils::callback_list<void()> list{};
+        utils::subscription_id first_id{};
+        utils::subscription_id added_id{};
+
+        first_id = list.subscribe([&] {
+            ++first;
+            list.unsubscribe(first_id);
+            added_id = list.subscribe([&] { ++added; });
+        });
+
+        const auto second_id = list.subscribe([&] { ++second; });
+
+        list();
+        ASSERT_EQ(first, 1);
+        ASSERT_EQ(second, 1);
+        ASSERT_EQ(added, 0);
+
+        list();
+        ASSERT_EQ(first, 1);
+        ASSERT_EQ(second, 2);
+        ASSERT_EQ(added, 1);
+
+        list.unsubscribe(second_id);
+        list.unsubscribe(added_id);
+        ASSERT_FALSE(list);
+    }
+
+    TEST(PluginTest, AnySubscriberCanSkipSyscalls)
+    {
+        using continuation = instruction_hook_continuation;
+        utils::callback_list<continuation()> list{};
+
+        list = [] { return continuation::run_instruction; };
+        ASSERT_EQ(list(), continuation::run_instruction);
+
+        list.subscribe([] { return continuation::skip_instruction; });
+        list.subscribe([] { return continuation::run_instruction; });
+        ASSERT_EQ(list(), continuation::skip_instruction);
+    }
+
+    TEST(PluginTest, PluginsOnlyReceiveSubscribedEvents)
+    {
+        size_t primary_syscalls = 0;
+
+        emulator_callbacks callbacks{};
+        callbacks.on_syscall = [&](uint32_t, std::string_view) {
+            ++primary_syscalls;
+            return instruction_hook_continuation::run_instruction;
+        };
+
+        auto emu = create_sample_emulator(emulator_settings{.use_relative_time = true}, {}, std::move(callbacks));
+
+        auto& plugin = static_cast<counting_plugin&>(emu.plugins.add(
+            std::make_unique<counting_plugin>(emulator_event::syscall | emulator_event::module_load)));
+
+        ASSERT_TRUE(plugin.attached);
+        ASSERT_FALSE(emu.callbacks.on_instruction);
+
+        emu.start();
+
+        ASSERT_TERMINATED_SUCCESSFULLY(emu);
+        ASSERT_GT(plugin.syscalls, 0);
+        ASSERT_EQ(plugin.syscalls, primary_syscalls);
+        ASSERT_GT(plugin.module_loads, 0);
+        ASSERT_EQ(plugin.instructions, 0);
+
+        emu.plugins.remove(plugin);
+        ASSERT_EQ(emu.plugins.size(), 0);
+        ASSERT_FALSE(emu.callbacks.on_module_load);
+    }
+}
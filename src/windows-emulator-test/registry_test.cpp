@@ -0,0 +1,144 @@
+#include "emulation_test_utils.hpp"
+
+namespace test
+{
+    namespace
+    {
+        constexpr auto TEST_KEY = R"(\registry\machine\software\SogenTest)";
+        constexpr auto HIVE_KEY = R"(\registry\machine\software\Microsoft\Windows\CurrentVersion)";
+
+        std::vector<std::byte> make_data(const std::string_view data)
+        {
+            const auto* begin = reinterpret_cast<const std::byte*>(data.data());
+            return {begin, begin + data.size()};
+        }
+
+        bool has_sub_key(registry_manager& registry, const registry_key& key, const std::string_view name)
+        {
+            for (size_t i = 0;; ++i)
+            {
+                const auto sub_key = registry.get_sub_key_name(key, i);
+                if (!sub_key)
+                {
+                    return false;
+                }
+
+                if (*sub_key == name)
+                {
+                    return true;
+                }
+            }
+        }
+
+        bool has_value(registry_manager& registry, const registry_key& key, const std::string_view name)
+        {
+            for (size_t i = 0;; ++i)
+            {
+                const auto value = registry.get_value(key, i);
+                if (!value)
+                {
+                    return false;
+                }
+
+                if (value->name == name)
+                {
+                    return true;
+                }
+            }
+        }
+    }
+
+    TEST(RegistryTest, WritesAreMergedWithHives)
+    {
+        auto emu = create_empty_emulator();
+        auto& registry = emu.registry;
+
+        ASSERT_TRUE(registry.get_overlay().empty());
+
+        bool created = false;
+        const auto key = registry.create_key(TEST_KEY, &created);
+        ASSERT_TRUE(key.has_value());
+        ASSERT_TRUE(created);
+
+        registry.set_value(*key, "Name", REG_SZ, make_data("Value"));
+
+        const auto value = registry.get_value(*key, "name");
+        ASSERT_TRUE(value.has_value());
+        EXPECT_EQ(value->type, REG_SZ);
+        EXPECT_EQ(value->name, "Name");
+        EXPECT_EQ(value->data.size(), 5);
+
+        // Enumerations are cached until the key changes again
+        EXPECT_TRUE(has_value(registry, *key, "Name"));
+        registry.set_value(*key, "Other", REG_DWORD, make_data("1234"));
+        EXPECT_TRUE(has_value(registry, *key, "Other"));
+
+        const auto software = registry.get_key({R"(\registry\machine\software)"});
+        ASSERT_TRUE(software.has_value());
+        EXPECT_TRUE(has_sub_key(registry, *software, "SogenTest"));
+        EXPECT_TRUE(has_sub_key(registry, *software, "Microsoft"));
+
+        // Hive values can be hidden without touching the hive
+        const auto hive_key = registry.get_key({HIVE_KEY});
+        ASSERT_TRUE(hive_key.has_value());
+        ASSERT_TRUE(registry.delete_value(*hive_key, "ProgramFilesDir"));
+        EXPECT_FALSE(registry.get_value(*hive_key, "ProgramFilesDir").has_value());
+        EXPECT_FALSE(has_value(registry, *hive_key, "ProgramFilesDir"));
+        EXPECT_TRUE(has_value(registry, *hive_key, "CommonFilesDir"));
+
+        EXPECT_FALSE(registry.delete_key(*software));
+        ASSERT_TRUE(registry.delete_key(*key));
+        EXPECT_FALSE(registry.get_key({TEST_KEY}).has_value());
+        EXPECT_FALSE(has_sub_key(registry, *software, "SogenTest"));
+    }
+
+    TEST(RegistryTest, DeltaIsLoadedOnStartup)
+    {
+        const auto delta = std::filesystem::path(testing::TempDir()) / "emulator-test-registry.delta";
+
+        {
+            auto emu = create_empty_emulator();
+
+            const auto key = emu.registry.create_key(TEST_KEY);
+            ASSERT_TRUE(key.has_value());
+
+            emu.registry.set_value(*key, "Name", REG_SZ, make_data("Value"));
+            ASSERT_TRUE(emu.registry.save_overlay(delta));
+        }
+
+        emulator_settings settings{
+            .use_relative_time = true,
+            .registry_delta = delta,
+        };
+
+        auto emu = create_emulator(std::move(settings));
+
+        const auto key = emu.registry.get_key({TEST_KEY});
+        ASSERT_TRUE(key.has_value());
+
+        const auto value = emu.registry.get_value(*key, "Name");
+        ASSERT_TRUE(value.has_value());
+        EXPECT_EQ(value->data.size(), 5);
+
+        std::filesystem::remove(delta);
+    }
+
+    TEST(RegistryTest, OverlayIsSerialized)
+    {
+        auto emu = create_empty_emulator();
+
+        const auto key = emu.registry.create_key(TEST_KEY);
+        ASSERT_TRUE(key.has_value());
+
+        utils::buffer_serializer serializer{};
+        emu.registry.serialize(serializer);
+
+        emu.registry.delete_key(*key);
+        EXPECT_FALSE(emu.registry.get_key({TEST_KEY}).has_value());
+
+        utils::buffer_deserializer deserializer{serializer.get_buffer()};
+        emu.registry.deserialize(deserializer);
+
+        EXPECT_TRUE(emu.registry.get_key({TEST_KEY}).has_value());
+    }
+}
@@ -4,7 +4,8 @@ namespace test
 {
     TEST(SerializationTest, ResettingEmulatorWorks)
     {
-        auto emu = create_sample_emulator();
+        const auto emu_ptr = create_warmed_sample_emulator();
+        auto& emu = *emu_ptr;
 
         utils::buffer_serializer start_state{};
         emu.serialize(start_state);
@@ -31,7 +32,8 @@ namespace test
 
     TEST(SerializationTest, SerializedDataIsReproducible)
     {
-        auto emu1 = create_sample_emulator();
+        const auto emu_ptr = create_warmed_sample_emulator();
+        auto& emu1 = *emu_ptr;
         emu1.start();
 
         ASSERT_TERMINATED_SUCCESSFULLY(emu1);
@@ -76,7 +78,8 @@ namespace test
 
     TEST(SerializationTest, DeserializedEmulatorBehavesLikeSource)
     {
-        auto emu = create_sample_emulator();
+        const auto emu_ptr = create_warmed_sample_emulator();
+        auto& emu = *emu_ptr;
         emu.start(100);
 
         utils::buffer_serializer serializer{};
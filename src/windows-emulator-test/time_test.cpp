@@ -11,11 +11,13 @@ namespace test
             output_buffer.append(data); //
         };
 
-        const emulator_settings settings{
+        emulator_settings settings{
             .use_relative_time = false,
         };
 
-        auto emu = create_sample_emulator(settings, {.print_time = true}, std::move(callbacks));
+        const auto emu_ptr =
+            create_warmed_sample_emulator(std::move(settings), {.print_time = true}, std::move(callbacks));
+        auto& emu = *emu_ptr;
         emu.start();
 
         constexpr auto prefix = "Time: "sv;
@@ -0,0 +1,253 @@
+#include "std_include.hpp"
+#include "console.hpp"
+
+#include <iostream>
+
+namespace
+{
+    constexpr size_t MAX_PENDING_OUTPUT = 0x1000;
+
+    // Applies backspaces and turns lone LFs into CRLFs, as the console does before handing out cooked input.
+    // Backspaces only edit the line within the same chunk of input.
+    std::string cook_input(const std::string_view data)
+    {
+        std::string result{};
+        result.reserve(data.size() + data.size() / 8);
+
+        for (size_t i = 0; i < data.size(); ++i)
+        {
+            const auto c = data[i];
+
+            if (c == '\b')
+            {
+                if (!result.empty() && result.back() != '\n')
+                {
+                    result.pop_back();
+                }
+
+                continue;
+            }
+
+            if (c == '\n' && (i == 0 || data[i - 1] != '\r'))
+            {
+                result.push_back('\r');
+            }
+
+            result.push_back(c);
+        }
+
+        return result;
+    }
+}
+
+std::optional<console_mode> get_console_mode(const std::string_view name)
+{
+    if (name == "raw")
+    {
+        return console_mode::raw;
+    }
+
+    if (name == "line")
+    {
+        return console_mode::line;
+    }
+
+    if (name == "cooked")
+    {
+        return console_mode::cooked;
+    }
+
+    return std::nullopt;
+}
+
+console_device::console_device(const console_mode mode)
+    : mode_(mode)
+{
+}
+
+void console_device::set_sink(sink sink)
+{
+    this->sink_ = std::move(sink);
+}
+
+void console_device::set_mode(const console_mode mode)
+{
+    this->mode_ = mode;
+}
+
+void console_device::push_input(const std::string_view data)
+{
+    this->input_scripted_ = true;
+    this->append_input(data);
+}
+
+void console_device::close_input()
+{
+    this->input_scripted_ = true;
+    this->input_closed_ = true;
+}
+
+void console_device::append_input(const std::string_view data)
+{
+    if (this->input_offset_ > 0 && this->input_offset_ >= this->input_.size() / 2)
+    {
+        this->input_.erase(0, this->input_offset_);
+        this->input_offset_ = 0;
+    }
+
+    if (this->mode_ == console_mode::cooked)
+    {
+        this->input_.append(cook_input(data));
+    }
+    else
+    {
+        this->input_.append(data);
+    }
+}
+
+bool console_device::has_pending_line() const
+{
+    return this->input_.find('\n', this->input_offset_) != std::string::npos;
+}
+
+bool console_device::fill_from_host()
+{
+    if (this->input_scripted_ || this->input_closed_)
+    {
+        return false;
+    }
+
+    // Prompts have to be visible before blocking on the user
+    this->flush();
+
+    std::string line{};
+    if (!std::getline(std::cin, line))
+    {
+        this->input_closed_ = true;
+        return false;
+    }
+
+    line.push_back('\n');
+    this->append_input(line);
+    return true;
+}
+
+size_t console_device::read(memory_interface& memory, const uint64_t address, const size_t length)
+{
+    if (length == 0)
+    {
+        return 0;
+    }
+
+    if (this->mode_ == console_mode::raw)
+    {
+        while (this->get_buffered_input() == 0 && this->fill_from_host())
+        {
+        }
+    }
+    else
+    {
+        while (!this->has_pending_line() && this->fill_from_host())
+        {
+        }
+    }
+
+    auto count = std::min(length, this->get_buffered_input());
+
+    if (this->mode_ != console_mode::raw)
+    {
+        const auto line_end = this->input_.find('\n', this->input_offset_);
+        if (line_end != std::string::npos)
+        {
+            count = std::min(count, line_end + 1 - this->input_offset_);
+        }
+    }
+
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    memory.write_memory(address, this->input_.data() + this->input_offset_, count);
+    this->input_offset_ += count;
+
+    return count;
+}
+
+bool console_device::write(const memory_interface& memory, const uint64_t address, const size_t length)
+{
+    const auto offset = this->output_.size();
+    this->output_.resize(offset + length);
+
+    if (!memory.try_read_memory(address, this->output_.data() + offset, length))
+    {
+        this->output_.resize(offset);
+        return false;
+    }
+
+    this->emit_complete_lines();
+    return true;
+}
+
+void console_device::write(const std::string_view data)
+{
+    this->output_.append(data);
+    this->emit_complete_lines();
+}
+
+void console_device::emit_complete_lines()
+{
+    if (this->output_.size() >= MAX_PENDING_OUTPUT)
+    {
+        this->flush();
+        return;
+    }
+
+    const auto line_end = this->output_.rfind('\n');
+    if (line_end == std::string::npos)
+    {
+        return;
+    }
+
+    if (this->sink_)
+    {
+        this->sink_(std::string_view(this->output_.data(), line_end + 1));
+    }
+
+    this->output_.erase(0, line_end + 1);
+}
+
+void console_device::flush()
+{
+    if (this->output_.empty())
+    {
+        return;
+    }
+
+    if (this->sink_)
+    {
+        this->sink_(this->output_);
+    }
+
+    this->output_.clear();
+}
+
+void console_device::serialize(utils::buffer_serializer& buffer) const
+{
+    buffer.write(this->mode_);
+    buffer.write_string(std::string_view(this->input_).substr(this->input_offset_));
+    buffer.write(this->input_closed_);
+    buffer.write(this->input_scripted_);
+    buffer.write(this->output_);
+}
+
+void console_device::deserialize(utils::buffer_deserializer& buffer)
+{
+    buffer.read(this->mode_);
+    buffer.read(this->input_);
+    buffer.read(this->input_closed_);
+    buffer.read(this->input_scripted_);
+    buffer.read(this->output_);
+
+    this->input_offset_ = 0;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "std_include.hpp"
+
+#include <memory_interface.hpp>
+#include <serialization.hpp>
+
+enum class console_mode : uint8_t
+{
+    // Reads return whatever input is buffered
+    raw,
+    // Reads return at most one line, including its terminator
+    line,
+    // Line mode with backspace editing and CRLF line endings, like a cooked Windows console
+    cooked,
+};
+
+std::optional<console_mode> get_console_mode(std::string_view name);
+
+// Console behind the standard handles of the guest. Input is served from an in-memory buffer,
+// that is either scripted up front or through push_input, or refilled from host stdin a line at a
+// time for interactive runs. Output is read from guest memory in one piece and passed to the sink
+// per complete line, so byte-wise writers don't cause a host write per character.
+class console_device
+{
+  public:
+    using sink = std::function<void(std::string_view data)>;
+
+    explicit console_device(console_mode mode = console_mode::line);
+
+    void set_sink(sink sink);
+
+    console_mode get_mode() const
+    {
+        return this->mode_;
+    }
+
+    void set_mode(console_mode mode);
+
+    // Once input is scripted, host stdin is never consulted and the end of the script is the end of input
+    void push_input(std::string_view data);
+    void close_input();
+
+    bool is_input_closed() const
+    {
+        return this->input_closed_;
+    }
+
+    size_t get_buffered_input() const
+    {
+        return this->input_.size() - this->input_offset_;
+    }
+
+    // Moves up to length bytes of input to guest memory, returns the number of bytes written.
+    // Blocks on host stdin if nothing is buffered and the input is not scripted.
+    size_t read(memory_interface& memory, uint64_t address, size_t length);
+
+    // Returns false if the guest buffer is not readable
+    bool write(const memory_interface& memory, uint64_t address, size_t length);
+    void write(std::string_view data);
+
+    void flush();
+
+    void serialize(utils::buffer_serializer& buffer) const;
+    void deserialize(utils::buffer_deserializer& buffer);
+
+  private:
+    console_mode mode_{};
+    sink sink_{};
+
+    std::string input_{};
+    size_t input_offset_{};
+    bool input_closed_{false};
+    bool input_scripted_{false};
+
+    std::string output_{};
+
+    void append_input(std::string_view data);
+    bool has_pending_line() const;
+    bool fill_from_host();
+    void emit_complete_lines();
+};
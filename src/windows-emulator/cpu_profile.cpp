@@ -0,0 +1,381 @@
+#include "std_include.hpp"
+#include "cpu_profile.hpp"
+
+#include <cstring>
+
+namespace
+{
+    constexpr uint32_t MAX_BASIC_LEAF = 0xD;
+    constexpr uint32_t MAX_EXTENDED_LEAF = 0x80000008;
+
+    constexpr uint32_t bit(const uint32_t index)
+    {
+        return 1U << index;
+    }
+
+    // CPUID.1:EDX of every x86-64 processor: FPU up to SSE2, without HTT
+    constexpr uint32_t BASELINE_FEATURES_EDX = 0x078BFBFF;
+
+    namespace features_ecx
+    {
+        constexpr auto SSE3 = bit(0);
+        constexpr auto PCLMULQDQ = bit(1);
+        constexpr auto SSSE3 = bit(9);
+        constexpr auto FMA = bit(12);
+        constexpr auto CX16 = bit(13);
+        constexpr auto SSE4_1 = bit(19);
+        constexpr auto SSE4_2 = bit(20);
+        constexpr auto MOVBE = bit(22);
+        constexpr auto POPCNT = bit(23);
+        constexpr auto XSAVE = bit(26);
+        constexpr auto OSXSAVE = bit(27);
+        constexpr auto AVX = bit(28);
+        constexpr auto F16C = bit(29);
+        constexpr auto RDRAND = bit(30);
+    }
+
+    namespace features_edx
+    {
+        constexpr auto TSC = bit(4);
+        constexpr auto PAE = bit(6);
+        constexpr auto CX8 = bit(8);
+        constexpr auto MMX = bit(23);
+        constexpr auto SSE = bit(25);
+        constexpr auto SSE2 = bit(26);
+    }
+
+    namespace extended_features_ebx
+    {
+        constexpr auto FSGSBASE = bit(0);
+        constexpr auto BMI1 = bit(3);
+        constexpr auto AVX2 = bit(5);
+        constexpr auto BMI2 = bit(8);
+        constexpr auto ERMS = bit(9);
+        constexpr auto AVX512F = bit(16);
+        constexpr auto AVX512DQ = bit(17);
+        constexpr auto AVX512CD = bit(28);
+        constexpr auto AVX512BW = bit(30);
+        constexpr auto AVX512VL = bit(31);
+    }
+
+    namespace extended_features_edx
+    {
+        constexpr auto FSRM = bit(4);
+    }
+
+    namespace amd_features_ecx
+    {
+        constexpr auto LAHF = bit(0);
+        constexpr auto LZCNT = bit(5);
+        constexpr auto PREFETCHW = bit(8);
+    }
+
+    namespace amd_features_edx
+    {
+        constexpr auto SYSCALL = bit(11);
+        constexpr auto NX = bit(20);
+        constexpr auto PDPE1GB = bit(26);
+        constexpr auto RDTSCP = bit(27);
+        constexpr auto LM = bit(29);
+    }
+
+    // Indices into KUSER_SHARED_DATA::ProcessorFeatures (PF_* in winnt.h)
+    enum processor_feature : size_t
+    {
+        compare_exchange_double = 2,
+        mmx_instructions = 3,
+        xmmi_instructions = 6,
+        rdtsc_instruction = 8,
+        pae_enabled = 9,
+        xmmi64_instructions = 10,
+        nx_enabled = 12,
+        sse3_instructions = 13,
+        compare_exchange128 = 14,
+        xsave_enabled = 17,
+        rdwrfsgsbase = 22,
+        fastfail = 23,
+        rdrand_instruction = 28,
+        rdtscp_instruction = 32,
+        ssse3_instructions = 36,
+        sse4_1_instructions = 37,
+        sse4_2_instructions = 38,
+        avx_instructions = 39,
+        avx2_instructions = 40,
+        avx512f_instructions = 41,
+        erms = 42,
+    };
+
+    struct xstate_component
+    {
+        uint32_t index{};
+        uint32_t offset{};
+        uint32_t size{};
+    };
+
+    // Standard (non-compacted) XSAVE layout. x87 and SSE live in the 512 byte legacy area,
+    // followed by the 64 byte XSAVE header.
+    constexpr uint32_t XSAVE_LEGACY_SIZE = 512 + 64;
+
+    constexpr std::array<xstate_component, 4> XSTATE_COMPONENTS{{
+        {.index = 2, .offset = 576, .size = 256},  // AVX (YMM_Hi128)
+        {.index = 5, .offset = 1088, .size = 64},  // Opmask
+        {.index = 6, .offset = 1152, .size = 512}, // ZMM_Hi256
+        {.index = 7, .offset = 1664, .size = 1024} // Hi16_ZMM
+    }};
+
+    constexpr uint64_t XSTATE_LEGACY = 0x3;
+    constexpr uint64_t XSTATE_AVX = XSTATE_LEGACY | bit(2);
+    constexpr uint64_t XSTATE_AVX512 = XSTATE_AVX | bit(5) | bit(6) | bit(7);
+
+    uint32_t get_xsave_size(const uint64_t xcr0)
+    {
+        uint32_t size = XSAVE_LEGACY_SIZE;
+
+        for (const auto& component : XSTATE_COMPONENTS)
+        {
+            if (xcr0 & (1ULL << component.index))
+            {
+                size = std::max(size, component.offset + component.size);
+            }
+        }
+
+        return size;
+    }
+
+    cpuid_result pack_string(const std::string_view value, const size_t offset)
+    {
+        std::array<char, 16> buffer{};
+        if (offset < value.size())
+        {
+            memcpy(buffer.data(), value.data() + offset, std::min(buffer.size(), value.size() - offset));
+        }
+
+        cpuid_result result{};
+        memcpy(&result, buffer.data(), sizeof(result));
+        return result;
+    }
+
+    cpu_profile make_fast_emulation_profile()
+    {
+        cpu_profile profile{};
+        profile.name = "fast-emulation";
+        profile.brand = "Sogen Virtual CPU @ 3.00GHz";
+        profile.signature = 0x000906EA;
+        profile.features_ecx = features_ecx::SSE3 | features_ecx::SSSE3 | features_ecx::CX16 | features_ecx::SSE4_1 |
+                               features_ecx::SSE4_2 | features_ecx::POPCNT;
+        profile.features_edx = BASELINE_FEATURES_EDX;
+        profile.amd_features_ecx = amd_features_ecx::LAHF | amd_features_ecx::PREFETCHW;
+        profile.amd_features_edx = amd_features_edx::SYSCALL | amd_features_edx::NX | amd_features_edx::PDPE1GB |
+                                   amd_features_edx::RDTSCP | amd_features_edx::LM;
+        profile.xcr0 = XSTATE_LEGACY;
+
+        return profile;
+    }
+
+    cpu_profile make_default_profile()
+    {
+        auto profile = make_fast_emulation_profile();
+        profile.name = "default";
+        profile.features_ecx |= features_ecx::MOVBE;
+        profile.extended_features_ebx |= extended_features_ebx::ERMS;
+        profile.extended_features_edx |= extended_features_edx::FSRM;
+
+        return profile;
+    }
+
+    cpu_profile make_modern_profile()
+    {
+        auto profile = make_default_profile();
+        profile.name = "modern";
+        profile.features_ecx |= features_ecx::PCLMULQDQ | features_ecx::FMA | features_ecx::XSAVE |
+                                features_ecx::OSXSAVE | features_ecx::AVX | features_ecx::F16C;
+        profile.extended_features_ebx |=
+            extended_features_ebx::BMI1 | extended_features_ebx::AVX2 | extended_features_ebx::BMI2;
+        profile.amd_features_ecx |= amd_features_ecx::LZCNT;
+        profile.xcr0 = XSTATE_AVX;
+
+        return profile;
+    }
+
+    cpu_profile make_avx512_profile()
+    {
+        auto profile = make_modern_profile();
+        profile.name = "avx512";
+        profile.extended_features_ebx |= extended_features_ebx::AVX512F | extended_features_ebx::AVX512DQ |
+                                         extended_features_ebx::AVX512CD | extended_features_ebx::AVX512BW |
+                                         extended_features_ebx::AVX512VL;
+        profile.xcr0 = XSTATE_AVX512;
+
+        return profile;
+    }
+
+    const std::vector<cpu_profile>& get_cpu_profiles()
+    {
+        static const std::vector<cpu_profile> profiles{
+            make_fast_emulation_profile(),
+            make_default_profile(),
+            make_modern_profile(),
+            make_avx512_profile(),
+        };
+
+        return profiles;
+    }
+}
+
+cpuid_result cpu_profile::query(const uint32_t leaf, const uint32_t subleaf) const
+{
+    const auto has_xsave = (this->features_ecx & features_ecx::XSAVE) != 0;
+
+    switch (leaf)
+    {
+    case 0:
+        return {.eax = MAX_BASIC_LEAF, .ebx = 0x756E6547, .ecx = 0x6C65746E, .edx = 0x49656E69}; // GenuineIntel
+    case 1:
+        return {.eax = this->signature, .ebx = 0x00010800, .ecx = this->features_ecx, .edx = this->features_edx};
+    case 7:
+        if (subleaf != 0)
+        {
+            return {};
+        }
+
+        return {.ebx = this->extended_features_ebx,
+                .ecx = this->extended_features_ecx,
+                .edx = this->extended_features_edx};
+    case 0xD: {
+        if (!has_xsave)
+        {
+            return {};
+        }
+
+        const auto size = get_xsave_size(this->xcr0);
+
+        if (subleaf == 0)
+        {
+            return {.eax = static_cast<uint32_t>(this->xcr0),
+                    .ebx = size,
+                    .ecx = size,
+                    .edx = static_cast<uint32_t>(this->xcr0 >> 32)};
+        }
+
+        for (const auto& component : XSTATE_COMPONENTS)
+        {
+            if (component.index == subleaf && (this->xcr0 & (1ULL << component.index)))
+            {
+                return {.eax = component.size, .ebx = component.offset};
+            }
+        }
+
+        return {};
+    }
+    case 0x80000000:
+        return {.eax = MAX_EXTENDED_LEAF};
+    case 0x80000001:
+        return {.ecx = this->amd_features_ecx, .edx = this->amd_features_edx};
+    case 0x80000002:
+    case 0x80000003:
+    case 0x80000004:
+        return pack_string(this->brand, (leaf - 0x80000002) * sizeof(cpuid_result));
+    case 0x80000006:
+        return {.ecx = 0x01006040};
+    case 0x80000007:
+        return {.edx = bit(8)}; // Invariant TSC
+    case 0x80000008:
+        return {.eax = 0x00003027};
+    default:
+        return {};
+    }
+}
+
+uint64_t cpu_profile::read_xcr(const uint32_t index) const
+{
+    return index == 0 ? this->xcr0 : 0;
+}
+
+void cpu_profile::apply(KUSER_SHARED_DATA64& kusd) const
+{
+    auto& features = kusd.ProcessorFeatures.arr;
+    memset(features, 0, sizeof(features));
+
+    const auto set_feature = [&](const processor_feature feature, const bool enabled) {
+        features[feature] = enabled ? 1 : 0; //
+    };
+
+    const auto ecx = this->features_ecx;
+    const auto edx = this->features_edx;
+    const auto ebx7 = this->extended_features_ebx;
+    const auto xcr0 = this->xcr0;
+    const auto os_avx = (ecx & features_ecx::OSXSAVE) && (xcr0 & XSTATE_AVX) == XSTATE_AVX;
+    const auto os_avx512 = os_avx && (xcr0 & XSTATE_AVX512) == XSTATE_AVX512;
+
+    set_feature(compare_exchange_double, edx & features_edx::CX8);
+    set_feature(mmx_instructions, edx & features_edx::MMX);
+    set_feature(xmmi_instructions, edx & features_edx::SSE);
+    set_feature(rdtsc_instruction, edx & features_edx::TSC);
+    set_feature(pae_enabled, edx & features_edx::PAE);
+    set_feature(xmmi64_instructions, edx & features_edx::SSE2);
+    set_feature(nx_enabled, this->amd_features_edx & amd_features_edx::NX);
+    set_feature(sse3_instructions, ecx & features_ecx::SSE3);
+    set_feature(compare_exchange128, ecx & features_ecx::CX16);
+    set_feature(xsave_enabled, ecx & features_ecx::OSXSAVE);
+    set_feature(rdwrfsgsbase, ebx7 & extended_features_ebx::FSGSBASE);
+    set_feature(fastfail, true);
+    set_feature(rdrand_instruction, ecx & features_ecx::RDRAND);
+    set_feature(rdtscp_instruction, this->amd_features_edx & amd_features_edx::RDTSCP);
+    set_feature(ssse3_instructions, ecx & features_ecx::SSSE3);
+    set_feature(sse4_1_instructions, ecx & features_ecx::SSE4_1);
+    set_feature(sse4_2_instructions, ecx & features_ecx::SSE4_2);
+    set_feature(avx_instructions, os_avx && (ecx & features_ecx::AVX));
+    set_feature(avx2_instructions, os_avx && (ebx7 & extended_features_ebx::AVX2));
+    set_feature(avx512f_instructions, os_avx512 && (ebx7 & extended_features_ebx::AVX512F));
+    set_feature(erms, ebx7 & extended_features_ebx::ERMS);
+
+    auto& xstate = kusd.XState;
+    const auto size = get_xsave_size(xcr0);
+
+    xstate.EnabledFeatures = xcr0;
+    xstate.EnabledVolatileFeatures = xcr0;
+    xstate.Size = size;
+    xstate.AllFeatureSize = size;
+
+    memset(xstate.Features, 0, sizeof(xstate.Features));
+    memset(xstate.AllFeatures, 0, sizeof(xstate.AllFeatures));
+
+    xstate.Features[0] = {.Offset = 0, .Size = 160};
+    xstate.Features[1] = {.Offset = 160, .Size = 256};
+    xstate.AllFeatures[0] = xstate.Features[0].Size;
+    xstate.AllFeatures[1] = xstate.Features[1].Size;
+
+    for (const auto& component : XSTATE_COMPONENTS)
+    {
+        if (xcr0 & (1ULL << component.index))
+        {
+            xstate.Features[component.index] = {.Offset = component.offset, .Size = component.size};
+            xstate.AllFeatures[component.index] = component.size;
+        }
+    }
+}
+
+std::optional<cpu_profile> get_cpu_profile(const std::string_view name)
+{
+    for (const auto& profile : get_cpu_profiles())
+    {
+        if (profile.name == name)
+        {
+            return profile;
+        }
+    }
+
+    return std::nullopt;
+}
+
+std::vector<std::string_view> get_cpu_profile_names()
+{
+    std::vector<std::string_view> names{};
+
+    for (const auto& profile : get_cpu_profiles())
+    {
+        names.emplace_back(profile.name);
+    }
+
+    return names;
+}
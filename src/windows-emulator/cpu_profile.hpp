@@ -0,0 +1,45 @@
+#pragma once
+
+#include "std_include.hpp"
+
+struct cpuid_result
+{
+    uint32_t eax{};
+    uint32_t ebx{};
+    uint32_t ecx{};
+    uint32_t edx{};
+};
+
+// Virtual processor presented to the guest. CPUID, XGETBV and the
+// ProcessorFeatures/XState fields of KUSER_SHARED_DATA are all derived from it,
+// so runtime dispatchers see the same extensions no matter which one they query.
+//
+// Presets:
+//   fast-emulation  SSE up to SSE4.2 without ERMS, steers CRT routines to SSE2 loops
+//   default         fast-emulation plus ERMS/FSRM and MOVBE
+//   modern          default plus AVX, AVX2, FMA and BMI (icicle only, unicorn can't execute AVX)
+//   avx512          modern plus AVX-512 F/CD/BW/DQ/VL (icicle only)
+struct cpu_profile
+{
+    std::string name{};
+    std::string brand{};
+
+    uint32_t signature{};
+    uint32_t features_ecx{};
+    uint32_t features_edx{};
+    uint32_t extended_features_ebx{};
+    uint32_t extended_features_ecx{};
+    uint32_t extended_features_edx{};
+    uint32_t amd_features_ecx{};
+    uint32_t amd_features_edx{};
+
+    uint64_t xcr0{};
+
+    cpuid_result query(uint32_t leaf, uint32_t subleaf) const;
+    uint64_t read_xcr(uint32_t index) const;
+
+    void apply(KUSER_SHARED_DATA64& kusd) const;
+};
+
+std::optional<cpu_profile> get_cpu_profile(std::string_view name);
+std::vector<std::string_view> get_cpu_profile_names();
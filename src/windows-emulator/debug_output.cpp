@@ -0,0 +1,171 @@
+#include "std_include.hpp"
+#include "debug_output.hpp"
+
+#include <address_utils.hpp>
+
+namespace
+{
+    constexpr auto RATE_LIMIT_WINDOW = std::chrono::seconds(1);
+
+    template <typename CharType>
+    std::basic_string<CharType> read_terminated_string(const memory_interface& memory, const uint64_t address,
+                                                       const size_t max_length)
+    {
+        std::basic_string<CharType> buffer(max_length, CharType{});
+        auto length = max_length;
+
+        if (!memory.try_read_memory(address, buffer.data(), length * sizeof(CharType)))
+        {
+            // The string ends somewhere before the unreadable part, fall back to page granular reads
+            length = 0;
+
+            while (length < max_length)
+            {
+                const auto current = address + length * sizeof(CharType);
+                const auto page_end = page_align_down(current) + 0x1000;
+                const auto page_remaining = static_cast<size_t>((page_end - current) / sizeof(CharType));
+                const auto chunk = std::min(max_length - length, page_remaining);
+
+                if (chunk == 0 || !memory.try_read_memory(current, buffer.data() + length, chunk * sizeof(CharType)))
+                {
+                    break;
+                }
+
+                length += chunk;
+            }
+        }
+
+        const std::basic_string_view<CharType> view(buffer.data(), length);
+        buffer.resize(std::min(view.find(CharType{}), length));
+
+        return buffer;
+    }
+
+    void trim_line_ending(std::string& text)
+    {
+        while (!text.empty() && (text.back() == '\n' || text.back() == '\r'))
+        {
+            text.pop_back();
+        }
+    }
+
+    bool is_same_message(const debug_output_message& a, const debug_output_message& b)
+    {
+        return a.source == b.source && a.thread_id == b.thread_id && a.text == b.text && a.data == b.data;
+    }
+}
+
+const char* get_debug_output_source_name(const debug_output_source source)
+{
+    switch (source)
+    {
+    case debug_output_source::output_debug_string:
+        return "OutputDebugString";
+    case debug_output_source::dbg_print:
+        return "DbgPrint";
+    case debug_output_source::trace_event:
+        return "TraceEvent";
+    default:
+        return "Unknown";
+    }
+}
+
+debug_output_stream::debug_output_stream(utils::clock& clock, const uint32_t max_messages_per_second)
+    : clock_(&clock),
+      max_messages_per_second_(max_messages_per_second)
+{
+}
+
+void debug_output_stream::set_sink(sink sink)
+{
+    this->sink_ = std::move(sink);
+}
+
+void debug_output_stream::push(debug_output_message message)
+{
+    ++this->total_messages_;
+    trim_line_ending(message.text);
+
+    if (this->last_message_ && is_same_message(*this->last_message_, message))
+    {
+        ++this->repeat_count_;
+        return;
+    }
+
+    this->emit_repeat_summary();
+
+    if (!this->is_within_rate_limit())
+    {
+        ++this->pending_suppressed_;
+        ++this->suppressed_messages_;
+        this->last_message_ = std::nullopt;
+        return;
+    }
+
+    message.suppressed_count = this->pending_suppressed_;
+    this->pending_suppressed_ = 0;
+
+    this->emit(message);
+    this->last_message_ = std::move(message);
+}
+
+void debug_output_stream::flush()
+{
+    this->emit_repeat_summary();
+}
+
+bool debug_output_stream::is_within_rate_limit()
+{
+    if (this->max_messages_per_second_ == 0)
+    {
+        return true;
+    }
+
+    const auto now = this->clock_->steady_now();
+    if (now - this->window_start_ >= RATE_LIMIT_WINDOW)
+    {
+        this->window_start_ = now;
+        this->window_messages_ = 0;
+    }
+
+    if (this->window_messages_ >= this->max_messages_per_second_)
+    {
+        return false;
+    }
+
+    ++this->window_messages_;
+    return true;
+}
+
+void debug_output_stream::emit(const debug_output_message& message)
+{
+    if (this->sink_)
+    {
+        this->sink_(message);
+    }
+}
+
+void debug_output_stream::emit_repeat_summary()
+{
+    if (this->repeat_count_ == 0 || !this->last_message_)
+    {
+        return;
+    }
+
+    auto summary = *this->last_message_;
+    summary.repeat_count = this->repeat_count_;
+    summary.suppressed_count = 0;
+
+    this->repeat_count_ = 0;
+    this->emit(summary);
+}
+
+std::string read_debug_string(const memory_interface& memory, const uint64_t address, const size_t max_length)
+{
+    return read_terminated_string<char>(memory, address, max_length);
+}
+
+std::string read_debug_wide_string(const memory_interface& memory, const uint64_t address, const size_t max_length)
+{
+    return u16_to_u8(read_terminated_string<char16_t>(memory, address, max_length));
+}
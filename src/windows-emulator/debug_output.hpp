@@ -0,0 +1,82 @@
+#pragma once
+
+#include "std_include.hpp"
+
+#include <memory_interface.hpp>
+#include <utils/time.hpp>
+
+enum class debug_output_source : uint8_t
+{
+    output_debug_string,
+    dbg_print,
+    trace_event,
+};
+
+const char* get_debug_output_source_name(debug_output_source source);
+
+struct debug_output_message
+{
+    debug_output_source source{};
+    uint32_t thread_id{};
+    std::string text{};
+
+    // Raw payload of trace events, the text only describes them
+    std::vector<std::byte> data{};
+
+    // Set on the summary emitted once a run of identical messages ends.
+    // The text is the one of the repeated message.
+    uint32_t repeat_count{};
+
+    // Messages dropped by the rate limit since the previous emitted message
+    uint64_t suppressed_count{};
+};
+
+// Single stream for all debug output channels of the guest. Runs of identical messages
+// are folded into one summary and at most max_messages_per_second messages of emulated
+// time reach the sink, so chatty guests don't spend their time in host console output.
+class debug_output_stream
+{
+  public:
+    using sink = std::function<void(const debug_output_message& message)>;
+
+    debug_output_stream(utils::clock& clock, uint32_t max_messages_per_second);
+
+    void set_sink(sink sink);
+
+    void push(debug_output_message message);
+    void flush();
+
+    uint64_t get_total_messages() const
+    {
+        return this->total_messages_;
+    }
+
+    uint64_t get_suppressed_messages() const
+    {
+        return this->suppressed_messages_;
+    }
+
+  private:
+    utils::clock* clock_{};
+    uint32_t max_messages_per_second_{};
+    sink sink_{};
+
+    std::optional<debug_output_message> last_message_{};
+    uint32_t repeat_count_{};
+
+    utils::clock::steady_time_point window_start_{};
+    uint32_t window_messages_{};
+    uint64_t pending_suppressed_{};
+
+    uint64_t total_messages_{};
+    uint64_t suppressed_messages_{};
+
+    bool is_within_rate_limit();
+    void emit(const debug_output_message& message);
+    void emit_repeat_summary();
+};
+
+// Reads up to max_length characters with a single memory access where possible and stops at
+// the first terminator. Reads that run into unmapped memory return what was readable.
+std::string read_debug_string(const memory_interface& memory, uint64_t address, size_t max_length);
+std::string read_debug_wide_string(const memory_interface& memory, uint64_t address, size_t max_length);
@@ -211,6 +211,32 @@ namespace
         throw std::runtime_error("Unsupported win address family for conversion: " + std::to_string(family));
     }
 
+    void serialize_address(utils::buffer_serializer& buffer, const std::optional<network::address>& address)
+    {
+        std::vector<std::byte> data{};
+
+        if (address)
+        {
+            const auto* bytes = reinterpret_cast<const std::byte*>(&address->get_addr());
+            data.assign(bytes, bytes + address->get_size());
+        }
+
+        buffer.write_vector(data);
+    }
+
+    std::optional<network::address> deserialize_address(utils::buffer_deserializer& buffer)
+    {
+        std::vector<std::byte> data{};
+        buffer.read_vector(data);
+
+        if (data.empty())
+        {
+            return std::nullopt;
+        }
+
+        return network::address{reinterpret_cast<const sockaddr*>(data.data()), static_cast<socklen_t>(data.size())};
+    }
+
     afd_creation_data get_creation_data(windows_emulator& win_emu, const io_device_creation_data& data)
     {
         if (!data.buffer || data.length < sizeof(afd_creation_data))
@@ -334,6 +360,11 @@ namespace
 
         std::unique_ptr<network::i_socket> s_{};
 
+        // Replayed onto the fresh host socket after deserialization
+        std::optional<network::address> local_address_{};
+        std::optional<network::address> remote_address_{};
+        std::optional<int> listen_backlog_{};
+
         bool executing_delayed_ioctl_{};
         std::optional<afd_creation_data> creation_data{};
         std::optional<bool> require_poll_{};
@@ -386,6 +417,31 @@ namespace
             this->s_->set_blocking(false);
         }
 
+        // Brings a fresh host socket back into the recorded state. Connections are initiated again,
+        // accepted connections and data in flight are lost.
+        void restore_socket_state() const
+        {
+            if (!this->s_)
+            {
+                return;
+            }
+
+            if (this->local_address_)
+            {
+                (void)this->s_->bind(*this->local_address_);
+            }
+
+            if (this->listen_backlog_)
+            {
+                (void)this->s_->listen(*this->listen_backlog_);
+            }
+
+            if (this->remote_address_)
+            {
+                (void)this->s_->connect(*this->remote_address_);
+            }
+        }
+
         void delay_ioctrl(const io_device_context& c, const std::optional<bool> require_poll = {},
                           const std::optional<std::chrono::steady_clock::time_point> timeout = {},
                           const std::optional<std::function<void(windows_emulator&, const io_device_context&)>>&
@@ -505,6 +561,17 @@ namespace
             buffer.read_optional(this->require_poll_);
             buffer.read_optional(this->delayed_ioctl_);
             buffer.read_optional(this->timeout_);
+
+            this->local_address_ = deserialize_address(buffer);
+            this->remote_address_ = deserialize_address(buffer);
+            buffer.read_optional(this->listen_backlog_);
+            buffer.read(this->next_sequence_);
+
+            buffer.read_optional(this->event_select_event_);
+            buffer.read(this->event_select_mask_);
+            buffer.read(this->triggered_events_);
+
+            this->restore_socket_state();
         }
 
         void serialize_object(utils::buffer_serializer& buffer) const override
@@ -513,6 +580,15 @@ namespace
             buffer.write_optional(this->require_poll_);
             buffer.write_optional(this->delayed_ioctl_);
             buffer.write_optional(this->timeout_);
+
+            serialize_address(buffer, this->local_address_);
+            serialize_address(buffer, this->remote_address_);
+            buffer.write_optional(this->listen_backlog_);
+            buffer.write(this->next_sequence_);
+
+            buffer.write_optional(this->event_select_event_);
+            buffer.write(this->event_select_mask_);
+            buffer.write(this->triggered_events_);
         }
 
         NTSTATUS io_control(windows_emulator& win_emu, const io_device_context& c) override
@@ -583,6 +659,7 @@ namespace
             }
 
             const auto addr = convert_to_host_address(win_emu, std::span(data).subspan(address_offset));
+            this->remote_address_ = addr;
 
             if (!this->s_->connect(addr))
             {
@@ -604,7 +681,7 @@ namespace
             return STATUS_SUCCESS;
         }
 
-        NTSTATUS ioctl_bind(windows_emulator& win_emu, const io_device_context& c) const
+        NTSTATUS ioctl_bind(windows_emulator& win_emu, const io_device_context& c)
         {
             if (!this->s_)
             {
@@ -627,10 +704,13 @@ namespace
                 return STATUS_ADDRESS_ALREADY_ASSOCIATED;
             }
 
+            // Keeps the port the host picked for ephemeral binds
+            this->local_address_ = this->s_->get_local_address().value_or(addr);
+
             return STATUS_SUCCESS;
         }
 
-        NTSTATUS ioctl_listen(windows_emulator& win_emu, const io_device_context& c) const
+        NTSTATUS ioctl_listen(windows_emulator& win_emu, const io_device_context& c)
         {
             if (!this->s_)
             {
@@ -644,11 +724,14 @@ namespace
 
             const auto listen_info = win_emu.emu().read_memory<AFD_LISTEN_INFO>(c.input_buffer);
 
-            if (!this->s_->listen(static_cast<int>(listen_info.MaximumConnectionQueue)))
+            const auto backlog = static_cast<int>(listen_info.MaximumConnectionQueue);
+            if (!this->s_->listen(backlog))
             {
                 return STATUS_INVALID_PARAMETER;
             }
 
+            this->listen_backlog_ = backlog;
+
             return STATUS_SUCCESS;
         }
 
@@ -59,7 +59,13 @@ namespace
         }
 
         case handle_types::timer: {
-            return true; // TODO
+            auto* t = c.timers.get(h);
+            return !t || t->is_signaled();
+        }
+
+        case handle_types::io_completion: {
+            const auto* p = c.io_completions.get(h);
+            return !p || !p->is_waiting(current_thread_id);
         }
 
         case handle_types::semaphore: {
@@ -72,6 +78,17 @@ namespace
             break;
         }
 
+        case handle_types::file: {
+            const auto* f = c.files.get(h);
+            if (!f || !f->pipe)
+            {
+                return true;
+            }
+
+            const auto entry = c.pipes.find(f->pipe->pipe_id);
+            return entry == c.pipes.end() || !entry->second.has_pending_operation(h);
+        }
+
         case handle_types::thread: {
             const auto* t = c.threads.get(h);
             if (t)
@@ -128,6 +145,7 @@ void emulator_thread::mark_as_ready(const NTSTATUS status)
     this->pending_status = status;
     this->await_time = {};
     this->await_objects = {};
+    this->await_pipe_instance = {};
 
     // TODO: Find out if this is correct
     if (this->waiting_for_alert)
@@ -166,6 +184,23 @@ bool emulator_thread::is_thread_ready(process_context& process, utils::clock& cl
         return false;
     }
 
+    if (this->await_pipe_instance.has_value())
+    {
+        if (has_available_pipe_instance(process.pipes, *this->await_pipe_instance))
+        {
+            this->mark_as_ready(STATUS_SUCCESS);
+            return true;
+        }
+
+        if (this->is_await_time_over(clock))
+        {
+            this->mark_as_ready(STATUS_IO_TIMEOUT);
+            return true;
+        }
+
+        return false;
+    }
+
     if (!this->await_objects.empty())
     {
         bool all_signaled = true;
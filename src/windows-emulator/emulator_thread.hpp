@@ -83,6 +83,7 @@ class emulator_thread : public ref_counted_object
     bool alerted{false};
     uint32_t suspended{0};
     std::optional<std::chrono::steady_clock::time_point> await_time{};
+    std::optional<std::u16string> await_pipe_instance{};
 
     bool apc_alertable{false};
     std::vector<pending_apc> pending_apcs{};
@@ -156,6 +157,7 @@ class emulator_thread : public ref_counted_object
 
         buffer.write(this->suspended);
         buffer.write_optional(this->await_time);
+        buffer.write_optional(this->await_pipe_instance);
 
         buffer.write(this->apc_alertable);
         buffer.write_vector(this->pending_apcs);
@@ -194,6 +196,7 @@ class emulator_thread : public ref_counted_object
 
         buffer.read(this->suspended);
         buffer.read_optional(this->await_time);
+        buffer.read_optional(this->await_pipe_instance);
 
         buffer.read(this->apc_alertable);
         buffer.read_vector(this->pending_apcs);
@@ -49,6 +49,7 @@ class object_wrapper
 
 class windows_emulator;
 class module_manager;
+class file_system;
 struct process_context;
 
 using clock_wrapper = object_wrapper<utils::clock>;
@@ -58,6 +59,7 @@ using module_manager_wrapper = object_wrapper<module_manager>;
 using process_context_wrapper = object_wrapper<process_context>;
 using windows_emulator_wrapper = object_wrapper<windows_emulator>;
 using socket_factory_wrapper = object_wrapper<network::socket_factory>;
+using file_system_wrapper = object_wrapper<file_system>;
 
 template <typename T>
 class emulator_object
@@ -385,3 +387,26 @@ inline uint64_t get_function_argument(x86_64_emulator& emu, const size_t index,
         return emu.read_stack(index + 1);
     }
 }
+
+inline void set_function_argument(x86_64_emulator& emu, const size_t index, const uint64_t value,
+                                  bool is_syscall = false)
+{
+    switch (index)
+    {
+    case 0:
+        emu.reg(is_syscall ? x86_register::r10 : x86_register::rcx, value);
+        break;
+    case 1:
+        emu.reg(x86_register::rdx, value);
+        break;
+    case 2:
+        emu.reg(x86_register::r8, value);
+        break;
+    case 3:
+        emu.reg(x86_register::r9, value);
+        break;
+    default:
+        emu.write_memory(emu.read_stack_pointer() + (index + 1) * sizeof(uint64_t), &value, sizeof(value));
+        break;
+    }
+}
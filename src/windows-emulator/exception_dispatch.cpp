@@ -3,48 +3,39 @@
 #include "process_context.hpp"
 #include "cpu_context.hpp"
 
+#include <algorithm>
+
 namespace
 {
     using exception_record = EMU_EXCEPTION_RECORD<EmulatorTraits<Emu64>>;
-    using exception_record_map = std::unordered_map<const exception_record*, emulator_object<exception_record>>;
 
-    emulator_object<exception_record> save_exception_record(emulator_allocator& allocator,
-                                                            const exception_record& record,
-                                                            exception_record_map& record_mapping)
+    // Flattens the record chain into the frame buffer. Nested records are placed behind
+    // their parent and their pointers are rebased to the guest address of the copy.
+    void write_exception_records(const std::span<std::byte> buffer, const uint64_t guest_address,
+                                 const exception_record& record)
     {
-        const auto record_obj = allocator.reserve<exception_record>();
-        record_obj.write(record);
+        std::vector<const exception_record*> records{};
 
-        if (record.ExceptionRecord)
+        const auto* current_record = &record;
+        while (current_record && std::ranges::find(records, current_record) == records.end())
         {
-            record_mapping.emplace(&record, record_obj);
+            records.push_back(current_record);
+            current_record = reinterpret_cast<exception_record*>(current_record->ExceptionRecord);
+        }
 
-            emulator_object<exception_record> nested_record_obj{allocator.get_memory()};
-            const auto nested_record = record_mapping.find(reinterpret_cast<exception_record*>(record.ExceptionRecord));
+        for (size_t i = 0; i < records.size(); ++i)
+        {
+            auto copy = *records[i];
 
-            if (nested_record != record_mapping.end())
-            {
-                nested_record_obj = nested_record->second;
-            }
-            else
+            if (copy.ExceptionRecord)
             {
-                nested_record_obj = save_exception_record(
-                    allocator, *reinterpret_cast<exception_record*>(record.ExceptionRecord), record_mapping);
+                const auto* nested = reinterpret_cast<exception_record*>(copy.ExceptionRecord);
+                const auto nested_index = static_cast<size_t>(std::ranges::find(records, nested) - records.begin());
+                copy.ExceptionRecord = guest_address + (nested_index * sizeof(exception_record));
             }
 
-            record_obj.access([&](exception_record& r) {
-                r.ExceptionRecord = nested_record_obj.value(); //
-            });
+            memcpy(buffer.data() + (i * sizeof(exception_record)), &copy, sizeof(copy));
         }
-
-        return record_obj;
-    }
-
-    emulator_object<exception_record> save_exception_record(emulator_allocator& allocator,
-                                                            const exception_record& record)
-    {
-        exception_record_map record_mapping{};
-        return save_exception_record(allocator, record, record_mapping);
     }
 
     uint32_t map_violation_operation_to_parameter(const memory_operation operation)
@@ -74,7 +65,7 @@ namespace
             }
 
             total_size += sizeof(*current_record);
-            current_record = reinterpret_cast<exception_record*>(record.ExceptionRecord);
+            current_record = reinterpret_cast<exception_record*>(current_record->ExceptionRecord);
         }
 
         return total_size;
@@ -108,35 +99,31 @@ namespace
         const auto total_size = initial_sp - new_sp;
         assert(total_size >= allocation_size);
 
-        std::vector<uint8_t> zero_memory{};
-        zero_memory.resize(static_cast<size_t>(total_size), 0);
+        const auto& context = *reinterpret_cast<CONTEXT64*>(pointers.ContextRecord);
+        const auto& record = *reinterpret_cast<exception_record*>(pointers.ExceptionRecord);
 
-        emu.write_memory(new_sp, zero_memory.data(), zero_memory.size());
+        // Build the whole dispatcher frame on the host and transfer it with a single write
+        std::vector<std::byte> frame{};
+        frame.resize(static_cast<size_t>(total_size));
 
-        emu.reg(x86_register::rsp, new_sp);
-        emu.reg(x86_register::rip, dispatcher);
+        memcpy(frame.data(), &context, sizeof(context));
 
-        const emulator_object<CONTEXT64> context_record_obj{emu, new_sp};
-        context_record_obj.write(*reinterpret_cast<CONTEXT64*>(pointers.ContextRecord));
+        const auto records = std::span(frame).subspan(context_record_size, exception_record_size);
+        write_exception_records(records, new_sp + context_record_size, record);
 
-        emulator_allocator allocator{emu, new_sp + context_record_size, exception_record_size};
-        const auto exception_record_obj =
-            save_exception_record(allocator, *reinterpret_cast<exception_record*>(pointers.ExceptionRecord));
+        machine_frame mach_frame{};
+        mach_frame.rip = context.Rip;
+        mach_frame.rsp = context.Rsp;
+        mach_frame.ss = context.SegSs;
+        mach_frame.cs = context.SegCs;
+        mach_frame.eflags = context.EFlags;
 
-        if (exception_record_obj.value() != allocator.get_base())
-        {
-            throw std::runtime_error("Bad exception record position on stack");
-        }
+        memcpy(frame.data() + combined_size, &mach_frame, sizeof(mach_frame));
+
+        emu.write_memory(new_sp, frame.data(), frame.size());
 
-        const emulator_object<machine_frame> machine_frame_obj{emu, new_sp + combined_size};
-        machine_frame_obj.access([&](machine_frame& frame) {
-            const auto& record = *reinterpret_cast<CONTEXT64*>(pointers.ContextRecord);
-            frame.rip = record.Rip;
-            frame.rsp = record.Rsp;
-            frame.ss = record.SegSs;
-            frame.cs = record.SegCs;
-            frame.eflags = record.EFlags;
-        });
+        emu.reg(x86_register::rsp, new_sp);
+        emu.reg(x86_register::rip, dispatcher);
     }
 }
 
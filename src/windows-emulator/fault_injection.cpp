@@ -0,0 +1,269 @@
+#include "std_include.hpp"
+#include "fault_injection.hpp"
+#include "emulator_utils.hpp"
+
+#include <algorithm>
+
+namespace
+{
+    struct fallible_syscall
+    {
+        std::string_view name{};
+        NTSTATUS status{};
+        std::optional<size_t> length_argument{};
+    };
+
+    // Syscalls whose failure the guest is expected to handle, with the status
+    // the kernel would report and the index of the output buffer length argument
+    constexpr std::array FALLIBLE_SYSCALLS{
+        fallible_syscall{"NtAllocateVirtualMemory", STATUS_NO_MEMORY},
+        fallible_syscall{"NtAllocateVirtualMemoryEx", STATUS_NO_MEMORY},
+        fallible_syscall{"NtCreateSection", STATUS_INSUFFICIENT_RESOURCES},
+        fallible_syscall{"NtMapViewOfSection", STATUS_NO_MEMORY},
+        fallible_syscall{"NtCreateFile", STATUS_ACCESS_DENIED},
+        fallible_syscall{"NtOpenFile", STATUS_OBJECT_NAME_NOT_FOUND},
+        fallible_syscall{"NtReadFile", STATUS_UNEXPECTED_IO_ERROR, 6},
+        fallible_syscall{"NtWriteFile", STATUS_UNEXPECTED_IO_ERROR},
+        fallible_syscall{"NtQueryDirectoryFile", STATUS_UNEXPECTED_IO_ERROR, 6},
+        fallible_syscall{"NtQueryDirectoryFileEx", STATUS_UNEXPECTED_IO_ERROR, 6},
+        fallible_syscall{"NtQueryInformationFile", STATUS_UNEXPECTED_IO_ERROR, 3},
+        fallible_syscall{"NtQueryVolumeInformationFile", STATUS_UNEXPECTED_IO_ERROR, 3},
+        fallible_syscall{"NtDeviceIoControlFile", STATUS_UNEXPECTED_IO_ERROR, 9},
+        fallible_syscall{"NtOpenKey", STATUS_OBJECT_NAME_NOT_FOUND},
+        fallible_syscall{"NtOpenKeyEx", STATUS_OBJECT_NAME_NOT_FOUND},
+        fallible_syscall{"NtCreateKey", STATUS_ACCESS_DENIED},
+        fallible_syscall{"NtQueryKey", STATUS_INSUFFICIENT_RESOURCES, 3},
+        fallible_syscall{"NtQueryValueKey", STATUS_OBJECT_NAME_NOT_FOUND, 4},
+        fallible_syscall{"NtEnumerateKey", STATUS_INSUFFICIENT_RESOURCES, 4},
+        fallible_syscall{"NtEnumerateValueKey", STATUS_INSUFFICIENT_RESOURCES, 4},
+        fallible_syscall{"NtQuerySystemInformation", STATUS_INSUFFICIENT_RESOURCES, 2},
+        fallible_syscall{"NtQueryInformationProcess", STATUS_ACCESS_DENIED, 3},
+        fallible_syscall{"NtQueryInformationThread", STATUS_ACCESS_DENIED, 3},
+        fallible_syscall{"NtQueryInformationToken", STATUS_ACCESS_DENIED, 3},
+        fallible_syscall{"NtQueryVirtualMemory", STATUS_ACCESS_DENIED, 4},
+        fallible_syscall{"NtQueryObject", STATUS_INSUFFICIENT_RESOURCES, 3},
+        fallible_syscall{"NtCreateEvent", STATUS_INSUFFICIENT_RESOURCES},
+        fallible_syscall{"NtCreateMutant", STATUS_INSUFFICIENT_RESOURCES},
+        fallible_syscall{"NtCreateThreadEx", STATUS_NO_MEMORY},
+    };
+
+    const fallible_syscall* find_fallible_syscall(const std::string_view name)
+    {
+        for (const auto& syscall : FALLIBLE_SYSCALLS)
+        {
+            if (syscall.name == name)
+            {
+                return &syscall;
+            }
+        }
+
+        return nullptr;
+    }
+
+    uint64_t parse_number(const std::string_view text)
+    {
+        const std::string value(text);
+
+        size_t end = 0;
+        uint64_t number = 0;
+
+        try
+        {
+            number = std::stoull(value, &end, 0);
+        }
+        catch (const std::exception&)
+        {
+            end = 0;
+        }
+
+        if (value.empty() || end != value.size())
+        {
+            throw std::runtime_error("Invalid number: " + value);
+        }
+
+        return number;
+    }
+}
+
+syscall_fault_rule parse_syscall_fault_rule(const std::string_view text)
+{
+    std::vector<std::string_view> parts{};
+
+    size_t start = 0;
+    while (true)
+    {
+        const auto end = text.find(':', start);
+        parts.push_back(text.substr(start, end - start));
+
+        if (end == std::string_view::npos)
+        {
+            break;
+        }
+
+        start = end + 1;
+    }
+
+    if (parts.size() > 4 || parts.front().empty())
+    {
+        throw std::runtime_error("Invalid syscall fault: " + std::string(text));
+    }
+
+    syscall_fault_rule rule{};
+    rule.syscall = std::string(parts[0]);
+
+    if (parts.size() > 1)
+    {
+        rule.status = static_cast<NTSTATUS>(parse_number(parts[1]));
+    }
+    else if (const auto* syscall = find_fallible_syscall(rule.syscall))
+    {
+        rule.status = syscall->status;
+    }
+
+    if (parts.size() > 2)
+    {
+        rule.first_call = parse_number(parts[2]);
+    }
+
+    if (parts.size() > 3)
+    {
+        rule.count = parse_number(parts[3]);
+    }
+
+    return rule;
+}
+
+void fault_injector::add_rule(syscall_fault_rule rule)
+{
+    this->rules_.push_back(std::move(rule));
+}
+
+void fault_injector::clear_rules()
+{
+    this->rules_.clear();
+}
+
+void fault_injector::set_fault_input(const std::span<const uint8_t> input)
+{
+    this->input_.assign(input.begin(), input.end());
+    this->input_position_ = 0;
+}
+
+bool fault_injector::apply(x86_64_emulator& emu, const std::string& syscall_name)
+{
+    if (!this->is_active())
+    {
+        return false;
+    }
+
+    return this->apply_rules(emu, syscall_name) || this->apply_input(emu, syscall_name);
+}
+
+std::optional<uint8_t> fault_injector::read_input()
+{
+    if (this->input_position_ >= this->input_.size())
+    {
+        return std::nullopt;
+    }
+
+    return this->input_[this->input_position_++];
+}
+
+bool fault_injector::apply_rules(x86_64_emulator& emu, const std::string& syscall_name)
+{
+    const auto is_targeted = std::ranges::any_of(this->rules_, [&](const syscall_fault_rule& rule) {
+        return rule.syscall == syscall_name; //
+    });
+
+    if (!is_targeted)
+    {
+        return false;
+    }
+
+    const auto call = this->call_counts_[syscall_name]++;
+
+    for (const auto& rule : this->rules_)
+    {
+        if (rule.syscall != syscall_name || call < rule.first_call)
+        {
+            continue;
+        }
+
+        if (rule.count != 0 && call - rule.first_call >= rule.count)
+        {
+            continue;
+        }
+
+        this->inject(emu, syscall_name, rule.action, rule.status, rule.truncated_length);
+        return rule.action == fault_action::fail;
+    }
+
+    return false;
+}
+
+bool fault_injector::apply_input(x86_64_emulator& emu, const std::string& syscall_name)
+{
+    const auto* syscall = find_fallible_syscall(syscall_name);
+    if (!syscall)
+    {
+        return false;
+    }
+
+    // One in eight invocations fails for random input, the remaining bits select the kind of fault
+    const auto decision = this->read_input();
+    if (!decision || (*decision & 7) != 0)
+    {
+        return false;
+    }
+
+    if (syscall->length_argument && (*decision & 8) != 0)
+    {
+        const auto length = get_function_argument(emu, *syscall->length_argument, true) & 0xFFFFFFFF;
+        const auto fraction = this->read_input().value_or(0);
+        const auto truncated_length = static_cast<uint32_t>((length * fraction) / 0x100);
+
+        this->inject(emu, syscall_name, fault_action::truncate, STATUS_SUCCESS, truncated_length);
+        return false;
+    }
+
+    this->inject(emu, syscall_name, fault_action::fail, syscall->status, 0);
+    return true;
+}
+
+void fault_injector::inject(x86_64_emulator& emu, const std::string& syscall_name, const fault_action action,
+                            const NTSTATUS status, const uint32_t truncated_length)
+{
+    if (action == fault_action::fail)
+    {
+        ++this->injected_faults_;
+        emu.reg<uint64_t>(x86_register::rax, status);
+        return;
+    }
+
+    const auto* syscall = find_fallible_syscall(syscall_name);
+    if (!syscall || !syscall->length_argument)
+    {
+        return;
+    }
+
+    const auto length = get_function_argument(emu, *syscall->length_argument, true) & 0xFFFFFFFF;
+    if (length <= truncated_length)
+    {
+        return;
+    }
+
+    ++this->injected_faults_;
+    set_function_argument(emu, *syscall->length_argument, truncated_length, true);
+}
+
+void fault_injector::serialize(utils::buffer_serializer& buffer) const
+{
+    buffer.write_map(this->call_counts_);
+    buffer.write(this->injected_faults_);
+}
+
+void fault_injector::deserialize(utils::buffer_deserializer& buffer)
+{
+    buffer.read_map(this->call_counts_);
+    buffer.read(this->injected_faults_);
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "std_include.hpp"
+
+#include <arch_emulator.hpp>
+#include <serialization.hpp>
+
+enum class fault_action : uint8_t
+{
+    // The handler does not run, the syscall returns the rule's status
+    fail,
+    // The handler runs with the output buffer length argument reduced
+    truncate,
+};
+
+struct syscall_fault_rule
+{
+    std::string syscall{};
+    fault_action action{fault_action::fail};
+    NTSTATUS status{STATUS_UNSUCCESSFUL};
+    uint32_t truncated_length{0};
+
+    // Zero-based invocation of the syscall the fault starts at and the number of
+    // consecutive invocations it applies to, 0 for all following ones
+    uint64_t first_call{0};
+    uint64_t count{1};
+};
+
+// Format: <syscall>[:<status>[:<first call>[:<count>]]], numbers may be hexadecimal
+syscall_fault_rule parse_syscall_fault_rule(std::string_view text);
+
+// Forces syscalls to fail or to see shorter output buffers, either following a fixed
+// schedule of rules or driven by fault input bytes supplied by a fuzzer.
+// Invocation counters are part of the serialized state, rules and fault input are not.
+class fault_injector
+{
+  public:
+    void add_rule(syscall_fault_rule rule);
+    void clear_rules();
+
+    // Every invocation of a fallible syscall consumes input to decide whether and how it fails.
+    // Exhausted input lets all further syscalls pass.
+    void set_fault_input(std::span<const uint8_t> input);
+
+    bool is_active() const
+    {
+        return !this->rules_.empty() || this->input_position_ < this->input_.size();
+    }
+
+    // Returns true if the syscall was failed and its handler must not run
+    bool apply(x86_64_emulator& emu, const std::string& syscall_name);
+
+    uint64_t get_injected_faults() const
+    {
+        return this->injected_faults_;
+    }
+
+    void serialize(utils::buffer_serializer& buffer) const;
+    void deserialize(utils::buffer_deserializer& buffer);
+
+  private:
+    std::vector<syscall_fault_rule> rules_{};
+    std::vector<uint8_t> input_{};
+    size_t input_position_{0};
+
+    std::map<std::string, uint64_t> call_counts_{};
+    uint64_t injected_faults_{0};
+
+    std::optional<uint8_t> read_input();
+    bool apply_rules(x86_64_emulator& emu, const std::string& syscall_name);
+    bool apply_input(x86_64_emulator& emu, const std::string& syscall_name);
+    void inject(x86_64_emulator& emu, const std::string& syscall_name, fault_action action, NTSTATUS status,
+                uint32_t truncated_length);
+};
@@ -0,0 +1,150 @@
+#include "std_include.hpp"
+#include "file_overlay.hpp"
+
+#include <utils/io.hpp>
+
+std::u16string file_overlay::get_key(const windows_path& path)
+{
+    auto key = utils::string::to_lower(path.u16string());
+    if (key.ends_with(u'\\'))
+    {
+        key.pop_back();
+    }
+
+    return key;
+}
+
+const overlay_node* file_overlay::find(const windows_path& path) const
+{
+    const auto entry = this->nodes_.find(get_key(path));
+    return entry == this->nodes_.end() ? nullptr : &entry->second;
+}
+
+overlay_node* file_overlay::find(const windows_path& path)
+{
+    const auto entry = this->nodes_.find(get_key(path));
+    return entry == this->nodes_.end() ? nullptr : &entry->second;
+}
+
+bool file_overlay::hides_lower(const windows_path& path) const
+{
+    auto current = path;
+    bool is_self = true;
+
+    while (true)
+    {
+        if (const auto* node = this->find(current))
+        {
+            if (node->deleted || (!is_self && node->opaque))
+            {
+                return true;
+            }
+        }
+
+        auto parent = current.parent();
+        if (parent == current)
+        {
+            return false;
+        }
+
+        current = std::move(parent);
+        is_self = false;
+    }
+}
+
+overlay_node& file_overlay::create_node(const windows_path& path)
+{
+    auto& node = this->nodes_[get_key(path)];
+    node = {};
+    node.path = path;
+    return node;
+}
+
+overlay_node& file_overlay::create_file(const windows_path& path, std::vector<std::byte> data)
+{
+    auto& node = this->create_node(path);
+    node.data = std::move(data);
+    return node;
+}
+
+overlay_node& file_overlay::create_directory(const windows_path& path)
+{
+    const auto* existing = this->find(path);
+    const auto was_deleted = existing && existing->deleted;
+
+    auto& node = this->create_node(path);
+    node.is_directory = true;
+    node.opaque = was_deleted;
+    return node;
+}
+
+void file_overlay::remove(const windows_path& path)
+{
+    const auto key = get_key(path);
+    const auto prefix = key + u'\\';
+
+    for (auto i = this->nodes_.lower_bound(prefix); i != this->nodes_.end() && i->first.starts_with(prefix);)
+    {
+        i = this->nodes_.erase(i);
+    }
+
+    auto& node = this->create_node(path);
+    node.deleted = true;
+}
+
+std::vector<const overlay_node*> file_overlay::get_children(const windows_path& directory) const
+{
+    std::vector<const overlay_node*> children{};
+    const auto prefix = get_key(directory) + u'\\';
+
+    for (auto i = this->nodes_.lower_bound(prefix); i != this->nodes_.end() && i->first.starts_with(prefix); ++i)
+    {
+        if (i->first.find(u'\\', prefix.size()) == std::u16string::npos)
+        {
+            children.push_back(&i->second);
+        }
+    }
+
+    return children;
+}
+
+size_t file_overlay::export_files(const std::filesystem::path& target) const
+{
+    size_t exported_files = 0;
+    std::error_code ec{};
+
+    for (const auto& node : this->nodes_ | std::views::values)
+    {
+        if (node.deleted)
+        {
+            continue;
+        }
+
+        const auto path = target / node.path.to_portable_path();
+
+        if (node.is_directory)
+        {
+            std::filesystem::create_directories(path, ec);
+            continue;
+        }
+
+        std::filesystem::create_directories(path.parent_path(), ec);
+
+        if (utils::io::write_file(path, node.data))
+        {
+            ++exported_files;
+        }
+    }
+
+    return exported_files;
+}
+
+void file_overlay::serialize(utils::buffer_serializer& buffer) const
+{
+    buffer.write_map(this->nodes_);
+}
+
+void file_overlay::deserialize(utils::buffer_deserializer& buffer)
+{
+    buffer.read_map(this->nodes_);
+}
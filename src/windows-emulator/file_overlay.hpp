@@ -0,0 +1,64 @@
+#pragma once
+
+#include "windows_path.hpp"
+
+struct overlay_node
+{
+    windows_path path{};
+    bool is_directory{};
+    bool deleted{};
+    bool opaque{};
+    std::vector<std::byte> data{};
+
+    void serialize(utils::buffer_serializer& buffer) const
+    {
+        buffer.write(this->path);
+        buffer.write(this->is_directory);
+        buffer.write(this->deleted);
+        buffer.write(this->opaque);
+        buffer.write_vector(this->data);
+    }
+
+    void deserialize(utils::buffer_deserializer& buffer)
+    {
+        buffer.read(this->path);
+        buffer.read(this->is_directory);
+        buffer.read(this->deleted);
+        buffer.read(this->opaque);
+        buffer.read_vector(this->data);
+    }
+};
+
+// In-memory upper layer over the read-only emulation root.
+// Deleted entries are recorded as whiteouts that hide the lower layer,
+// directories recreated over a whiteout are opaque.
+class file_overlay
+{
+  public:
+    const overlay_node* find(const windows_path& path) const;
+    overlay_node* find(const windows_path& path);
+
+    bool hides_lower(const windows_path& path) const;
+
+    overlay_node& create_file(const windows_path& path, std::vector<std::byte> data = {});
+    overlay_node& create_directory(const windows_path& path);
+    void remove(const windows_path& path);
+
+    std::vector<const overlay_node*> get_children(const windows_path& directory) const;
+
+    size_t export_files(const std::filesystem::path& target) const;
+
+    bool empty() const
+    {
+        return this->nodes_.empty();
+    }
+
+    void serialize(utils::buffer_serializer& buffer) const;
+    void deserialize(utils::buffer_deserializer& buffer);
+
+  private:
+    std::map<std::u16string, overlay_node> nodes_{};
+
+    static std::u16string get_key(const windows_path& path);
+    overlay_node& create_node(const windows_path& path);
+};
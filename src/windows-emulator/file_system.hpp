@@ -1,6 +1,9 @@
 #pragma once
 #include "std_include.hpp"
 #include "windows_path.hpp"
+#include "file_overlay.hpp"
+
+#include <utils/io.hpp>
 
 class file_system
 {
@@ -137,7 +140,89 @@ class file_system
         this->mappings_[std::move(src)] = std::move(dest);
     }
 
+    // Redirects guest modifications into memory, the root stays untouched
+    void enable_overlay()
+    {
+        if (!this->overlay_)
+        {
+            this->overlay_.emplace();
+        }
+    }
+
+    file_overlay* overlay()
+    {
+        return this->overlay_ ? &*this->overlay_ : nullptr;
+    }
+
+    const file_overlay* overlay() const
+    {
+        return this->overlay_ ? &*this->overlay_ : nullptr;
+    }
+
+    // Registers file content under a guest path without backing it by the root.
+    // Memory files live in the overlay, which makes guest modifications stay in memory as well.
+    void add_memory_file(const windows_path& path, std::vector<std::byte> data)
+    {
+        this->enable_overlay();
+        this->overlay_->create_file(path, std::move(data));
+    }
+
+    const overlay_node* find_overlay_file(const windows_path& path) const
+    {
+        if (!this->overlay_)
+        {
+            return nullptr;
+        }
+
+        const auto* node = this->overlay_->find(path);
+        if (!node || node->deleted || node->is_directory)
+        {
+            return nullptr;
+        }
+
+        return node;
+    }
+
+    bool read_file(const windows_path& path, std::vector<std::byte>& data) const
+    {
+        if (!path.is_absolute())
+        {
+            return false;
+        }
+
+        if (const auto* node = this->find_overlay_file(path))
+        {
+            data = node->data;
+            return true;
+        }
+
+        if (this->overlay_ && this->overlay_->hides_lower(path))
+        {
+            return false;
+        }
+
+        return utils::io::read_file(this->translate(path), &data);
+    }
+
+    void serialize(utils::buffer_serializer& buffer) const
+    {
+        buffer.write_optional(this->overlay_);
+    }
+
+    void deserialize(utils::buffer_deserializer& buffer)
+    {
+        const auto overlay_enabled = this->overlay_.has_value();
+        buffer.read_optional(this->overlay_);
+
+        // A snapshot without overlay must not make a configured overlay write through to the root
+        if (overlay_enabled)
+        {
+            this->enable_overlay();
+        }
+    }
+
   private:
     std::filesystem::path root_{};
     std::unordered_map<windows_path, std::filesystem::path> mappings_{};
+    std::optional<file_overlay> overlay_{};
 };
@@ -21,6 +21,8 @@ struct handle_types
         token,
         window,
         timer,
+        io_completion,
+        worker_factory,
     };
 };
 
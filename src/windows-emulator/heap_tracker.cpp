@@ -0,0 +1,229 @@
+#include "std_include.hpp"
+#include "heap_tracker.hpp"
+#include "emulator_utils.hpp"
+
+heap_tracker::heap_tracker(callbacks& cb, const bool enabled)
+    : callbacks_(&cb),
+      enabled_(enabled)
+{
+}
+
+void heap_tracker::setup(const mapped_module& ntdll)
+{
+    if (!this->enabled_)
+    {
+        return;
+    }
+
+    this->allocate_heap_ = ntdll.find_export("RtlAllocateHeap");
+    this->reallocate_heap_ = ntdll.find_export("RtlReAllocateHeap");
+    this->free_heap_ = ntdll.find_export("RtlFreeHeap");
+}
+
+void heap_tracker::on_instruction(x86_64_emulator& emu, const uint32_t thread_id, const uint64_t address)
+{
+    if (address == this->allocate_heap_)
+    {
+        this->on_call(emu, thread_id, call_type::allocate);
+    }
+    else if (address == this->reallocate_heap_)
+    {
+        this->on_call(emu, thread_id, call_type::reallocate);
+    }
+    else if (address == this->free_heap_)
+    {
+        this->on_call(emu, thread_id, call_type::free);
+    }
+    else if (!this->pending_calls_.empty())
+    {
+        this->on_return(emu, thread_id, address);
+    }
+}
+
+const heap_allocation* heap_tracker::find_allocation(const uint64_t address) const
+{
+    auto entry = this->allocations_.upper_bound(address);
+    if (entry == this->allocations_.begin())
+    {
+        return nullptr;
+    }
+
+    --entry;
+
+    if (!entry->second.contains(address))
+    {
+        return nullptr;
+    }
+
+    return &entry->second;
+}
+
+void heap_tracker::on_call(x86_64_emulator& emu, const uint32_t thread_id, const call_type type)
+{
+    pending_call call{};
+    call.type = type;
+    call.thread_id = thread_id;
+    call.return_address = emu.read_stack(0);
+    call.stack_pointer = emu.read_stack_pointer() + sizeof(uint64_t);
+    call.heap = get_function_argument(emu, 0);
+
+    // RtlAllocateHeap(heap, flags, size), RtlReAllocateHeap(heap, flags, base, size), RtlFreeHeap(heap, flags, base)
+    switch (type)
+    {
+    case call_type::allocate:
+        call.size = get_function_argument(emu, 2);
+        break;
+    case call_type::reallocate:
+        call.base = get_function_argument(emu, 2);
+        call.size = get_function_argument(emu, 3);
+        break;
+    case call_type::free:
+        call.base = get_function_argument(emu, 2);
+        break;
+    }
+
+    // Calls of this thread that were left through an exception or a longjmp can never return.
+    // Their frames are at or below the new one.
+    std::erase_if(this->pending_calls_, [&](const pending_call& pending) {
+        return pending.thread_id == thread_id && pending.stack_pointer <= call.stack_pointer;
+    });
+
+    this->pending_calls_.push_back(call);
+}
+
+void heap_tracker::on_return(x86_64_emulator& emu, const uint32_t thread_id, const uint64_t address)
+{
+    for (auto i = this->pending_calls_.size(); i > 0; --i)
+    {
+        const auto& call = this->pending_calls_[i - 1];
+        if (call.return_address != address || call.thread_id != thread_id)
+        {
+            continue;
+        }
+
+        if (call.stack_pointer != emu.read_stack_pointer())
+        {
+            continue;
+        }
+
+        const auto completed = call;
+        this->pending_calls_.erase(this->pending_calls_.begin() + static_cast<ptrdiff_t>(i - 1));
+        this->complete_call(completed, emu.reg(x86_register::rax));
+        return;
+    }
+}
+
+void heap_tracker::complete_call(const pending_call& call, const uint64_t result)
+{
+    heap_allocation allocation{};
+    allocation.address = result;
+    allocation.size = call.size;
+    allocation.heap = call.heap;
+    allocation.caller = call.return_address;
+    allocation.thread_id = call.thread_id;
+
+    switch (call.type)
+    {
+    case call_type::allocate:
+        if (result)
+        {
+            ++this->statistics_.allocations;
+            this->insert_allocation(allocation);
+        }
+        break;
+
+    case call_type::reallocate:
+        if (result)
+        {
+            ++this->statistics_.reallocations;
+            this->remove_allocation(call.base);
+            this->insert_allocation(allocation);
+        }
+        break;
+
+    case call_type::free:
+        // The result is a BOOLEAN
+        if (static_cast<uint8_t>(result) != 0)
+        {
+            ++this->statistics_.frees;
+            this->remove_allocation(call.base);
+        }
+        break;
+    }
+}
+
+void heap_tracker::insert_allocation(heap_allocation allocation)
+{
+    this->statistics_.allocated_bytes += allocation.size;
+
+    auto& entry = this->allocations_[allocation.address];
+    entry = std::move(allocation);
+
+    this->callbacks_->on_heap_allocate(entry);
+}
+
+void heap_tracker::remove_allocation(const uint64_t address)
+{
+    const auto entry = this->allocations_.find(address);
+    if (entry == this->allocations_.end())
+    {
+        return;
+    }
+
+    const auto allocation = entry->second;
+    this->allocations_.erase(entry);
+
+    this->callbacks_->on_heap_free(allocation);
+}
+
+void heap_tracker::pending_call::serialize(utils::buffer_serializer& buffer) const
+{
+    buffer.write(this->type);
+    buffer.write(this->thread_id);
+    buffer.write(this->return_address);
+    buffer.write(this->stack_pointer);
+    buffer.write(this->heap);
+    buffer.write(this->base);
+    buffer.write(this->size);
+}
+
+void heap_tracker::pending_call::deserialize(utils::buffer_deserializer& buffer)
+{
+    buffer.read(this->type);
+    buffer.read(this->thread_id);
+    buffer.read(this->return_address);
+    buffer.read(this->stack_pointer);
+    buffer.read(this->heap);
+    buffer.read(this->base);
+    buffer.read(this->size);
+}
+
+void heap_tracker::serialize(utils::buffer_serializer& buffer) const
+{
+    buffer.write(this->allocate_heap_);
+    buffer.write(this->reallocate_heap_);
+    buffer.write(this->free_heap_);
+    buffer.write_map(this->allocations_);
+    buffer.write_vector(this->pending_calls_);
+    buffer.write(this->statistics_);
+}
+
+void heap_tracker::deserialize(utils::buffer_deserializer& buffer)
+{
+    buffer.read(this->allocate_heap_);
+    buffer.read(this->reallocate_heap_);
+    buffer.read(this->free_heap_);
+    buffer.read_map(this->allocations_);
+    buffer.read_vector(this->pending_calls_);
+    buffer.read(this->statistics_);
+
+    // State saved by a tracking emulator must not activate tracking here
+    if (!this->enabled_)
+    {
+        this->allocate_heap_ = 0;
+        this->reallocate_heap_ = 0;
+        this->free_heap_ = 0;
+        this->allocations_.clear();
+        this->pending_calls_.clear();
+    }
+}
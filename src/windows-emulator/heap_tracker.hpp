@@ -0,0 +1,138 @@
+#pragma once
+
+#include "std_include.hpp"
+
+#include <arch_emulator.hpp>
+#include <serialization.hpp>
+#include <utils/function.hpp>
+
+#include "module/mapped_module.hpp"
+
+struct heap_allocation
+{
+    uint64_t address{};
+    uint64_t size{};
+    uint64_t heap{};
+    uint64_t caller{};
+    uint32_t thread_id{};
+
+    uint64_t end() const
+    {
+        return this->address + this->size;
+    }
+
+    bool contains(const uint64_t value) const
+    {
+        // Zero sized blocks still own their base address
+        return value == this->address || (value > this->address && value < this->end());
+    }
+
+    void serialize(utils::buffer_serializer& buffer) const
+    {
+        buffer.write(this->address);
+        buffer.write(this->size);
+        buffer.write(this->heap);
+        buffer.write(this->caller);
+        buffer.write(this->thread_id);
+    }
+
+    void deserialize(utils::buffer_deserializer& buffer)
+    {
+        buffer.read(this->address);
+        buffer.read(this->size);
+        buffer.read(this->heap);
+        buffer.read(this->caller);
+        buffer.read(this->thread_id);
+    }
+};
+
+struct heap_statistics
+{
+    uint64_t allocations{};
+    uint64_t reallocations{};
+    uint64_t frees{};
+    uint64_t allocated_bytes{};
+};
+
+// Maintains the live allocations of the guest heaps. The exported ntdll heap functions are
+// observed from the regular instruction callback: entries record the arguments and the return
+// address, the return to that address with the matching stack pointer completes the call.
+class heap_tracker
+{
+  public:
+    struct callbacks
+    {
+        utils::callback_list<void(const heap_allocation& allocation)> on_heap_allocate{};
+        utils::callback_list<void(const heap_allocation& allocation)> on_heap_free{};
+    };
+
+    using allocation_map = std::map<uint64_t, heap_allocation>;
+
+    heap_tracker(callbacks& cb, bool enabled);
+
+    // Resolves the heap entry points, does nothing unless tracking is enabled
+    void setup(const mapped_module& ntdll);
+
+    bool is_active() const
+    {
+        return this->allocate_heap_ != 0;
+    }
+
+    void on_instruction(x86_64_emulator& emu, uint32_t thread_id, uint64_t address);
+
+    // Returns the live allocation owning the address, if any
+    const heap_allocation* find_allocation(uint64_t address) const;
+
+    const allocation_map& get_allocations() const
+    {
+        return this->allocations_;
+    }
+
+    const heap_statistics& get_statistics() const
+    {
+        return this->statistics_;
+    }
+
+    void serialize(utils::buffer_serializer& buffer) const;
+    void deserialize(utils::buffer_deserializer& buffer);
+
+  private:
+    enum class call_type : uint8_t
+    {
+        allocate,
+        reallocate,
+        free,
+    };
+
+    struct pending_call
+    {
+        call_type type{};
+        uint32_t thread_id{};
+        uint64_t return_address{};
+        uint64_t stack_pointer{};
+        uint64_t heap{};
+        uint64_t base{};
+        uint64_t size{};
+
+        void serialize(utils::buffer_serializer& buffer) const;
+        void deserialize(utils::buffer_deserializer& buffer);
+    };
+
+    callbacks* callbacks_{};
+    bool enabled_{false};
+
+    uint64_t allocate_heap_{};
+    uint64_t reallocate_heap_{};
+    uint64_t free_heap_{};
+
+    allocation_map allocations_{};
+    std::vector<pending_call> pending_calls_{};
+    heap_statistics statistics_{};
+
+    void on_call(x86_64_emulator& emu, uint32_t thread_id, call_type type);
+    void on_return(x86_64_emulator& emu, uint32_t thread_id, uint64_t address);
+    void complete_call(const pending_call& call, uint64_t result);
+
+    void insert_allocation(heap_allocation allocation);
+    void remove_allocation(uint64_t address);
+};
@@ -0,0 +1,258 @@
+#include "std_include.hpp"
+#include "memory_diff.hpp"
+
+#include <address_utils.hpp>
+
+namespace
+{
+    // Differing runs separated by fewer equal bytes are reported as one delta
+    constexpr size_t DELTA_MERGE_DISTANCE = 8;
+
+    using page_buffer = std::array<std::byte, TRACKING_PAGE_SIZE>;
+
+    size_t hash_page(const std::span<const std::byte> page)
+    {
+        const std::string_view view(reinterpret_cast<const char*>(page.data()), page.size());
+        return std::hash<std::string_view>{}(view);
+    }
+
+    void read_page(const memory_interface& memory, const uint64_t address, page_buffer& page)
+    {
+        if (!memory.try_read_memory(address, page.data(), page.size()))
+        {
+            page.fill(std::byte{0});
+        }
+    }
+
+    std::vector<memory_delta> compute_deltas(const uint64_t address, const std::span<const std::byte> old_data,
+                                             const std::span<const std::byte> new_data)
+    {
+        std::vector<memory_delta> deltas{};
+
+        size_t offset = 0;
+        while (offset < new_data.size())
+        {
+            if (old_data[offset] == new_data[offset])
+            {
+                ++offset;
+                continue;
+            }
+
+            const auto start = offset;
+            auto end = offset + 1;
+
+            for (auto i = end; i < new_data.size() && i - end < DELTA_MERGE_DISTANCE; ++i)
+            {
+                if (old_data[i] != new_data[i])
+                {
+                    end = i + 1;
+                }
+            }
+
+            const auto old_run = old_data.subspan(start, end - start);
+            const auto new_run = new_data.subspan(start, end - start);
+
+            deltas.push_back(memory_delta{
+                .address = address + start,
+                .old_data = {old_run.begin(), old_run.end()},
+                .new_data = {new_run.begin(), new_run.end()},
+            });
+
+            offset = end;
+        }
+
+        return deltas;
+    }
+
+    changed_page make_page(const uint64_t address, const page_change change, const tracked_region* old_region,
+                           const tracked_region* new_region)
+    {
+        changed_page page{};
+        page.address = address;
+        page.change = change;
+        page.old_permissions = old_region ? old_region->permissions : memory_permission::none;
+        page.new_permissions = new_region ? new_region->permissions : memory_permission::none;
+        page.allocation_base = new_region ? new_region->allocation_base : old_region->allocation_base;
+
+        return page;
+    }
+}
+
+memory_change_tracker::memory_change_tracker(const bool keep_contents)
+    : keep_contents_(keep_contents)
+{
+}
+
+void memory_change_tracker::add_region(const tracked_region& region, const std::span<const std::byte> data)
+{
+    assert(this->regions_.empty() || this->regions_.back().address < region.address);
+
+    this->regions_.push_back(region);
+
+    for (size_t offset = 0; offset < region.length; offset += TRACKING_PAGE_SIZE)
+    {
+        const auto page = data.subspan(offset, std::min(TRACKING_PAGE_SIZE, region.length - offset));
+        const auto address = region.address + offset;
+
+        this->page_hashes_[address] = hash_page(page);
+
+        if (this->keep_contents_ && is_writable(region.permissions))
+        {
+            this->page_contents_[address].assign(page.begin(), page.end());
+        }
+    }
+}
+
+void memory_change_tracker::mark_dirty(const uint64_t address, const size_t size)
+{
+    const auto end = page_align_up(address + std::max<size_t>(size, 1));
+
+    for (auto page = page_align_down(address); page < end; page += TRACKING_PAGE_SIZE)
+    {
+        this->dirty_pages_.insert(page);
+    }
+}
+
+void memory_change_tracker::capture_contents(const memory_interface& memory, const uint64_t address,
+                                             const size_t size)
+{
+    if (!this->keep_contents_)
+    {
+        return;
+    }
+
+    const auto end = page_align_up(address + size);
+
+    for (auto page = page_align_down(address); page < end; page += TRACKING_PAGE_SIZE)
+    {
+        if (!this->page_hashes_.contains(page) || this->page_contents_.contains(page))
+        {
+            continue;
+        }
+
+        page_buffer data{};
+        read_page(memory, page, data);
+
+        this->page_contents_[page].assign(data.begin(), data.end());
+    }
+}
+
+void memory_change_tracker::compare_page(memory_diff& result, const memory_interface& memory, const uint64_t address,
+                                         const tracked_region& old_region, const tracked_region& new_region) const
+{
+    if (this->dirty_pages_.contains(address))
+    {
+        ++result.dirty_pages;
+    }
+    else
+    {
+        ++result.hashed_pages;
+    }
+
+    page_buffer data{};
+    read_page(memory, address, data);
+
+    const auto hash = this->page_hashes_.find(address);
+    const auto is_modified = hash == this->page_hashes_.end() || hash->second != hash_page(data);
+
+    if (!is_modified && old_region.permissions == new_region.permissions)
+    {
+        return;
+    }
+
+    auto page = make_page(address, is_modified ? page_change::modified : page_change::protection, &old_region,
+                          &new_region);
+
+    const auto contents = this->page_contents_.find(address);
+    if (is_modified && contents != this->page_contents_.end())
+    {
+        page.deltas = compute_deltas(address, contents->second, data);
+    }
+
+    result.pages.push_back(std::move(page));
+}
+
+// Sweeps the old and the new layout in parallel. Only pages whose layout changed, pages
+// written since tracking started and, if requested, writable pages are looked at.
+memory_diff memory_change_tracker::diff(const std::vector<tracked_region>& current, const memory_interface& memory,
+                                        const bool verify_untracked) const
+{
+    constexpr auto no_address = std::numeric_limits<uint64_t>::max();
+
+    memory_diff result{};
+
+    size_t old_index = 0;
+    size_t new_index = 0;
+    uint64_t position = 0;
+
+    while (old_index < this->regions_.size() || new_index < current.size())
+    {
+        const auto* old_region = old_index < this->regions_.size() ? &this->regions_[old_index] : nullptr;
+        const auto* new_region = new_index < current.size() ? &current[new_index] : nullptr;
+
+        const auto old_start = old_region ? std::max(old_region->address, position) : no_address;
+        const auto new_start = new_region ? std::max(new_region->address, position) : no_address;
+        const auto old_end = old_region ? old_region->address + old_region->length : no_address;
+        const auto new_end = new_region ? new_region->address + new_region->length : no_address;
+
+        const auto start = std::min(old_start, new_start);
+        const auto in_old = old_start == start;
+        const auto in_new = new_start == start;
+        const auto end = std::min(in_old ? old_end : old_start, in_new ? new_end : new_start);
+
+        if (in_old && !in_new)
+        {
+            for (auto address = start; address < end; address += TRACKING_PAGE_SIZE)
+            {
+                result.pages.push_back(make_page(address, page_change::decommitted, old_region, nullptr));
+            }
+        }
+        else if (!in_old && in_new)
+        {
+            for (auto address = start; address < end; address += TRACKING_PAGE_SIZE)
+            {
+                auto page = make_page(address, page_change::committed, nullptr, new_region);
+
+                // Fresh memory starts out zeroed
+                if (this->keep_contents_)
+                {
+                    page_buffer data{};
+                    read_page(memory, address, data);
+                    page.deltas = compute_deltas(address, page_buffer{}, data);
+                }
+
+                result.pages.push_back(std::move(page));
+            }
+        }
+        else if (old_region->permissions != new_region->permissions ||
+                 (verify_untracked && is_writable(new_region->permissions)))
+        {
+            for (auto address = start; address < end; address += TRACKING_PAGE_SIZE)
+            {
+                this->compare_page(result, memory, address, *old_region, *new_region);
+            }
+        }
+        else
+        {
+            for (auto page = this->dirty_pages_.lower_bound(start); page != this->dirty_pages_.end() && *page < end;
+                 ++page)
+            {
+                this->compare_page(result, memory, *page, *old_region, *new_region);
+            }
+        }
+
+        position = end;
+
+        if (old_region && old_end <= position)
+        {
+            ++old_index;
+        }
+
+        if (new_region && new_end <= position)
+        {
+            ++new_index;
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "std_include.hpp"
+
+#include <memory_interface.hpp>
+#include <memory_permission.hpp>
+
+constexpr size_t TRACKING_PAGE_SIZE = 0x1000;
+
+enum class page_change : uint8_t
+{
+    // Contents differ, permissions may have changed as well
+    modified,
+    // Only the permissions differ
+    protection,
+    committed,
+    decommitted,
+};
+
+// Contiguous run of bytes that differ
+struct memory_delta
+{
+    uint64_t address{};
+    std::vector<std::byte> old_data{};
+    std::vector<std::byte> new_data{};
+};
+
+struct changed_page
+{
+    uint64_t address{};
+    page_change change{};
+    memory_permission old_permissions{};
+    memory_permission new_permissions{};
+    uint64_t allocation_base{};
+
+    // Name of the module the page belongs to, empty for other memory
+    std::string module{};
+
+    // Only available if the contents were kept when tracking started
+    std::vector<memory_delta> deltas{};
+};
+
+struct memory_diff
+{
+    std::vector<changed_page> pages{};
+
+    // Pages compared because a write to them was observed
+    uint64_t dirty_pages{};
+    // Pages compared by hash because writes to them may have gone unobserved
+    uint64_t hashed_pages{};
+};
+
+struct tracked_region
+{
+    uint64_t address{};
+    size_t length{};
+    memory_permission permissions{};
+    uint64_t allocation_base{};
+};
+
+// Committed memory state at the point tracking started, plus the pages written since.
+// Writes are reported through mark_dirty, pages that can be written without being
+// observed are verified by hash. Contents are only kept for writable pages.
+class memory_change_tracker
+{
+  public:
+    explicit memory_change_tracker(bool keep_contents);
+
+    void add_region(const tracked_region& region, std::span<const std::byte> data);
+
+    void mark_dirty(uint64_t address, size_t size);
+
+    // Keeps the original contents of pages that become writable after tracking started
+    void capture_contents(const memory_interface& memory, uint64_t address, size_t size);
+
+    // Regions must be sorted and describe the currently committed memory
+    memory_diff diff(const std::vector<tracked_region>& current, const memory_interface& memory,
+                     bool verify_untracked) const;
+
+  private:
+    bool keep_contents_{false};
+
+    std::vector<tracked_region> regions_{};
+    std::unordered_map<uint64_t, size_t> page_hashes_{};
+    std::unordered_map<uint64_t, std::vector<std::byte>> page_contents_{};
+    std::set<uint64_t> dirty_pages_{};
+
+    void compare_page(memory_diff& result, const memory_interface& memory, uint64_t address,
+                      const tracked_region& old_region, const tracked_region& new_region) const;
+};
@@ -6,6 +6,7 @@
 
 #include <vector>
 #include <optional>
+#include <algorithm>
 #include <stdexcept>
 #include <cassert>
 
@@ -95,9 +96,7 @@ namespace utils
 
 void memory_manager::update_layout_version()
 {
-#if MOMO_REFLECTION_LEVEL > 0
     this->layout_version_.fetch_add(1, std::memory_order_relaxed);
-#endif
 }
 
 memory_stats memory_manager::compute_memory_stats() const
@@ -129,6 +128,14 @@ void memory_manager::serialize_memory_state(utils::buffer_serializer& buffer, co
         return;
     }
 
+    if (this->parked_)
+    {
+        this->parked_->for_each_region([&](uint64_t, memory_permission, const std::span<const std::byte> data) {
+            buffer.write(data.data(), data.size()); //
+        });
+        return;
+    }
+
     std::vector<uint8_t> data{};
 
     for (const auto& reserved_region : this->reserved_regions_)
@@ -159,6 +166,9 @@ void memory_manager::deserialize_memory_state(utils::buffer_deserializer& buffer
     buffer.read_atomic(this->layout_version_);
     buffer.read_map(this->reserved_regions_);
 
+    // The restored version may collide with one the cursor was built for
+    this->region_cursor_ = {};
+
     if (is_snapshot)
     {
         return;
@@ -206,6 +216,11 @@ bool memory_manager::protect_memory(const uint64_t address, const size_t size, c
         throw std::runtime_error("Cross region protect not supported yet!");
     }
 
+    if (this->change_tracker_ && is_writable(permissions))
+    {
+        this->change_tracker_->capture_contents(*this, address, size);
+    }
+
     std::optional<memory_permission> old_first_permissions{};
 
     auto& committed_regions = entry->second.committed_regions;
@@ -462,6 +477,17 @@ bool memory_manager::release_memory(const uint64_t address, size_t size)
 
 void memory_manager::unmap_all_memory()
 {
+    this->change_tracker_ = std::nullopt;
+
+    // Parked memory is not mapped in the backend anymore
+    if (this->parked_)
+    {
+        this->parked_ = std::nullopt;
+        this->reserved_regions_.clear();
+        this->region_cursor_ = {};
+        return;
+    }
+
     for (const auto& reserved_region : this->reserved_regions_)
     {
         for (const auto& region : reserved_region.second.committed_regions)
@@ -471,6 +497,135 @@ void memory_manager::unmap_all_memory()
     }
 
     this->reserved_regions_.clear();
+    this->region_cursor_ = {};
+}
+
+std::vector<tracked_region> memory_manager::get_committed_layout() const
+{
+    std::vector<tracked_region> layout{};
+
+    for (const auto& reserved_region : this->reserved_regions_)
+    {
+        if (reserved_region.second.is_mmio)
+        {
+            continue;
+        }
+
+        for (const auto& region : reserved_region.second.committed_regions)
+        {
+            layout.push_back(tracked_region{
+                .address = region.first,
+                .length = region.second.length,
+                .permissions = region.second.permissions,
+                .allocation_base = reserved_region.first,
+            });
+        }
+    }
+
+    return layout;
+}
+
+void memory_manager::begin_change_tracking(const bool keep_contents)
+{
+    assert(!this->parked_);
+
+    memory_change_tracker tracker{keep_contents};
+    std::vector<std::byte> data{};
+
+    for (const auto& region : this->get_committed_layout())
+    {
+        data.resize(region.length);
+        this->read_memory(region.address, data.data(), region.length);
+
+        tracker.add_region(region, data);
+    }
+
+    this->change_tracker_ = std::move(tracker);
+}
+
+void memory_manager::end_change_tracking()
+{
+    this->change_tracker_ = std::nullopt;
+}
+
+void memory_manager::mark_dirty(const uint64_t address, const size_t size)
+{
+    if (this->change_tracker_)
+    {
+        this->change_tracker_->mark_dirty(address, size);
+    }
+}
+
+memory_diff memory_manager::diff_memory(const bool verify_untracked) const
+{
+    if (!this->change_tracker_)
+    {
+        throw std::runtime_error("Memory changes are not being tracked");
+    }
+
+    assert(!this->parked_);
+    return this->change_tracker_->diff(this->get_committed_layout(), *this, verify_untracked);
+}
+
+parking_stats memory_manager::park_memory()
+{
+    if (this->parked_)
+    {
+        return this->parked_->get_stats();
+    }
+
+    parked_memory parked{};
+    std::vector<std::byte> data{};
+
+    for (const auto& reserved_region : this->reserved_regions_)
+    {
+        if (reserved_region.second.is_mmio)
+        {
+            continue;
+        }
+
+        for (const auto& region : reserved_region.second.committed_regions)
+        {
+            data.resize(region.second.length);
+            this->read_memory(region.first, data.data(), region.second.length);
+
+            parked.add_region(region.first, region.second.permissions, data);
+        }
+    }
+
+    // Only release the backend memory once everything is captured
+    for (const auto& reserved_region : this->reserved_regions_)
+    {
+        if (reserved_region.second.is_mmio)
+        {
+            continue;
+        }
+
+        for (const auto& region : reserved_region.second.committed_regions)
+        {
+            this->unmap_memory(region.first, region.second.length);
+        }
+    }
+
+    this->parked_ = std::move(parked);
+    return this->parked_->get_stats();
+}
+
+void memory_manager::unpark_memory()
+{
+    if (!this->parked_)
+    {
+        return;
+    }
+
+    const auto parked = std::move(*this->parked_);
+    this->parked_ = std::nullopt;
+
+    parked.for_each_region(
+        [this](const uint64_t address, const memory_permission permissions, const std::span<const std::byte> data) {
+            this->map_memory(address, data.size(), permissions);
+            this->write_memory(address, data.data(), data.size());
+        });
 }
 
 uint64_t memory_manager::allocate_memory(const size_t size, const memory_permission permissions,
@@ -538,12 +693,16 @@ region_info memory_manager::get_region_info(const uint64_t address)
         return result;
     }
 
+    const auto next_region = upper_bound;
     const auto entry = --upper_bound;
     const auto lower_end = entry->first + entry->second.length;
     if (lower_end <= address)
     {
+        const auto upper_end = next_region == this->reserved_regions_.end() ? MAX_ALLOCATION_ADDRESS //
+                                                                              : next_region->first;
+
         result.start = lower_end;
-        result.length = static_cast<size_t>(MAX_ALLOCATION_ADDRESS - result.start);
+        result.length = static_cast<size_t>(upper_end - result.start);
         return result;
     }
 
@@ -570,12 +729,15 @@ region_info memory_manager::get_region_info(const uint64_t address)
         return result;
     }
 
+    const auto next_committed = committed_bound;
     const auto committed_entry = --committed_bound;
     const auto committed_lower_end = committed_entry->first + committed_entry->second.length;
     if (committed_lower_end <= address)
     {
+        const auto upper_end = next_committed == committed_regions.end() ? lower_end : next_committed->first;
+
         result.start = committed_lower_end;
-        result.length = static_cast<size_t>(lower_end - result.start);
+        result.length = static_cast<size_t>(upper_end - result.start);
         return result;
     }
 
@@ -587,6 +749,67 @@ region_info memory_manager::get_region_info(const uint64_t address)
     return result;
 }
 
+region_cursor& memory_manager::get_region_cursor()
+{
+    if (!this->region_cursor_.is_valid_for(this->get_layout_version()))
+    {
+        this->region_cursor_ = this->build_region_cursor();
+    }
+
+    return this->region_cursor_;
+}
+
+region_cursor memory_manager::build_region_cursor() const
+{
+    std::vector<region_info> regions{};
+    regions.reserve(this->reserved_regions_.size() * 2 + 1);
+
+    const auto add_region = [&](const uint64_t start, const uint64_t end, region_info info) {
+        if (start < end)
+        {
+            info.start = start;
+            info.length = static_cast<size_t>(end - start);
+            info.allocation_length = info.is_reserved ? info.allocation_length : info.length;
+            regions.push_back(info);
+        }
+    };
+
+    uint64_t position = MIN_ALLOCATION_ADDRESS;
+
+    for (const auto& [base, reserved_region] : this->reserved_regions_)
+    {
+        add_region(position, base, {});
+
+        region_info reserved{};
+        reserved.allocation_base = base;
+        reserved.allocation_length = reserved_region.length;
+        reserved.is_reserved = true;
+        reserved.initial_permissions = reserved_region.initial_permission;
+
+        auto current = base;
+        const auto end = base + reserved_region.length;
+
+        for (const auto& [committed_base, committed_region] : reserved_region.committed_regions)
+        {
+            add_region(current, committed_base, reserved);
+
+            auto committed = reserved;
+            committed.is_committed = true;
+            committed.permissions = committed_region.permissions;
+
+            current = committed_base + committed_region.length;
+            add_region(committed_base, current, committed);
+        }
+
+        add_region(current, end, reserved);
+        position = std::max(position, end);
+    }
+
+    add_region(position, MAX_ALLOCATION_ADDRESS, {});
+
+    return {std::move(regions), this->get_layout_version()};
+}
+
 memory_manager::reserved_region_map::iterator memory_manager::find_reserved_region(const uint64_t address)
 {
     if (this->reserved_regions_.empty())
@@ -634,6 +857,11 @@ bool memory_manager::try_read_memory(const uint64_t address, void* data, const s
 
 void memory_manager::write_memory(const uint64_t address, const void* data, const size_t size)
 {
+    if (this->change_tracker_)
+    {
+        this->change_tracker_->mark_dirty(address, size);
+    }
+
     this->memory_->write_memory(address, data, size);
 }
 
@@ -658,3 +886,48 @@ void memory_manager::apply_memory_protection(const uint64_t address, const size_
 {
     this->memory_->apply_memory_protection(address, size, permissions);
 }
+
+region_cursor::region_cursor(std::vector<region_info> regions, const uint64_t layout_version)
+    : regions_(std::move(regions)),
+      layout_version_(layout_version)
+{
+}
+
+bool region_cursor::contains(const size_t index, const uint64_t address) const
+{
+    if (index >= this->regions_.size())
+    {
+        return false;
+    }
+
+    const auto& region = this->regions_[index];
+    return address >= region.start && address - region.start < region.length;
+}
+
+const region_info& region_cursor::find(const uint64_t address)
+{
+    if (this->regions_.empty())
+    {
+        throw std::runtime_error("Region cursor has no layout");
+    }
+
+    // Sweeps query the same region again or continue right after it
+    if (this->contains(this->position_, address))
+    {
+        return this->regions_[this->position_];
+    }
+
+    if (this->contains(this->position_ + 1, address))
+    {
+        return this->regions_[++this->position_];
+    }
+
+    const auto entry = std::ranges::upper_bound(this->regions_, address, {}, [](const region_info& region) {
+        return region.start; //
+    });
+
+    const auto index = entry == this->regions_.begin() ? 0 : std::distance(this->regions_.begin(), entry) - 1;
+    this->position_ = static_cast<size_t>(index);
+
+    return this->regions_[this->position_];
+}
@@ -1,9 +1,12 @@
 #pragma once
 #include <map>
 #include <atomic>
+#include <vector>
 #include <cstdint>
 
 #include "memory_region.hpp"
+#include "memory_parking.hpp"
+#include "memory_diff.hpp"
 #include "serialization.hpp"
 
 #include <memory_interface.hpp>
@@ -21,6 +24,29 @@ struct region_info : basic_memory_region
     memory_permission initial_permissions{};
 };
 
+// Flattened snapshot of the address space layout. Every address maps to exactly one
+// entry, so sequential sweeps are answered by advancing to the next entry.
+class region_cursor
+{
+  public:
+    region_cursor() = default;
+    region_cursor(std::vector<region_info> regions, uint64_t layout_version);
+
+    const region_info& find(uint64_t address);
+
+    bool is_valid_for(const uint64_t layout_version) const
+    {
+        return !this->regions_.empty() && this->layout_version_ == layout_version;
+    }
+
+  private:
+    std::vector<region_info> regions_{};
+    uint64_t layout_version_{};
+    size_t position_{};
+
+    bool contains(size_t index, uint64_t address) const;
+};
+
 using mmio_read_callback = std::function<void(uint64_t addr, void* data, size_t size)>;
 using mmio_write_callback = std::function<void(uint64_t addr, const void* data, size_t size)>;
 
@@ -78,6 +104,7 @@ class memory_manager : public memory_interface
     uint64_t find_free_allocation_base(size_t size, uint64_t start = 0) const;
 
     region_info get_region_info(uint64_t address);
+    region_cursor& get_region_cursor();
 
     reserved_region_map::iterator find_reserved_region(uint64_t address);
 
@@ -98,10 +125,39 @@ class memory_manager : public memory_interface
 
     memory_stats compute_memory_stats() const;
 
+    // Moves committed memory out of the backend. The layout is kept, but guest memory
+    // must not be accessed until it is unparked.
+    parking_stats park_memory();
+    void unpark_memory();
+
+    bool is_parked() const
+    {
+        return this->parked_.has_value();
+    }
+
+    // Records the committed memory state that following diffs are relative to.
+    // Keeping the contents of writable pages enables byte level deltas.
+    void begin_change_tracking(bool keep_contents = false);
+    void end_change_tracking();
+
+    bool is_tracking_changes() const
+    {
+        return this->change_tracker_.has_value();
+    }
+
+    // Reports writes that do not go through this manager, like guest stores
+    void mark_dirty(uint64_t address, size_t size);
+
+    // Without verifying untracked pages, only observed writes and layout changes are found
+    memory_diff diff_memory(bool verify_untracked = true) const;
+
   private:
     memory_interface* memory_{};
     reserved_region_map reserved_regions_{};
     std::atomic<std::uint64_t> layout_version_{0};
+    region_cursor region_cursor_{};
+    std::optional<parked_memory> parked_{};
+    std::optional<memory_change_tracker> change_tracker_{};
 
     void map_mmio(uint64_t address, size_t size, mmio_read_callback read_cb, mmio_write_callback write_cb) final;
     void map_memory(uint64_t address, size_t size, memory_permission permissions) final;
@@ -109,4 +165,6 @@ class memory_manager : public memory_interface
     void apply_memory_protection(uint64_t address, size_t size, memory_permission permissions) final;
 
     void update_layout_version();
+    region_cursor build_region_cursor() const;
+    std::vector<tracked_region> get_committed_layout() const;
 };
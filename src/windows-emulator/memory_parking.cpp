@@ -0,0 +1,163 @@
+#include "std_include.hpp"
+#include "memory_parking.hpp"
+
+#include <algorithm>
+#include <utils/compression.hpp>
+
+namespace
+{
+    constexpr size_t PURGE_INTERVAL = 0x1000;
+
+    size_t hash_page(const std::span<const std::byte> page)
+    {
+        const std::string_view view(reinterpret_cast<const char*>(page.data()), page.size());
+        return std::hash<std::string_view>{}(view);
+    }
+
+    bool is_zero_page(const std::span<const std::byte> page)
+    {
+        return std::ranges::all_of(page, [](const std::byte value) {
+            return value == std::byte{0}; //
+        });
+    }
+}
+
+shared_page_pool& shared_page_pool::get()
+{
+    static shared_page_pool pool{};
+    return pool;
+}
+
+std::shared_ptr<const parked_page> shared_page_pool::insert(const std::span<const std::byte> page)
+{
+    assert(page.size() == PARKING_PAGE_SIZE);
+
+    const auto hash = hash_page(page);
+    const std::scoped_lock lock{this->mutex_};
+
+    const auto [begin, end] = this->pages_.equal_range(hash);
+    for (auto i = begin; i != end; ++i)
+    {
+        auto existing = i->second.lock();
+        if (existing && std::ranges::equal(*existing, page))
+        {
+            return existing;
+        }
+    }
+
+    auto new_page = std::make_shared<parked_page>();
+    std::ranges::copy(page, new_page->begin());
+
+    this->pages_.emplace(hash, new_page);
+
+    if (++this->insertions_ % PURGE_INTERVAL == 0)
+    {
+        this->purge_expired();
+    }
+
+    return new_page;
+}
+
+size_t shared_page_pool::size()
+{
+    const std::scoped_lock lock{this->mutex_};
+    this->purge_expired();
+    return this->pages_.size();
+}
+
+void shared_page_pool::purge_expired()
+{
+    std::erase_if(this->pages_, [](const auto& entry) {
+        return entry.second.expired(); //
+    });
+}
+
+void parked_memory::add_region(const uint64_t address, const memory_permission permissions,
+                               const std::span<const std::byte> data)
+{
+    region r{};
+    r.address = address;
+    r.length = data.size();
+    r.permissions = permissions;
+
+    std::vector<std::byte> private_data{};
+
+    for (size_t offset = 0; offset < data.size(); offset += PARKING_PAGE_SIZE)
+    {
+        const auto page = data.subspan(offset, std::min(PARKING_PAGE_SIZE, data.size() - offset));
+
+        if (is_zero_page(page))
+        {
+            r.pages.push_back(page_kind::zero);
+            ++this->stats_.zero_pages;
+        }
+        else if (page.size() == PARKING_PAGE_SIZE && !is_writable(permissions))
+        {
+            r.pages.push_back(page_kind::shared);
+            r.shared_pages.push_back(shared_page_pool::get().insert(page));
+            ++this->stats_.shared_pages;
+        }
+        else
+        {
+            r.pages.push_back(page_kind::private_page);
+            private_data.insert(private_data.end(), page.begin(), page.end());
+            ++this->stats_.private_pages;
+        }
+    }
+
+    if (!private_data.empty())
+    {
+        r.private_data = utils::compression::zlib::compress(private_data, utils::compression::zlib::level::fastest);
+        if (r.private_data.empty())
+        {
+            throw std::runtime_error("Failed to compress parked memory");
+        }
+    }
+
+    this->stats_.original_size += data.size();
+    this->stats_.parked_size += r.private_data.size();
+
+    this->regions_.push_back(std::move(r));
+}
+
+void parked_memory::for_each_region(const region_callback& callback) const
+{
+    std::vector<std::byte> data{};
+
+    for (const auto& r : this->regions_)
+    {
+        data.assign(r.length, std::byte{0});
+
+        const auto private_data = r.private_data.empty() ? std::vector<std::byte>{}
+                                                         : utils::compression::zlib::decompress(r.private_data);
+
+        size_t shared_index = 0;
+        size_t private_offset = 0;
+
+        for (size_t i = 0; i < r.pages.size(); ++i)
+        {
+            const auto offset = i * PARKING_PAGE_SIZE;
+            const auto size = std::min(PARKING_PAGE_SIZE, r.length - offset);
+
+            switch (r.pages[i])
+            {
+            case page_kind::zero:
+                break;
+            case page_kind::shared:
+                std::ranges::copy(*r.shared_pages.at(shared_index++), data.begin() + offset);
+                break;
+            case page_kind::private_page:
+                if (private_offset + size > private_data.size())
+                {
+                    throw std::runtime_error("Corrupted parked memory");
+                }
+
+                std::copy_n(private_data.begin() + private_offset, size, data.begin() + offset);
+                private_offset += size;
+                break;
+            }
+        }
+
+        callback(r.address, r.permissions, data);
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "std_include.hpp"
+
+#include <memory_permission.hpp>
+
+constexpr size_t PARKING_PAGE_SIZE = 0x1000;
+
+using parked_page = std::array<std::byte, PARKING_PAGE_SIZE>;
+
+// Process-wide store of read-only pages, such as module images, that parked
+// emulators share instead of keeping a copy each. Pages live as long as an
+// emulator references them.
+class shared_page_pool
+{
+  public:
+    static shared_page_pool& get();
+
+    std::shared_ptr<const parked_page> insert(std::span<const std::byte> page);
+    size_t size();
+
+  private:
+    std::mutex mutex_{};
+    std::unordered_multimap<size_t, std::weak_ptr<const parked_page>> pages_{};
+    size_t insertions_{0};
+
+    void purge_expired();
+};
+
+struct parking_stats
+{
+    uint64_t original_size{};
+    uint64_t parked_size{};
+    uint64_t zero_pages{};
+    uint64_t shared_pages{};
+    uint64_t private_pages{};
+};
+
+// Guest memory contents while the backend mapping is released.
+// Zero pages are dropped, read-only pages are deduplicated through the
+// shared pool and all remaining pages are compressed per region.
+class parked_memory
+{
+  public:
+    using region_callback = std::function<void(uint64_t address, memory_permission permissions,
+                                               std::span<const std::byte> data)>;
+
+    void add_region(uint64_t address, memory_permission permissions, std::span<const std::byte> data);
+    void for_each_region(const region_callback& callback) const;
+
+    const parking_stats& get_stats() const
+    {
+        return this->stats_;
+    }
+
+  private:
+    enum class page_kind : uint8_t
+    {
+        zero,
+        shared,
+        private_page,
+    };
+
+    struct region
+    {
+        uint64_t address{};
+        size_t length{};
+        memory_permission permissions{};
+        std::vector<page_kind> pages{};
+        std::vector<std::shared_ptr<const parked_page>> shared_pages{};
+        std::vector<std::byte> private_data{};
+    };
+
+    std::vector<region> regions_{};
+    parking_stats stats_{};
+};
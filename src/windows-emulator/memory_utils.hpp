@@ -3,6 +3,8 @@
 #include <string>
 #include <emulator.hpp>
 
+#include "memory_manager.hpp"
+
 inline std::string get_permission_string(const memory_permission permission)
 {
     const bool has_exec = (permission & memory_permission::exec) != memory_permission::none;
@@ -71,3 +73,22 @@ inline uint32_t map_emulator_to_nt_protection(const memory_permission permission
 
     return PAGE_READONLY;
 }
+
+inline EMU_MEMORY_BASIC_INFORMATION64 get_basic_memory_information(const region_info& region_info)
+{
+    assert(!region_info.is_committed || region_info.is_reserved);
+
+    EMU_MEMORY_BASIC_INFORMATION64 info{};
+    const auto state = region_info.is_reserved ? MEM_RESERVE : MEM_FREE;
+    info.State = region_info.is_committed ? MEM_COMMIT : state;
+    info.BaseAddress = region_info.start;
+    info.AllocationBase = region_info.allocation_base;
+    info.PartitionId = 0;
+    info.RegionSize = static_cast<int64_t>(region_info.length);
+
+    info.Protect = map_emulator_to_nt_protection(region_info.permissions);
+    info.AllocationProtect = map_emulator_to_nt_protection(region_info.initial_permissions);
+    info.Type = MEM_PRIVATE;
+
+    return info;
+}
@@ -1,6 +1,8 @@
 #pragma once
 #include <memory_region.hpp>
 
+#include <algorithm>
+
 struct exported_symbol
 {
     std::string name{};
@@ -18,6 +20,56 @@ struct mapped_section
     basic_memory_region region{};
 };
 
+struct runtime_function
+{
+    uint32_t begin_address{};
+    uint32_t end_address{};
+    uint32_t unwind_info{};
+};
+
+// Host-side copy of the image's exception directory (.pdata)
+struct function_table
+{
+    uint32_t rva{};
+    bool is_sorted{true};
+    std::vector<runtime_function> entries{};
+
+    const runtime_function* find(const uint32_t rva) const
+    {
+        if (!this->is_sorted)
+        {
+            return nullptr;
+        }
+
+        const auto entry = std::ranges::upper_bound(this->entries, rva, {}, &runtime_function::begin_address);
+        if (entry == this->entries.begin())
+        {
+            return nullptr;
+        }
+
+        const auto& function = *std::prev(entry);
+        if (rva >= function.end_address)
+        {
+            return nullptr;
+        }
+
+        return &function;
+    }
+
+    uint32_t get_entry_rva(const runtime_function& function) const
+    {
+        const auto index = static_cast<uint32_t>(&function - this->entries.data());
+        return this->rva + (index * static_cast<uint32_t>(sizeof(runtime_function)));
+    }
+};
+
+struct pdb_reference
+{
+    std::string name{};
+    std::array<uint8_t, 16> guid{};
+    uint32_t age{};
+};
+
 struct mapped_module
 {
     std::string name{};
@@ -32,6 +84,9 @@ struct mapped_module
 
     std::vector<mapped_section> sections{};
 
+    function_table functions{};
+    std::optional<pdb_reference> pdb{};
+
     bool is_static{false};
 
     bool is_within(const uint64_t address) const
@@ -39,6 +94,16 @@ struct mapped_module
         return address >= this->image_base && address < (this->image_base + this->size_of_image);
     }
 
+    const runtime_function* find_function_entry(const uint64_t address) const
+    {
+        if (!this->is_within(address))
+        {
+            return nullptr;
+        }
+
+        return this->functions.find(static_cast<uint32_t>(address - this->image_base));
+    }
+
     uint64_t find_export(const std::string_view export_name) const
     {
         for (const auto& symbol : this->exports)
@@ -49,6 +49,34 @@ namespace utils
         buffer.read(mod.region);
     }
 
+    static void serialize(buffer_serializer& buffer, const function_table& table)
+    {
+        buffer.write(table.rva);
+        buffer.write(table.is_sorted);
+        buffer.write_vector(table.entries);
+    }
+
+    static void deserialize(buffer_deserializer& buffer, function_table& table)
+    {
+        buffer.read(table.rva);
+        buffer.read(table.is_sorted);
+        buffer.read_vector(table.entries);
+    }
+
+    static void serialize(buffer_serializer& buffer, const pdb_reference& pdb)
+    {
+        buffer.write(pdb.name);
+        buffer.write(pdb.guid);
+        buffer.write(pdb.age);
+    }
+
+    static void deserialize(buffer_deserializer& buffer, pdb_reference& pdb)
+    {
+        buffer.read(pdb.name);
+        buffer.read(pdb.guid);
+        buffer.read(pdb.age);
+    }
+
     static void serialize(buffer_serializer& buffer, const mapped_module& mod)
     {
         buffer.write(mod.name);
@@ -62,6 +90,8 @@ namespace utils
         buffer.write_map(mod.address_names);
 
         buffer.write_vector(mod.sections);
+        buffer.write(mod.functions);
+        buffer.write_optional(mod.pdb);
 
         buffer.write(mod.is_static);
     }
@@ -79,6 +109,8 @@ namespace utils
         buffer.read_map(mod.address_names);
 
         buffer.read_vector(mod.sections);
+        buffer.read(mod.functions);
+        buffer.read_optional(mod.pdb);
 
         buffer.read(mod.is_static);
     }
@@ -101,11 +133,30 @@ void module_manager::map_main_modules(const windows_path& executable_path, const
 
 mapped_module* module_manager::map_module(const windows_path& file, const logger& logger, const bool is_static)
 {
+    // Memory files have no backing in the root, the translated path only serves as their identity
+    if (const auto* memory_file = this->file_sys_->find_overlay_file(file))
+    {
+        return this->map_module_internal(this->file_sys_->translate(file), logger, is_static,
+                                         [&](std::filesystem::path path) {
+                                             return map_module_from_data(*this->memory_, memory_file->data,
+                                                                         std::move(path));
+                                         });
+    }
+
     return this->map_local_module(this->file_sys_->translate(file), logger, is_static);
 }
 
 mapped_module* module_manager::map_local_module(const std::filesystem::path& file, const logger& logger,
                                                 const bool is_static)
+{
+    return this->map_module_internal(file, logger, is_static, [this](std::filesystem::path path) {
+        return map_module_from_file(*this->memory_, std::move(path)); //
+    });
+}
+
+mapped_module* module_manager::map_module_internal(std::filesystem::path file, const logger& logger,
+                                                   const bool is_static,
+                                                   const std::function<mapped_module(std::filesystem::path)>& mapper)
 {
     auto local_file = weakly_canonical(absolute(file));
 
@@ -119,7 +170,7 @@ mapped_module* module_manager::map_local_module(const std::filesystem::path& fil
 
     try
     {
-        auto mod = map_module_from_file(*this->memory_, std::move(local_file));
+        auto mod = mapper(std::move(local_file));
         mod.is_static = is_static;
 
         const auto image_base = mod.image_base;
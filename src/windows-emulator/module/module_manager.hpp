@@ -12,8 +12,8 @@ class module_manager
   public:
     struct callbacks
     {
-        utils::optional_function<void(mapped_module& mod)> on_module_load{};
-        utils::optional_function<void(mapped_module& mod)> on_module_unload{};
+        utils::callback_list<void(mapped_module& mod)> on_module_load{};
+        utils::callback_list<void(mapped_module& mod)> on_module_unload{};
     };
 
     using module_map = std::map<uint64_t, mapped_module>;
@@ -69,6 +69,9 @@ class module_manager
     file_system* file_sys_{};
     callbacks* callbacks_{};
 
+    mapped_module* map_module_internal(std::filesystem::path file, const logger& logger, bool is_static,
+                                       const std::function<mapped_module(std::filesystem::path)>& mapper);
+
     module_map modules_{};
 
     module_map::iterator get_module(const uint64_t address)
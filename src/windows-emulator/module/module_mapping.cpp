@@ -68,6 +68,78 @@ namespace
         }
     }
 
+    void collect_function_table(mapped_module& binary, const utils::safe_buffer_accessor<const std::byte> buffer,
+                                const PEOptionalHeader_t<std::uint64_t>& optional_header)
+    {
+        const auto& exception_directory_entry = optional_header.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXCEPTION];
+        if (exception_directory_entry.VirtualAddress == 0 || exception_directory_entry.Size == 0)
+        {
+            return;
+        }
+
+        const auto entries = buffer.as<runtime_function>(exception_directory_entry.VirtualAddress);
+        const auto entry_count = exception_directory_entry.Size / sizeof(runtime_function);
+
+        auto& table = binary.functions;
+        table.rva = exception_directory_entry.VirtualAddress;
+        table.entries.reserve(entry_count);
+
+        for (size_t i = 0; i < entry_count; ++i)
+        {
+            const auto entry = entries.get(i);
+
+            if (!table.entries.empty() && table.entries.back().end_address > entry.begin_address)
+            {
+                table.is_sorted = false;
+            }
+
+            table.entries.push_back(entry);
+        }
+    }
+
+    void collect_pdb_reference(mapped_module& binary, const utils::safe_buffer_accessor<const std::byte> buffer,
+                               const PEOptionalHeader_t<std::uint64_t>& optional_header)
+    {
+        constexpr uint32_t rsds_signature = 0x53445352; // 'RSDS'
+
+        const auto& debug_directory_entry = optional_header.DataDirectory[IMAGE_DIRECTORY_ENTRY_DEBUG];
+        if (debug_directory_entry.VirtualAddress == 0 || debug_directory_entry.Size == 0)
+        {
+            return;
+        }
+
+        const auto entries = buffer.as<IMAGE_DEBUG_DIRECTORY>(debug_directory_entry.VirtualAddress);
+        const auto entry_count = debug_directory_entry.Size / sizeof(IMAGE_DEBUG_DIRECTORY);
+
+        for (size_t i = 0; i < entry_count; ++i)
+        {
+            const auto entry = entries.get(i);
+            if (entry.Type != IMAGE_DEBUG_TYPE_CODEVIEW || entry.AddressOfRawData == 0 || entry.SizeOfData < 24)
+            {
+                continue;
+            }
+
+            if (buffer.as<uint32_t>(entry.AddressOfRawData).get() != rsds_signature)
+            {
+                continue;
+            }
+
+            pdb_reference pdb{};
+            pdb.guid = buffer.as<std::array<uint8_t, 16>>(entry.AddressOfRawData + 4).get();
+            pdb.age = buffer.as<uint32_t>(entry.AddressOfRawData + 20).get();
+            pdb.name = buffer.as_string(entry.AddressOfRawData + 24);
+
+            const auto separator = pdb.name.find_last_of("\\/");
+            if (separator != std::string::npos)
+            {
+                pdb.name = pdb.name.substr(separator + 1);
+            }
+
+            binary.pdb = std::move(pdb);
+            return;
+        }
+    }
+
     template <typename T>
         requires(std::is_integral_v<T>)
     void apply_relocation(const utils::safe_buffer_accessor<std::byte> buffer, const uint64_t offset,
@@ -248,6 +320,8 @@ mapped_module map_module_from_data(memory_manager& memory, const std::span<const
 
     apply_relocations(binary, mapped_buffer, optional_header);
     collect_exports(binary, mapped_buffer, optional_header);
+    collect_function_table(binary, mapped_buffer, optional_header);
+    collect_pdb_reference(binary, mapped_buffer, optional_header);
 
     memory.write_memory(binary.image_base, mapped_memory.data(), mapped_memory.size());
 
@@ -323,6 +397,8 @@ mapped_module map_module_from_memory(memory_manager& memory, uint64_t base_addre
         }
 
         collect_exports(binary, buffer, optional_header);
+        collect_function_table(binary, buffer, optional_header);
+        collect_pdb_reference(binary, buffer, optional_header);
     }
     catch (const std::exception&)
     {
@@ -0,0 +1,267 @@
+#include "../std_include.hpp"
+#include "pdb_reader.hpp"
+
+#include <cstring>
+
+#include <utils/io.hpp>
+#include <utils/buffer_accessor.hpp>
+
+namespace
+{
+    constexpr std::string_view msf_magic{"Microsoft C/C++ MSF 7.00\r\n\x1a"
+                                         "DS\0\0\0",
+                                         32};
+
+    constexpr uint32_t nil_stream_size = 0xFFFFFFFF;
+
+    constexpr uint16_t pdb_info_stream = 1;
+    constexpr uint16_t dbi_stream = 3;
+
+    constexpr size_t dbi_header_size = 64;
+    constexpr size_t dbg_header_section_headers = 5;
+
+    constexpr uint16_t S_PUB32 = 0x110E;
+
+    class msf_file
+    {
+      public:
+        msf_file(const std::span<const std::byte> data)
+            : buffer_(data)
+        {
+            const auto* magic = reinterpret_cast<const char*>(this->buffer_.get_pointer_for_range(0, msf_magic.size()));
+            if (std::string_view(magic, msf_magic.size()) != msf_magic)
+            {
+                throw std::runtime_error("Invalid MSF magic");
+            }
+
+            this->block_size_ = this->buffer_.as<uint32_t>(32).get();
+            const auto directory_size = this->buffer_.as<uint32_t>(44).get();
+            const auto block_map_block = this->buffer_.as<uint32_t>(52).get();
+
+            if (this->block_size_ == 0 || (this->block_size_ & (this->block_size_ - 1)) != 0)
+            {
+                throw std::runtime_error("Invalid MSF block size");
+            }
+
+            const auto block_map = this->buffer_.as<uint32_t>(this->get_block_offset(block_map_block));
+            const auto directory_block_count = this->get_block_count(directory_size);
+
+            std::vector<uint32_t> directory_blocks{};
+            directory_blocks.reserve(directory_block_count);
+
+            for (size_t i = 0; i < directory_block_count; ++i)
+            {
+                directory_blocks.push_back(block_map.get(i));
+            }
+
+            const auto directory_data = this->read_blocks(directory_blocks, directory_size);
+            const utils::safe_buffer_accessor<const std::byte> directory{directory_data};
+
+            const auto stream_count = directory.as<uint32_t>(0).get();
+            const auto stream_sizes = directory.as<uint32_t>(4);
+
+            size_t block_offset = 4 + (static_cast<size_t>(stream_count) * 4);
+            this->streams_.resize(stream_count);
+
+            for (uint32_t i = 0; i < stream_count; ++i)
+            {
+                auto& stream = this->streams_[i];
+                stream.size = stream_sizes.get(i);
+
+                if (stream.size == nil_stream_size)
+                {
+                    stream.size = 0;
+                    continue;
+                }
+
+                const auto block_count = this->get_block_count(stream.size);
+                const auto blocks = directory.as<uint32_t>(block_offset);
+
+                stream.blocks.reserve(block_count);
+
+                for (size_t j = 0; j < block_count; ++j)
+                {
+                    stream.blocks.push_back(blocks.get(j));
+                }
+
+                block_offset += block_count * 4;
+            }
+        }
+
+        std::vector<std::byte> read_stream(const size_t index) const
+        {
+            if (index >= this->streams_.size())
+            {
+                return {};
+            }
+
+            const auto& stream = this->streams_[index];
+            return this->read_blocks(stream.blocks, stream.size);
+        }
+
+      private:
+        struct stream_info
+        {
+            uint32_t size{};
+            std::vector<uint32_t> blocks{};
+        };
+
+        utils::safe_buffer_accessor<const std::byte> buffer_;
+        uint32_t block_size_{};
+        std::vector<stream_info> streams_{};
+
+        size_t get_block_offset(const uint32_t block) const
+        {
+            return static_cast<size_t>(block) * this->block_size_;
+        }
+
+        size_t get_block_count(const size_t size) const
+        {
+            return (size + this->block_size_ - 1) / this->block_size_;
+        }
+
+        std::vector<std::byte> read_blocks(const std::span<const uint32_t> blocks, const size_t size) const
+        {
+            std::vector<std::byte> data{};
+            data.reserve(size);
+
+            for (const auto block : blocks)
+            {
+                const auto chunk_size = std::min(static_cast<size_t>(this->block_size_), size - data.size());
+                const auto* chunk = this->buffer_.get_pointer_for_range(this->get_block_offset(block), chunk_size);
+                data.insert(data.end(), chunk, chunk + chunk_size);
+            }
+
+            return data;
+        }
+    };
+
+    std::vector<uint32_t> read_section_addresses(const msf_file& msf,
+                                                 const utils::safe_buffer_accessor<const std::byte> dbi)
+    {
+        size_t offset = dbi_header_size;
+        offset += static_cast<uint32_t>(dbi.as<int32_t>(24).get()); // ModInfoSize
+        offset += static_cast<uint32_t>(dbi.as<int32_t>(28).get()); // SectionContributionSize
+        offset += static_cast<uint32_t>(dbi.as<int32_t>(32).get()); // SectionMapSize
+        offset += static_cast<uint32_t>(dbi.as<int32_t>(36).get()); // SourceInfoSize
+        offset += static_cast<uint32_t>(dbi.as<int32_t>(40).get()); // TypeServerMapSize
+        offset += static_cast<uint32_t>(dbi.as<int32_t>(52).get()); // ECSubstreamSize
+
+        const auto dbg_header_size = static_cast<uint32_t>(dbi.as<int32_t>(48).get());
+        if (dbg_header_size < (dbg_header_section_headers + 1) * sizeof(uint16_t))
+        {
+            return {};
+        }
+
+        const auto section_stream = dbi.as<uint16_t>(offset).get(dbg_header_section_headers);
+        if (section_stream == 0xFFFF)
+        {
+            return {};
+        }
+
+        const auto section_data = msf.read_stream(section_stream);
+        const auto section_count = section_data.size() / sizeof(IMAGE_SECTION_HEADER);
+        const utils::safe_buffer_accessor<const std::byte> sections{section_data};
+
+        std::vector<uint32_t> addresses{};
+        addresses.reserve(section_count);
+
+        for (size_t i = 0; i < section_count; ++i)
+        {
+            addresses.push_back(sections.as<IMAGE_SECTION_HEADER>(0).get(i).VirtualAddress);
+        }
+
+        return addresses;
+    }
+
+    void read_public_symbols(pdb_contents& contents, const std::span<const std::byte> record_data,
+                             const std::span<const uint32_t> section_addresses)
+    {
+        const utils::safe_buffer_accessor<const std::byte> records{record_data};
+
+        size_t offset = 0;
+        while (offset + 4 <= record_data.size())
+        {
+            const auto record_length = records.as<uint16_t>(offset).get();
+            const auto record_kind = records.as<uint16_t>(offset + 2).get();
+
+            if (record_length < 2)
+            {
+                break;
+            }
+
+            const auto record_offset = offset + 4;
+            offset += 2 + static_cast<size_t>(record_length);
+
+            if (record_kind != S_PUB32)
+            {
+                continue;
+            }
+
+            // flags (4), offset (4), segment (2), name
+            const auto symbol_offset = records.as<uint32_t>(record_offset + 4).get();
+            const auto segment = records.as<uint16_t>(record_offset + 8).get();
+
+            if (segment == 0 || segment > section_addresses.size())
+            {
+                continue;
+            }
+
+            pdb_public_symbol symbol{};
+            symbol.rva = section_addresses[segment - 1] + symbol_offset;
+            symbol.name = records.as_string(record_offset + 10);
+
+            contents.publics.push_back(std::move(symbol));
+        }
+    }
+}
+
+std::optional<pdb_contents> read_pdb_data(const std::span<const std::byte> data)
+{
+    try
+    {
+        const msf_file msf{data};
+
+        pdb_contents contents{};
+
+        const auto info_data = msf.read_stream(pdb_info_stream);
+        const utils::safe_buffer_accessor<const std::byte> info{info_data};
+        contents.age = info.as<uint32_t>(8).get();
+        contents.guid = info.as<std::array<uint8_t, 16>>(12).get();
+
+        const auto dbi_data = msf.read_stream(dbi_stream);
+        const utils::safe_buffer_accessor<const std::byte> dbi{dbi_data};
+
+        const auto dbi_age = dbi.as<uint32_t>(8).get();
+        if (dbi_age != 0)
+        {
+            contents.age = dbi_age;
+        }
+
+        const auto section_addresses = read_section_addresses(msf, dbi);
+        const auto record_stream = dbi.as<uint16_t>(20).get();
+
+        if (!section_addresses.empty() && record_stream != 0xFFFF)
+        {
+            const auto record_data = msf.read_stream(record_stream);
+            read_public_symbols(contents, record_data, section_addresses);
+        }
+
+        return contents;
+    }
+    catch (const std::exception&)
+    {
+        return std::nullopt;
+    }
+}
+
+std::optional<pdb_contents> read_pdb_file(const std::filesystem::path& file)
+{
+    std::vector<std::byte> data{};
+    if (!utils::io::read_file(file, &data))
+    {
+        return std::nullopt;
+    }
+
+    return read_pdb_data(data);
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+struct pdb_public_symbol
+{
+    uint32_t rva{};
+    std::string name{};
+};
+
+struct pdb_contents
+{
+    std::array<uint8_t, 16> guid{};
+    uint32_t age{};
+    std::vector<pdb_public_symbol> publics{};
+};
+
+// Minimal MSF 7.0 reader that only extracts what is needed for symbolisation:
+// the PDB info stream (GUID/age) and S_PUB32 records translated to RVAs.
+std::optional<pdb_contents> read_pdb_file(const std::filesystem::path& file);
+std::optional<pdb_contents> read_pdb_data(std::span<const std::byte> data);
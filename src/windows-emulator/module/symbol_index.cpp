@@ -0,0 +1,190 @@
+#include "../std_include.hpp"
+#include "symbol_index.hpp"
+
+#include <random>
+#include <cstring>
+#include <algorithm>
+
+#include <utils/io.hpp>
+
+namespace
+{
+    constexpr uint64_t index_magic = 0x3158444E494D5953; // 'SYMINDX1'
+    constexpr uint32_t index_version = 1;
+}
+
+symbol_index::symbol_index(std::vector<std::byte> data)
+    : buffer_(std::move(data))
+{
+}
+
+symbol_index::symbol_index(utils::mapped_file file)
+    : mapping_(std::move(file))
+{
+}
+
+symbol_index symbol_index::build(const pdb_contents& contents)
+{
+    std::vector<const pdb_public_symbol*> symbols{};
+    symbols.reserve(contents.publics.size());
+
+    for (const auto& symbol : contents.publics)
+    {
+        symbols.push_back(&symbol);
+    }
+
+    std::ranges::stable_sort(symbols, {}, &pdb_public_symbol::rva);
+
+    // Keep the first name for aliased addresses
+    const auto duplicates = std::ranges::unique(symbols, {}, &pdb_public_symbol::rva);
+    symbols.erase(duplicates.begin(), duplicates.end());
+
+    std::vector<entry> entries{};
+    entries.reserve(symbols.size());
+
+    std::string strings{};
+
+    for (const auto* symbol : symbols)
+    {
+        entries.push_back({
+            .rva = symbol->rva,
+            .name_offset = static_cast<uint32_t>(strings.size()),
+        });
+
+        strings.append(symbol->name);
+        strings.push_back('\0');
+    }
+
+    header h{};
+    h.magic = index_magic;
+    h.version = index_version;
+    h.age = contents.age;
+    h.guid = contents.guid;
+    h.entry_count = static_cast<uint32_t>(entries.size());
+    h.string_size = static_cast<uint32_t>(strings.size());
+
+    const auto entries_size = entries.size() * sizeof(entry);
+
+    std::vector<std::byte> data{};
+    data.resize(sizeof(header) + entries_size + strings.size());
+
+    memcpy(data.data(), &h, sizeof(h));
+    memcpy(data.data() + sizeof(header), entries.data(), entries_size);
+    memcpy(data.data() + sizeof(header) + entries_size, strings.data(), strings.size());
+
+    return symbol_index{std::move(data)};
+}
+
+std::optional<symbol_index> symbol_index::load(const std::filesystem::path& file, const pdb_reference& pdb)
+{
+    utils::mapped_file mapping{file};
+    if (!mapping || mapping.get_data().size() < sizeof(header))
+    {
+        return std::nullopt;
+    }
+
+    symbol_index index{std::move(mapping)};
+    const auto data = index.get_data();
+    const auto& h = index.get_header();
+
+    if (h.magic != index_magic || h.version != index_version || !index.matches(pdb))
+    {
+        return std::nullopt;
+    }
+
+    const auto expected_size =
+        sizeof(header) + (static_cast<size_t>(h.entry_count) * sizeof(entry)) + static_cast<size_t>(h.string_size);
+
+    if (data.size() != expected_size || (h.string_size > 0 && data.back() != std::byte{0}))
+    {
+        return std::nullopt;
+    }
+
+    for (const auto& e : index.get_entries())
+    {
+        if (e.name_offset >= h.string_size)
+        {
+            return std::nullopt;
+        }
+    }
+
+    return index;
+}
+
+bool symbol_index::save(const std::filesystem::path& file) const
+{
+    std::error_code ec{};
+    std::filesystem::create_directories(file.parent_path(), ec);
+
+    // Other emulators may have the file mapped, so it is replaced instead of rewritten in place
+    auto temporary = file;
+    temporary += "." + std::to_string(std::random_device{}());
+
+    if (!utils::io::write_file(temporary, this->get_data()))
+    {
+        return false;
+    }
+
+    std::filesystem::rename(temporary, file, ec);
+    if (ec)
+    {
+        std::filesystem::remove(temporary, ec);
+        return false;
+    }
+
+    return true;
+}
+
+bool symbol_index::matches(const pdb_reference& pdb) const
+{
+    const auto& h = this->get_header();
+    return h.guid == pdb.guid && h.age == pdb.age;
+}
+
+std::optional<symbol_index::symbol> symbol_index::find(const uint32_t rva) const
+{
+    const auto entries = this->get_entries();
+    const auto it = std::ranges::upper_bound(entries, rva, {}, &entry::rva);
+
+    if (it == entries.begin())
+    {
+        return std::nullopt;
+    }
+
+    const auto& e = *std::prev(it);
+
+    return symbol{
+        .rva = e.rva,
+        .name = this->get_name(e.name_offset),
+    };
+}
+
+size_t symbol_index::size() const
+{
+    return this->get_header().entry_count;
+}
+
+std::span<const std::byte> symbol_index::get_data() const
+{
+    return this->mapping_ ? this->mapping_.get_data() : std::span<const std::byte>(this->buffer_);
+}
+
+const symbol_index::header& symbol_index::get_header() const
+{
+    return *reinterpret_cast<const header*>(this->get_data().data());
+}
+
+std::span<const symbol_index::entry> symbol_index::get_entries() const
+{
+    const auto* entries = reinterpret_cast<const entry*>(this->get_data().data() + sizeof(header));
+    return {entries, this->get_header().entry_count};
+}
+
+std::string_view symbol_index::get_name(const uint32_t offset) const
+{
+    const auto& h = this->get_header();
+    const auto* strings = reinterpret_cast<const char*>(this->get_data().data() + sizeof(header) +
+                                                        (static_cast<size_t>(h.entry_count) * sizeof(entry)));
+
+    return strings + offset;
+}
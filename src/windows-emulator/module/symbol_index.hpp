@@ -0,0 +1,58 @@
+#pragma once
+
+#include "mapped_module.hpp"
+#include "pdb_reader.hpp"
+
+#include <utils/mapped_file.hpp>
+
+// Flat, position-independent address->name table. The in-memory representation is
+// identical to the on-disk cache file, so loading it maps the file into memory
+// and lookups binary-search the entry array in place.
+class symbol_index
+{
+  public:
+    struct symbol
+    {
+        uint32_t rva{};
+        std::string_view name{};
+    };
+
+    static symbol_index build(const pdb_contents& contents);
+    static std::optional<symbol_index> load(const std::filesystem::path& file, const pdb_reference& pdb);
+
+    bool save(const std::filesystem::path& file) const;
+
+    bool matches(const pdb_reference& pdb) const;
+    std::optional<symbol> find(uint32_t rva) const;
+
+    size_t size() const;
+
+  private:
+    struct header
+    {
+        uint64_t magic{};
+        uint32_t version{};
+        uint32_t age{};
+        std::array<uint8_t, 16> guid{};
+        uint32_t entry_count{};
+        uint32_t string_size{};
+    };
+
+    struct entry
+    {
+        uint32_t rva{};
+        uint32_t name_offset{};
+    };
+
+    // Built indices own their buffer, loaded ones map the cache file
+    std::vector<std::byte> buffer_{};
+    utils::mapped_file mapping_{};
+
+    symbol_index(std::vector<std::byte> data);
+    symbol_index(utils::mapped_file file);
+
+    std::span<const std::byte> get_data() const;
+    const header& get_header() const;
+    std::span<const entry> get_entries() const;
+    std::string_view get_name(uint32_t offset) const;
+};
@@ -0,0 +1,200 @@
+#include "../std_include.hpp"
+#include "symbol_manager.hpp"
+#include "module_manager.hpp"
+
+#include <utils/string.hpp>
+
+namespace
+{
+    std::string get_pdb_identifier(const pdb_reference& pdb)
+    {
+        const auto& g = pdb.guid;
+
+        // Symbol server layout: Data1, Data2 and Data3 are little-endian, Data4 is a byte array
+        return utils::string::va("%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%X", g[3], g[2],
+                                 g[1], g[0], g[5], g[4], g[7], g[6], g[8], g[9], g[10], g[11], g[12], g[13], g[14],
+                                 g[15], pdb.age);
+    }
+
+    // Indices are immutable, so emulator instances running in parallel share them
+    struct shared_indices
+    {
+        std::mutex mutex{};
+        std::unordered_map<std::string, std::weak_ptr<const symbol_index>> indices{};
+    };
+
+    shared_indices& get_shared_indices()
+    {
+        static shared_indices indices{};
+        return indices;
+    }
+
+    std::shared_ptr<const symbol_index> get_shared_index(const std::string& key)
+    {
+        auto& shared = get_shared_indices();
+        const std::scoped_lock lock{shared.mutex};
+
+        // Drop the entries of indices no emulator uses anymore
+        std::erase_if(shared.indices, [](const auto& entry) {
+            return entry.second.expired(); //
+        });
+
+        const auto entry = shared.indices.find(key);
+        return entry == shared.indices.end() ? nullptr : entry->second.lock();
+    }
+
+    void store_shared_index(const std::string& key, const std::shared_ptr<const symbol_index>& index)
+    {
+        auto& shared = get_shared_indices();
+        const std::scoped_lock lock{shared.mutex};
+        shared.indices[key] = index;
+    }
+}
+
+symbol_manager::symbol_manager(std::filesystem::path symbol_directory)
+    : symbol_directory_(std::move(symbol_directory))
+{
+}
+
+void symbol_manager::set_symbol_directory(std::filesystem::path symbol_directory)
+{
+    this->symbol_directory_ = std::move(symbol_directory);
+    this->indices_.clear();
+}
+
+std::optional<resolved_symbol> symbol_manager::resolve(const mapped_module& mod, const uint64_t address)
+{
+    if (!mod.is_within(address))
+    {
+        return std::nullopt;
+    }
+
+    std::optional<resolved_symbol> result{};
+
+    const auto* index = this->get_index(mod);
+    if (index)
+    {
+        const auto symbol = index->find(static_cast<uint32_t>(address - mod.image_base));
+        if (symbol)
+        {
+            result = resolved_symbol{
+                .module = &mod,
+                .name = std::string(symbol->name),
+                .displacement = address - (mod.image_base + symbol->rva),
+            };
+        }
+    }
+
+    auto export_entry = mod.address_names.upper_bound(address);
+    if (export_entry != mod.address_names.begin())
+    {
+        --export_entry;
+
+        const auto displacement = address - export_entry->first;
+        if (!result || displacement < result->displacement)
+        {
+            result = resolved_symbol{
+                .module = &mod,
+                .name = export_entry->second,
+                .displacement = displacement,
+            };
+        }
+    }
+
+    return result;
+}
+
+std::optional<resolved_symbol> symbol_manager::resolve(module_manager& modules, const uint64_t address)
+{
+    const auto* mod = modules.find_by_address(address);
+    if (!mod)
+    {
+        return std::nullopt;
+    }
+
+    return this->resolve(*mod, address);
+}
+
+std::string symbol_manager::describe(module_manager& modules, const uint64_t address)
+{
+    const auto* mod = modules.find_by_address(address);
+    if (!mod)
+    {
+        return utils::string::va("0x%" PRIx64, address);
+    }
+
+    const auto symbol = this->resolve(*mod, address);
+    if (!symbol)
+    {
+        return utils::string::va("%s+0x%" PRIx64, mod->name.c_str(), address - mod->image_base);
+    }
+
+    if (symbol->displacement == 0)
+    {
+        return utils::string::va("%s!%.*s", mod->name.c_str(), static_cast<int>(symbol->name.size()),
+                                 symbol->name.data());
+    }
+
+    return utils::string::va("%s!%.*s+0x%" PRIx64, mod->name.c_str(), static_cast<int>(symbol->name.size()),
+                             symbol->name.data(), symbol->displacement);
+}
+
+const symbol_index* symbol_manager::get_index(const mapped_module& mod)
+{
+    if (this->symbol_directory_.empty() || !mod.pdb)
+    {
+        return nullptr;
+    }
+
+    auto& entry = this->indices_[mod.image_base];
+    if (entry.module_path != mod.path)
+    {
+        entry.module_path = mod.path;
+        entry.index = this->load_index(*mod.pdb);
+    }
+
+    return entry.index.get();
+}
+
+std::shared_ptr<const symbol_index> symbol_manager::load_index(const pdb_reference& pdb) const
+{
+    const auto identifier = get_pdb_identifier(pdb);
+    const auto pdb_directory = this->symbol_directory_ / pdb.name / identifier;
+    const auto cache_file = pdb_directory / (std::filesystem::path(pdb.name).stem().string() + ".symidx");
+    const auto shared_key = (pdb_directory / pdb.name).string();
+
+    auto index = get_shared_index(shared_key);
+    if (index)
+    {
+        return index;
+    }
+
+    auto cached = symbol_index::load(cache_file, pdb);
+    if (cached)
+    {
+        index = std::make_shared<const symbol_index>(std::move(*cached));
+        store_shared_index(shared_key, index);
+        return index;
+    }
+
+    for (const auto& pdb_file : {pdb_directory / pdb.name, this->symbol_directory_ / pdb.name})
+    {
+        auto contents = read_pdb_file(pdb_file);
+        if (!contents || contents->guid != pdb.guid)
+        {
+            continue;
+        }
+
+        // The PDB info stream age may be ahead of the image's CodeView age
+        contents->age = pdb.age;
+
+        auto built = symbol_index::build(*contents);
+        (void)built.save(cache_file);
+
+        index = std::make_shared<const symbol_index>(std::move(built));
+        store_shared_index(shared_key, index);
+        return index;
+    }
+
+    return nullptr;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "symbol_index.hpp"
+
+class module_manager;
+
+struct resolved_symbol
+{
+    const mapped_module* module{};
+    std::string name{};
+    uint64_t displacement{};
+};
+
+class symbol_manager
+{
+  public:
+    symbol_manager(std::filesystem::path symbol_directory = {});
+
+    void set_symbol_directory(std::filesystem::path symbol_directory);
+
+    const std::filesystem::path& get_symbol_directory() const
+    {
+        return this->symbol_directory_;
+    }
+
+    // Resolves the closest symbol at or below the address. PDB publics are used when a
+    // matching PDB is found in the symbol directory, exports otherwise.
+    std::optional<resolved_symbol> resolve(const mapped_module& mod, uint64_t address);
+    std::optional<resolved_symbol> resolve(module_manager& modules, uint64_t address);
+
+    // Formats an address as module!symbol+0x10, module+0x1234 or plain hex
+    std::string describe(module_manager& modules, uint64_t address);
+
+  private:
+    struct cached_index
+    {
+        std::filesystem::path module_path{};
+        std::shared_ptr<const symbol_index> index{};
+    };
+
+    std::filesystem::path symbol_directory_{};
+    std::unordered_map<uint64_t, cached_index> indices_{};
+
+    const symbol_index* get_index(const mapped_module& mod);
+    std::shared_ptr<const symbol_index> load_index(const pdb_reference& pdb) const;
+};
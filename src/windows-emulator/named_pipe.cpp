@@ -0,0 +1,626 @@
+#include "std_include.hpp"
+#include "named_pipe.hpp"
+#include "windows_emulator.hpp"
+
+#include <utils/string.hpp>
+
+namespace
+{
+    constexpr size_t minimum_buffer_size = 0x1000;
+
+    emulator_thread* find_thread(windows_emulator& win_emu, const uint32_t thread_id)
+    {
+        for (auto& thread : win_emu.process.threads | std::views::values)
+        {
+            if (thread.id == thread_id)
+            {
+                return &thread;
+            }
+        }
+
+        return nullptr;
+    }
+
+    void write_io_result(const io_device_context& c, const NTSTATUS status, const uint64_t information)
+    {
+        if (!c.io_status_block)
+        {
+            return;
+        }
+
+        c.io_status_block.access([&](IO_STATUS_BLOCK<EmulatorTraits<Emu64>>& block) {
+            block.Status = status;
+            block.Information = information;
+        });
+    }
+
+    void signal_completion(windows_emulator& win_emu, const io_device_context& c)
+    {
+        if (auto* e = win_emu.process.events.get(c.event))
+        {
+            e->signaled = true;
+        }
+    }
+
+    void complete_operation(windows_emulator& win_emu, const pending_pipe_operation& op, const NTSTATUS status,
+                            const uint64_t information)
+    {
+        write_io_result(op.context, status, information);
+        signal_completion(win_emu, op.context);
+
+        auto* thread = find_thread(win_emu, op.thread_id);
+        if (!thread)
+        {
+            return;
+        }
+
+        if (op.synchronous)
+        {
+            thread->mark_as_ready(status);
+        }
+        else if (op.context.apc_routine)
+        {
+            thread->pending_apcs.push_back({
+                .flags = 0,
+                .apc_routine = op.context.apc_routine,
+                .apc_argument1 = op.context.apc_context,
+                .apc_argument2 = op.context.io_status_block.value(),
+                .apc_argument3 = 0,
+            });
+        }
+    }
+
+    // Copies straight from the pipe buffer into guest memory
+    NTSTATUS read_into_guest(windows_emulator& win_emu, pipe_buffer& buffer, const io_device_context& c,
+                             const bool message_mode, size_t& transferred)
+    {
+        bool more_data = false;
+        transferred = buffer.read(c.output_buffer_length, message_mode, more_data,
+                                  [&](const size_t offset, const std::span<const std::byte> data) {
+                                      win_emu.emu().write_memory(c.output_buffer + offset, data.data(), data.size());
+                                  });
+
+        return more_data ? STATUS_BUFFER_OVERFLOW : STATUS_SUCCESS;
+    }
+}
+
+void pipe_buffer::write(const std::span<const std::byte> data, const bool is_message)
+{
+    this->write(data.size(), is_message, [&](const size_t offset, const std::span<std::byte> target) {
+        std::copy_n(data.begin() + static_cast<ptrdiff_t>(offset), target.size(), target.begin()); //
+    });
+}
+
+void pipe_buffer::write(const size_t size, const bool is_message, const pipe_data_source& source)
+{
+    // Zero-length messages carry no data, the buffer may not even be allocated yet
+    if (size == 0)
+    {
+        if (is_message)
+        {
+            this->messages_.push_back(0);
+        }
+
+        return;
+    }
+
+    const auto required = this->size_ + size;
+    if (required > this->data_.size())
+    {
+        std::vector<std::byte> new_data(std::max({required, this->data_.size() * 2, minimum_buffer_size}));
+        this->copy_out(this->size_, [&](const size_t offset, const std::span<const std::byte> data) {
+            std::ranges::copy(data, new_data.begin() + static_cast<ptrdiff_t>(offset)); //
+        });
+
+        this->data_ = std::move(new_data);
+        this->head_ = 0;
+    }
+
+    const auto capacity = this->data_.size();
+    const auto tail = (this->head_ + this->size_) % capacity;
+    const auto first_part = std::min(size, capacity - tail);
+
+    // The data only becomes visible once the source filled it completely
+    source(0, std::span(this->data_).subspan(tail, first_part));
+
+    if (first_part < size)
+    {
+        source(first_part, std::span(this->data_).first(size - first_part));
+    }
+
+    this->size_ += size;
+
+    if (is_message)
+    {
+        this->messages_.push_back(static_cast<uint32_t>(size));
+    }
+}
+
+size_t pipe_buffer::read(const std::span<std::byte> data, const bool message_mode, bool& more_data)
+{
+    return this->read(data.size(), message_mode, more_data,
+                      [&](const size_t offset, const std::span<const std::byte> part) {
+                          std::ranges::copy(part, data.begin() + static_cast<ptrdiff_t>(offset)); //
+                      });
+}
+
+size_t pipe_buffer::read(const size_t size, const bool message_mode, bool& more_data, const pipe_data_sink& sink)
+{
+    auto available = this->size_;
+    if (message_mode && !this->messages_.empty())
+    {
+        available = this->messages_.front();
+    }
+
+    const auto count = std::min(size, available);
+    this->copy_out(count, sink);
+
+    more_data = message_mode && count < available;
+
+    if (message_mode && !more_data && !this->messages_.empty() && this->messages_.front() == 0)
+    {
+        this->messages_.pop_front();
+    }
+
+    this->consume(count);
+    return count;
+}
+
+size_t pipe_buffer::peek(const size_t size, const pipe_data_sink& sink) const
+{
+    const auto count = std::min(size, this->size_);
+    this->copy_out(count, sink);
+    return count;
+}
+
+void pipe_buffer::clear()
+{
+    this->head_ = 0;
+    this->size_ = 0;
+    this->messages_.clear();
+}
+
+void pipe_buffer::copy_out(const size_t count, const pipe_data_sink& sink) const
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    const auto capacity = this->data_.size();
+    const auto first_part = std::min(count, capacity - this->head_);
+
+    sink(0, std::span(this->data_).subspan(this->head_, first_part));
+
+    if (first_part < count)
+    {
+        sink(first_part, std::span(this->data_).first(count - first_part));
+    }
+}
+
+void pipe_buffer::consume(size_t count)
+{
+    if (!this->data_.empty())
+    {
+        this->head_ = (this->head_ + count) % this->data_.size();
+    }
+
+    this->size_ -= count;
+
+    while (count > 0 && !this->messages_.empty())
+    {
+        auto& message = this->messages_.front();
+        const auto part = std::min(static_cast<size_t>(message), count);
+
+        message -= static_cast<uint32_t>(part);
+        count -= part;
+
+        if (message == 0)
+        {
+            this->messages_.pop_front();
+        }
+    }
+}
+
+void pipe_buffer::serialize(utils::buffer_serializer& buffer) const
+{
+    std::vector<std::byte> data(this->size_);
+    this->copy_out(data.size(), [&](const size_t offset, const std::span<const std::byte> part) {
+        std::ranges::copy(part, data.begin() + static_cast<ptrdiff_t>(offset)); //
+    });
+
+    buffer.write_vector(data);
+    buffer.write_vector(std::vector(this->messages_.begin(), this->messages_.end()));
+}
+
+void pipe_buffer::deserialize(utils::buffer_deserializer& buffer)
+{
+    buffer.read_vector(this->data_);
+
+    std::vector<uint32_t> messages{};
+    buffer.read_vector(messages);
+
+    this->head_ = 0;
+    this->size_ = this->data_.size();
+    this->messages_ = {messages.begin(), messages.end()};
+}
+
+bool named_pipe::has_pending_operation(const handle file_handle) const
+{
+    return std::ranges::any_of(this->pending_operations, [&](const pending_pipe_operation& op) {
+        return op.file_handle == file_handle; //
+    });
+}
+
+NTSTATUS named_pipe::validate_end(const pipe_end& end) const
+{
+    if (!end.is_server && end.connection != this->connection)
+    {
+        return STATUS_PIPE_DISCONNECTED;
+    }
+
+    switch (this->state)
+    {
+    case FILE_PIPE_LISTENING_STATE:
+        return STATUS_PIPE_LISTENING;
+    case FILE_PIPE_DISCONNECTED_STATE:
+        return STATUS_PIPE_DISCONNECTED;
+    default:
+        return STATUS_SUCCESS;
+    }
+}
+
+void named_pipe::queue_operation(windows_emulator& win_emu, const pipe_end& end, const handle file_handle,
+                                 const io_device_context& c)
+{
+    pending_pipe_operation op{win_emu.emu()};
+    op.server_end = end.is_server;
+    op.synchronous = end.synchronous;
+    op.message_mode = end.message_read_mode;
+    op.thread_id = win_emu.current_thread().id;
+    op.file_handle = file_handle;
+    op.context = c;
+
+    this->pending_operations.push_back(std::move(op));
+}
+
+void named_pipe::complete_operations(windows_emulator& win_emu, const NTSTATUS status,
+                                     const std::function<bool(const pending_pipe_operation&)>& filter)
+{
+    std::vector<pending_pipe_operation> completed{};
+
+    for (auto i = this->pending_operations.begin(); i != this->pending_operations.end();)
+    {
+        if (filter(*i))
+        {
+            completed.push_back(std::move(*i));
+            i = this->pending_operations.erase(i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    for (const auto& op : completed)
+    {
+        complete_operation(win_emu, op, status, 0);
+    }
+}
+
+NTSTATUS named_pipe::read(windows_emulator& win_emu, const pipe_end& end, const handle file_handle,
+                          const io_device_context& c)
+{
+    const auto status = this->validate_end(end);
+    if (status != STATUS_SUCCESS)
+    {
+        return status;
+    }
+
+    auto& buffer = this->get_read_buffer(end);
+
+    if (buffer.empty())
+    {
+        if (!this->is_peer_open(end))
+        {
+            return STATUS_PIPE_BROKEN;
+        }
+
+        if (end.non_blocking)
+        {
+            return STATUS_PIPE_EMPTY;
+        }
+
+        this->queue_operation(win_emu, end, file_handle, c);
+        return STATUS_PENDING;
+    }
+
+    size_t transferred{};
+    const auto result = read_into_guest(win_emu, buffer, c, end.message_read_mode, transferred);
+
+    write_io_result(c, result, transferred);
+    return result;
+}
+
+NTSTATUS named_pipe::write(windows_emulator& win_emu, const pipe_end& end, const uint64_t address, const size_t size)
+{
+    const auto status = this->validate_end(end);
+    if (status != STATUS_SUCCESS)
+    {
+        return status;
+    }
+
+    if (!this->is_peer_open(end))
+    {
+        return STATUS_PIPE_CLOSING;
+    }
+
+    auto& buffer = this->get_write_buffer(end);
+    const auto is_reader = [&](const pending_pipe_operation& op) {
+        return op.server_end != end.is_server && op.context.io_control_code == 0;
+    };
+
+    // Byte mode pipes keep nothing for zero-length writes, they only complete a waiting read
+    if (size == 0 && !this->message_type)
+    {
+        const auto entry = std::ranges::find_if(this->pending_operations, is_reader);
+        if (entry != this->pending_operations.end() && buffer.empty())
+        {
+            const auto op = std::move(*entry);
+            this->pending_operations.erase(entry);
+            complete_operation(win_emu, op, STATUS_SUCCESS, 0);
+        }
+
+        return STATUS_SUCCESS;
+    }
+
+    // The data is copied from the writer into the pipe buffer once, waiting readers are served from there
+    buffer.write(size, this->message_type, [&](const size_t offset, const std::span<std::byte> target) {
+        win_emu.emu().read_memory(address + offset, target.data(), target.size()); //
+    });
+
+    while (!buffer.empty())
+    {
+        const auto entry = std::ranges::find_if(this->pending_operations, is_reader);
+        if (entry == this->pending_operations.end())
+        {
+            break;
+        }
+
+        const auto op = std::move(*entry);
+        this->pending_operations.erase(entry);
+
+        size_t transferred{};
+        const auto result = read_into_guest(win_emu, buffer, op.context, op.message_mode, transferred);
+        complete_operation(win_emu, op, result, transferred);
+    }
+
+    return STATUS_SUCCESS;
+}
+
+NTSTATUS named_pipe::listen(windows_emulator& win_emu, const pipe_end& end, const handle file_handle,
+                            const io_device_context& c)
+{
+    if (!end.is_server)
+    {
+        return STATUS_ILLEGAL_FUNCTION;
+    }
+
+    switch (this->state)
+    {
+    case FILE_PIPE_CONNECTED_STATE:
+        return STATUS_PIPE_CONNECTED;
+    case FILE_PIPE_CLOSING_STATE:
+        return STATUS_PIPE_CLOSING;
+    default:
+        break;
+    }
+
+    this->state = FILE_PIPE_LISTENING_STATE;
+
+    if (end.non_blocking)
+    {
+        return STATUS_PIPE_LISTENING;
+    }
+
+    this->queue_operation(win_emu, end, file_handle, c);
+    return STATUS_PENDING;
+}
+
+NTSTATUS named_pipe::disconnect(windows_emulator& win_emu, const pipe_end& end)
+{
+    if (!end.is_server)
+    {
+        return STATUS_ILLEGAL_FUNCTION;
+    }
+
+    if (this->state == FILE_PIPE_DISCONNECTED_STATE)
+    {
+        return STATUS_PIPE_DISCONNECTED;
+    }
+
+    this->state = FILE_PIPE_DISCONNECTED_STATE;
+    this->client_open = false;
+    ++this->connection;
+
+    this->inbound.clear();
+    this->outbound.clear();
+
+    this->complete_operations(win_emu, STATUS_PIPE_DISCONNECTED, [](const pending_pipe_operation&) {
+        return true; //
+    });
+
+    return STATUS_SUCCESS;
+}
+
+NTSTATUS named_pipe::peek(windows_emulator& win_emu, const pipe_end& end, const io_device_context& c)
+{
+    constexpr auto header_size = offsetof(FILE_PIPE_PEEK_BUFFER, Data);
+    if (c.output_buffer_length < header_size)
+    {
+        return STATUS_BUFFER_TOO_SMALL;
+    }
+
+    if (!end.is_server && end.connection != this->connection)
+    {
+        return STATUS_PIPE_DISCONNECTED;
+    }
+
+    if (this->state != FILE_PIPE_CONNECTED_STATE && this->state != FILE_PIPE_CLOSING_STATE)
+    {
+        return STATUS_INVALID_PIPE_STATE;
+    }
+
+    const auto& buffer = this->get_read_buffer(end);
+    const auto available = this->message_type ? buffer.get_next_message_size() : buffer.size();
+
+    const auto data_address = c.output_buffer + header_size;
+    const auto data_size = std::min(static_cast<size_t>(c.output_buffer_length) - header_size, available);
+
+    const auto count = buffer.peek(data_size, [&](const size_t offset, const std::span<const std::byte> data) {
+        win_emu.emu().write_memory(data_address + offset, data.data(), data.size()); //
+    });
+
+    FILE_PIPE_PEEK_BUFFER peek_buffer{};
+    peek_buffer.NamedPipeState = this->state;
+    peek_buffer.ReadDataAvailable = static_cast<ULONG>(buffer.size());
+    peek_buffer.NumberOfMessages = static_cast<ULONG>(buffer.get_message_count());
+    peek_buffer.MessageLength = static_cast<ULONG>(buffer.get_next_message_size());
+
+    win_emu.emu().write_memory(c.output_buffer, &peek_buffer, header_size);
+
+    write_io_result(c, STATUS_SUCCESS, header_size + count);
+    return count < available ? STATUS_BUFFER_OVERFLOW : STATUS_SUCCESS;
+}
+
+NTSTATUS named_pipe::fs_control(windows_emulator& win_emu, const pipe_end& end, const handle file_handle,
+                                const io_device_context& c)
+{
+    switch (c.io_control_code)
+    {
+    case FSCTL_PIPE_LISTEN:
+        return this->listen(win_emu, end, file_handle, c);
+
+    case FSCTL_PIPE_DISCONNECT:
+        return this->disconnect(win_emu, end);
+
+    case FSCTL_PIPE_PEEK:
+        return this->peek(win_emu, end, c);
+
+    case FSCTL_PIPE_TRANSCEIVE: {
+        const auto status = this->write(win_emu, end, c.input_buffer, c.input_buffer_length);
+        if (status != STATUS_SUCCESS)
+        {
+            return status;
+        }
+
+        auto read_context = c;
+        read_context.io_control_code = 0;
+        return this->read(win_emu, end, file_handle, read_context);
+    }
+
+    default:
+        return STATUS_INVALID_DEVICE_REQUEST;
+    }
+}
+
+void named_pipe::connect(windows_emulator& win_emu)
+{
+    this->state = FILE_PIPE_CONNECTED_STATE;
+    this->client_open = true;
+
+    this->inbound.clear();
+    this->outbound.clear();
+
+    this->complete_operations(win_emu, STATUS_SUCCESS, [](const pending_pipe_operation& op) {
+        return op.server_end && op.context.io_control_code == FSCTL_PIPE_LISTEN;
+    });
+}
+
+void named_pipe::close(windows_emulator& win_emu, const pipe_end& end)
+{
+    if (!end.is_server && end.connection != this->connection)
+    {
+        return;
+    }
+
+    if (end.is_server)
+    {
+        this->server_open = false;
+    }
+    else
+    {
+        this->client_open = false;
+    }
+
+    if (this->state == FILE_PIPE_CONNECTED_STATE)
+    {
+        this->state = FILE_PIPE_CLOSING_STATE;
+    }
+
+    this->complete_operations(win_emu, STATUS_CANCELLED, [&](const pending_pipe_operation& op) {
+        return op.server_end == end.is_server; //
+    });
+
+    this->complete_operations(win_emu, STATUS_PIPE_BROKEN, [&](const pending_pipe_operation& op) {
+        return op.server_end != end.is_server; //
+    });
+}
+
+void named_pipe::serialize(utils::buffer_serializer& buffer) const
+{
+    buffer.write(this->name);
+    buffer.write(this->message_type);
+    buffer.write(this->maximum_instances);
+    buffer.write(this->inbound_quota);
+    buffer.write(this->outbound_quota);
+    buffer.write(this->default_timeout);
+    buffer.write(this->state);
+    buffer.write(this->connection);
+    buffer.write(this->server_open);
+    buffer.write(this->client_open);
+    buffer.write(this->inbound);
+    buffer.write(this->outbound);
+    buffer.write_vector(this->pending_operations);
+}
+
+void named_pipe::deserialize(utils::buffer_deserializer& buffer)
+{
+    buffer.read(this->name);
+    buffer.read(this->message_type);
+    buffer.read(this->maximum_instances);
+    buffer.read(this->inbound_quota);
+    buffer.read(this->outbound_quota);
+    buffer.read(this->default_timeout);
+    buffer.read(this->state);
+    buffer.read(this->connection);
+    buffer.read(this->server_open);
+    buffer.read(this->client_open);
+    buffer.read(this->inbound);
+    buffer.read(this->outbound);
+    buffer.read_vector(this->pending_operations);
+}
+
+std::optional<std::u16string> get_pipe_name(const std::u16string_view filename)
+{
+    constexpr std::u16string_view prefixes[] = {u"\\??\\pipe\\", u"\\Device\\NamedPipe\\"};
+
+    const auto lower_name = utils::string::to_lower(std::u16string(filename));
+
+    for (const auto prefix : prefixes)
+    {
+        if (lower_name.starts_with(utils::string::to_lower(std::u16string(prefix))))
+        {
+            return lower_name.substr(prefix.size());
+        }
+    }
+
+    return std::nullopt;
+}
+
+bool has_available_pipe_instance(const std::map<uint32_t, named_pipe>& pipes, const std::u16string_view name)
+{
+    return std::ranges::any_of(pipes | std::views::values, [&](const named_pipe& pipe) {
+        return pipe.name == name && pipe.is_available(); //
+    });
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "io_device.hpp"
+#include "windows_objects.hpp"
+
+class windows_emulator;
+
+// Ring buffer wrap-around splits a transfer into at most two contiguous parts,
+// each one is passed along with its offset in the transferred data
+using pipe_data_sink = std::function<void(size_t offset, std::span<const std::byte> data)>;
+using pipe_data_source = std::function<void(size_t offset, std::span<std::byte> data)>;
+
+// Grows on demand, so writes never block on the pipe quota
+class pipe_buffer
+{
+  public:
+    size_t size() const
+    {
+        return this->size_;
+    }
+
+    bool empty() const
+    {
+        return this->size_ == 0 && this->messages_.empty();
+    }
+
+    size_t get_message_count() const
+    {
+        return this->messages_.size();
+    }
+
+    size_t get_next_message_size() const
+    {
+        return this->messages_.empty() ? 0 : this->messages_.front();
+    }
+
+    void write(std::span<const std::byte> data, bool is_message);
+    void write(size_t size, bool is_message, const pipe_data_source& source);
+    size_t read(std::span<std::byte> data, bool message_mode, bool& more_data);
+    size_t read(size_t size, bool message_mode, bool& more_data, const pipe_data_sink& sink);
+    size_t peek(size_t size, const pipe_data_sink& sink) const;
+    void clear();
+
+    void serialize(utils::buffer_serializer& buffer) const;
+    void deserialize(utils::buffer_deserializer& buffer);
+
+  private:
+    std::vector<std::byte> data_{};
+    size_t head_{};
+    size_t size_{};
+    std::deque<uint32_t> messages_{};
+
+    void copy_out(size_t count, const pipe_data_sink& sink) const;
+    void consume(size_t count);
+};
+
+struct pending_pipe_operation
+{
+    bool server_end{};
+    bool synchronous{};
+    bool message_mode{};
+    uint32_t thread_id{};
+    handle file_handle{};
+    io_device_context context;
+
+    pending_pipe_operation(x86_64_emulator& emu)
+        : context(emu)
+    {
+    }
+
+    pending_pipe_operation(utils::buffer_deserializer& buffer)
+        : context(buffer)
+    {
+    }
+
+    void serialize(utils::buffer_serializer& buffer) const
+    {
+        buffer.write(this->server_end);
+        buffer.write(this->synchronous);
+        buffer.write(this->message_mode);
+        buffer.write(this->thread_id);
+        buffer.write(this->file_handle);
+        buffer.write(this->context);
+    }
+
+    void deserialize(utils::buffer_deserializer& buffer)
+    {
+        buffer.read(this->server_end);
+        buffer.read(this->synchronous);
+        buffer.read(this->message_mode);
+        buffer.read(this->thread_id);
+        buffer.read(this->file_handle);
+        buffer.read(this->context);
+    }
+};
+
+// A pipe instance shared by a server and a client file object.
+// Reads that find no data are queued and completed by the next write.
+struct named_pipe
+{
+    std::u16string name{};
+    bool message_type{};
+    ULONG maximum_instances{};
+    ULONG inbound_quota{};
+    ULONG outbound_quota{};
+    int64_t default_timeout{};
+    ULONG state{FILE_PIPE_LISTENING_STATE};
+    uint32_t connection{};
+    bool server_open{true};
+    bool client_open{false};
+
+    pipe_buffer inbound{};
+    pipe_buffer outbound{};
+    std::vector<pending_pipe_operation> pending_operations{};
+
+    bool is_closed() const
+    {
+        return !this->server_open && !this->client_open;
+    }
+
+    // A client can only connect while the server listens
+    bool is_available() const
+    {
+        return this->state == FILE_PIPE_LISTENING_STATE && this->server_open;
+    }
+
+    bool is_peer_open(const pipe_end& end) const
+    {
+        return end.is_server ? this->client_open : this->server_open;
+    }
+
+    bool has_pending_operation(handle file_handle) const;
+
+    pipe_buffer& get_read_buffer(const pipe_end& end)
+    {
+        return end.is_server ? this->inbound : this->outbound;
+    }
+
+    pipe_buffer& get_write_buffer(const pipe_end& end)
+    {
+        return end.is_server ? this->outbound : this->inbound;
+    }
+
+    NTSTATUS read(windows_emulator& win_emu, const pipe_end& end, handle file_handle, const io_device_context& c);
+    NTSTATUS write(windows_emulator& win_emu, const pipe_end& end, uint64_t address, size_t size);
+    NTSTATUS fs_control(windows_emulator& win_emu, const pipe_end& end, handle file_handle,
+                        const io_device_context& c);
+
+    void connect(windows_emulator& win_emu);
+    void close(windows_emulator& win_emu, const pipe_end& end);
+
+    void serialize(utils::buffer_serializer& buffer) const;
+    void deserialize(utils::buffer_deserializer& buffer);
+
+  private:
+    NTSTATUS validate_end(const pipe_end& end) const;
+    NTSTATUS listen(windows_emulator& win_emu, const pipe_end& end, handle file_handle, const io_device_context& c);
+    NTSTATUS disconnect(windows_emulator& win_emu, const pipe_end& end);
+    NTSTATUS peek(windows_emulator& win_emu, const pipe_end& end, const io_device_context& c);
+
+    void queue_operation(windows_emulator& win_emu, const pipe_end& end, handle file_handle,
+                         const io_device_context& c);
+    void complete_operations(windows_emulator& win_emu, NTSTATUS status,
+                             const std::function<bool(const pending_pipe_operation&)>& filter);
+};
+
+std::optional<std::u16string> get_pipe_name(std::u16string_view filename);
+bool has_available_pipe_instance(const std::map<uint32_t, named_pipe>& pipes, std::u16string_view name);
@@ -0,0 +1,176 @@
+#pragma once
+
+#include "std_include.hpp"
+
+#include <hook_interface.hpp>
+
+#include "handles.hpp"
+
+class windows_emulator;
+class emulator_thread;
+struct mapped_module;
+struct debug_output_message;
+
+// Events a plugin can subscribe to. The plugin manager only hooks the callbacks
+// of events in a plugin's mask, events nobody subscribed to cost nothing.
+enum class emulator_event : uint32_t
+{
+    none = 0,
+    syscall = 1 << 0,
+    memory_allocate = 1 << 1,
+    memory_protect = 1 << 2,
+    memory_violate = 1 << 3,
+    generic_access = 1 << 4,
+    generic_activity = 1 << 5,
+    suspicious_activity = 1 << 6,
+    exception = 1 << 7,
+    instruction = 1 << 8,
+    module_load = 1 << 9,
+    module_unload = 1 << 10,
+    thread_create = 1 << 11,
+    thread_terminated = 1 << 12,
+    stdout_output = 1 << 13,
+    debug_output = 1 << 14,
+};
+
+constexpr emulator_event operator|(const emulator_event x, const emulator_event y)
+{
+    return static_cast<emulator_event>(static_cast<uint32_t>(x) | static_cast<uint32_t>(y));
+}
+
+constexpr emulator_event operator&(const emulator_event x, const emulator_event y)
+{
+    return static_cast<emulator_event>(static_cast<uint32_t>(x) & static_cast<uint32_t>(y));
+}
+
+constexpr bool has_event(const emulator_event mask, const emulator_event event)
+{
+    return (mask & event) != emulator_event::none;
+}
+
+class emulator_plugin
+{
+  public:
+    using continuation = instruction_hook_continuation;
+
+    virtual ~emulator_plugin() = default;
+
+    virtual std::string_view get_name() const = 0;
+    virtual emulator_event get_subscriptions() const = 0;
+
+    virtual void on_attach(windows_emulator& win_emu)
+    {
+        (void)win_emu;
+    }
+
+    virtual void on_detach()
+    {
+    }
+
+    // Any plugin returning skip_instruction skips the syscall
+    virtual continuation on_syscall(uint32_t syscall_id, std::string_view syscall_name)
+    {
+        (void)syscall_id;
+        (void)syscall_name;
+        return continuation::run_instruction;
+    }
+
+    virtual void on_memory_allocate(uint64_t address, uint64_t length, memory_permission permission, bool commit)
+    {
+        (void)address;
+        (void)length;
+        (void)permission;
+        (void)commit;
+    }
+
+    virtual void on_memory_protect(uint64_t address, uint64_t length, memory_permission permission)
+    {
+        (void)address;
+        (void)length;
+        (void)permission;
+    }
+
+    virtual void on_memory_violate(uint64_t address, uint64_t length, memory_operation operation,
+                                   memory_violation_type type)
+    {
+        (void)address;
+        (void)length;
+        (void)operation;
+        (void)type;
+    }
+
+    virtual void on_generic_access(std::string_view type, std::u16string_view name)
+    {
+        (void)type;
+        (void)name;
+    }
+
+    virtual void on_generic_activity(std::string_view description)
+    {
+        (void)description;
+    }
+
+    virtual void on_suspicious_activity(std::string_view description)
+    {
+        (void)description;
+    }
+
+    virtual void on_exception(NTSTATUS exception_code)
+    {
+        (void)exception_code;
+    }
+
+    virtual void on_instruction(uint64_t address)
+    {
+        (void)address;
+    }
+
+    virtual void on_module_load(mapped_module& mod)
+    {
+        (void)mod;
+    }
+
+    virtual void on_module_unload(mapped_module& mod)
+    {
+        (void)mod;
+    }
+
+    virtual void on_thread_create(handle h, emulator_thread& thread)
+    {
+        (void)h;
+        (void)thread;
+    }
+
+    virtual void on_thread_terminated(handle h, emulator_thread& thread)
+    {
+        (void)h;
+        (void)thread;
+    }
+
+    virtual void on_stdout(std::string_view data)
+    {
+        (void)data;
+    }
+
+    virtual void on_debug_output(const debug_output_message& message)
+    {
+        (void)message;
+    }
+};
+
+// Plugins in shared libraries are C++ objects, so they have to be built with the same
+// compiler and emulator headers as the host. The version guards against stale builds.
+#define SOGEN_PLUGIN_API_VERSION 1
+
+using plugin_api_version_function = uint32_t (*)();
+using create_plugin_function = emulator_plugin* (*)();
+
+#define SOGEN_REGISTER_PLUGIN(plugin_type)                          \
+    extern "C" EXPORT_SYMBOL uint32_t sogen_plugin_api_version()    \
+    {                                                               \
+        return SOGEN_PLUGIN_API_VERSION;                            \
+    }                                                               \
+    extern "C" EXPORT_SYMBOL emulator_plugin* sogen_create_plugin() \
+    {                                                               \
+        return new plugin_type();                                   \
+    }
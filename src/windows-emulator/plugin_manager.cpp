@@ -0,0 +1,227 @@
+#include "std_include.hpp"
+#include "plugin_manager.hpp"
+#include "windows_emulator.hpp"
+
+namespace
+{
+    template <typename Signature, typename Handler>
+    std::function<void()> subscribe_to(utils::callback_list<Signature>& list, Handler&& handler)
+    {
+        const auto id = list.subscribe(std::forward<Handler>(handler));
+        return [&list, id] {
+            list.unsubscribe(id); //
+        };
+    }
+}
+
+plugin_manager::plugin_manager(windows_emulator& win_emu)
+    : win_emu_(&win_emu)
+{
+}
+
+plugin_manager::~plugin_manager()
+{
+    while (!this->plugins_.empty())
+    {
+        detach(*this->plugins_.back());
+        this->plugins_.pop_back();
+    }
+}
+
+emulator_plugin& plugin_manager::add(std::unique_ptr<emulator_plugin> plugin)
+{
+    if (!plugin)
+    {
+        throw std::runtime_error("Invalid plugin");
+    }
+
+    auto entry = std::make_unique<plugin_entry>();
+    entry->plugin = std::move(plugin);
+
+    return this->attach(std::move(entry));
+}
+
+emulator_plugin& plugin_manager::load(const std::filesystem::path& file)
+{
+    auto entry = std::make_unique<plugin_entry>();
+    entry->library = utils::library(file);
+
+    const auto get_version = entry->library.get<plugin_api_version_function>("sogen_plugin_api_version");
+    const auto create_plugin = entry->library.get<create_plugin_function>("sogen_create_plugin");
+
+    if (!get_version || !create_plugin)
+    {
+        throw std::runtime_error("Not a plugin: " + file.string());
+    }
+
+    const auto version = get_version();
+    if (version != SOGEN_PLUGIN_API_VERSION)
+    {
+        throw std::runtime_error("Unsupported plugin API version " + std::to_string(version) +
+                                 " (needed: " + std::to_string(SOGEN_PLUGIN_API_VERSION) + "): " + file.string());
+    }
+
+    entry->plugin.reset(create_plugin());
+    if (!entry->plugin)
+    {
+        throw std::runtime_error("Failed to create plugin: " + file.string());
+    }
+
+    return this->attach(std::move(entry));
+}
+
+void plugin_manager::remove(const emulator_plugin& plugin)
+{
+    const auto entry = std::ranges::find_if(this->plugins_, [&](const std::unique_ptr<plugin_entry>& e) {
+        return e->plugin.get() == &plugin; //
+    });
+
+    if (entry == this->plugins_.end())
+    {
+        return;
+    }
+
+    detach(**entry);
+    this->plugins_.erase(entry);
+}
+
+emulator_plugin& plugin_manager::attach(std::unique_ptr<plugin_entry> entry)
+{
+    auto& plugin = *entry->plugin;
+    plugin.on_attach(*this->win_emu_);
+
+    this->subscribe(*entry);
+    this->plugins_.push_back(std::move(entry));
+
+    return plugin;
+}
+
+void plugin_manager::subscribe(plugin_entry& entry)
+{
+    auto& p = *entry.plugin;
+    auto& cb = this->win_emu_->callbacks;
+    auto& subs = entry.unsubscribers;
+
+    const auto events = p.get_subscriptions();
+
+    if (has_event(events, emulator_event::syscall))
+    {
+        subs.push_back(subscribe_to(cb.on_syscall, [&p](const uint32_t syscall_id, const std::string_view name) {
+            return p.on_syscall(syscall_id, name); //
+        }));
+    }
+
+    if (has_event(events, emulator_event::memory_allocate))
+    {
+        subs.push_back(subscribe_to(cb.on_memory_allocate, [&p](const uint64_t address, const uint64_t length,
+                                                                const memory_permission permission, const bool commit) {
+            p.on_memory_allocate(address, length, permission, commit); //
+        }));
+    }
+
+    if (has_event(events, emulator_event::memory_protect))
+    {
+        subs.push_back(subscribe_to(cb.on_memory_protect, [&p](const uint64_t address, const uint64_t length,
+                                                               const memory_permission permission) {
+            p.on_memory_protect(address, length, permission); //
+        }));
+    }
+
+    if (has_event(events, emulator_event::memory_violate))
+    {
+        subs.push_back(subscribe_to(cb.on_memory_violate,
+                                    [&p](const uint64_t address, const uint64_t length,
+                                         const memory_operation operation, const memory_violation_type type) {
+                                        p.on_memory_violate(address, length, operation, type); //
+                                    }));
+    }
+
+    if (has_event(events, emulator_event::generic_access))
+    {
+        subs.push_back(subscribe_to(cb.on_generic_access, [&p](const std::string_view type,
+                                                               const std::u16string_view name) {
+            p.on_generic_access(type, name); //
+        }));
+    }
+
+    if (has_event(events, emulator_event::generic_activity))
+    {
+        subs.push_back(subscribe_to(cb.on_generic_activity, [&p](const std::string_view description) {
+            p.on_generic_activity(description); //
+        }));
+    }
+
+    if (has_event(events, emulator_event::suspicious_activity))
+    {
+        subs.push_back(subscribe_to(cb.on_suspicious_activity, [&p](const std::string_view description) {
+            p.on_suspicious_activity(description); //
+        }));
+    }
+
+    if (has_event(events, emulator_event::exception))
+    {
+        subs.push_back(subscribe_to(cb.on_exception, [&p](const NTSTATUS exception_code) {
+            p.on_exception(exception_code); //
+        }));
+    }
+
+    if (has_event(events, emulator_event::instruction))
+    {
+        subs.push_back(subscribe_to(cb.on_instruction, [&p](const uint64_t address) {
+            p.on_instruction(address); //
+        }));
+    }
+
+    if (has_event(events, emulator_event::module_load))
+    {
+        subs.push_back(subscribe_to(cb.on_module_load, [&p](mapped_module& mod) {
+            p.on_module_load(mod); //
+        }));
+    }
+
+    if (has_event(events, emulator_event::module_unload))
+    {
+        subs.push_back(subscribe_to(cb.on_module_unload, [&p](mapped_module& mod) {
+            p.on_module_unload(mod); //
+        }));
+    }
+
+    if (has_event(events, emulator_event::thread_create))
+    {
+        subs.push_back(subscribe_to(cb.on_thread_create, [&p](const handle h, emulator_thread& thread) {
+            p.on_thread_create(h, thread); //
+        }));
+    }
+
+    if (has_event(events, emulator_event::thread_terminated))
+    {
+        subs.push_back(subscribe_to(cb.on_thread_terminated, [&p](const handle h, emulator_thread& thread) {
+            p.on_thread_terminated(h, thread); //
+        }));
+    }
+
+    if (has_event(events, emulator_event::stdout_output))
+    {
+        subs.push_back(subscribe_to(cb.on_stdout, [&p](const std::string_view data) {
+            p.on_stdout(data); //
+        }));
+    }
+
+    if (has_event(events, emulator_event::debug_output))
+    {
+        subs.push_back(subscribe_to(cb.on_debug_output, [&p](const debug_output_message& message) {
+            p.on_debug_output(message); //
+        }));
+    }
+}
+
+void plugin_manager::detach(plugin_entry& entry)
+{
+    for (const auto& unsubscribe : entry.unsubscribers)
+    {
+        unsubscribe();
+    }
+
+    entry.unsubscribers.clear();
+    entry.plugin->on_detach();
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "std_include.hpp"
+#include "plugin.hpp"
+
+#include <utils/library.hpp>
+
+class windows_emulator;
+
+// Attaches plugins to the emulator callbacks. Every plugin only subscribes to the events in its
+// mask, and any number of plugins can observe the same event next to the primary callbacks.
+class plugin_manager
+{
+  public:
+    explicit plugin_manager(windows_emulator& win_emu);
+    ~plugin_manager();
+
+    plugin_manager(plugin_manager&&) = delete;
+    plugin_manager(const plugin_manager&) = delete;
+    plugin_manager& operator=(plugin_manager&&) = delete;
+    plugin_manager& operator=(const plugin_manager&) = delete;
+
+    emulator_plugin& add(std::unique_ptr<emulator_plugin> plugin);
+
+    // Loads a shared library exporting the SOGEN_REGISTER_PLUGIN entry points
+    emulator_plugin& load(const std::filesystem::path& file);
+
+    void remove(const emulator_plugin& plugin);
+
+    size_t size() const
+    {
+        return this->plugins_.size();
+    }
+
+  private:
+    struct plugin_entry
+    {
+        // Declared first, so that the library is unloaded after the plugin is gone
+        utils::library library{};
+        std::unique_ptr<emulator_plugin> plugin{};
+        std::vector<std::function<void()>> unsubscribers{};
+    };
+
+    windows_emulator* win_emu_{};
+    std::vector<std::unique_ptr<plugin_entry>> plugins_{};
+
+    emulator_plugin& attach(std::unique_ptr<plugin_entry> entry);
+    void subscribe(plugin_entry& entry);
+    static void detach(plugin_entry& entry);
+};
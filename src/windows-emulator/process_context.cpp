@@ -243,6 +243,8 @@ void process_context::setup(x86_64_emulator& emu, memory_manager& memory, regist
     this->rtl_user_thread_start = ntdll.find_export("RtlUserThreadStart");
     this->ki_user_apc_dispatcher = ntdll.find_export("KiUserApcDispatcher");
     this->ki_user_exception_dispatcher = ntdll.find_export("KiUserExceptionDispatcher");
+    this->rtl_lookup_function_entry = ntdll.find_export("RtlLookupFunctionEntry");
+    this->nt_query_virtual_memory = ntdll.find_export("NtQueryVirtualMemory");
 
     this->default_register_set = emu.save_registers();
 }
@@ -266,6 +268,8 @@ void process_context::serialize(utils::buffer_serializer& buffer) const
     buffer.write(this->rtl_user_thread_start);
     buffer.write(this->ki_user_apc_dispatcher);
     buffer.write(this->ki_user_exception_dispatcher);
+    buffer.write(this->rtl_lookup_function_entry);
+    buffer.write(this->nt_query_virtual_memory);
 
     buffer.write(this->events);
     buffer.write(this->files);
@@ -276,8 +280,11 @@ void process_context::serialize(utils::buffer_serializer& buffer) const
     buffer.write(this->mutants);
     buffer.write(this->windows);
     buffer.write(this->timers);
+    buffer.write(this->io_completions);
+    buffer.write(this->worker_factories);
     buffer.write(this->registry_keys);
     buffer.write_map(this->atoms);
+    buffer.write_map(this->pipes);
 
     buffer.write_vector(this->default_register_set);
     buffer.write(this->spawned_thread_count);
@@ -305,6 +312,8 @@ void process_context::deserialize(utils::buffer_deserializer& buffer)
     buffer.read(this->rtl_user_thread_start);
     buffer.read(this->ki_user_apc_dispatcher);
     buffer.read(this->ki_user_exception_dispatcher);
+    buffer.read(this->rtl_lookup_function_entry);
+    buffer.read(this->nt_query_virtual_memory);
 
     buffer.read(this->events);
     buffer.read(this->files);
@@ -315,8 +324,11 @@ void process_context::deserialize(utils::buffer_deserializer& buffer)
     buffer.read(this->mutants);
     buffer.read(this->windows);
     buffer.read(this->timers);
+    buffer.read(this->io_completions);
+    buffer.read(this->worker_factories);
     buffer.read(this->registry_keys);
     buffer.read_map(this->atoms);
+    buffer.read_map(this->pipes);
 
     buffer.read_vector(this->default_register_set);
     buffer.read(this->spawned_thread_count);
@@ -353,6 +365,12 @@ generic_handle_store* process_context::get_handle_store(const handle handle)
         return &ports;
     case handle_types::section:
         return &sections;
+    case handle_types::timer:
+        return &timers;
+    case handle_types::io_completion:
+        return &io_completions;
+    case handle_types::worker_factory:
+        return &worker_factories;
     default:
         return nullptr;
     }
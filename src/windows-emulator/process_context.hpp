@@ -11,6 +11,7 @@
 
 #include "io_device.hpp"
 #include "kusd_mmio.hpp"
+#include "named_pipe.hpp"
 #include "windows_objects.hpp"
 #include "emulator_thread.hpp"
 
@@ -32,10 +33,10 @@ struct process_context
 {
     struct callbacks
     {
-        utils::optional_function<void(handle h, emulator_thread& thr)> on_thread_create{};
-        utils::optional_function<void(handle h, emulator_thread& thr)> on_thread_terminated{};
-        utils::optional_function<void(emulator_thread& current_thread, emulator_thread& new_thread)> on_thread_switch{};
-        utils::optional_function<void(emulator_thread& current_thread)> on_thread_set_name{};
+        utils::callback_list<void(handle h, emulator_thread& thr)> on_thread_create{};
+        utils::callback_list<void(handle h, emulator_thread& thr)> on_thread_terminated{};
+        utils::callback_list<void(emulator_thread& current_thread, emulator_thread& new_thread)> on_thread_switch{};
+        utils::callback_list<void(emulator_thread& current_thread)> on_thread_set_name{};
     };
 
     struct atom_entry
@@ -106,6 +107,8 @@ struct process_context
     uint64_t rtl_user_thread_start{};
     uint64_t ki_user_apc_dispatcher{};
     uint64_t ki_user_exception_dispatcher{};
+    uint64_t rtl_lookup_function_entry{};
+    uint64_t nt_query_virtual_memory{};
 
     handle_store<handle_types::event, event> events{};
     handle_store<handle_types::file, file> files{};
@@ -116,8 +119,11 @@ struct process_context
     handle_store<handle_types::mutant, mutant> mutants{};
     handle_store<handle_types::window, window> windows{};
     handle_store<handle_types::timer, timer> timers{};
+    handle_store<handle_types::io_completion, io_completion> io_completions{};
+    handle_store<handle_types::worker_factory, worker_factory> worker_factories{};
     handle_store<handle_types::registry, registry_key, 2> registry_keys{};
     std::map<uint16_t, atom_entry> atoms{};
+    std::map<uint32_t, named_pipe> pipes{};
 
     std::vector<std::byte> default_register_set{};
 
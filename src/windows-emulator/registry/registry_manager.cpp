@@ -2,6 +2,8 @@
 #include "registry_manager.hpp"
 
 #include <serialization_helper.hpp>
+#include <utils/io.hpp>
+#include <utils/compression.hpp>
 
 #include "hive_parser.hpp"
 
@@ -28,6 +30,48 @@ namespace
         hives[key] = std::make_unique<hive_parser>(file);
     }
 
+    struct overlay_file_header
+    {
+        // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays,hicpp-avoid-c-arrays,modernize-avoid-c-arrays)
+        char magic[4] = {'R', 'E', 'G', 'D'};
+        uint32_t version{1};
+    };
+
+    static_assert(sizeof(overlay_file_header) == 8);
+
+    registry_value make_value(const overlay_value& value)
+    {
+        registry_value v{};
+        v.type = value.type;
+        v.name = value.name;
+        v.data = value.data;
+
+        return v;
+    }
+
+    registry_value make_value(const hive_value& value)
+    {
+        registry_value v{};
+        v.type = value.type;
+        v.name = value.name;
+        v.data = value.data;
+
+        return v;
+    }
+
+    std::string get_key_name(const std::filesystem::path& key)
+    {
+        const auto name = u16_to_u8(key.u16string());
+        const auto separator = name.find_last_of("\\/");
+
+        return separator == std::string::npos ? name : name.substr(separator + 1);
+    }
+
+    bool is_hive_root(const std::filesystem::path& path)
+    {
+        return path.empty() || path == ".";
+    }
+
     std::pair<utils::path_key, bool> perform_path_substitution(
         const std::unordered_map<utils::path_key, utils::path_key>& path_mapping, utils::path_key path)
     {
@@ -128,6 +172,22 @@ std::optional<registry_key> registry_manager::get_key(const utils::path_key& key
         return {std::move(reg_key)};
     }
 
+    if (this->is_overlay_relevant(reg_key))
+    {
+        const auto full_path = reg_key.get_full_path();
+        const auto* node = this->overlay_.find(full_path);
+
+        if (node && node->created && !node->deleted)
+        {
+            return {std::move(reg_key)};
+        }
+
+        if (this->overlay_.hides_lower(full_path))
+        {
+            return std::nullopt;
+        }
+    }
+
     auto path = reg_key.path.get();
     const auto* entry = iterator->second->get_sub_key(path);
 
@@ -154,6 +214,30 @@ std::optional<registry_key> registry_manager::get_key(const utils::path_key& key
 
 std::optional<registry_value> registry_manager::get_value(const registry_key& key, const std::string_view name)
 {
+    if (this->is_overlay_relevant(key))
+    {
+        const auto full_path = key.get_full_path();
+
+        if (const auto* node = this->overlay_.find(full_path))
+        {
+            const auto entry = node->values.find(utils::string::to_lower(std::string(name)));
+            if (entry != node->values.end())
+            {
+                if (entry->second.deleted)
+                {
+                    return std::nullopt;
+                }
+
+                return make_value(entry->second);
+            }
+        }
+
+        if (this->overlay_.hides_lower(full_path))
+        {
+            return std::nullopt;
+        }
+    }
+
     const auto iterator = this->hives_.find(key.hive);
     if (iterator == this->hives_.end())
     {
@@ -166,34 +250,34 @@ std::optional<registry_value> registry_manager::get_value(const registry_key& ke
         return std::nullopt;
     }
 
-    registry_value v{};
-    v.type = entry->type;
-    v.name = entry->name;
-    v.data = entry->data;
-
-    return v;
+    return make_value(*entry);
 }
 
 std::optional<registry_value> registry_manager::get_value(const registry_key& key, const size_t index)
 {
-    const auto iterator = this->hives_.find(key.hive);
-    if (iterator == this->hives_.end())
+    if (!this->is_overlay_relevant(key))
     {
-        return std::nullopt;
+        const auto* entry = this->get_hive_value(key, index);
+        if (!entry)
+        {
+            return std::nullopt;
+        }
+
+        return make_value(*entry);
     }
 
-    const auto* entry = iterator->second->get_value(key.path.get(), index);
-    if (!entry)
+    auto& listing = this->get_overlay_listing(key);
+    if (!listing.values)
     {
-        return std::nullopt;
+        listing.values = this->merge_values(key);
     }
 
-    registry_value v{};
-    v.type = entry->type;
-    v.name = entry->name;
-    v.data = entry->data;
+    if (index >= listing.values->size())
+    {
+        return std::nullopt;
+    }
 
-    return v;
+    return listing.values->at(index);
 }
 
 registry_manager::hive_map::iterator registry_manager::find_hive(const utils::path_key& key)
@@ -210,18 +294,320 @@ registry_manager::hive_map::iterator registry_manager::find_hive(const utils::pa
 }
 
 std::optional<std::string_view> registry_manager::get_sub_key_name(const registry_key& key, const size_t index)
+{
+    if (!this->is_overlay_relevant(key))
+    {
+        const auto* name = this->get_hive_sub_key_name(key, index);
+        if (!name)
+        {
+            return std::nullopt;
+        }
+
+        return *name;
+    }
+
+    auto& listing = this->get_overlay_listing(key);
+    if (!listing.sub_key_names)
+    {
+        listing.sub_key_names = this->merge_sub_key_names(key);
+    }
+
+    if (index >= listing.sub_key_names->size())
+    {
+        return std::nullopt;
+    }
+
+    return listing.sub_key_names->at(index);
+}
+
+// Overlay values follow the hive values they do not replace
+std::vector<registry_value> registry_manager::merge_values(const registry_key& key)
+{
+    const auto full_path = key.get_full_path();
+    const auto* node = this->overlay_.find(full_path);
+    const auto hides_lower = this->overlay_.hides_lower(full_path);
+
+    std::vector<registry_value> values{};
+
+    for (size_t i = 0; !hides_lower; ++i)
+    {
+        const auto* entry = this->get_hive_value(key, i);
+        if (!entry)
+        {
+            break;
+        }
+
+        if (!node || !node->values.contains(utils::string::to_lower(entry->name)))
+        {
+            values.push_back(make_value(*entry));
+        }
+    }
+
+    if (node)
+    {
+        for (const auto& value : node->values | std::views::values)
+        {
+            if (!value.deleted)
+            {
+                values.push_back(make_value(value));
+            }
+        }
+    }
+
+    return values;
+}
+
+// Sub keys created in the overlay follow the hive sub keys
+std::vector<std::string_view> registry_manager::merge_sub_key_names(const registry_key& key)
+{
+    const auto full_path = key.get_full_path();
+    const auto hides_lower = this->overlay_.hides_lower(full_path);
+
+    std::unordered_set<std::string> hive_names{};
+    std::vector<std::string_view> names{};
+
+    for (size_t i = 0; !hides_lower; ++i)
+    {
+        const auto* name = this->get_hive_sub_key_name(key, i);
+        if (!name)
+        {
+            break;
+        }
+
+        const auto* node = this->overlay_.find(full_path / *name);
+        if (node && node->deleted)
+        {
+            continue;
+        }
+
+        names.push_back(*name);
+        hive_names.insert(utils::string::to_lower(std::string(*name)));
+    }
+
+    for (const auto* node : this->overlay_.get_sub_keys(full_path))
+    {
+        if (!hive_names.contains(utils::string::to_lower(node->name)))
+        {
+            names.emplace_back(node->name);
+        }
+    }
+
+    return names;
+}
+
+bool registry_manager::is_overlay_relevant(const registry_key& key) const
+{
+    const auto entry = this->overlay_index_.find(key.hive);
+    if (entry == this->overlay_index_.end())
+    {
+        return false;
+    }
+
+    const auto& index = entry->second;
+    return index.has_whiteouts || is_hive_root(key.path.get()) || index.touched_keys.contains(key.path);
+}
+
+void registry_manager::touch_overlay_key(const registry_key& key, const bool whiteout)
+{
+    auto& index = this->overlay_index_[key.hive];
+    index.has_whiteouts |= whiteout;
+    index.listings.clear();
+
+    for (auto path = key.path.get(); !is_hive_root(path); path = path.parent_path())
+    {
+        index.touched_keys.emplace(path);
+    }
+}
+
+void registry_manager::rebuild_overlay_index()
+{
+    this->overlay_index_.clear();
+
+    this->overlay_.access_keys([&](const std::string& path, const overlay_key& node) {
+        const utils::path_key full_path{std::filesystem::path(u8_to_u16(path))};
+
+        const auto hive = this->find_hive(full_path);
+        if (hive == this->hives_.end())
+        {
+            return;
+        }
+
+        registry_key key{};
+        key.hive = hive->first;
+        key.path = full_path.get().lexically_relative(hive->first.get());
+
+        this->touch_overlay_key(key, node.deleted || node.opaque);
+    });
+}
+
+registry_manager::overlay_listing& registry_manager::get_overlay_listing(const registry_key& key)
+{
+    return this->overlay_index_[key.hive].listings[key.path];
+}
+
+const hive_value* registry_manager::get_hive_value(const registry_key& key, const size_t index)
 {
     const auto iterator = this->hives_.find(key.hive);
     if (iterator == this->hives_.end())
+    {
+        return nullptr;
+    }
+
+    return iterator->second->get_value(key.path.get(), index);
+}
+
+const std::string_view* registry_manager::get_hive_sub_key_name(const registry_key& key, const size_t index)
+{
+    const auto iterator = this->hives_.find(key.hive);
+    if (iterator == this->hives_.end())
+    {
+        return nullptr;
+    }
+
+    return iterator->second->get_sub_key_name(key.path.get(), index);
+}
+
+std::optional<registry_key> registry_manager::create_key(const std::filesystem::path& key, bool* created)
+{
+    if (created)
+    {
+        *created = false;
+    }
+
+    const utils::path_key key_path{key};
+
+    if (auto existing = this->get_key(key_path))
+    {
+        return existing;
+    }
+
+    const auto normal_key = this->normalize_path(key_path);
+    const auto iterator = this->find_hive(normal_key);
+    if (iterator == this->hives_.end())
+    {
+        return std::nullopt;
+    }
+
+    registry_key reg_key{};
+    reg_key.hive = iterator->first.get();
+    reg_key.path = normal_key.get().lexically_relative(reg_key.hive.get());
+
+    const auto& relative_path = reg_key.path.get();
+    if (relative_path.empty())
     {
         return std::nullopt;
     }
 
-    const auto* name = iterator->second->get_sub_key_name(key.path.get(), index);
-    if (!name)
+    const auto parent_path = relative_path.parent_path();
+    if (!parent_path.empty() && !this->get_key(reg_key.hive.get() / parent_path))
     {
         return std::nullopt;
     }
 
-    return *name;
+    const auto recreated = this->overlay_.hides_lower(reg_key.get_full_path());
+    this->overlay_.create_key(reg_key.get_full_path(), get_key_name(key));
+    this->touch_overlay_key(reg_key, recreated);
+
+    if (created)
+    {
+        *created = true;
+    }
+
+    return {std::move(reg_key)};
+}
+
+bool registry_manager::delete_key(const registry_key& key)
+{
+    if (key.path.get().empty() || this->get_sub_key_name(key, 0))
+    {
+        return false;
+    }
+
+    this->overlay_.delete_key(key.get_full_path());
+    this->touch_overlay_key(key, true);
+
+    return true;
+}
+
+void registry_manager::set_value(const registry_key& key, std::string name, const uint32_t type,
+                                 std::vector<std::byte> data)
+{
+    overlay_value value{};
+    value.type = type;
+    value.name = std::move(name);
+    value.data = std::move(data);
+
+    this->overlay_.set_value(key.get_full_path(), std::move(value));
+    this->touch_overlay_key(key, false);
+}
+
+bool registry_manager::delete_value(const registry_key& key, const std::string_view name)
+{
+    if (!this->get_value(key, name))
+    {
+        return false;
+    }
+
+    this->overlay_.delete_value(key.get_full_path(), name);
+    this->touch_overlay_key(key, false);
+
+    return true;
+}
+
+bool registry_manager::save_overlay(const std::filesystem::path& file) const
+{
+    utils::buffer_serializer buffer{};
+    this->overlay_.serialize(buffer);
+
+    constexpr overlay_file_header header{};
+    const auto compressed = utils::compression::zlib::compress(buffer.get_buffer());
+
+    std::vector<std::byte> data(sizeof(header));
+    memcpy(data.data(), &header, sizeof(header));
+    data.insert(data.end(), compressed.begin(), compressed.end());
+
+    return utils::io::write_file(file, data);
+}
+
+void registry_manager::load_overlay(const std::filesystem::path& file)
+{
+    std::vector<std::byte> data{};
+    if (!utils::io::read_file(file, &data))
+    {
+        throw std::runtime_error("Failed to read registry delta: " + file.string());
+    }
+
+    overlay_file_header header{};
+    constexpr overlay_file_header default_header{};
+
+    if (data.size() < sizeof(header))
+    {
+        throw std::runtime_error("Registry delta is too small");
+    }
+
+    memcpy(&header, data.data(), sizeof(header));
+
+    if (memcmp(default_header.magic, header.magic, sizeof(header.magic)) != 0 ||
+        default_header.version != header.version)
+    {
+        throw std::runtime_error("Invalid registry delta: " + file.string());
+    }
+
+    const auto decompressed =
+        utils::compression::zlib::decompress(std::span<const std::byte>(data).subspan(sizeof(header)));
+
+    utils::buffer_deserializer buffer{decompressed};
+    this->overlay_.deserialize(buffer);
+    this->rebuild_overlay_index();
+}
+
+void registry_manager::serialize(utils::buffer_serializer& buffer) const
+{
+    this->overlay_.serialize(buffer);
+}
+
+void registry_manager::deserialize(utils::buffer_deserializer& buffer)
+{
+    this->overlay_.deserialize(buffer);
+    this->rebuild_overlay_index();
 }
@@ -2,6 +2,7 @@
 
 #include "../std_include.hpp"
 #include "hive_parser.hpp"
+#include "registry_overlay.hpp"
 #include "serialization_helper.hpp"
 #include "../handles.hpp"
 
@@ -45,6 +46,11 @@ struct registry_key : ref_counted_object
     {
         return this->hive.get().u16string() + u"\\" + this->path.get().u16string();
     }
+
+    std::filesystem::path get_full_path() const
+    {
+        return this->hive.get() / this->path.get();
+    }
 };
 
 struct registry_value
@@ -76,15 +82,67 @@ class registry_manager
 
     std::optional<std::string_view> get_sub_key_name(const registry_key& key, size_t index);
 
+    // Modifications are kept in an overlay, the hives are never written.
+    // Opens the key if it exists, otherwise its parent has to exist.
+    std::optional<registry_key> create_key(const std::filesystem::path& key, bool* created = nullptr);
+
+    // Keys with sub keys can not be deleted
+    bool delete_key(const registry_key& key);
+
+    void set_value(const registry_key& key, std::string name, uint32_t type, std::vector<std::byte> data);
+    bool delete_value(const registry_key& key, std::string_view name);
+
+    const registry_overlay& get_overlay() const
+    {
+        return this->overlay_;
+    }
+
+    // Compact delta file of all modifications, to carry them over to later runs
+    bool save_overlay(const std::filesystem::path& file) const;
+    void load_overlay(const std::filesystem::path& file);
+
+    // Only the overlay is serialized, the hives are immutable
+    void serialize(utils::buffer_serializer& buffer) const;
+    void deserialize(utils::buffer_deserializer& buffer);
+
   private:
+    // Merged hive and overlay enumeration of a key, valid until the hive is modified again
+    struct overlay_listing
+    {
+        std::optional<std::vector<registry_value>> values{};
+        std::optional<std::vector<std::string_view>> sub_key_names{};
+    };
+
+    // Keys of a hive that are in the overlay, along with their parents.
+    // Lookups of keys that were never touched skip the overlay entirely.
+    struct hive_overlay_index
+    {
+        std::unordered_set<utils::path_key> touched_keys{};
+        bool has_whiteouts{};
+        std::unordered_map<utils::path_key, overlay_listing> listings{};
+    };
+
     std::filesystem::path hive_path_{};
     hive_map hives_{};
     std::unordered_map<utils::path_key, utils::path_key> path_mapping_{};
+    registry_overlay overlay_{};
+    std::unordered_map<utils::path_key, hive_overlay_index> overlay_index_{};
 
     utils::path_key normalize_path(utils::path_key path) const;
     void add_path_mapping(const utils::path_key& key, const utils::path_key& value);
 
     hive_map::iterator find_hive(const utils::path_key& key);
 
+    const hive_value* get_hive_value(const registry_key& key, size_t index);
+    const std::string_view* get_hive_sub_key_name(const registry_key& key, size_t index);
+
+    bool is_overlay_relevant(const registry_key& key) const;
+    void touch_overlay_key(const registry_key& key, bool whiteout);
+    void rebuild_overlay_index();
+    overlay_listing& get_overlay_listing(const registry_key& key);
+
+    std::vector<registry_value> merge_values(const registry_key& key);
+    std::vector<std::string_view> merge_sub_key_names(const registry_key& key);
+
     void setup();
 };
@@ -0,0 +1,169 @@
+#include "../std_include.hpp"
+#include "registry_overlay.hpp"
+
+#include <utils/string.hpp>
+
+std::string registry_overlay::get_lookup_key(const std::filesystem::path& key)
+{
+    auto lookup = utils::string::to_lower(u16_to_u8(key.generic_u16string()));
+    while (lookup.ends_with('/'))
+    {
+        lookup.pop_back();
+    }
+
+    return lookup;
+}
+
+const overlay_key* registry_overlay::find(const std::filesystem::path& key) const
+{
+    const auto entry = this->keys_.find(get_lookup_key(key));
+    return entry == this->keys_.end() ? nullptr : &entry->second;
+}
+
+overlay_key* registry_overlay::find(const std::filesystem::path& key)
+{
+    const auto entry = this->keys_.find(get_lookup_key(key));
+    return entry == this->keys_.end() ? nullptr : &entry->second;
+}
+
+bool registry_overlay::hides_lower(const std::filesystem::path& key) const
+{
+    if (this->whiteouts_ == 0)
+    {
+        return false;
+    }
+
+    auto current = get_lookup_key(key);
+
+    while (!current.empty())
+    {
+        const auto entry = this->keys_.find(current);
+        if (entry != this->keys_.end() && (entry->second.deleted || entry->second.opaque))
+        {
+            return true;
+        }
+
+        const auto separator = current.find_last_of('/');
+        if (separator == std::string::npos)
+        {
+            break;
+        }
+
+        current.resize(separator);
+    }
+
+    return false;
+}
+
+bool registry_overlay::covers(const std::filesystem::path& key) const
+{
+    if (this->keys_.empty())
+    {
+        return false;
+    }
+
+    const auto lookup = get_lookup_key(key);
+    if (this->keys_.contains(lookup))
+    {
+        return true;
+    }
+
+    const auto prefix = lookup + '/';
+    const auto entry = this->keys_.lower_bound(prefix);
+
+    return entry != this->keys_.end() && entry->first.starts_with(prefix);
+}
+
+overlay_key& registry_overlay::create_key(const std::filesystem::path& key, std::string name)
+{
+    auto& node = this->keys_[get_lookup_key(key)];
+    const auto was_deleted = node.deleted;
+
+    node = {};
+    node.name = std::move(name);
+    node.created = true;
+    node.opaque = was_deleted;
+
+    this->count_whiteouts();
+    return node;
+}
+
+void registry_overlay::delete_key(const std::filesystem::path& key)
+{
+    const auto lookup = get_lookup_key(key);
+    const auto prefix = lookup + '/';
+
+    for (auto i = this->keys_.lower_bound(prefix); i != this->keys_.end() && i->first.starts_with(prefix);)
+    {
+        i = this->keys_.erase(i);
+    }
+
+    auto& node = this->keys_[lookup];
+    node.values.clear();
+    node.created = false;
+    node.deleted = true;
+    node.opaque = false;
+
+    this->count_whiteouts();
+}
+
+void registry_overlay::set_value(const std::filesystem::path& key, overlay_value value)
+{
+    auto& node = this->keys_[get_lookup_key(key)];
+    value.deleted = false;
+
+    node.values[utils::string::to_lower(value.name)] = std::move(value);
+}
+
+void registry_overlay::delete_value(const std::filesystem::path& key, const std::string_view name)
+{
+    auto& node = this->keys_[get_lookup_key(key)];
+
+    overlay_value value{};
+    value.name = name;
+    value.deleted = true;
+
+    node.values[utils::string::to_lower(value.name)] = std::move(value);
+}
+
+std::vector<const overlay_key*> registry_overlay::get_sub_keys(const std::filesystem::path& key) const
+{
+    const auto prefix = get_lookup_key(key) + '/';
+
+    std::vector<const overlay_key*> sub_keys{};
+
+    for (auto i = this->keys_.lower_bound(prefix); i != this->keys_.end() && i->first.starts_with(prefix); ++i)
+    {
+        const auto is_direct_child = i->first.find('/', prefix.size()) == std::string::npos;
+        if (is_direct_child && i->second.created && !i->second.deleted)
+        {
+            sub_keys.push_back(&i->second);
+        }
+    }
+
+    return sub_keys;
+}
+
+void registry_overlay::count_whiteouts()
+{
+    this->whiteouts_ = 0;
+
+    for (const auto& key : this->keys_ | std::views::values)
+    {
+        if (key.deleted || key.opaque)
+        {
+            ++this->whiteouts_;
+        }
+    }
+}
+
+void registry_overlay::serialize(utils::buffer_serializer& buffer) const
+{
+    buffer.write_map(this->keys_);
+}
+
+void registry_overlay::deserialize(utils::buffer_deserializer& buffer)
+{
+    buffer.read_map(this->keys_);
+    this->count_whiteouts();
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "../std_include.hpp"
+
+#include <serialization.hpp>
+
+struct overlay_value
+{
+    uint32_t type{};
+    std::string name{};
+    std::vector<std::byte> data{};
+    bool deleted{};
+
+    void serialize(utils::buffer_serializer& buffer) const
+    {
+        buffer.write(this->type);
+        buffer.write(this->name);
+        buffer.write_vector(this->data);
+        buffer.write(this->deleted);
+    }
+
+    void deserialize(utils::buffer_deserializer& buffer)
+    {
+        buffer.read(this->type);
+        buffer.read(this->name);
+        buffer.read_vector(this->data);
+        buffer.read(this->deleted);
+    }
+};
+
+struct overlay_key
+{
+    // Name of the key as created, the lookup path is lower case
+    std::string name{};
+
+    // Created in the overlay, otherwise the key only carries value changes of a hive key
+    bool created{};
+    bool deleted{};
+    bool opaque{};
+
+    // Keyed by the lower case value name
+    std::map<std::string, overlay_value> values{};
+
+    void serialize(utils::buffer_serializer& buffer) const
+    {
+        buffer.write(this->name);
+        buffer.write(this->created);
+        buffer.write(this->deleted);
+        buffer.write(this->opaque);
+        buffer.write_map(this->values);
+    }
+
+    void deserialize(utils::buffer_deserializer& buffer)
+    {
+        buffer.read(this->name);
+        buffer.read(this->created);
+        buffer.read(this->deleted);
+        buffer.read(this->opaque);
+        buffer.read_map(this->values);
+    }
+};
+
+// Copy-on-write layer above the read-only hives. Keys are addressed by their full
+// lower case path. Deleted keys and values are recorded as whiteouts that hide the
+// hive contents, keys recreated over a whiteout are opaque.
+class registry_overlay
+{
+  public:
+    const overlay_key* find(const std::filesystem::path& key) const;
+    overlay_key* find(const std::filesystem::path& key);
+
+    bool hides_lower(const std::filesystem::path& key) const;
+
+    // True if the key or anything below it was touched
+    bool covers(const std::filesystem::path& key) const;
+
+    overlay_key& create_key(const std::filesystem::path& key, std::string name);
+    void delete_key(const std::filesystem::path& key);
+
+    void set_value(const std::filesystem::path& key, overlay_value value);
+    void delete_value(const std::filesystem::path& key, std::string_view name);
+
+    // Direct sub keys created in the overlay
+    std::vector<const overlay_key*> get_sub_keys(const std::filesystem::path& key) const;
+
+    bool empty() const
+    {
+        return this->keys_.empty();
+    }
+
+    template <typename F>
+    void access_keys(const F& accessor) const
+    {
+        for (const auto& [path, key] : this->keys_)
+        {
+            accessor(path, key);
+        }
+    }
+
+    void serialize(utils::buffer_serializer& buffer) const;
+    void deserialize(utils::buffer_deserializer& buffer);
+
+  private:
+    std::map<std::string, overlay_key> keys_{};
+    size_t whiteouts_{0};
+
+    static std::string get_lookup_key(const std::filesystem::path& key);
+    void count_whiteouts();
+};
@@ -0,0 +1,516 @@
+#include "std_include.hpp"
+#include "stack_trace.hpp"
+#include "windows_emulator.hpp"
+
+namespace
+{
+    constexpr size_t max_chained_unwind_infos = 32;
+    constexpr size_t max_heuristic_stack_slots = 0x800;
+
+    constexpr uint8_t UNW_FLAG_CHAININFO = 0x4;
+
+    enum unwind_operation : uint8_t
+    {
+        UWOP_PUSH_NONVOL = 0,
+        UWOP_ALLOC_LARGE = 1,
+        UWOP_ALLOC_SMALL = 2,
+        UWOP_SET_FPREG = 3,
+        UWOP_SAVE_NONVOL = 4,
+        UWOP_SAVE_NONVOL_FAR = 5,
+        UWOP_EPILOG = 6,
+        UWOP_SPARE_CODE = 7,
+        UWOP_SAVE_XMM128 = 8,
+        UWOP_SAVE_XMM128_FAR = 9,
+        UWOP_PUSH_MACHFRAME = 10,
+    };
+
+    constexpr size_t rsp_index = 4;
+    constexpr size_t rbp_index = 5;
+
+    constexpr std::array<x86_register, 16> unwind_registers{
+        x86_register::rax, x86_register::rcx, x86_register::rdx, x86_register::rbx,
+        x86_register::rsp, x86_register::rbp, x86_register::rsi, x86_register::rdi,
+        x86_register::r8,  x86_register::r9,  x86_register::r10, x86_register::r11,
+        x86_register::r12, x86_register::r13, x86_register::r14, x86_register::r15,
+    };
+
+    struct unwind_context
+    {
+        uint64_t rip{};
+        std::array<uint64_t, 16> registers{};
+
+        uint64_t& rsp()
+        {
+            return this->registers[rsp_index];
+        }
+
+        uint64_t& rbp()
+        {
+            return this->registers[rbp_index];
+        }
+    };
+
+    struct stack_bounds
+    {
+        uint64_t start{};
+        uint64_t end{};
+
+        bool contains(const uint64_t address) const
+        {
+            if (this->start == this->end)
+            {
+                return address != 0;
+            }
+
+            return address >= this->start && address < this->end;
+        }
+    };
+
+    template <typename T>
+    bool read_value(const x86_64_emulator& emu, const uint64_t address, T& value)
+    {
+        return emu.try_read_memory(address, &value, sizeof(value));
+    }
+
+    size_t get_unwind_code_slots(const uint8_t operation, const uint8_t info)
+    {
+        switch (operation)
+        {
+        case UWOP_ALLOC_LARGE:
+            return info == 0 ? 2 : 3;
+        case UWOP_SAVE_NONVOL:
+        case UWOP_SAVE_XMM128:
+        case UWOP_EPILOG:
+            return 2;
+        case UWOP_SAVE_NONVOL_FAR:
+        case UWOP_SAVE_XMM128_FAR:
+        case UWOP_SPARE_CODE:
+            return 3;
+        default:
+            return 1;
+        }
+    }
+
+    // Returns true if the leaf frame sits in an epilog and was unwound by simulating it
+    bool unwind_epilog(const x86_64_emulator& emu, unwind_context& context)
+    {
+        std::array<uint8_t, 0x40> code{};
+        if (!read_value(emu, context.rip, code))
+        {
+            return false;
+        }
+
+        auto simulated = context;
+
+        for (size_t offset = 0; offset < code.size();)
+        {
+            const auto remaining = code.size() - offset;
+            const auto* instruction = code.data() + offset;
+
+            if (instruction[0] == 0xC3 || instruction[0] == 0xC2)
+            {
+                if (!read_value(emu, simulated.rsp(), simulated.rip))
+                {
+                    return false;
+                }
+
+                simulated.rsp() += sizeof(uint64_t);
+                context = simulated;
+                return true;
+            }
+
+            if (instruction[0] >= 0x58 && instruction[0] <= 0x5F)
+            {
+                if (!read_value(emu, simulated.rsp(), simulated.registers[instruction[0] - 0x58]))
+                {
+                    return false;
+                }
+
+                simulated.rsp() += sizeof(uint64_t);
+                offset += 1;
+            }
+            else if (remaining >= 2 && instruction[0] == 0x41 && instruction[1] >= 0x58 && instruction[1] <= 0x5F)
+            {
+                if (!read_value(emu, simulated.rsp(), simulated.registers[8 + instruction[1] - 0x58]))
+                {
+                    return false;
+                }
+
+                simulated.rsp() += sizeof(uint64_t);
+                offset += 2;
+            }
+            else if (remaining >= 4 && instruction[0] == 0x48 && instruction[1] == 0x83 && instruction[2] == 0xC4)
+            {
+                simulated.rsp() += instruction[3];
+                offset += 4;
+            }
+            else if (remaining >= 7 && instruction[0] == 0x48 && instruction[1] == 0x81 && instruction[2] == 0xC4)
+            {
+                uint32_t size{};
+                memcpy(&size, instruction + 3, sizeof(size));
+                simulated.rsp() += size;
+                offset += 7;
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        return false;
+    }
+
+    bool unwind_with_function_entry(const x86_64_emulator& emu, const mapped_module& mod, runtime_function function,
+                                    unwind_context& context)
+    {
+        bool has_machine_frame = false;
+
+        for (size_t depth = 0; depth < max_chained_unwind_infos; ++depth)
+        {
+            const auto unwind_info = mod.image_base + function.unwind_info;
+
+            std::array<uint8_t, 4> header{};
+            if (!read_value(emu, unwind_info, header))
+            {
+                return false;
+            }
+
+            const auto flags = static_cast<uint8_t>(header[0] >> 3);
+            const auto prolog_size = header[1];
+            const auto code_count = header[2];
+            const auto frame_register = static_cast<uint8_t>(header[3] & 0xF);
+            const auto frame_offset = static_cast<uint64_t>(header[3] >> 4) * 16;
+
+            std::vector<uint16_t> codes{};
+            codes.resize(code_count);
+
+            if (code_count > 0 && !emu.try_read_memory(unwind_info + 4, codes.data(), codes.size() * 2))
+            {
+                return false;
+            }
+
+            const auto function_start = mod.image_base + function.begin_address;
+            const auto prolog_offset = context.rip >= function_start + prolog_size
+                                           ? std::numeric_limits<uint64_t>::max()
+                                           : context.rip - function_start;
+
+            for (size_t i = 0; i < codes.size();)
+            {
+                const auto code_offset = static_cast<uint8_t>(codes[i] & 0xFF);
+                const auto operation = static_cast<uint8_t>((codes[i] >> 8) & 0xF);
+                const auto info = static_cast<uint8_t>(codes[i] >> 12);
+                const auto slots = get_unwind_code_slots(operation, info);
+
+                if (i + slots > codes.size())
+                {
+                    return false;
+                }
+
+                if (prolog_offset < code_offset)
+                {
+                    i += slots;
+                    continue;
+                }
+
+                switch (operation)
+                {
+                case UWOP_PUSH_NONVOL:
+                    if (!read_value(emu, context.rsp(), context.registers[info]))
+                    {
+                        return false;
+                    }
+                    context.rsp() += sizeof(uint64_t);
+                    break;
+
+                case UWOP_ALLOC_LARGE:
+                    context.rsp() += info == 0 ? static_cast<uint64_t>(codes[i + 1]) * 8
+                                               : codes[i + 1] | (static_cast<uint64_t>(codes[i + 2]) << 16);
+                    break;
+
+                case UWOP_ALLOC_SMALL:
+                    context.rsp() += (static_cast<uint64_t>(info) * 8) + 8;
+                    break;
+
+                case UWOP_SET_FPREG:
+                    context.rsp() = context.registers[frame_register] - frame_offset;
+                    break;
+
+                case UWOP_SAVE_NONVOL:
+                    if (!read_value(emu, context.rsp() + (static_cast<uint64_t>(codes[i + 1]) * 8),
+                                    context.registers[info]))
+                    {
+                        return false;
+                    }
+                    break;
+
+                case UWOP_SAVE_NONVOL_FAR:
+                    if (!read_value(emu, context.rsp() + (codes[i + 1] | (static_cast<uint64_t>(codes[i + 2]) << 16)),
+                                    context.registers[info]))
+                    {
+                        return false;
+                    }
+                    break;
+
+                case UWOP_PUSH_MACHFRAME: {
+                    const auto frame = context.rsp() + (info ? sizeof(uint64_t) : 0);
+                    if (!read_value(emu, frame, context.rip) || !read_value(emu, frame + 0x18, context.rsp()))
+                    {
+                        return false;
+                    }
+
+                    has_machine_frame = true;
+                    break;
+                }
+
+                default:
+                    break;
+                }
+
+                i += slots;
+            }
+
+            if (!(flags & UNW_FLAG_CHAININFO))
+            {
+                break;
+            }
+
+            const auto chain_offset = unwind_info + 4 + (static_cast<uint64_t>((code_count + 1) & ~1) * 2);
+            if (!read_value(emu, chain_offset, function))
+            {
+                return false;
+            }
+        }
+
+        if (has_machine_frame)
+        {
+            return true;
+        }
+
+        if (!read_value(emu, context.rsp(), context.rip))
+        {
+            return false;
+        }
+
+        context.rsp() += sizeof(uint64_t);
+        return true;
+    }
+
+    bool unwind_with_frame_pointer(const x86_64_emulator& emu, const stack_bounds& bounds, unwind_context& context)
+    {
+        const auto rbp = context.rbp();
+        if (!bounds.contains(rbp) || rbp < context.rsp() || (rbp & 7) != 0)
+        {
+            return false;
+        }
+
+        uint64_t saved_rbp{};
+        uint64_t return_address{};
+
+        if (!read_value(emu, rbp, saved_rbp) || !read_value(emu, rbp + 8, return_address))
+        {
+            return false;
+        }
+
+        context.rbp() = saved_rbp;
+        context.rip = return_address;
+        context.rsp() = rbp + 16;
+
+        return true;
+    }
+
+    bool is_executable_address(const mapped_module& mod, const uint64_t address)
+    {
+        return std::ranges::any_of(mod.sections, [&](const mapped_section& section) {
+            return is_executable(section.region.permissions) && address >= section.region.start &&
+                   address < section.region.start + section.region.length;
+        });
+    }
+
+    bool is_preceded_by_call(const x86_64_emulator& emu, const uint64_t address)
+    {
+        std::array<uint8_t, 7> code{};
+        if (!read_value(emu, address - code.size(), code))
+        {
+            return false;
+        }
+
+        const auto byte_at = [&](const size_t distance) { return code[code.size() - distance]; };
+
+        if (byte_at(5) == 0xE8)
+        {
+            return true;
+        }
+
+        // FF /2: indirect calls through register or memory operands
+        for (size_t distance = 2; distance <= code.size(); ++distance)
+        {
+            if (byte_at(distance) == 0xFF && ((byte_at(distance - 1) >> 3) & 7) == 2)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool unwind_with_heuristic(windows_emulator& win_emu, const stack_bounds& bounds, unwind_context& context)
+    {
+        const auto& emu = win_emu.emu();
+
+        for (size_t i = 0; i < max_heuristic_stack_slots; ++i)
+        {
+            const auto slot = context.rsp() + (i * sizeof(uint64_t));
+            if (!bounds.contains(slot))
+            {
+                break;
+            }
+
+            uint64_t value{};
+            if (!read_value(emu, slot, value))
+            {
+                break;
+            }
+
+            const auto* mod = win_emu.mod_manager.find_by_address(value);
+            if (!mod || !is_executable_address(*mod, value) || !is_preceded_by_call(emu, value))
+            {
+                continue;
+            }
+
+            context.rip = value;
+            context.rsp() = slot + sizeof(uint64_t);
+            return true;
+        }
+
+        return false;
+    }
+
+    stack_bounds get_stack_bounds(const windows_emulator& win_emu)
+    {
+        const auto* thread = win_emu.process.active_thread;
+        if (!thread || !thread->stack_base)
+        {
+            return {};
+        }
+
+        return {
+            .start = thread->stack_base,
+            .end = thread->stack_base + thread->stack_size,
+        };
+    }
+
+    stack_frame_source unwind_frame(windows_emulator& win_emu, const stack_bounds& bounds, unwind_context& context,
+                                    const bool is_leaf)
+    {
+        const auto& emu = win_emu.emu();
+        const auto* mod = win_emu.mod_manager.find_by_address(context.rip);
+
+        if (mod)
+        {
+            // Return addresses may point past the end of a function ending in a call
+            const auto lookup_address = is_leaf ? context.rip : context.rip - 1;
+            const auto* function = mod->find_function_entry(lookup_address);
+
+            if (function)
+            {
+                auto unwound = context;
+                if ((is_leaf && unwind_epilog(emu, unwound)) ||
+                    unwind_with_function_entry(emu, *mod, *function, unwound))
+                {
+                    context = unwound;
+                    return stack_frame_source::unwind_info;
+                }
+            }
+            else if (is_leaf && !mod->functions.entries.empty())
+            {
+                // Leaf functions have no unwind data and keep the return address at rsp
+                auto unwound = context;
+                if (read_value(emu, unwound.rsp(), unwound.rip))
+                {
+                    unwound.rsp() += sizeof(uint64_t);
+                    context = unwound;
+                    return stack_frame_source::unwind_info;
+                }
+            }
+        }
+
+        if (unwind_with_frame_pointer(emu, bounds, context))
+        {
+            return stack_frame_source::frame_pointer;
+        }
+
+        if (unwind_with_heuristic(win_emu, bounds, context))
+        {
+            return stack_frame_source::heuristic;
+        }
+
+        return stack_frame_source::instruction_pointer;
+    }
+
+    stack_frame make_frame(windows_emulator& win_emu, const unwind_context& context, const stack_frame_source source)
+    {
+        return {
+            .address = context.rip,
+            .stack_pointer = context.registers[rsp_index],
+            .module = win_emu.mod_manager.find_by_address(context.rip),
+            .symbol = win_emu.symbols.describe(win_emu.mod_manager, context.rip),
+            .source = source,
+        };
+    }
+}
+
+stack_trace capture_stack_trace(windows_emulator& win_emu, const size_t max_frames)
+{
+    stack_trace trace{};
+    if (max_frames == 0 || !win_emu.process.active_thread)
+    {
+        return trace;
+    }
+
+    auto& emu = win_emu.emu();
+
+    unwind_context context{};
+    context.rip = emu.read_instruction_pointer();
+
+    for (size_t i = 0; i < unwind_registers.size(); ++i)
+    {
+        context.registers[i] = emu.reg(unwind_registers[i]);
+    }
+
+    const auto bounds = get_stack_bounds(win_emu);
+
+    trace.push_back(make_frame(win_emu, context, stack_frame_source::instruction_pointer));
+
+    while (trace.size() < max_frames)
+    {
+        const auto previous_rsp = context.rsp();
+        const auto source = unwind_frame(win_emu, bounds, context, trace.size() == 1);
+
+        if (source == stack_frame_source::instruction_pointer || context.rip == 0 || context.rsp() <= previous_rsp ||
+            !bounds.contains(context.rsp()))
+        {
+            break;
+        }
+
+        trace.push_back(make_frame(win_emu, context, source));
+    }
+
+    return trace;
+}
+
+const char* get_stack_frame_source_name(const stack_frame_source source)
+{
+    switch (source)
+    {
+    case stack_frame_source::instruction_pointer:
+        return "ip";
+    case stack_frame_source::unwind_info:
+        return "unwind";
+    case stack_frame_source::frame_pointer:
+        return "frame";
+    case stack_frame_source::heuristic:
+        return "scan";
+    default:
+        return "?";
+    }
+}
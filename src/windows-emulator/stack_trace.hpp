@@ -0,0 +1,30 @@
+#pragma once
+
+struct mapped_module;
+class windows_emulator;
+
+enum class stack_frame_source : uint8_t
+{
+    instruction_pointer,
+    unwind_info,
+    frame_pointer,
+    heuristic,
+};
+
+struct stack_frame
+{
+    uint64_t address{};
+    uint64_t stack_pointer{};
+    const mapped_module* module{};
+    std::string symbol{};
+    stack_frame_source source{stack_frame_source::instruction_pointer};
+};
+
+using stack_trace = std::vector<stack_frame>;
+
+// Walks the active guest thread's stack on the host. Frames are unwound through the
+// module's .pdata index. When no unwind data is available, the walk falls back to the
+// rbp chain and finally to scanning the stack for return addresses.
+stack_trace capture_stack_trace(windows_emulator& win_emu, size_t max_frames = 32);
+
+const char* get_stack_frame_source_name(stack_frame_source source);
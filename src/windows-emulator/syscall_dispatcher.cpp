@@ -99,6 +99,11 @@ void syscall_dispatcher::dispatch(windows_emulator& win_emu)
             return;
         }
 
+        if (win_emu.faults.apply(emu, entry->second.name))
+        {
+            return;
+        }
+
         entry->second.handler(c);
     }
     catch (std::exception& e)
@@ -115,6 +120,23 @@ void syscall_dispatcher::dispatch(windows_emulator& win_emu)
     }
 }
 
+bool syscall_dispatcher::intercept(windows_emulator& win_emu, const uint32_t syscall_id)
+{
+    const auto entry = this->handlers_.find(syscall_id);
+    if (entry == this->handlers_.end())
+    {
+        return false;
+    }
+
+    const auto res = win_emu.callbacks.on_syscall(syscall_id, entry->second.name);
+    if (res == instruction_hook_continuation::skip_instruction)
+    {
+        return true;
+    }
+
+    return win_emu.faults.apply(win_emu.emu(), entry->second.name);
+}
+
 syscall_dispatcher::syscall_dispatcher(const exported_symbols& ntdll_exports,
                                        const std::span<const std::byte> ntdll_data,
                                        const exported_symbols& win32u_exports,
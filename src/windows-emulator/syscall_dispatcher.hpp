@@ -22,6 +22,10 @@ class syscall_dispatcher
 
     void dispatch(windows_emulator& win_emu);
 
+    // Runs the callback and fault injection stages for a syscall that is answered without being
+    // dispatched. Returns true if one of them completed the syscall.
+    bool intercept(windows_emulator& win_emu, uint32_t syscall_id);
+
     void serialize(utils::buffer_serializer& buffer) const;
     void deserialize(utils::buffer_deserializer& buffer);
 
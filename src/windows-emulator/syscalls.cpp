@@ -15,7 +15,8 @@ namespace syscalls
 {
     // syscalls/event.cpp:
     NTSTATUS handle_NtSetEvent(const syscall_context& c, uint64_t handle, emulator_object<LONG> previous_state);
-    NTSTATUS handle_NtTraceEvent();
+    NTSTATUS handle_NtTraceEvent(const syscall_context& c, handle trace_handle, ULONG flags, ULONG field_size,
+                                 uint64_t fields);
     NTSTATUS handle_NtQueryEvent();
     NTSTATUS handle_NtClearEvent(const syscall_context& c, handle event_handle);
     NTSTATUS handle_NtCreateEvent(const syscall_context& c, emulator_object<handle> event_handle,
@@ -66,13 +67,13 @@ namespace syscalls
         const syscall_context& c, emulator_object<OBJECT_ATTRIBUTES<EmulatorTraits<Emu64>>> object_attributes,
         emulator_object<IO_STATUS_BLOCK<EmulatorTraits<Emu64>>> io_status_block, uint64_t file_information,
         uint32_t length, uint32_t info_class);
-    NTSTATUS handle_NtReadFile(const syscall_context& c, handle file_handle, uint64_t /*event*/,
-                               uint64_t /*apc_routine*/, uint64_t /*apc_context*/,
+    NTSTATUS handle_NtReadFile(const syscall_context& c, handle file_handle, uint64_t event, uint64_t apc_routine,
+                               uint64_t apc_context,
                                emulator_object<IO_STATUS_BLOCK<EmulatorTraits<Emu64>>> io_status_block, uint64_t buffer,
                                ULONG length, emulator_object<LARGE_INTEGER> /*byte_offset*/,
                                emulator_object<ULONG> /*key*/);
-    NTSTATUS handle_NtWriteFile(const syscall_context& c, handle file_handle, uint64_t /*event*/,
-                                uint64_t /*apc_routine*/, uint64_t /*apc_context*/,
+    NTSTATUS handle_NtWriteFile(const syscall_context& c, handle file_handle, uint64_t event, uint64_t apc_routine,
+                                uint64_t apc_context,
                                 emulator_object<IO_STATUS_BLOCK<EmulatorTraits<Emu64>>> io_status_block,
                                 uint64_t buffer, ULONG length, emulator_object<LARGE_INTEGER> /*byte_offset*/,
                                 emulator_object<ULONG> /*key*/);
@@ -111,8 +112,8 @@ namespace syscalls
                                           ULONG named_pipe_type, ULONG read_mode, ULONG completion_mode,
                                           ULONG maximum_instances, ULONG inbound_quota, ULONG outbound_quota,
                                           emulator_object<LARGE_INTEGER> default_timeout);
-    NTSTATUS handle_NtFsControlFile(const syscall_context& c, handle event_handle, uint64_t apc_routine,
-                                    uint64_t app_context,
+    NTSTATUS handle_NtFsControlFile(const syscall_context& c, handle file_handle, handle event_handle,
+                                    uint64_t apc_routine, uint64_t apc_context,
                                     emulator_object<IO_STATUS_BLOCK<EmulatorTraits<Emu64>>> io_status_block,
                                     ULONG fs_control_code, uint64_t input_buffer, ULONG input_buffer_length,
                                     uint64_t output_buffer, ULONG output_buffer_length);
@@ -247,7 +248,14 @@ namespace syscalls
                                 ACCESS_MASK desired_access,
                                 emulator_object<OBJECT_ATTRIBUTES<EmulatorTraits<Emu64>>> object_attributes,
                                 ULONG /*title_index*/, emulator_object<UNICODE_STRING<EmulatorTraits<Emu64>>> /*class*/,
-                                ULONG /*create_options*/, emulator_object<ULONG> /*disposition*/);
+                                ULONG /*create_options*/, emulator_object<ULONG> disposition);
+    NTSTATUS handle_NtSetValueKey(const syscall_context& c, handle key_handle,
+                                  emulator_object<UNICODE_STRING<EmulatorTraits<Emu64>>> value_name,
+                                  ULONG /*title_index*/, ULONG type, uint64_t data, ULONG data_size);
+    NTSTATUS handle_NtDeleteKey(const syscall_context& c, handle key_handle);
+    NTSTATUS handle_NtDeleteValueKey(const syscall_context& c, handle key_handle,
+                                     emulator_object<UNICODE_STRING<EmulatorTraits<Emu64>>> value_name);
+    NTSTATUS handle_NtFlushKey();
     NTSTATUS handle_NtNotifyChangeKey();
     NTSTATUS handle_NtSetInformationKey();
     NTSTATUS handle_NtEnumerateKey(const syscall_context& c, handle key_handle, ULONG index,
@@ -371,11 +379,55 @@ namespace syscalls
                                   ACCESS_MASK desired_access,
                                   emulator_object<OBJECT_ATTRIBUTES<EmulatorTraits<Emu64>>> object_attributes,
                                   ULONG timer_type);
-    NTSTATUS handle_NtSetTimer();
-    NTSTATUS handle_NtSetTimer2();
+    NTSTATUS handle_NtSetTimer(const syscall_context& c, handle timer_handle, emulator_object<LARGE_INTEGER> due_time,
+                               uint64_t timer_apc_routine, uint64_t timer_context, BOOLEAN resume_timer, LONG period,
+                               emulator_object<BOOLEAN> previous_state);
+    NTSTATUS handle_NtSetTimer2(const syscall_context& c, handle timer_handle, emulator_object<LARGE_INTEGER> due_time,
+                                emulator_object<LARGE_INTEGER> period, uint64_t parameters);
     NTSTATUS handle_NtSetTimerEx(const syscall_context& c, handle timer_handle, uint32_t timer_set_info_class,
                                  uint64_t timer_set_information, ULONG timer_set_information_length);
-    NTSTATUS handle_NtCancelTimer();
+    NTSTATUS handle_NtCancelTimer(const syscall_context& c, handle timer_handle,
+                                  emulator_object<BOOLEAN> current_state);
+    NTSTATUS handle_NtQueryTimer(const syscall_context& c, handle timer_handle,
+                                 TIMER_INFORMATION_CLASS timer_information_class, uint64_t timer_information,
+                                 ULONG timer_information_length, emulator_object<ULONG> return_length);
+
+    // syscalls/worker_factory.cpp:
+    NTSTATUS handle_NtCreateIoCompletion(
+        const syscall_context& c, emulator_object<handle> io_completion_handle, ACCESS_MASK desired_access,
+        emulator_object<OBJECT_ATTRIBUTES<EmulatorTraits<Emu64>>> object_attributes,
+        uint32_t number_of_concurrent_threads);
+    NTSTATUS handle_NtSetIoCompletion(const syscall_context& c, handle io_completion_handle, uint64_t key_context,
+                                      uint64_t apc_context, NTSTATUS io_status, uint64_t io_status_information);
+    NTSTATUS handle_NtSetIoCompletionEx(const syscall_context& c, handle io_completion_handle,
+                                        handle io_completion_packet_handle, uint64_t key_context,
+                                        uint64_t apc_context, NTSTATUS io_status, uint64_t io_status_information);
+    NTSTATUS handle_NtRemoveIoCompletion(const syscall_context& c, handle io_completion_handle,
+                                         emulator_object<uint64_t> key_context, emulator_object<uint64_t> apc_context,
+                                         emulator_object<IO_STATUS_BLOCK<EmulatorTraits<Emu64>>> io_status_block,
+                                         emulator_object<LARGE_INTEGER> timeout);
+    NTSTATUS handle_NtRemoveIoCompletionEx(
+        const syscall_context& c, handle io_completion_handle,
+        emulator_object<FILE_IO_COMPLETION_INFORMATION<EmulatorTraits<Emu64>>> io_completion_information,
+        ULONG count, emulator_object<ULONG> num_entries_removed, emulator_object<LARGE_INTEGER> timeout,
+        BOOLEAN alertable);
+    NTSTATUS handle_NtCreateWorkerFactory(
+        const syscall_context& c, emulator_object<handle> worker_factory_handle, ACCESS_MASK desired_access,
+        emulator_object<OBJECT_ATTRIBUTES<EmulatorTraits<Emu64>>> object_attributes, handle completion_port_handle,
+        handle worker_process_handle, uint64_t start_routine, uint64_t start_parameter, ULONG max_thread_count,
+        EmulatorTraits<Emu64>::SIZE_T stack_reserve, EmulatorTraits<Emu64>::SIZE_T stack_commit);
+    NTSTATUS handle_NtSetInformationWorkerFactory(const syscall_context& c, handle worker_factory_handle,
+                                                  WORKERFACTORYINFOCLASS worker_factory_information_class,
+                                                  uint64_t worker_factory_information,
+                                                  ULONG worker_factory_information_length);
+    NTSTATUS handle_NtWorkerFactoryWorkerReady(const syscall_context& c, handle worker_factory_handle);
+    NTSTATUS handle_NtReleaseWorkerFactoryWorker(const syscall_context& c, handle worker_factory_handle);
+    NTSTATUS handle_NtWaitForWorkViaWorkerFactory(
+        const syscall_context& c, handle worker_factory_handle,
+        emulator_object<FILE_IO_COMPLETION_INFORMATION<EmulatorTraits<Emu64>>> mini_packets, ULONG count,
+        emulator_object<ULONG> packets_returned, uint64_t deferred_work);
+    NTSTATUS handle_NtShutdownWorkerFactory(const syscall_context& c, handle worker_factory_handle,
+                                            emulator_object<LONG> pending_worker_count);
 
     // syscalls/window.cpp:
     NTSTATUS handle_NtUserBuildHwndList(const syscall_context& c, handle desktop_handle,
@@ -394,11 +446,6 @@ namespace syscalls
                                             ULONG token_information_length, emulator_object<ULONG> return_length);
     NTSTATUS handle_NtQuerySecurityAttributesToken();
 
-    NTSTATUS handle_NtReleaseWorkerFactoryWorker(const syscall_context& c, handle token_handle)
-    {
-        return STATUS_SUCCESS;
-    }
-
     NTSTATUS handle_NtQueryPerformanceCounter(const syscall_context& c,
                                               const emulator_object<LARGE_INTEGER> performance_counter,
                                               const emulator_object<LARGE_INTEGER> performance_frequency)
@@ -432,54 +479,6 @@ namespace syscalls
         return STATUS_NOT_SUPPORTED;
     }
 
-    NTSTATUS handle_NtCreateWorkerFactory()
-    {
-        return STATUS_SUCCESS;
-    }
-
-    NTSTATUS handle_NtSetInformationWorkerFactory()
-    {
-        return STATUS_SUCCESS;
-    }
-
-    NTSTATUS handle_NtShutdownWorkerFactory()
-    {
-        return STATUS_SUCCESS;
-    }
-
-    NTSTATUS handle_NtCreateIoCompletion(
-        const syscall_context& c, const emulator_object<handle> event_handle, const ACCESS_MASK desired_access,
-        const emulator_object<OBJECT_ATTRIBUTES<EmulatorTraits<Emu64>>> object_attributes,
-        const uint32_t /*number_of_concurrent_threads*/)
-    {
-        return handle_NtCreateEvent(c, event_handle, desired_access, object_attributes, NotificationEvent, FALSE);
-    }
-
-    NTSTATUS handle_NtSetIoCompletion()
-    {
-        return STATUS_NOT_SUPPORTED;
-    }
-
-    NTSTATUS handle_NtRemoveIoCompletion(
-        const syscall_context&, const emulator_object<handle> /*io_completion__handle*/,
-        const emulator_object<int64_t> key_context, const emulator_pointer /*apc_context*/,
-        const emulator_object<IO_STATUS_BLOCK<EmulatorTraits<Emu64>>> /*io_status_block*/,
-        const emulator_object<LARGE_INTEGER> timeout)
-    {
-        if (timeout && timeout.read().QuadPart == 0)
-        {
-            return STATUS_TIMEOUT;
-        }
-
-        key_context.write_if_valid(-1);
-        return STATUS_SUCCESS;
-    }
-
-    NTSTATUS handle_NtRemoveIoCompletionEx()
-    {
-        return STATUS_NOT_SUPPORTED;
-    }
-
     NTSTATUS handle_NtCreateWaitCompletionPacket(
         const syscall_context& c, const emulator_object<handle> event_handle, const ACCESS_MASK desired_access,
         const emulator_object<OBJECT_ATTRIBUTES<EmulatorTraits<Emu64>>> object_attributes)
@@ -1031,11 +1030,14 @@ void syscall_dispatcher::add_handlers(std::map<std::string, syscall_handler>& ha
     add_handler(NtAllocateVirtualMemoryEx);
     add_handler(NtCreateIoCompletion);
     add_handler(NtSetIoCompletion);
+    add_handler(NtSetIoCompletionEx);
     add_handler(NtRemoveIoCompletion);
     add_handler(NtCreateWaitCompletionPacket);
     add_handler(NtCreateWorkerFactory);
     add_handler(NtSetInformationWorkerFactory);
     add_handler(NtShutdownWorkerFactory);
+    add_handler(NtWorkerFactoryWorkerReady);
+    add_handler(NtWaitForWorkViaWorkerFactory);
     add_handler(NtManageHotPatch);
     add_handler(NtOpenSection);
     add_handler(NtMapViewOfSection);
@@ -1135,6 +1137,10 @@ void syscall_dispatcher::add_handlers(std::map<std::string, syscall_handler>& ha
     add_handler(NtReleaseSemaphore);
     add_handler(NtEnumerateKey);
     add_handler(NtEnumerateValueKey);
+    add_handler(NtSetValueKey);
+    add_handler(NtDeleteKey);
+    add_handler(NtDeleteValueKey);
+    add_handler(NtFlushKey);
     add_handler(NtAlpcConnectPort);
     add_handler(NtGetNextThread);
     add_handler(NtSetInformationObject);
@@ -1189,6 +1195,7 @@ void syscall_dispatcher::add_handlers(std::map<std::string, syscall_handler>& ha
     add_handler(NtSetTimer2);
     add_handler(NtSetTimerEx);
     add_handler(NtCancelTimer);
+    add_handler(NtQueryTimer);
     add_handler(NtAssociateWaitCompletionPacket);
     add_handler(NtCancelWaitCompletionPacket);
     add_handler(NtSetWnfProcessNotificationEvent);
@@ -12,8 +12,13 @@ namespace syscalls
             if (c.proc.dbwin_buffer)
             {
                 constexpr auto pid_length = 4;
-                const auto debug_data = read_string<char>(c.win_emu.memory, c.proc.dbwin_buffer + pid_length);
-                c.win_emu.log.info("--> Debug string: %s\n", debug_data.c_str());
+
+                c.win_emu.debug_output.push({
+                    .source = debug_output_source::output_debug_string,
+                    .thread_id = c.win_emu.current_thread().id,
+                    .text = read_debug_string(c.win_emu.memory, c.proc.dbwin_buffer + pid_length,
+                                              c.proc.dbwin_buffer_size - pid_length),
+                });
             }
 
             return STATUS_SUCCESS;
@@ -34,8 +39,27 @@ namespace syscalls
         return STATUS_SUCCESS;
     }
 
-    NTSTATUS handle_NtTraceEvent()
+    NTSTATUS handle_NtTraceEvent(const syscall_context& c, const handle trace_handle, const ULONG flags,
+                                 const ULONG field_size, const uint64_t fields)
     {
+        // Payloads are kept raw, decoding them requires the provider manifests
+        constexpr ULONG max_trace_event_size = 0x1000;
+
+        debug_output_message message{
+            .source = debug_output_source::trace_event,
+            .thread_id = c.win_emu.current_thread().id,
+        };
+
+        message.data.resize(std::min(field_size, max_trace_event_size));
+        if (fields && !c.win_emu.memory.try_read_memory(fields, message.data.data(), message.data.size()))
+        {
+            message.data.clear();
+        }
+
+        message.text = "Handle 0x" + utils::string::to_hex_number(trace_handle.bits) + ", flags 0x" +
+                       utils::string::to_hex_number(flags) + ", " + std::to_string(field_size) + " bytes";
+
+        c.win_emu.debug_output.push(std::move(message));
         return STATUS_SUCCESS;
     }
 
@@ -1,9 +1,41 @@
 #include "../std_include.hpp"
 #include "../emulator_utils.hpp"
 #include "../syscall_utils.hpp"
+#include "../cpu_context.hpp"
 
 namespace syscalls
 {
+    namespace
+    {
+        // DBG_PRINTEXCEPTION_C and DBG_PRINTEXCEPTION_WIDE_C, raised by OutputDebugString
+        constexpr NTSTATUS PRINT_EXCEPTION = 0x40010006;
+        constexpr NTSTATUS PRINT_EXCEPTION_WIDE = 0x4001000A;
+        constexpr size_t MAX_PRINT_EXCEPTION_LENGTH = 0x10000;
+
+        bool capture_print_exception(const syscall_context& c,
+                                     const EMU_EXCEPTION_RECORD<EmulatorTraits<Emu64>>& record)
+        {
+            const auto is_wide = record.ExceptionCode == PRINT_EXCEPTION_WIDE;
+            if ((record.ExceptionCode != PRINT_EXCEPTION && !is_wide) || record.NumberParameters < 2)
+            {
+                return false;
+            }
+
+            const auto length = static_cast<size_t>(std::min<uint64_t>(record.ExceptionInformation[0], //
+                                                                       MAX_PRINT_EXCEPTION_LENGTH));
+            const auto address = record.ExceptionInformation[1];
+
+            c.win_emu.debug_output.push({
+                .source = debug_output_source::output_debug_string,
+                .thread_id = c.win_emu.current_thread().id,
+                .text = is_wide ? read_debug_wide_string(c.win_emu.memory, address, length)
+                                : read_debug_string(c.win_emu.memory, address, length),
+            });
+
+            return true;
+        }
+    }
+
     NTSTATUS handle_NtRaiseHardError(const syscall_context& c, const NTSTATUS error_status,
                                      const ULONG /*number_of_parameters*/,
                                      const emulator_object<UNICODE_STRING<EmulatorTraits<Emu64>>>
@@ -18,7 +50,7 @@ namespace syscalls
         }
 
         c.proc.exit_status = error_status;
-        c.win_emu.callbacks.on_exception();
+        c.win_emu.callbacks.on_exception(error_status);
         c.emu.stop();
 
         return STATUS_SUCCESS;
@@ -26,9 +58,17 @@ namespace syscalls
 
     NTSTATUS handle_NtRaiseException(
         const syscall_context& c,
-        const emulator_object<EMU_EXCEPTION_RECORD<EmulatorTraits<Emu64>>> /*exception_record*/,
-        const emulator_object<CONTEXT64> /*thread_context*/, const BOOLEAN handle_exception)
+        const emulator_object<EMU_EXCEPTION_RECORD<EmulatorTraits<Emu64>>> exception_record,
+        const emulator_object<CONTEXT64> thread_context, const BOOLEAN handle_exception)
     {
+        // Consumed like an attached debugger would, so the guest doesn't fall back to DBWIN
+        if (capture_print_exception(c, exception_record.read()))
+        {
+            c.write_status = false;
+            cpu_context::restore(c.emu, thread_context.read());
+            return STATUS_SUCCESS;
+        }
+
         if (handle_exception)
         {
             c.win_emu.log.error("Unhandled exceptions not supported yet!\n");
@@ -36,7 +76,7 @@ namespace syscalls
             return STATUS_NOT_SUPPORTED;
         }
 
-        c.win_emu.callbacks.on_exception();
+        c.win_emu.callbacks.on_exception(exception_record.read().ExceptionCode);
         c.emu.stop();
 
         return STATUS_SUCCESS;
@@ -3,7 +3,6 @@
 #include "../syscall_utils.hpp"
 #include "utils/io.hpp"
 
-#include <iostream>
 #include <utils/finally.hpp>
 #include <utils/wildcard.hpp>
 
@@ -44,6 +43,347 @@ namespace syscalls
                 return {fh{}, STATUS_NOT_SUPPORTED};
             }
         }
+
+        overlay_node* get_overlay_file(const syscall_context& c, const file& f)
+        {
+            auto* overlay = c.win_emu.file_sys.overlay();
+            if (!overlay || !f.in_overlay)
+            {
+                return nullptr;
+            }
+
+            auto* node = overlay->find(f.name);
+            return node && !node->deleted && !node->is_directory ? node : nullptr;
+        }
+
+        const overlay_node* find_overlay_entry(const file_system& file_sys, const windows_path& path)
+        {
+            const auto* overlay = file_sys.overlay();
+            const auto* node = overlay ? overlay->find(path) : nullptr;
+            return node && !node->deleted ? node : nullptr;
+        }
+
+        bool is_hidden_by_overlay(const file_system& file_sys, const windows_path& path)
+        {
+            const auto* overlay = file_sys.overlay();
+            return overlay && overlay->hides_lower(path);
+        }
+
+        NTSTATUS open_overlay_file(const syscall_context& c, const emulator_object<handle> file_handle, file f,
+                                   file_overlay& overlay, const std::u16string& mode)
+        {
+            const windows_path path = f.name;
+            const auto* upper = overlay.find(path);
+            const auto in_upper = upper && !upper->deleted && !upper->is_directory;
+
+            // Read-only access to untouched files is served by the lower layer
+            if (!in_upper && mode == u"rb")
+            {
+                if (overlay.hides_lower(path))
+                {
+                    return STATUS_OBJECT_NAME_NOT_FOUND;
+                }
+
+                auto [native_file_handle, status] = open_file(c.win_emu.file_sys, path, mode);
+                if (status != STATUS_SUCCESS)
+                {
+                    return status;
+                }
+
+                f.handle = std::move(native_file_handle);
+                f.host_mode = mode;
+            }
+            else
+            {
+                const auto truncate = mode.starts_with(u'w');
+
+                if (!in_upper || truncate)
+                {
+                    std::vector<std::byte> data{};
+
+                    const auto copied_up = !truncate && !overlay.hides_lower(path) &&
+                                           utils::io::read_file(c.win_emu.file_sys.translate(path), &data);
+
+                    if (!copied_up && mode == u"r+b")
+                    {
+                        return STATUS_OBJECT_NAME_NOT_FOUND;
+                    }
+
+                    overlay.create_file(path, std::move(data));
+                }
+
+                f.in_overlay = true;
+                f.append = mode == u"a+b";
+            }
+
+            const auto handle = c.proc.files.store(std::move(f));
+            file_handle.write(handle);
+
+            return STATUS_SUCCESS;
+        }
+
+        NTSTATUS rename_overlay_file(const syscall_context& c, file& f, const std::u16string& new_name,
+                                     const bool replace_if_exists)
+        {
+            auto& overlay = *c.win_emu.file_sys.overlay();
+            const windows_path source = f.name;
+            const windows_path target = new_name;
+
+            if (f.is_directory() || target.is_relative())
+            {
+                return STATUS_ACCESS_DENIED;
+            }
+
+            std::error_code ec{};
+            const auto target_exists = find_overlay_entry(c.win_emu.file_sys, target) ||
+                                       (!overlay.hides_lower(target) &&
+                                        std::filesystem::exists(c.win_emu.file_sys.translate(target), ec));
+
+            if (target_exists && !replace_if_exists)
+            {
+                return STATUS_OBJECT_NAME_COLLISION;
+            }
+
+            std::vector<std::byte> data{};
+            if (const auto* node = get_overlay_file(c, f))
+            {
+                data = node->data;
+            }
+            else if (!utils::io::read_file(c.win_emu.file_sys.translate(source), &data))
+            {
+                return STATUS_OBJECT_NAME_NOT_FOUND;
+            }
+
+            overlay.remove(source);
+            overlay.create_file(target, std::move(data));
+
+            f.name = new_name;
+            f.handle = {};
+            f.host_mode = {};
+            f.in_overlay = true;
+
+            return STATUS_SUCCESS;
+        }
+
+        bool is_pipe_synchronous(const ULONG create_options)
+        {
+            return create_options & (FILE_SYNCHRONOUS_IO_ALERT | FILE_SYNCHRONOUS_IO_NONALERT);
+        }
+
+        named_pipe* get_pipe(const syscall_context& c, const file& f)
+        {
+            if (!f.pipe)
+            {
+                return nullptr;
+            }
+
+            const auto entry = c.proc.pipes.find(f.pipe->pipe_id);
+            return entry == c.proc.pipes.end() ? nullptr : &entry->second;
+        }
+
+        bool is_pipe_root(const file& f)
+        {
+            const auto pipe_name = get_pipe_name(f.name);
+            return !f.pipe && pipe_name && pipe_name->empty();
+        }
+
+        io_device_context create_pipe_context(
+            const syscall_context& c, const handle event, const uint64_t apc_routine, const uint64_t apc_context,
+            const emulator_object<IO_STATUS_BLOCK<EmulatorTraits<Emu64>>> io_status_block)
+        {
+            io_device_context context{c.emu};
+            context.event = event;
+            context.apc_routine = apc_routine;
+            context.apc_context = apc_context;
+            context.io_status_block = io_status_block;
+
+            if (auto* e = c.proc.events.get(event))
+            {
+                e->signaled = false;
+            }
+
+            if (io_status_block)
+            {
+                io_status_block.write({});
+            }
+
+            return context;
+        }
+
+        // Synchronous handles block the calling thread until the pipe completes the request
+        NTSTATUS finish_pipe_operation(const syscall_context& c, const pipe_end& end, const handle file_handle,
+                                       const io_device_context& context, const NTSTATUS status)
+        {
+            write_io_status(context.io_status_block, status);
+
+            if (status == STATUS_PENDING)
+            {
+                if (end.synchronous)
+                {
+                    auto& t = c.win_emu.current_thread();
+                    t.await_objects = {file_handle};
+                    t.await_any = false;
+                    c.win_emu.yield_thread();
+                }
+
+                return status;
+            }
+
+            if (status == STATUS_SUCCESS || status == STATUS_BUFFER_OVERFLOW)
+            {
+                if (auto* e = c.proc.events.get(context.event))
+                {
+                    e->signaled = true;
+                }
+            }
+
+            return status;
+        }
+
+        uint32_t store_pipe(process_context& proc, named_pipe pipe)
+        {
+            const auto id = proc.pipes.empty() ? 1 : proc.pipes.rbegin()->first + 1;
+            proc.pipes.emplace(id, std::move(pipe));
+            return id;
+        }
+
+        NTSTATUS connect_to_pipe(const syscall_context& c, const emulator_object<handle> file_handle,
+                                 const uint32_t pipe_id, std::u16string name, const ULONG create_options)
+        {
+            auto& pipe = c.proc.pipes.at(pipe_id);
+            pipe.connect(c.win_emu);
+
+            file f{};
+            f.name = std::move(name);
+            f.pipe = pipe_end{
+                .pipe_id = pipe_id,
+                .connection = pipe.connection,
+                .is_server = false,
+                .synchronous = is_pipe_synchronous(create_options),
+            };
+
+            const auto handle = c.proc.files.store(std::move(f));
+            file_handle.write(handle);
+
+            return STATUS_SUCCESS;
+        }
+
+        std::optional<NTSTATUS> open_pipe(const syscall_context& c, const emulator_object<handle> file_handle,
+                                          const handle root_directory, const std::u16string& filename,
+                                          const ULONG create_options)
+        {
+            const auto* root = c.proc.files.get(root_directory);
+
+            // Anonymous pipe clients are opened relative to the server end
+            if (root && root->pipe && filename.empty())
+            {
+                const auto* pipe = get_pipe(c, *root);
+                if (!pipe)
+                {
+                    return STATUS_PIPE_DISCONNECTED;
+                }
+
+                if (pipe->state != FILE_PIPE_LISTENING_STATE)
+                {
+                    return STATUS_PIPE_NOT_AVAILABLE;
+                }
+
+                return connect_to_pipe(c, file_handle, root->pipe->pipe_id, root->name, create_options);
+            }
+
+            const auto full_name = root ? root->name + filename : filename;
+            const auto pipe_name = get_pipe_name(full_name);
+            if (!pipe_name)
+            {
+                return std::nullopt;
+            }
+
+            c.win_emu.callbacks.on_generic_access("Opening pipe", full_name);
+
+            if (pipe_name->empty())
+            {
+                file f{};
+                f.name = full_name;
+
+                const auto handle = c.proc.files.store(std::move(f));
+                file_handle.write(handle);
+
+                return STATUS_SUCCESS;
+            }
+
+            bool found = false;
+
+            for (auto& [id, pipe] : c.proc.pipes)
+            {
+                if (pipe.name != *pipe_name)
+                {
+                    continue;
+                }
+
+                found = true;
+
+                if (pipe.is_available())
+                {
+                    return connect_to_pipe(c, file_handle, id, full_name, create_options);
+                }
+            }
+
+            return found ? STATUS_PIPE_NOT_AVAILABLE : STATUS_OBJECT_NAME_NOT_FOUND;
+        }
+
+        NTSTATUS wait_for_pipe_instance(const syscall_context& c, const uint64_t input_buffer,
+                                        const ULONG input_buffer_length)
+        {
+            constexpr auto header_size = offsetof(FILE_PIPE_WAIT_FOR_BUFFER, Name);
+            if (input_buffer_length < header_size)
+            {
+                return STATUS_INVALID_PARAMETER;
+            }
+
+            const auto info = c.emu.read_memory<FILE_PIPE_WAIT_FOR_BUFFER>(input_buffer);
+            if (header_size + info.NameLength > input_buffer_length)
+            {
+                return STATUS_INVALID_PARAMETER;
+            }
+
+            auto name = read_string<char16_t>(c.emu, input_buffer + header_size, info.NameLength / 2);
+            utils::string::to_lower_inplace(name);
+
+            const named_pipe* instance = nullptr;
+            for (const auto& pipe : c.proc.pipes | std::views::values)
+            {
+                if (pipe.name == name)
+                {
+                    instance = &pipe;
+                    break;
+                }
+            }
+
+            if (!instance)
+            {
+                return STATUS_OBJECT_NAME_NOT_FOUND;
+            }
+
+            if (has_available_pipe_instance(c.proc.pipes, name))
+            {
+                return STATUS_SUCCESS;
+            }
+
+            LARGE_INTEGER timeout{};
+            timeout.QuadPart = info.TimeoutSpecified ? info.Timeout.QuadPart : instance->default_timeout;
+
+            // The thread is parked until a server instance listens again
+            auto& t = c.win_emu.current_thread();
+            t.await_pipe_instance = std::move(name);
+
+            if (timeout.QuadPart != std::numeric_limits<int64_t>::min())
+            {
+                t.await_time = utils::convert_delay_interval_to_time_point(c.win_emu.clock(), timeout);
+            }
+
+            c.win_emu.yield_thread();
+            return STATUS_SUCCESS;
+        }
     }
 
     NTSTATUS handle_NtSetInformationFile(const syscall_context& c, const handle file_handle,
@@ -51,7 +391,7 @@ namespace syscalls
                                          const uint64_t file_information, const ULONG length,
                                          const FILE_INFORMATION_CLASS info_class)
     {
-        const auto* f = c.proc.files.get(file_handle);
+        auto* f = c.proc.files.get(file_handle);
         if (!f)
         {
             if (c.proc.devices.get(file_handle))
@@ -89,7 +429,43 @@ namespace syscalls
             c.win_emu.log.warn("--> File rename requested: %s --> %s\n", u16_to_u8(f->name).c_str(),
                                u16_to_u8(new_name).c_str());
 
-            return STATUS_ACCESS_DENIED;
+            if (!c.win_emu.file_sys.overlay())
+            {
+                return STATUS_ACCESS_DENIED;
+            }
+
+            return rename_overlay_file(c, *f, new_name, info.ReplaceIfExists);
+        }
+
+        if (info_class == FileDispositionInformation || info_class == FileDispositionInformationEx)
+        {
+            if (!c.win_emu.file_sys.overlay())
+            {
+                c.win_emu.log.warn("--> File deletion requested: %s\n", u16_to_u8(f->name).c_str());
+                return STATUS_ACCESS_DENIED;
+            }
+
+            if (info_class == FileDispositionInformation)
+            {
+                if (length < sizeof(FILE_DISPOSITION_INFORMATION))
+                {
+                    return STATUS_INFO_LENGTH_MISMATCH;
+                }
+
+                f->delete_on_close = c.emu.read_memory<FILE_DISPOSITION_INFORMATION>(file_information).DeleteFile;
+            }
+            else
+            {
+                if (length < sizeof(FILE_DISPOSITION_INFORMATION_EX))
+                {
+                    return STATUS_INFO_LENGTH_MISMATCH;
+                }
+
+                const auto flags = c.emu.read_memory<FILE_DISPOSITION_INFORMATION_EX>(file_information).Flags;
+                f->delete_on_close = flags & FILE_DISPOSITION_DELETE;
+            }
+
+            return write_io_status(io_status_block, STATUS_SUCCESS, true);
         }
 
         if (info_class == FileBasicInformation)
@@ -97,9 +473,36 @@ namespace syscalls
             return STATUS_NOT_SUPPORTED;
         }
 
+        if (info_class == FilePipeInformation)
+        {
+            if (!f->pipe)
+            {
+                return STATUS_INVALID_PARAMETER;
+            }
+
+            if (length < sizeof(FILE_PIPE_INFORMATION))
+            {
+                return STATUS_INFO_LENGTH_MISMATCH;
+            }
+
+            const auto info = c.emu.read_memory<FILE_PIPE_INFORMATION>(file_information);
+            const auto* pipe = get_pipe(c, *f);
+
+            if (info.ReadMode == FILE_PIPE_MESSAGE_MODE && pipe && !pipe->message_type)
+            {
+                return STATUS_INVALID_PARAMETER;
+            }
+
+            auto& end = *f->pipe;
+            end.message_read_mode = info.ReadMode == FILE_PIPE_MESSAGE_MODE;
+            end.non_blocking = info.CompletionMode == FILE_PIPE_COMPLETE_OPERATION;
+
+            return write_io_status(io_status_block, STATUS_SUCCESS, true);
+        }
+
         if (info_class == FilePositionInformation)
         {
-            if (!f->handle)
+            if (!f->handle && !f->in_overlay)
             {
                 return STATUS_NOT_SUPPORTED;
             }
@@ -119,6 +522,12 @@ namespace syscalls
             const emulator_object<FILE_POSITION_INFORMATION> info{c.emu, file_information};
             const auto i = info.read();
 
+            if (f->in_overlay)
+            {
+                f->position = static_cast<uint64_t>(i.CurrentByteOffset.QuadPart);
+                return STATUS_SUCCESS;
+            }
+
             if (!f->handle.seek_to(i.CurrentByteOffset.QuadPart))
             {
                 return STATUS_INVALID_PARAMETER;
@@ -138,16 +547,25 @@ namespace syscalls
         const emulator_object<IO_STATUS_BLOCK<EmulatorTraits<Emu64>>> io_status_block, const uint64_t fs_information,
         const ULONG length, const FS_INFORMATION_CLASS fs_information_class)
     {
+        const auto* f = c.proc.files.get(file_handle);
+        const auto is_pipe = f && (f->pipe || is_pipe_root(*f));
+
         switch (fs_information_class)
         {
         case FileFsDeviceInformation:
             return handle_query<FILE_FS_DEVICE_INFORMATION>(c.emu, fs_information, length, io_status_block,
                                                             [&](FILE_FS_DEVICE_INFORMATION& info) {
-                                                                if (file_handle == STDOUT_HANDLE)
+                                                                if (file_handle == STDOUT_HANDLE ||
+                                                                    file_handle == STDIN_HANDLE)
                                                                 {
                                                                     info.DeviceType = FILE_DEVICE_CONSOLE;
                                                                     info.Characteristics = 0x20000;
                                                                 }
+                                                                else if (is_pipe)
+                                                                {
+                                                                    info.DeviceType = FILE_DEVICE_NAMED_PIPE;
+                                                                    info.Characteristics = 0;
+                                                                }
                                                                 else
                                                                 {
                                                                     info.DeviceType = FILE_DEVICE_DISK;
@@ -188,21 +606,53 @@ namespace syscalls
             files.emplace_back(file_entry{.file_path = "..", .is_directory = true});
         }
 
-        std::error_code ec{};
-        for (const auto& file : std::filesystem::directory_iterator(dir, ec))
+        const auto* overlay = file_sys.overlay();
+        const auto upper_entries = overlay ? overlay->get_children(win_path) : std::vector<const overlay_node*>{};
+
+        std::set<std::u16string> shadowed_entries{};
+        for (const auto* entry : upper_entries)
         {
-            if (!file_mask.empty() && !utils::wildcard::match_filename(file.path().filename().u16string(), file_mask))
+            const auto filename = entry->path.leaf();
+            shadowed_entries.insert(utils::string::to_lower(filename));
+
+            if (entry->deleted || (!file_mask.empty() && !utils::wildcard::match_filename(filename, file_mask)))
             {
                 continue;
             }
 
             files.emplace_back(file_entry{
-                .file_path = file.path().filename(),
-                .file_size = file.is_directory() ? 0 : file.file_size(),
-                .is_directory = file.is_directory(),
+                .file_path = filename,
+                .file_size = entry->data.size(),
+                .is_directory = entry->is_directory,
             });
         }
 
+        std::error_code ec{};
+        const auto lower_visible = !overlay || !overlay->hides_lower(win_path);
+
+        if (lower_visible)
+        {
+            for (const auto& file : std::filesystem::directory_iterator(dir, ec))
+            {
+                const auto filename = file.path().filename().u16string();
+                if (!file_mask.empty() && !utils::wildcard::match_filename(filename, file_mask))
+                {
+                    continue;
+                }
+
+                if (shadowed_entries.contains(utils::string::to_lower(filename)))
+                {
+                    continue;
+                }
+
+                files.emplace_back(file_entry{
+                    .file_path = file.path().filename(),
+                    .file_size = file.is_directory() ? 0 : file.file_size(),
+                    .is_directory = file.is_directory(),
+                });
+            }
+        }
+
         file_sys.access_mapped_entries(win_path, [&](const std::pair<windows_path, std::filesystem::path>& entry) {
             const auto filename = entry.first.leaf();
 
@@ -443,6 +893,10 @@ namespace syscalls
             {
                 i.EndOfFile.QuadPart = f->handle.size();
             }
+            else if (const auto* node = get_overlay_file(c, *f))
+            {
+                i.EndOfFile.QuadPart = static_cast<int64_t>(node->data.size());
+            }
 
             info.write(i);
 
@@ -458,6 +912,22 @@ namespace syscalls
                 return ret(STATUS_BUFFER_OVERFLOW);
             }
 
+            if (f->in_overlay)
+            {
+                FILE_BASIC_INFORMATION i{};
+                i.FileAttributes = FILE_ATTRIBUTE_NORMAL;
+
+                const emulator_object<FILE_BASIC_INFORMATION> info{c.emu, file_information};
+                info.write(i);
+
+                return ret(STATUS_SUCCESS);
+            }
+
+            if (!f->handle)
+            {
+                return ret(STATUS_NOT_SUPPORTED);
+            }
+
             struct _stat64 file_stat{};
             if (fstat64(f->handle, &file_stat) != 0)
             {
@@ -480,7 +950,7 @@ namespace syscalls
 
         if (info_class == FilePositionInformation)
         {
-            if (!f->handle)
+            if (!f->handle && !f->in_overlay)
             {
                 return ret(STATUS_NOT_SUPPORTED);
             }
@@ -495,7 +965,8 @@ namespace syscalls
             const emulator_object<FILE_POSITION_INFORMATION> info{c.emu, file_information};
             FILE_POSITION_INFORMATION i{};
 
-            i.CurrentByteOffset.QuadPart = f->handle.tell();
+            i.CurrentByteOffset.QuadPart =
+                f->in_overlay ? static_cast<int64_t>(f->position) : f->handle.tell();
 
             info.write(i);
 
@@ -504,7 +975,7 @@ namespace syscalls
 
         if (info_class == FileAttributeTagInformation)
         {
-            if (!f->handle)
+            if (!f->handle && !f->in_overlay)
             {
                 return ret(STATUS_NOT_SUPPORTED);
             }
@@ -531,6 +1002,62 @@ namespace syscalls
             return ret(STATUS_NOT_SUPPORTED);
         }
 
+        if (info_class == FilePipeInformation || info_class == FilePipeLocalInformation)
+        {
+            auto* pipe = get_pipe(c, *f);
+            if (!pipe)
+            {
+                return ret(f->pipe ? STATUS_PIPE_DISCONNECTED : STATUS_INVALID_PARAMETER);
+            }
+
+            const auto& end = *f->pipe;
+
+            if (info_class == FilePipeInformation)
+            {
+                block.Information = sizeof(FILE_PIPE_INFORMATION);
+
+                if (length < block.Information)
+                {
+                    return ret(STATUS_INFO_LENGTH_MISMATCH);
+                }
+
+                FILE_PIPE_INFORMATION i{};
+                i.ReadMode = end.message_read_mode ? FILE_PIPE_MESSAGE_MODE : FILE_PIPE_BYTE_STREAM_MODE;
+                i.CompletionMode = end.non_blocking ? FILE_PIPE_COMPLETE_OPERATION : FILE_PIPE_QUEUE_OPERATION;
+
+                c.emu.write_memory(file_information, i);
+
+                return ret(STATUS_SUCCESS);
+            }
+
+            block.Information = sizeof(FILE_PIPE_LOCAL_INFORMATION);
+
+            if (length < block.Information)
+            {
+                return ret(STATUS_INFO_LENGTH_MISMATCH);
+            }
+
+            const auto instances = std::ranges::count_if(c.proc.pipes | std::views::values, [&](const named_pipe& p) {
+                return !pipe->name.empty() && p.name == pipe->name; //
+            });
+
+            FILE_PIPE_LOCAL_INFORMATION i{};
+            i.NamedPipeType = pipe->message_type ? FILE_PIPE_MESSAGE_TYPE : FILE_PIPE_BYTE_STREAM_TYPE;
+            i.NamedPipeConfiguration = FILE_PIPE_FULL_DUPLEX;
+            i.MaximumInstances = pipe->maximum_instances;
+            i.CurrentInstances = static_cast<ULONG>(std::max<ptrdiff_t>(instances, 1));
+            i.InboundQuota = pipe->inbound_quota;
+            i.ReadDataAvailable = static_cast<ULONG>(pipe->get_read_buffer(end).size());
+            i.OutboundQuota = pipe->outbound_quota;
+            i.WriteQuotaAvailable = end.is_server ? pipe->outbound_quota : pipe->inbound_quota;
+            i.NamedPipeState = pipe->state;
+            i.NamedPipeEnd = end.is_server ? FILE_PIPE_SERVER_END : FILE_PIPE_CLIENT_END;
+
+            c.emu.write_memory(file_information, i);
+
+            return ret(STATUS_SUCCESS);
+        }
+
         c.win_emu.log.error("Unsupported query file info class: %X\n", info_class);
         c.emu.stop();
 
@@ -617,39 +1144,70 @@ namespace syscalls
         emu.write_memory(buffer, data.data(), data.size());
     }
 
-    NTSTATUS handle_NtReadFile(const syscall_context& c, const handle file_handle, const uint64_t /*event*/,
-                               const uint64_t /*apc_routine*/, const uint64_t /*apc_context*/,
+    NTSTATUS handle_NtReadFile(const syscall_context& c, const handle file_handle, const uint64_t event,
+                               const uint64_t apc_routine, const uint64_t apc_context,
                                const emulator_object<IO_STATUS_BLOCK<EmulatorTraits<Emu64>>> io_status_block,
                                const uint64_t buffer, const ULONG length,
                                const emulator_object<LARGE_INTEGER> /*byte_offset*/,
                                const emulator_object<ULONG> /*key*/)
     {
+        if (file_handle == STDIN_HANDLE)
+        {
+            const auto count = c.win_emu.console.read(c.emu, buffer, length);
+
+            if (io_status_block)
+            {
+                IO_STATUS_BLOCK<EmulatorTraits<Emu64>> block{};
+                block.Information = count;
+                io_status_block.write(block);
+            }
+
+            return STATUS_SUCCESS;
+        }
+
         std::string temp_buffer{};
         temp_buffer.resize(length);
 
-        if (file_handle == STDIN_HANDLE)
+        auto* f = c.proc.files.get(file_handle);
+        if (!f)
+        {
+            return STATUS_INVALID_HANDLE;
+        }
+
+        if (f->pipe)
         {
-            char chr{};
-            if (std::cin.readsome(&chr, 1) <= 0)
+            auto context = create_pipe_context(c, make_handle(event), apc_routine, apc_context, io_status_block);
+            context.output_buffer = buffer;
+            context.output_buffer_length = length;
+
+            auto* pipe = get_pipe(c, *f);
+            const auto status =
+                pipe ? pipe->read(c.win_emu, *f->pipe, file_handle, context) : STATUS_PIPE_DISCONNECTED;
+
+            return finish_pipe_operation(c, *f->pipe, file_handle, context, status);
+        }
+
+        if (f->in_overlay)
+        {
+            const auto* node = get_overlay_file(c, *f);
+            if (!node)
             {
-                std::cin.read(&chr, 1);
+                return STATUS_FILE_DELETED;
             }
 
-            std::cin.putback(chr);
+            const auto offset = std::min(static_cast<size_t>(f->position), node->data.size());
+            const auto count = std::min(static_cast<size_t>(length), node->data.size() - offset);
 
-            const auto read_count =
-                std::cin.readsome(temp_buffer.data(), static_cast<std::streamsize>(temp_buffer.size()));
-            const auto count = std::max(read_count, static_cast<std::streamsize>(0));
+            const auto* data = reinterpret_cast<const char*>(node->data.data()) + offset;
+            commit_file_data(std::string_view(data, count), c.emu, io_status_block, buffer);
 
-            commit_file_data(std::string_view(temp_buffer.data(), static_cast<size_t>(count)), c.emu, io_status_block,
-                             buffer);
+            f->position = offset + count;
             return STATUS_SUCCESS;
         }
 
-        const auto* f = c.proc.files.get(file_handle);
-        if (!f)
+        if (!f->handle)
         {
-            return STATUS_INVALID_HANDLE;
+            return f->is_directory() ? STATUS_INVALID_DEVICE_REQUEST : STATUS_FILE_INVALID;
         }
 
         const auto bytes_read = fread(temp_buffer.data(), 1, temp_buffer.size(), f->handle);
@@ -658,19 +1216,76 @@ namespace syscalls
         return STATUS_SUCCESS;
     }
 
-    NTSTATUS handle_NtWriteFile(const syscall_context& c, const handle file_handle, const uint64_t /*event*/,
-                                const uint64_t /*apc_routine*/, const uint64_t /*apc_context*/,
+    NTSTATUS handle_NtWriteFile(const syscall_context& c, const handle file_handle, const uint64_t event,
+                                const uint64_t apc_routine, const uint64_t apc_context,
                                 const emulator_object<IO_STATUS_BLOCK<EmulatorTraits<Emu64>>> io_status_block,
                                 const uint64_t buffer, const ULONG length,
                                 const emulator_object<LARGE_INTEGER> /*byte_offset*/,
                                 const emulator_object<ULONG> /*key*/)
     {
+        if (file_handle == STDOUT_HANDLE)
+        {
+            if (!c.win_emu.console.write(c.emu, buffer, length))
+            {
+                return STATUS_ACCESS_VIOLATION;
+            }
+
+            if (io_status_block)
+            {
+                IO_STATUS_BLOCK<EmulatorTraits<Emu64>> block{};
+                block.Information = length;
+                io_status_block.write(block);
+            }
+
+            return STATUS_SUCCESS;
+        }
+
+        auto* f = c.proc.files.get(file_handle);
+        if (!f)
+        {
+            return STATUS_INVALID_HANDLE;
+        }
+
+        // Pipes copy straight from guest memory into their buffer
+        if (f->pipe)
+        {
+            const auto context = create_pipe_context(c, make_handle(event), apc_routine, apc_context, io_status_block);
+
+            auto* pipe = get_pipe(c, *f);
+            const auto status = pipe ? pipe->write(c.win_emu, *f->pipe, buffer, length) : STATUS_PIPE_DISCONNECTED;
+
+            if (status == STATUS_SUCCESS && io_status_block)
+            {
+                io_status_block.access([&](IO_STATUS_BLOCK<EmulatorTraits<Emu64>>& block) {
+                    block.Information = length; //
+                });
+            }
+
+            return finish_pipe_operation(c, *f->pipe, file_handle, context, status);
+        }
+
         std::string temp_buffer{};
         temp_buffer.resize(length);
         c.emu.read_memory(buffer, temp_buffer.data(), temp_buffer.size());
 
-        if (file_handle == STDOUT_HANDLE)
+        if (f->in_overlay)
         {
+            auto* node = get_overlay_file(c, *f);
+            if (!node)
+            {
+                return STATUS_FILE_DELETED;
+            }
+
+            const auto offset = f->append ? node->data.size() : static_cast<size_t>(f->position);
+            if (offset + length > node->data.size())
+            {
+                node->data.resize(offset + length);
+            }
+
+            const auto data = std::as_bytes(std::span(temp_buffer));
+            std::ranges::copy(data, node->data.begin() + static_cast<ptrdiff_t>(offset));
+            f->position = offset + length;
+
             if (io_status_block)
             {
                 IO_STATUS_BLOCK<EmulatorTraits<Emu64>> block{};
@@ -678,15 +1293,12 @@ namespace syscalls
                 io_status_block.write(block);
             }
 
-            c.win_emu.callbacks.on_stdout(temp_buffer);
-
             return STATUS_SUCCESS;
         }
 
-        const auto* f = c.proc.files.get(file_handle);
-        if (!f)
+        if (!f->handle)
         {
-            return STATUS_INVALID_HANDLE;
+            return f->is_directory() ? STATUS_INVALID_DEVICE_REQUEST : STATUS_FILE_INVALID;
         }
 
         const auto bytes_written = fwrite(temp_buffer.data(), 1, temp_buffer.size(), f->handle);
@@ -788,6 +1400,14 @@ namespace syscalls
         const auto attributes = object_attributes.read();
         auto filename = read_unicode_string(c.emu, attributes.ObjectName);
 
+        handle root_handle{};
+        root_handle.bits = attributes.RootDirectory;
+
+        if (const auto pipe_status = open_pipe(c, file_handle, root_handle, filename, create_options))
+        {
+            return *pipe_status;
+        }
+
         auto printer = utils::finally([&] {
             c.win_emu.callbacks.on_generic_access("Opening file", filename); //
         });
@@ -808,8 +1428,6 @@ namespace syscalls
             return STATUS_SUCCESS;
         }
 
-        handle root_handle{};
-        root_handle.bits = attributes.RootDirectory;
         if (root_handle.value.is_pseudo && (filename == u"\\Reference" || filename == u"\\Connect"))
         {
             file_handle.write(root_handle);
@@ -836,7 +1454,23 @@ namespace syscalls
         std::error_code ec{};
 
         const windows_path path = f.name;
-        const bool is_directory = std::filesystem::is_directory(c.win_emu.file_sys.translate(path), ec);
+        auto* overlay = c.win_emu.file_sys.overlay();
+
+        if (create_options & FILE_DELETE_ON_CLOSE)
+        {
+            if (!overlay)
+            {
+                c.win_emu.log.warn("--> File deletion requested: %s\n", u16_to_u8(f.name).c_str());
+                return STATUS_ACCESS_DENIED;
+            }
+
+            f.delete_on_close = true;
+        }
+        const auto* upper = find_overlay_entry(c.win_emu.file_sys, path);
+
+        const bool is_directory = upper ? upper->is_directory
+                                        : !is_hidden_by_overlay(c.win_emu.file_sys, path) &&
+                                              std::filesystem::is_directory(c.win_emu.file_sys.translate(path), ec);
 
         if (is_directory || create_options & FILE_DIRECTORY_FILE)
         {
@@ -844,7 +1478,17 @@ namespace syscalls
 
             if (create_disposition & FILE_CREATE)
             {
-                create_directory(c.win_emu.file_sys.translate(path), ec);
+                if (overlay)
+                {
+                    if (!is_directory)
+                    {
+                        overlay->create_directory(path);
+                    }
+                }
+                else
+                {
+                    create_directory(c.win_emu.file_sys.translate(path), ec);
+                }
 
                 if (ec)
                 {
@@ -871,6 +1515,11 @@ namespace syscalls
             return STATUS_NOT_SUPPORTED;
         }
 
+        if (overlay)
+        {
+            return open_overlay_file(c, file_handle, std::move(f), *overlay, mode);
+        }
+
         auto [native_file_handle, status] = open_file(c.win_emu.file_sys, path, mode);
         if (status != STATUS_SUCCESS)
         {
@@ -878,6 +1527,7 @@ namespace syscalls
         }
 
         f.handle = std::move(native_file_handle);
+        f.host_mode = mode;
 
         const auto handle = c.proc.files.store(std::move(f));
         file_handle.write(handle);
@@ -917,6 +1567,23 @@ namespace syscalls
 
         c.win_emu.callbacks.on_generic_access("Querying file attributes", filename);
 
+        if (const auto* node = find_overlay_entry(c.win_emu.file_sys, filename))
+        {
+            file_information.access([&](FILE_NETWORK_OPEN_INFORMATION& info) {
+                info = {};
+                info.AllocationSize.QuadPart = static_cast<int64_t>(node->data.size());
+                info.EndOfFile.QuadPart = static_cast<int64_t>(node->data.size());
+                info.FileAttributes = node->is_directory ? FILE_ATTRIBUTE_DIRECTORY : FILE_ATTRIBUTE_NORMAL;
+            });
+
+            return STATUS_SUCCESS;
+        }
+
+        if (is_hidden_by_overlay(c.win_emu.file_sys, filename))
+        {
+            return STATUS_OBJECT_NAME_NOT_FOUND;
+        }
+
         const auto local_filename = c.win_emu.file_sys.translate(filename).u8string();
 
         struct _stat64 file_stat{};
@@ -964,6 +1631,21 @@ namespace syscalls
             return STATUS_OBJECT_NAME_NOT_FOUND;
         }
 
+        if (const auto* node = find_overlay_entry(c.win_emu.file_sys, filepath))
+        {
+            file_information.access([&](FILE_BASIC_INFORMATION& info) {
+                info = {};
+                info.FileAttributes = node->is_directory ? FILE_ATTRIBUTE_DIRECTORY : FILE_ATTRIBUTE_NORMAL;
+            });
+
+            return STATUS_SUCCESS;
+        }
+
+        if (is_hidden_by_overlay(c.win_emu.file_sys, filepath))
+        {
+            return STATUS_OBJECT_NAME_NOT_FOUND;
+        }
+
         const auto local_filename = c.win_emu.file_sys.translate(filepath).u8string();
 
         struct _stat64 file_stat{};
@@ -1068,31 +1750,152 @@ namespace syscalls
     }
 
     NTSTATUS handle_NtCreateNamedPipeFile(
-        const syscall_context& c, const emulator_object<handle> /*file_handle*/, const ULONG /*desired_access*/,
-        const emulator_object<OBJECT_ATTRIBUTES<EmulatorTraits<Emu64>>> /*object_attributes*/,
-        const emulator_object<IO_STATUS_BLOCK<EmulatorTraits<Emu64>>> /*io_status_block*/, const ULONG /*share_access*/,
-        const ULONG /*create_disposition*/, const ULONG /*create_options*/, const ULONG /*named_pipe_type*/,
-        const ULONG /*read_mode*/, const ULONG /*completion_mode*/, const ULONG /*maximum_instances*/,
-        const ULONG /*inbound_quota*/, const ULONG /*outbound_quota*/,
-        const emulator_object<LARGE_INTEGER> /*default_timeout*/)
+        const syscall_context& c, const emulator_object<handle> file_handle, const ULONG /*desired_access*/,
+        const emulator_object<OBJECT_ATTRIBUTES<EmulatorTraits<Emu64>>> object_attributes,
+        const emulator_object<IO_STATUS_BLOCK<EmulatorTraits<Emu64>>> io_status_block, const ULONG /*share_access*/,
+        const ULONG create_disposition, const ULONG create_options, const ULONG named_pipe_type, const ULONG read_mode,
+        const ULONG completion_mode, const ULONG maximum_instances, const ULONG inbound_quota,
+        const ULONG outbound_quota, const emulator_object<LARGE_INTEGER> default_timeout)
     {
-        c.win_emu.log.error("Unimplemented syscall NtCreateNamedPipeFile!");
-        c.emu.stop();
+        const auto attributes = object_attributes.read();
+        auto filename = read_unicode_string(c.emu, attributes.ObjectName);
 
-        return STATUS_NOT_SUPPORTED;
+        if (attributes.RootDirectory)
+        {
+            const auto* root = c.proc.files.get(attributes.RootDirectory);
+            if (!root)
+            {
+                return STATUS_INVALID_HANDLE;
+            }
+
+            filename = root->name + filename;
+        }
+
+        c.win_emu.callbacks.on_generic_access("Creating pipe", filename);
+
+        auto pipe_name = get_pipe_name(filename);
+        if (!pipe_name)
+        {
+            return STATUS_OBJECT_NAME_INVALID;
+        }
+
+        if (read_mode == FILE_PIPE_MESSAGE_MODE && named_pipe_type != FILE_PIPE_MESSAGE_TYPE)
+        {
+            return STATUS_INVALID_PARAMETER;
+        }
+
+        // Anonymous pipes have no name and are never shared between instances
+        if (!pipe_name->empty())
+        {
+            const auto instances = std::ranges::count_if(c.proc.pipes | std::views::values, [&](const named_pipe& p) {
+                return p.name == *pipe_name; //
+            });
+
+            if (instances > 0 && create_disposition == FILE_CREATE)
+            {
+                return STATUS_ACCESS_DENIED;
+            }
+
+            const auto limited = maximum_instances != FILE_PIPE_UNLIMITED_INSTANCES;
+            if (limited && static_cast<ULONG>(instances) >= maximum_instances)
+            {
+                return STATUS_INSTANCE_NOT_AVAILABLE;
+            }
+        }
+
+        named_pipe pipe{};
+        pipe.name = std::move(*pipe_name);
+        pipe.message_type = named_pipe_type == FILE_PIPE_MESSAGE_TYPE;
+        pipe.maximum_instances = maximum_instances;
+        pipe.inbound_quota = inbound_quota;
+        pipe.outbound_quota = outbound_quota;
+
+        // Without an explicit timeout, waiting clients give up after 50 milliseconds
+        pipe.default_timeout = default_timeout.value() ? default_timeout.read().QuadPart : -500'000;
+
+        const auto pipe_id = store_pipe(c.proc, std::move(pipe));
+
+        file f{};
+        f.name = std::move(filename);
+        f.pipe = pipe_end{
+            .pipe_id = pipe_id,
+            .is_server = true,
+            .synchronous = is_pipe_synchronous(create_options),
+            .message_read_mode = read_mode == FILE_PIPE_MESSAGE_MODE,
+            .non_blocking = completion_mode == FILE_PIPE_COMPLETE_OPERATION,
+        };
+
+        const auto handle = c.proc.files.store(std::move(f));
+        file_handle.write(handle);
+
+        if (io_status_block)
+        {
+            IO_STATUS_BLOCK<EmulatorTraits<Emu64>> block{};
+            block.Status = STATUS_SUCCESS;
+            block.Information = FILE_CREATED;
+            io_status_block.write(block);
+        }
+
+        return STATUS_SUCCESS;
     }
 
-    NTSTATUS handle_NtFsControlFile(const syscall_context& c, const handle /*event_handle*/,
-                                    const uint64_t /*apc_routine*/, const uint64_t /*app_context*/,
-                                    const emulator_object<IO_STATUS_BLOCK<EmulatorTraits<Emu64>>> /*io_status_block*/,
-                                    const ULONG /*fs_control_code*/, const uint64_t /*input_buffer*/,
-                                    const ULONG /*input_buffer_length*/, const uint64_t /*output_buffer*/,
-                                    const ULONG /*output_buffer_length*/)
+    NTSTATUS handle_NtFsControlFile(const syscall_context& c, const handle file_handle, const handle event_handle,
+                                    const uint64_t apc_routine, const uint64_t apc_context,
+                                    const emulator_object<IO_STATUS_BLOCK<EmulatorTraits<Emu64>>> io_status_block,
+                                    const ULONG fs_control_code, const uint64_t input_buffer,
+                                    const ULONG input_buffer_length, const uint64_t output_buffer,
+                                    const ULONG output_buffer_length)
     {
-        c.win_emu.log.error("Unimplemented syscall NtFsControlFile!");
-        c.emu.stop();
+        const auto* f = c.proc.files.get(file_handle);
+        if (!f)
+        {
+            return STATUS_INVALID_HANDLE;
+        }
 
-        return STATUS_NOT_SUPPORTED;
+        if (fs_control_code == FSCTL_PIPE_WAIT && is_pipe_root(*f))
+        {
+            return write_io_status(io_status_block, wait_for_pipe_instance(c, input_buffer, input_buffer_length),
+                                   true);
+        }
+
+        if (!f->pipe)
+        {
+            c.win_emu.log.error("Unsupported fs control code: %X\n", fs_control_code);
+            c.emu.stop();
+
+            return STATUS_NOT_SUPPORTED;
+        }
+
+        switch (fs_control_code)
+        {
+        case FSCTL_PIPE_IMPERSONATE:
+        case FSCTL_PIPE_ASSIGN_EVENT:
+            return write_io_status(io_status_block, STATUS_SUCCESS, true);
+
+        case FSCTL_PIPE_LISTEN:
+        case FSCTL_PIPE_DISCONNECT:
+        case FSCTL_PIPE_PEEK:
+        case FSCTL_PIPE_TRANSCEIVE: {
+            auto context = create_pipe_context(c, event_handle, apc_routine, apc_context, io_status_block);
+            context.io_control_code = fs_control_code;
+            context.input_buffer = input_buffer;
+            context.input_buffer_length = input_buffer_length;
+            context.output_buffer = output_buffer;
+            context.output_buffer_length = output_buffer_length;
+
+            auto* pipe = get_pipe(c, *f);
+            const auto status =
+                pipe ? pipe->fs_control(c.win_emu, *f->pipe, file_handle, context) : STATUS_PIPE_DISCONNECTED;
+
+            return finish_pipe_operation(c, *f->pipe, file_handle, context, status);
+        }
+
+        default:
+            c.win_emu.log.error("Unsupported pipe fs control code: %X\n", fs_control_code);
+            c.emu.stop();
+
+            return STATUS_NOT_SUPPORTED;
+        }
     }
 
     NTSTATUS handle_NtFlushBuffersFile(
@@ -1101,6 +1904,7 @@ namespace syscalls
     {
         if (file_handle == STDOUT_HANDLE)
         {
+            c.win_emu.console.flush();
             return STATUS_SUCCESS;
         }
 
@@ -1110,7 +1914,11 @@ namespace syscalls
             return STATUS_INVALID_HANDLE;
         }
 
-        (void)fflush(f->handle);
+        if (f->handle)
+        {
+            (void)fflush(f->handle);
+        }
+
         return STATUS_SUCCESS;
     }
 }
@@ -33,23 +33,13 @@ namespace syscalls
                 return STATUS_BUFFER_TOO_SMALL;
             }
 
-            const emulator_object<EMU_MEMORY_BASIC_INFORMATION64> info{c.emu, memory_information};
-
-            info.access([&](EMU_MEMORY_BASIC_INFORMATION64& image_info) {
-                const auto region_info = c.win_emu.memory.get_region_info(base_address);
-
-                assert(!region_info.is_committed || region_info.is_reserved);
-                const auto state = region_info.is_reserved ? MEM_RESERVE : MEM_FREE;
-                image_info.State = region_info.is_committed ? MEM_COMMIT : state;
-                image_info.BaseAddress = region_info.start;
-                image_info.AllocationBase = region_info.allocation_base;
-                image_info.PartitionId = 0;
-                image_info.RegionSize = static_cast<int64_t>(region_info.length);
+            if (base_address >= MAX_ALLOCATION_ADDRESS)
+            {
+                return STATUS_INVALID_PARAMETER;
+            }
 
-                image_info.Protect = map_emulator_to_nt_protection(region_info.permissions);
-                image_info.AllocationProtect = map_emulator_to_nt_protection(region_info.initial_permissions);
-                image_info.Type = MEM_PRIVATE;
-            });
+            const auto& region_info = c.win_emu.memory.get_region_cursor().find(base_address);
+            c.emu.write_memory(memory_information, get_basic_memory_information(region_info));
 
             return STATUS_SUCCESS;
         }
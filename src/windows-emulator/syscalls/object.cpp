@@ -4,6 +4,42 @@
 
 namespace syscalls
 {
+    void close_file(const syscall_context& c, const handle h)
+    {
+        const auto* f = c.proc.files.get(h);
+        if (!f || f->ref_count > 1)
+        {
+            return;
+        }
+
+        if (f->delete_on_close)
+        {
+            if (auto* overlay = c.win_emu.file_sys.overlay())
+            {
+                c.win_emu.callbacks.on_generic_access("Deleting file", f->name);
+                overlay->remove(f->name);
+            }
+        }
+
+        if (!f->pipe)
+        {
+            return;
+        }
+
+        const auto entry = c.proc.pipes.find(f->pipe->pipe_id);
+        if (entry == c.proc.pipes.end())
+        {
+            return;
+        }
+
+        entry->second.close(c.win_emu, *f->pipe);
+
+        if (entry->second.is_closed())
+        {
+            c.proc.pipes.erase(entry);
+        }
+    }
+
     NTSTATUS handle_NtClose(const syscall_context& c, const handle h)
     {
         const auto value = h.value;
@@ -12,6 +48,11 @@ namespace syscalls
             return STATUS_SUCCESS;
         }
 
+        if (value.type == handle_types::file)
+        {
+            close_file(c, h);
+        }
+
         auto* handle_store = c.proc.get_handle_store(h);
         if (handle_store && handle_store->erase(h))
         {
@@ -85,6 +126,10 @@ namespace syscalls
             return u"Window";
         case handle_types::timer:
             return u"Timer";
+        case handle_types::io_completion:
+            return u"IoCompletion";
+        case handle_types::worker_factory:
+            return u"TpWorkerFactory";
         default:
             return u"";
         }
@@ -182,6 +227,7 @@ namespace syscalls
                || h.value.type == handle_types::mutant    //
                || h.value.type == handle_types::semaphore //
                || h.value.type == handle_types::timer     //
+               || h.value.type == handle_types::file      //
                || h.value.type == handle_types::event;
     }
 
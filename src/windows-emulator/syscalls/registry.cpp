@@ -6,28 +6,43 @@
 
 namespace syscalls
 {
-    NTSTATUS handle_NtOpenKey(const syscall_context& c, const emulator_object<handle> key_handle,
-                              const ACCESS_MASK /*desired_access*/,
-                              const emulator_object<OBJECT_ATTRIBUTES<EmulatorTraits<Emu64>>> object_attributes)
+    namespace
     {
-        const auto attributes = object_attributes.read();
-        auto key = read_unicode_string(c.emu, attributes.ObjectName);
-
-        if (attributes.RootDirectory)
+        std::optional<std::u16string> read_key_path(
+            const syscall_context& c, const emulator_object<OBJECT_ATTRIBUTES<EmulatorTraits<Emu64>>> object_attributes)
         {
-            const auto* parent_handle = c.proc.registry_keys.get(attributes.RootDirectory);
-            if (!parent_handle)
+            const auto attributes = object_attributes.read();
+            auto key = read_unicode_string(c.emu, attributes.ObjectName);
+
+            if (attributes.RootDirectory)
             {
-                return STATUS_INVALID_HANDLE;
+                const auto* parent_handle = c.proc.registry_keys.get(attributes.RootDirectory);
+                if (!parent_handle)
+                {
+                    return std::nullopt;
+                }
+
+                const std::filesystem::path full_path = parent_handle->hive.get() / parent_handle->path.get() / key;
+                key = full_path.u16string();
             }
 
-            const std::filesystem::path full_path = parent_handle->hive.get() / parent_handle->path.get() / key;
-            key = full_path.u16string();
+            return key;
         }
+    }
 
-        c.win_emu.callbacks.on_generic_access("Registry key", key);
+    NTSTATUS handle_NtOpenKey(const syscall_context& c, const emulator_object<handle> key_handle,
+                              const ACCESS_MASK /*desired_access*/,
+                              const emulator_object<OBJECT_ATTRIBUTES<EmulatorTraits<Emu64>>> object_attributes)
+    {
+        const auto key = read_key_path(c, object_attributes);
+        if (!key)
+        {
+            return STATUS_INVALID_HANDLE;
+        }
+
+        c.win_emu.callbacks.on_generic_access("Registry key", *key);
 
-        auto entry = c.win_emu.registry.get_key({key});
+        auto entry = c.win_emu.registry.get_key({*key});
         if (!entry.has_value())
         {
             return STATUS_OBJECT_NAME_NOT_FOUND;
@@ -234,20 +249,115 @@ namespace syscalls
     }
 
     NTSTATUS handle_NtCreateKey(const syscall_context& c, const emulator_object<handle> key_handle,
-                                const ACCESS_MASK desired_access,
+                                const ACCESS_MASK /*desired_access*/,
                                 const emulator_object<OBJECT_ATTRIBUTES<EmulatorTraits<Emu64>>> object_attributes,
                                 const ULONG /*title_index*/,
                                 const emulator_object<UNICODE_STRING<EmulatorTraits<Emu64>>> /*class*/,
-                                const ULONG /*create_options*/, const emulator_object<ULONG> /*disposition*/)
+                                const ULONG /*create_options*/, const emulator_object<ULONG> disposition)
     {
-        const auto result = handle_NtOpenKey(c, key_handle, desired_access, object_attributes);
+        const auto key = read_key_path(c, object_attributes);
+        if (!key)
+        {
+            return STATUS_INVALID_HANDLE;
+        }
+
+        c.win_emu.callbacks.on_generic_access("Registry key", *key);
 
-        if (result == STATUS_OBJECT_NAME_NOT_FOUND)
+        bool created = false;
+        auto entry = c.win_emu.registry.create_key(*key, &created);
+        if (!entry.has_value())
         {
-            return STATUS_NOT_SUPPORTED;
+            return STATUS_OBJECT_NAME_NOT_FOUND;
+        }
+
+        const auto handle = c.proc.registry_keys.store(std::move(entry.value()));
+        key_handle.write(handle);
+
+        if (disposition)
+        {
+            disposition.write(created ? REG_CREATED_NEW_KEY : REG_OPENED_EXISTING_KEY);
+        }
+
+        return STATUS_SUCCESS;
+    }
+
+    NTSTATUS handle_NtSetValueKey(const syscall_context& c, const handle key_handle,
+                                  const emulator_object<UNICODE_STRING<EmulatorTraits<Emu64>>> value_name,
+                                  const ULONG /*title_index*/, const ULONG type, const uint64_t data,
+                                  const ULONG data_size)
+    {
+        const auto* key = c.proc.registry_keys.get(key_handle);
+        if (!key)
+        {
+            return STATUS_INVALID_HANDLE;
+        }
+
+        const auto name = value_name ? read_unicode_string(c.emu, value_name) : std::u16string{};
+
+        std::vector<std::byte> value_data(data_size);
+        if (data_size && !c.emu.try_read_memory(data, value_data.data(), value_data.size()))
+        {
+            return STATUS_ACCESS_VIOLATION;
+        }
+
+        if (c.win_emu.callbacks.on_generic_access)
+        {
+            c.win_emu.callbacks.on_generic_access("Setting value key", name + u" (" + key->to_string() + u")");
         }
 
-        return result;
+        c.win_emu.registry.set_value(*key, u16_to_u8(name), type, std::move(value_data));
+
+        return STATUS_SUCCESS;
+    }
+
+    NTSTATUS handle_NtDeleteKey(const syscall_context& c, const handle key_handle)
+    {
+        const auto* key = c.proc.registry_keys.get(key_handle);
+        if (!key)
+        {
+            return STATUS_INVALID_HANDLE;
+        }
+
+        if (c.win_emu.callbacks.on_generic_access)
+        {
+            c.win_emu.callbacks.on_generic_access("Deleting key", key->to_string());
+        }
+
+        if (!c.win_emu.registry.delete_key(*key))
+        {
+            return STATUS_CANNOT_DELETE;
+        }
+
+        return STATUS_SUCCESS;
+    }
+
+    NTSTATUS handle_NtDeleteValueKey(const syscall_context& c, const handle key_handle,
+                                     const emulator_object<UNICODE_STRING<EmulatorTraits<Emu64>>> value_name)
+    {
+        const auto* key = c.proc.registry_keys.get(key_handle);
+        if (!key)
+        {
+            return STATUS_INVALID_HANDLE;
+        }
+
+        const auto name = value_name ? read_unicode_string(c.emu, value_name) : std::u16string{};
+
+        if (c.win_emu.callbacks.on_generic_access)
+        {
+            c.win_emu.callbacks.on_generic_access("Deleting value key", name + u" (" + key->to_string() + u")");
+        }
+
+        if (!c.win_emu.registry.delete_value(*key, u16_to_u8(name)))
+        {
+            return STATUS_OBJECT_NAME_NOT_FOUND;
+        }
+
+        return STATUS_SUCCESS;
+    }
+
+    NTSTATUS handle_NtFlushKey()
+    {
+        return STATUS_SUCCESS;
     }
 
     NTSTATUS handle_NtNotifyChangeKey()
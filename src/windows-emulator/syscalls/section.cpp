@@ -2,8 +2,6 @@
 #include "../emulator_utils.hpp"
 #include "../syscall_utils.hpp"
 
-#include <utils/io.hpp>
-
 namespace syscalls
 {
     NTSTATUS handle_NtCreateSection(const syscall_context& c, const emulator_object<handle> section_handle,
@@ -231,7 +229,7 @@ namespace syscalls
 
         if (!section_entry->file_name.empty())
         {
-            if (!utils::io::read_file(section_entry->file_name, &file_data))
+            if (!c.win_emu.file_sys.read_file(section_entry->file_name, file_data))
             {
                 return STATUS_INVALID_PARAMETER;
             }
@@ -31,71 +31,207 @@ namespace syscalls
         return STATUS_SUCCESS;
     }
 
-    NTSTATUS handle_NtCreateTimer2(const syscall_context& c, const emulator_object<handle> timer_handle,
-                                   uint64_t /*reserved*/,
-                                   const emulator_object<OBJECT_ATTRIBUTES<EmulatorTraits<Emu64>>> object_attributes,
-                                   ULONG /*attributes*/, ACCESS_MASK /*desired_access*/)
+    namespace
     {
-        std::u16string name{};
-        if (object_attributes)
+        NTSTATUS create_timer(const syscall_context& c, const emulator_object<handle> timer_handle,
+                              const emulator_object<OBJECT_ATTRIBUTES<EmulatorTraits<Emu64>>> object_attributes,
+                              const TIMER_TYPE type)
         {
-            const auto attributes = object_attributes.read();
-            if (attributes.ObjectName)
+            std::u16string name{};
+            if (object_attributes)
             {
-                name = read_unicode_string(c.emu, attributes.ObjectName);
-                c.win_emu.callbacks.on_generic_access("Opening timer", name);
+                const auto attributes = object_attributes.read();
+                if (attributes.ObjectName)
+                {
+                    name = read_unicode_string(c.emu, attributes.ObjectName);
+                    c.win_emu.callbacks.on_generic_access("Opening timer", name);
+                }
             }
-        }
 
-        if (!name.empty())
-        {
-            for (auto& entry : c.proc.timers)
+            if (!name.empty())
             {
-                if (entry.second.name == name)
+                for (auto& entry : c.proc.timers)
                 {
-                    ++entry.second.ref_count;
-                    timer_handle.write(c.proc.timers.make_handle(entry.first));
-                    return STATUS_OBJECT_NAME_EXISTS;
+                    if (entry.second.name == name)
+                    {
+                        ++entry.second.ref_count;
+                        timer_handle.write(c.proc.timers.make_handle(entry.first));
+                        return STATUS_OBJECT_NAME_EXISTS;
+                    }
                 }
             }
+
+            timer t{};
+            t.name = std::move(name);
+            t.type = type;
+
+            const auto h = c.proc.timers.store(std::move(t));
+            timer_handle.write(h);
+
+            return STATUS_SUCCESS;
         }
 
-        timer t{};
-        t.name = std::move(name);
+        NTSTATUS set_timer(const syscall_context& c, const handle timer_handle, const LARGE_INTEGER due_time,
+                           const std::chrono::steady_clock::duration period, const uint64_t apc_routine,
+                           const uint64_t apc_context, const emulator_object<BOOLEAN> previous_state)
+        {
+            auto* t = c.proc.timers.get(timer_handle);
+            if (!t)
+            {
+                return STATUS_INVALID_HANDLE;
+            }
 
-        const auto h = c.proc.timers.store(std::move(t));
-        timer_handle.write(h);
+            previous_state.write_if_valid(t->signaled ? TRUE : FALSE);
 
-        return STATUS_SUCCESS;
+            t->cancel();
+            t->signaled = false;
+            t->due_time = utils::convert_delay_interval_to_time_point(c.win_emu.clock(), due_time);
+            t->period = period;
+
+            if (apc_routine)
+            {
+                t->apc_routine = apc_routine;
+                t->apc_context = apc_context;
+                t->apc_thread_id = c.win_emu.current_thread().id;
+            }
+
+            return STATUS_SUCCESS;
+        }
+    }
+
+    NTSTATUS handle_NtCreateTimer2(const syscall_context& c, const emulator_object<handle> timer_handle,
+                                   uint64_t /*reserved*/,
+                                   const emulator_object<OBJECT_ATTRIBUTES<EmulatorTraits<Emu64>>> object_attributes,
+                                   ULONG /*attributes*/, ACCESS_MASK /*desired_access*/)
+    {
+        return create_timer(c, timer_handle, object_attributes, NotificationTimer);
     }
 
     NTSTATUS handle_NtCreateTimer(const syscall_context& c, const emulator_object<handle> timer_handle,
-                                  ACCESS_MASK desired_access,
+                                  ACCESS_MASK /*desired_access*/,
                                   const emulator_object<OBJECT_ATTRIBUTES<EmulatorTraits<Emu64>>> object_attributes,
-                                  ULONG timer_type)
+                                  const ULONG timer_type)
     {
-        return handle_NtCreateTimer2(c, timer_handle, 0, object_attributes, timer_type, desired_access);
+        if (timer_type != NotificationTimer && timer_type != SynchronizationTimer)
+        {
+            return STATUS_INVALID_PARAMETER;
+        }
+
+        return create_timer(c, timer_handle, object_attributes, static_cast<TIMER_TYPE>(timer_type));
     }
 
-    NTSTATUS handle_NtSetTimer()
+    NTSTATUS handle_NtSetTimer(const syscall_context& c, const handle timer_handle,
+                               const emulator_object<LARGE_INTEGER> due_time, const uint64_t timer_apc_routine,
+                               const uint64_t timer_context, BOOLEAN /*resume_timer*/, const LONG period,
+                               const emulator_object<BOOLEAN> previous_state)
     {
-        return STATUS_SUCCESS;
+        if (period < 0)
+        {
+            return STATUS_INVALID_PARAMETER;
+        }
+
+        return set_timer(c, timer_handle, due_time.read(), std::chrono::milliseconds(period), timer_apc_routine,
+                         timer_context, previous_state);
     }
 
-    NTSTATUS handle_NtSetTimer2()
+    NTSTATUS handle_NtSetTimer2(const syscall_context& c, const handle timer_handle,
+                                const emulator_object<LARGE_INTEGER> due_time,
+                                const emulator_object<LARGE_INTEGER> period, uint64_t /*parameters*/)
     {
-        return STATUS_SUCCESS;
+        std::chrono::steady_clock::duration timer_period{};
+
+        if (period)
+        {
+            const auto value = period.read().QuadPart;
+            if (value < 0)
+            {
+                return STATUS_INVALID_PARAMETER;
+            }
+
+            timer_period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::nanoseconds(value * 100));
+        }
+
+        return set_timer(c, timer_handle, due_time.read(), timer_period, 0, 0, emulator_object<BOOLEAN>{c.emu});
+    }
+
+    NTSTATUS handle_NtSetTimerEx(const syscall_context& c, const handle timer_handle,
+                                 const uint32_t timer_set_info_class, const uint64_t timer_set_information,
+                                 const ULONG timer_set_information_length)
+    {
+        if (timer_set_info_class != TimerSetCoalescableTimer)
+        {
+            c.win_emu.log.error("Unsupported timer set info class: %X\n", timer_set_info_class);
+            c.emu.stop();
+            return STATUS_NOT_SUPPORTED;
+        }
+
+        using info_type = TIMER_SET_COALESCABLE_TIMER_INFO<EmulatorTraits<Emu64>>;
+
+        if (timer_set_information_length != sizeof(info_type))
+        {
+            return STATUS_INFO_LENGTH_MISMATCH;
+        }
+
+        const auto info = c.emu.read_memory<info_type>(timer_set_information);
+        const emulator_object<BOOLEAN> previous_state{c.emu, info.PreviousState};
+
+        return set_timer(c, timer_handle, info.DueTime, std::chrono::milliseconds(info.Period), info.TimerApcRoutine,
+                         info.TimerContext, previous_state);
     }
 
-    NTSTATUS handle_NtSetTimerEx(const syscall_context& /*c*/, handle /*timer_handle*/,
-                                 uint32_t /*timer_set_info_class*/, uint64_t /*timer_set_information*/,
-                                 ULONG /*timer_set_information_length*/)
+    NTSTATUS handle_NtCancelTimer(const syscall_context& c, const handle timer_handle,
+                                  const emulator_object<BOOLEAN> current_state)
     {
-        return STATUS_NOT_SUPPORTED;
+        auto* t = c.proc.timers.get(timer_handle);
+        if (!t)
+        {
+            return STATUS_INVALID_HANDLE;
+        }
+
+        current_state.write_if_valid(t->signaled ? TRUE : FALSE);
+        t->cancel();
+
+        return STATUS_SUCCESS;
     }
 
-    NTSTATUS handle_NtCancelTimer()
+    NTSTATUS handle_NtQueryTimer(const syscall_context& c, const handle timer_handle,
+                                 const TIMER_INFORMATION_CLASS timer_information_class,
+                                 const uint64_t timer_information, const ULONG timer_information_length,
+                                 const emulator_object<ULONG> return_length)
     {
+        const auto* t = c.proc.timers.get(timer_handle);
+        if (!t)
+        {
+            return STATUS_INVALID_HANDLE;
+        }
+
+        if (timer_information_class != TimerBasicInformation)
+        {
+            c.win_emu.log.error("Unsupported timer info class: %X\n", timer_information_class);
+            c.emu.stop();
+            return STATUS_NOT_SUPPORTED;
+        }
+
+        return_length.write_if_valid(sizeof(TIMER_BASIC_INFORMATION));
+
+        if (timer_information_length != sizeof(TIMER_BASIC_INFORMATION))
+        {
+            return STATUS_INFO_LENGTH_MISMATCH;
+        }
+
+        std::chrono::steady_clock::duration remaining{};
+        if (t->due_time)
+        {
+            remaining = std::max(*t->due_time - c.win_emu.clock().steady_now(), remaining);
+        }
+
+        TIMER_BASIC_INFORMATION info{};
+        info.RemainingTime.QuadPart = std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count() / 100;
+        info.TimerState = t->signaled ? TRUE : FALSE;
+
+        c.emu.write_memory(timer_information, info);
+
         return STATUS_SUCCESS;
     }
 }
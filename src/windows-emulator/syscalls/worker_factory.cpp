@@ -0,0 +1,446 @@
+#include "../std_include.hpp"
+#include "../syscall_dispatcher.hpp"
+#include "../emulator_utils.hpp"
+#include "../syscall_utils.hpp"
+
+namespace syscalls
+{
+    namespace
+    {
+        using completion_information = FILE_IO_COMPLETION_INFORMATION<EmulatorTraits<Emu64>>;
+
+        emulator_thread* find_thread(const syscall_context& c, const uint32_t thread_id)
+        {
+            for (auto& thread : c.proc.threads | std::views::values)
+            {
+                if (thread.id == thread_id)
+                {
+                    return &thread;
+                }
+            }
+
+            return nullptr;
+        }
+
+        // Waiters stay registered after a timeout or an alert, so only
+        // threads that are still parked on the port may receive packets
+        emulator_thread* get_parked_thread(const syscall_context& c, const io_completion& port,
+                                           const io_completion_waiter& waiter)
+        {
+            auto* thread = find_thread(c, waiter.thread_id);
+            if (!thread || thread->is_terminated())
+            {
+                return nullptr;
+            }
+
+            const auto is_port = [&](const handle h) {
+                return c.proc.io_completions.get(h) == &port; //
+            };
+
+            return std::ranges::any_of(thread->await_objects, is_port) ? thread : nullptr;
+        }
+
+        void write_packets(const syscall_context& c, const io_completion_waiter& waiter,
+                           const std::span<const io_completion_packet> packets)
+        {
+            if (!waiter.array_form)
+            {
+                const auto& packet = packets.front();
+                emulator_object<uint64_t>{c.emu, waiter.key_context}.write_if_valid(packet.key_context);
+                emulator_object<uint64_t>{c.emu, waiter.apc_context}.write_if_valid(packet.apc_context);
+
+                IO_STATUS_BLOCK<EmulatorTraits<Emu64>> block{};
+                block.Status = packet.status;
+                block.Information = packet.information;
+
+                emulator_object<IO_STATUS_BLOCK<EmulatorTraits<Emu64>>>{c.emu, waiter.io_status_block}.write_if_valid(
+                    block);
+                return;
+            }
+
+            const emulator_object<completion_information> entries{c.emu, waiter.packets};
+
+            for (size_t i = 0; i < packets.size(); ++i)
+            {
+                completion_information info{};
+                info.KeyContext = packets[i].key_context;
+                info.ApcContext = packets[i].apc_context;
+                info.IoStatusBlock.Status = packets[i].status;
+                info.IoStatusBlock.Information = packets[i].information;
+
+                entries.write(info, i);
+            }
+
+            emulator_object<ULONG>{c.emu, waiter.removed_count}.write_if_valid(static_cast<ULONG>(packets.size()));
+        }
+
+        size_t remove_packets(const syscall_context& c, io_completion& port, const io_completion_waiter& waiter)
+        {
+            const auto count = std::min<size_t>(port.packets.size(), waiter.array_form ? waiter.count : 1);
+            if (count == 0)
+            {
+                return 0;
+            }
+
+            write_packets(c, waiter, std::span(port.packets).first(count));
+            port.packets.erase(port.packets.begin(), port.packets.begin() + static_cast<ptrdiff_t>(count));
+
+            return count;
+        }
+
+        void park_thread(const syscall_context& c, const handle port_handle, io_completion& port,
+                         io_completion_waiter waiter, const emulator_object<LARGE_INTEGER> timeout,
+                         const bool alertable)
+        {
+            auto& t = c.win_emu.current_thread();
+
+            std::erase_if(port.waiters, [&](const io_completion_waiter& entry) {
+                return entry.thread_id == t.id; //
+            });
+
+            waiter.thread_id = t.id;
+            port.waiters.push_back(waiter);
+
+            t.await_objects = {port_handle};
+            t.await_any = false;
+
+            if (timeout.value() && !t.await_time.has_value())
+            {
+                t.await_time = utils::convert_delay_interval_to_time_point(c.win_emu.clock(), timeout.read());
+            }
+
+            c.win_emu.yield_thread(alertable);
+        }
+
+        worker_factory* find_worker_factory(const syscall_context& c, const io_completion& port)
+        {
+            for (auto& factory : c.proc.worker_factories | std::views::values)
+            {
+                if (!factory.shutdown && c.proc.io_completions.get(factory.completion_port) == &port)
+                {
+                    return &factory;
+                }
+            }
+
+            return nullptr;
+        }
+
+        void spawn_worker(const syscall_context& c, worker_factory& factory)
+        {
+            const auto h = c.proc.create_thread(c.win_emu.memory, factory.start_routine, factory.start_parameter,
+                                                factory.stack_reserve, false);
+
+            factory.worker_ids.push_back(c.proc.threads.get(h)->id);
+            ++factory.starting_workers;
+        }
+
+        size_t get_live_worker_count(const syscall_context& c, worker_factory& factory)
+        {
+            std::erase_if(factory.worker_ids, [&](const uint32_t id) {
+                const auto* thread = find_thread(c, id);
+                return !thread || thread->is_terminated();
+            });
+
+            return factory.worker_ids.size();
+        }
+
+        // Workers that are still starting up will pick up queued packets
+        // before parking, so only the remainder needs new threads
+        void request_workers(const syscall_context& c, worker_factory& factory, const size_t pending_work)
+        {
+            const auto max_threads = std::max<size_t>(factory.max_threads, 1);
+
+            while (!factory.shutdown && factory.starting_workers < pending_work &&
+                   get_live_worker_count(c, factory) < max_threads)
+            {
+                spawn_worker(c, factory);
+            }
+        }
+
+        void ensure_minimum_workers(const syscall_context& c, worker_factory& factory)
+        {
+            while (!factory.shutdown && get_live_worker_count(c, factory) < factory.min_threads)
+            {
+                spawn_worker(c, factory);
+            }
+        }
+
+        void post_packet(const syscall_context& c, io_completion& port, const io_completion_packet& packet)
+        {
+            while (!port.waiters.empty())
+            {
+                const auto waiter = port.waiters.front();
+                port.waiters.erase(port.waiters.begin());
+
+                auto* thread = get_parked_thread(c, port, waiter);
+                if (!thread)
+                {
+                    continue;
+                }
+
+                // A parked thread receives the packet directly and never sees it queued
+                write_packets(c, waiter, std::span(&packet, 1));
+                thread->mark_as_ready(STATUS_SUCCESS);
+                return;
+            }
+
+            port.packets.push_back(packet);
+
+            if (auto* factory = find_worker_factory(c, port))
+            {
+                request_workers(c, *factory, port.packets.size());
+            }
+        }
+
+        NTSTATUS remove_io_completion(const syscall_context& c, const handle io_completion_handle,
+                                      const io_completion_waiter& waiter,
+                                      const emulator_object<LARGE_INTEGER> timeout, const bool alertable)
+        {
+            auto* port = c.proc.io_completions.get(io_completion_handle);
+            if (!port)
+            {
+                return STATUS_INVALID_HANDLE;
+            }
+
+            if (remove_packets(c, *port, waiter) > 0)
+            {
+                return STATUS_SUCCESS;
+            }
+
+            if (timeout && timeout.read().QuadPart == 0)
+            {
+                return STATUS_TIMEOUT;
+            }
+
+            park_thread(c, io_completion_handle, *port, waiter, timeout, alertable);
+            return STATUS_SUCCESS;
+        }
+    }
+
+    NTSTATUS handle_NtCreateIoCompletion(
+        const syscall_context& c, const emulator_object<handle> io_completion_handle,
+        const ACCESS_MASK /*desired_access*/,
+        const emulator_object<OBJECT_ATTRIBUTES<EmulatorTraits<Emu64>>> object_attributes,
+        const uint32_t /*number_of_concurrent_threads*/)
+    {
+        io_completion port{};
+
+        if (object_attributes)
+        {
+            const auto attributes = object_attributes.read();
+            if (attributes.ObjectName)
+            {
+                port.name = read_unicode_string(c.emu, attributes.ObjectName);
+            }
+        }
+
+        io_completion_handle.write(c.proc.io_completions.store(std::move(port)));
+        return STATUS_SUCCESS;
+    }
+
+    NTSTATUS handle_NtSetIoCompletion(const syscall_context& c, const handle io_completion_handle,
+                                      const uint64_t key_context, const uint64_t apc_context, const NTSTATUS io_status,
+                                      const uint64_t io_status_information)
+    {
+        auto* port = c.proc.io_completions.get(io_completion_handle);
+        if (!port)
+        {
+            return STATUS_INVALID_HANDLE;
+        }
+
+        post_packet(c, *port,
+                    {
+                        .key_context = key_context,
+                        .apc_context = apc_context,
+                        .status = io_status,
+                        .information = io_status_information,
+                    });
+
+        return STATUS_SUCCESS;
+    }
+
+    NTSTATUS handle_NtSetIoCompletionEx(const syscall_context& c, const handle io_completion_handle,
+                                        const handle /*io_completion_packet_handle*/, const uint64_t key_context,
+                                        const uint64_t apc_context, const NTSTATUS io_status,
+                                        const uint64_t io_status_information)
+    {
+        return handle_NtSetIoCompletion(c, io_completion_handle, key_context, apc_context, io_status,
+                                        io_status_information);
+    }
+
+    NTSTATUS handle_NtRemoveIoCompletion(const syscall_context& c, const handle io_completion_handle,
+                                         const emulator_object<uint64_t> key_context,
+                                         const emulator_object<uint64_t> apc_context,
+                                         const emulator_object<IO_STATUS_BLOCK<EmulatorTraits<Emu64>>> io_status_block,
+                                         const emulator_object<LARGE_INTEGER> timeout)
+    {
+        io_completion_waiter waiter{};
+        waiter.key_context = key_context.value();
+        waiter.apc_context = apc_context.value();
+        waiter.io_status_block = io_status_block.value();
+
+        return remove_io_completion(c, io_completion_handle, waiter, timeout, false);
+    }
+
+    NTSTATUS handle_NtRemoveIoCompletionEx(const syscall_context& c, const handle io_completion_handle,
+                                           const emulator_object<completion_information> io_completion_information,
+                                           const ULONG count, const emulator_object<ULONG> num_entries_removed,
+                                           const emulator_object<LARGE_INTEGER> timeout, const BOOLEAN alertable)
+    {
+        if (count == 0)
+        {
+            return STATUS_INVALID_PARAMETER;
+        }
+
+        io_completion_waiter waiter{};
+        waiter.array_form = true;
+        waiter.packets = io_completion_information.value();
+        waiter.count = count;
+        waiter.removed_count = num_entries_removed.value();
+
+        return remove_io_completion(c, io_completion_handle, waiter, timeout, alertable);
+    }
+
+    NTSTATUS handle_NtCreateWorkerFactory(
+        const syscall_context& c, const emulator_object<handle> worker_factory_handle,
+        const ACCESS_MASK /*desired_access*/,
+        const emulator_object<OBJECT_ATTRIBUTES<EmulatorTraits<Emu64>>> /*object_attributes*/,
+        const handle completion_port_handle, const handle /*worker_process_handle*/, const uint64_t start_routine,
+        const uint64_t start_parameter, const ULONG max_thread_count, const EmulatorTraits<Emu64>::SIZE_T stack_reserve,
+        const EmulatorTraits<Emu64>::SIZE_T stack_commit)
+    {
+        if (!c.proc.io_completions.get(completion_port_handle))
+        {
+            return STATUS_INVALID_HANDLE;
+        }
+
+        worker_factory factory{};
+        factory.completion_port = completion_port_handle;
+        factory.start_routine = start_routine;
+        factory.start_parameter = start_parameter;
+        factory.max_threads = max_thread_count;
+        factory.stack_reserve = stack_reserve;
+        factory.stack_commit = stack_commit;
+
+        worker_factory_handle.write(c.proc.worker_factories.store(std::move(factory)));
+        return STATUS_SUCCESS;
+    }
+
+    NTSTATUS handle_NtSetInformationWorkerFactory(const syscall_context& c, const handle worker_factory_handle,
+                                                  const WORKERFACTORYINFOCLASS worker_factory_information_class,
+                                                  const uint64_t worker_factory_information,
+                                                  const ULONG worker_factory_information_length)
+    {
+        auto* factory = c.proc.worker_factories.get(worker_factory_handle);
+        if (!factory)
+        {
+            return STATUS_INVALID_HANDLE;
+        }
+
+        const auto read_value = [&]() -> std::optional<ULONG> {
+            if (worker_factory_information_length < sizeof(ULONG))
+            {
+                return std::nullopt;
+            }
+
+            return c.emu.read_memory<ULONG>(worker_factory_information);
+        };
+
+        switch (worker_factory_information_class)
+        {
+        case WorkerFactoryThreadMinimum: {
+            const auto value = read_value();
+            if (!value)
+            {
+                return STATUS_INFO_LENGTH_MISMATCH;
+            }
+
+            factory->min_threads = *value;
+            ensure_minimum_workers(c, *factory);
+            return STATUS_SUCCESS;
+        }
+
+        case WorkerFactoryThreadMaximum: {
+            const auto value = read_value();
+            if (!value)
+            {
+                return STATUS_INFO_LENGTH_MISMATCH;
+            }
+
+            factory->max_threads = *value;
+            return STATUS_SUCCESS;
+        }
+
+        default:
+            return STATUS_SUCCESS;
+        }
+    }
+
+    NTSTATUS handle_NtWorkerFactoryWorkerReady(const syscall_context& c, const handle worker_factory_handle)
+    {
+        auto* factory = c.proc.worker_factories.get(worker_factory_handle);
+        if (!factory)
+        {
+            return STATUS_INVALID_HANDLE;
+        }
+
+        if (factory->starting_workers > 0)
+        {
+            --factory->starting_workers;
+        }
+
+        return STATUS_SUCCESS;
+    }
+
+    NTSTATUS handle_NtReleaseWorkerFactoryWorker(const syscall_context& c, const handle worker_factory_handle)
+    {
+        auto* factory = c.proc.worker_factories.get(worker_factory_handle);
+        if (!factory)
+        {
+            return STATUS_INVALID_HANDLE;
+        }
+
+        // The calling worker is about to block, so queued work may need another thread
+        if (const auto* port = c.proc.io_completions.get(factory->completion_port))
+        {
+            request_workers(c, *factory, port->packets.size());
+        }
+
+        return STATUS_SUCCESS;
+    }
+
+    NTSTATUS handle_NtWaitForWorkViaWorkerFactory(const syscall_context& c, const handle worker_factory_handle,
+                                                  const emulator_object<completion_information> mini_packets,
+                                                  const ULONG count, const emulator_object<ULONG> packets_returned,
+                                                  const uint64_t /*deferred_work*/)
+    {
+        const auto* factory = c.proc.worker_factories.get(worker_factory_handle);
+        if (!factory)
+        {
+            return STATUS_INVALID_HANDLE;
+        }
+
+        io_completion_waiter waiter{};
+        waiter.array_form = true;
+        waiter.packets = mini_packets.value();
+        waiter.count = std::max<ULONG>(count, 1);
+        waiter.removed_count = packets_returned.value();
+
+        return remove_io_completion(c, factory->completion_port, waiter, emulator_object<LARGE_INTEGER>{c.emu}, false);
+    }
+
+    NTSTATUS handle_NtShutdownWorkerFactory(const syscall_context& c, const handle worker_factory_handle,
+                                            const emulator_object<LONG> pending_worker_count)
+    {
+        auto* factory = c.proc.worker_factories.get(worker_factory_handle);
+        if (!factory)
+        {
+            return STATUS_INVALID_HANDLE;
+        }
+
+        factory->shutdown = true;
+        pending_worker_count.write_if_valid(static_cast<LONG>(factory->starting_workers));
+
+        return STATUS_SUCCESS;
+    }
+}
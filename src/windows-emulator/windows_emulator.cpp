@@ -48,8 +48,63 @@ namespace
         adjust_application(app_settings);
     }
 
+    void queue_timer_apc(windows_emulator& win_emu, const timer& t)
+    {
+        const auto system_time = utils::convert_to_ksystem_time(win_emu.clock().system_now());
+
+        for (auto& thread : win_emu.process.threads | std::views::values)
+        {
+            if (thread.id == t.apc_thread_id && !thread.is_terminated())
+            {
+                thread.pending_apcs.push_back({
+                    .apc_routine = t.apc_routine,
+                    .apc_argument1 = t.apc_context,
+                    .apc_argument2 = system_time.LowPart,
+                    .apc_argument3 = static_cast<uint32_t>(system_time.High1Time),
+                });
+
+                return;
+            }
+        }
+    }
+
+    void process_timers(windows_emulator& win_emu)
+    {
+        const auto now = win_emu.clock().steady_now();
+
+        for (auto& t : win_emu.process.timers | std::views::values)
+        {
+            if (!t.due_time || *t.due_time > now)
+            {
+                continue;
+            }
+
+            t.signaled = true;
+
+            if (t.apc_routine)
+            {
+                queue_timer_apc(win_emu, t);
+            }
+
+            if (t.period == std::chrono::steady_clock::duration{})
+            {
+                t.due_time = std::nullopt;
+                continue;
+            }
+
+            // Missed periods are not replayed, the timer fires once and rearms
+            *t.due_time += t.period;
+            if (*t.due_time <= now)
+            {
+                t.due_time = now + t.period;
+            }
+        }
+    }
+
     void perform_context_switch_work(windows_emulator& win_emu)
     {
+        process_timers(win_emu);
+
         auto& threads = win_emu.process.threads;
 
         for (auto it = threads.begin(); it != threads.end();)
@@ -253,6 +308,17 @@ namespace
         }
     };
 
+    cpu_profile resolve_cpu_profile(const std::string_view name)
+    {
+        auto profile = get_cpu_profile(name);
+        if (!profile)
+        {
+            throw std::runtime_error("Unknown CPU profile: " + std::string(name));
+        }
+
+        return std::move(*profile);
+    }
+
     std::unique_ptr<utils::clock> get_clock(emulator_interfaces& interfaces, const uint64_t& instructions,
                                             const bool use_relative_time)
     {
@@ -281,6 +347,24 @@ namespace
         return std::make_unique<network::socket_factory>();
 #endif
     }
+
+    NTSTATUS get_interrupt_exception_code(const int interrupt)
+    {
+        switch (interrupt)
+        {
+        case 0:
+            return STATUS_INTEGER_DIVIDE_BY_ZERO;
+        case 1:
+            return STATUS_SINGLE_STEP;
+        case 3:
+        case 45:
+            return STATUS_BREAKPOINT;
+        case 6:
+            return STATUS_ILLEGAL_INSTRUCTION;
+        default:
+            return STATUS_UNSUCCESSFUL;
+        }
+    }
 }
 
 windows_emulator::windows_emulator(std::unique_ptr<x86_64_emulator> emu, application_settings app_settings,
@@ -303,8 +387,16 @@ windows_emulator::windows_emulator(std::unique_ptr<x86_64_emulator> emu, const e
       memory(*this->emu_),
       registry(emulation_root.empty() ? settings.registry_directory : emulation_root / "registry"),
       mod_manager(memory, file_sys, this->callbacks),
+      symbols(settings.symbol_directory),
       process(*this->emu_, memory, *this->clock_, this->callbacks),
-      use_relative_time_(settings.use_relative_time)
+      debug_output(*this->clock_, settings.max_debug_messages_per_second),
+      console(settings.console_input_mode),
+      heap(this->callbacks, settings.track_heap_allocations),
+      plugins(*this),
+      use_relative_time_(settings.use_relative_time),
+      use_native_function_lookup_(settings.use_native_function_lookup),
+      use_fast_memory_queries_(settings.use_fast_memory_queries),
+      cpu_profile_(resolve_cpu_profile(settings.cpu_profile))
 {
 #ifndef OS_WINDOWS
     if (this->emulation_root.empty())
@@ -318,11 +410,52 @@ windows_emulator::windows_emulator(std::unique_ptr<x86_64_emulator> emu, const e
         this->file_sys.map(mapping.first, mapping.second);
     }
 
+    if (settings.use_file_overlay)
+    {
+        this->file_sys.enable_overlay();
+    }
+
+    if (!settings.registry_delta.empty() && std::filesystem::exists(settings.registry_delta))
+    {
+        this->registry.load_overlay(settings.registry_delta);
+    }
+
+    for (const auto& memory_file : settings.memory_files)
+    {
+        this->file_sys.add_memory_file(memory_file.first, memory_file.second);
+    }
+
+    for (const auto& rule : settings.syscall_faults)
+    {
+        this->faults.add_rule(rule);
+    }
+
     for (const auto& mapping : settings.port_mappings)
     {
         this->map_port(mapping.first, mapping.second);
     }
 
+    this->debug_output.set_sink([this](const debug_output_message& message) {
+        if (this->callbacks.on_debug_output)
+        {
+            this->callbacks.on_debug_output(message);
+        }
+        else if (message.repeat_count == 0)
+        {
+            this->log.info("--> %s: %s\n", get_debug_output_source_name(message.source), message.text.c_str());
+        }
+    });
+
+    this->console.set_sink([this](const std::string_view data) {
+        this->callbacks.on_stdout(data); //
+    });
+
+    if (settings.console_input)
+    {
+        this->console.push_input(*settings.console_input);
+        this->console.close_input();
+    }
+
     this->setup_hooks();
 }
 
@@ -356,11 +489,13 @@ void windows_emulator::setup_process(const application_settings& app_settings)
     const auto apiset_data = apiset::obtain(this->emulation_root);
 
     this->process.setup(this->emu(), this->memory, this->registry, app_settings, *executable, *ntdll, apiset_data);
+    this->cpu_profile_.apply(this->process.kusd.get());
 
     const auto ntdll_data = emu.read_memory(ntdll->image_base, static_cast<size_t>(ntdll->size_of_image));
     const auto win32u_data = emu.read_memory(win32u->image_base, static_cast<size_t>(win32u->size_of_image));
 
     this->dispatcher.setup(ntdll->exports, ntdll_data, win32u->exports, win32u_data);
+    this->heap.setup(*ntdll);
 
     const auto main_thread_id =
         context.create_thread(this->memory, this->mod_manager.executable->entry_point, 0, 0, false);
@@ -426,6 +561,234 @@ void windows_emulator::on_instruction_execution(const uint64_t address)
     this->process.current_ip = this->emu().read_instruction_pointer();
 
     this->callbacks.on_instruction(address);
+
+    if (this->use_native_function_lookup_ && address == this->process.rtl_lookup_function_entry)
+    {
+        this->perform_native_function_lookup();
+    }
+
+    if (this->use_fast_memory_queries_ && address == this->process.nt_query_virtual_memory)
+    {
+        this->perform_fast_memory_query();
+    }
+
+    if (this->heap.is_active())
+    {
+        this->heap.on_instruction(this->emu(), thread.id, address);
+    }
+}
+
+// Answers RtlLookupFunctionEntry from the host-side .pdata index and returns to the caller.
+// Only image functions with a direct entry are handled. Dynamic function tables, indirect
+// entries and misses fall through to the guest implementation. The optional history table
+// is a pure lookup cache, so leaving it untouched does not change any result.
+bool windows_emulator::perform_native_function_lookup()
+{
+    auto& emu = this->emu();
+
+    const auto control_pc = emu.reg(x86_register::rcx);
+    const auto image_base_ptr = emu.reg(x86_register::rdx);
+
+    const auto* mod = this->mod_manager.find_by_address(control_pc);
+    if (!mod)
+    {
+        return false;
+    }
+
+    const auto* function = mod->find_function_entry(control_pc);
+    if (!function || (function->unwind_info & 1) != 0)
+    {
+        return false;
+    }
+
+    const auto rsp = emu.reg(x86_register::rsp);
+
+    uint64_t return_address{};
+    if (!emu.try_read_memory(rsp, &return_address, sizeof(return_address)))
+    {
+        return false;
+    }
+
+    // Let the guest raise the fault for bad output pointers
+    uint64_t previous_image_base{};
+    if (image_base_ptr && !emu.try_read_memory(image_base_ptr, &previous_image_base, sizeof(previous_image_base)))
+    {
+        return false;
+    }
+
+    if (image_base_ptr)
+    {
+        emu.write_memory(image_base_ptr, mod->image_base);
+    }
+
+    emu.reg(x86_register::rax, mod->image_base + mod->functions.get_entry_rva(*function));
+    emu.reg(x86_register::rsp, rsp + sizeof(return_address));
+    emu.reg(x86_register::rip, return_address);
+
+    return true;
+}
+
+// Answers NtQueryVirtualMemory for address space sweeps from the cached region layout and returns
+// to the caller without dispatching the syscall. Only a basic information query that starts where the
+// previous answer ended is handled, so the first query of every sweep still goes through the syscall.
+// Syscall callbacks and fault injection still see every query, see syscall_dispatcher::intercept.
+bool windows_emulator::perform_fast_memory_query()
+{
+    auto& emu = this->emu();
+
+    const auto process_handle = make_handle(emu.reg(x86_register::rcx));
+    const auto base_address = emu.reg(x86_register::rdx);
+    const auto info_class = static_cast<uint32_t>(emu.reg(x86_register::r8));
+    const auto memory_information = emu.reg(x86_register::r9);
+    const auto rsp = emu.reg(x86_register::rsp);
+
+    if (process_handle != CURRENT_PROCESS || info_class != MemoryBasicInformation ||
+        base_address >= MAX_ALLOCATION_ADDRESS)
+    {
+        return false;
+    }
+
+    const auto& region = this->memory.get_region_cursor().find(base_address);
+
+    const auto is_sequential = base_address == this->next_memory_query_;
+    this->next_memory_query_ = region.start + region.length;
+
+    if (!is_sequential)
+    {
+        return false;
+    }
+
+    // Stack layout at entry: return address, 4 home slots, length, return length
+    std::array<uint64_t, 7> stack{};
+    if (!emu.try_read_memory(rsp, stack.data(), sizeof(stack)))
+    {
+        return false;
+    }
+
+    const auto return_address = stack[0];
+    const auto memory_information_length = stack[5];
+    const auto return_length = stack[6];
+
+    EMU_MEMORY_BASIC_INFORMATION64 info{};
+    if (memory_information_length < sizeof(info) ||
+        !emu.try_read_memory(memory_information, &info, sizeof(info)) ||
+        (return_length && !emu.try_read_memory(return_length, &info, sizeof(uint64_t))))
+    {
+        return false;
+    }
+
+    // The stub starts with 'mov r10, rcx' followed by 'mov eax, <syscall id>'
+    std::array<uint8_t, 8> stub{};
+    if (!emu.try_read_memory(this->process.nt_query_virtual_memory, stub.data(), stub.size()) || stub[3] != 0xB8)
+    {
+        return false;
+    }
+
+    uint32_t syscall_id{};
+    memcpy(&syscall_id, stub.data() + 4, sizeof(syscall_id));
+
+    emu.reg(x86_register::r10, emu.reg(x86_register::rcx));
+
+    if (!this->dispatcher.intercept(*this, syscall_id))
+    {
+        if (return_length)
+        {
+            emu.write_memory<uint64_t>(return_length, sizeof(info));
+        }
+
+        // Injected faults may have truncated the length
+        const auto length = emu.read_memory<uint64_t>(rsp + (5 * sizeof(uint64_t)));
+        if (length < sizeof(info))
+        {
+            emu.reg<uint64_t>(x86_register::rax, STATUS_BUFFER_TOO_SMALL);
+        }
+        else
+        {
+            info = get_basic_memory_information(region);
+            emu.write_memory(memory_information, info);
+
+            emu.reg<uint64_t>(x86_register::rax, STATUS_SUCCESS);
+        }
+    }
+
+    emu.reg(x86_register::rsp, rsp + sizeof(return_address));
+    emu.reg(x86_register::rip, return_address);
+
+    return true;
+}
+
+void windows_emulator::emulate_xgetbv()
+{
+    const auto index = this->emu().reg<uint32_t>(x86_register::ecx);
+    const auto value = this->cpu_profile_.read_xcr(index);
+
+    this->emu().reg(x86_register::rax, value & 0xFFFFFFFF);
+    this->emu().reg(x86_register::rdx, value >> 32);
+}
+
+// Backends that can't hook XGETBV raise #UD for it instead, as they don't set CR4.OSXSAVE
+bool windows_emulator::emulate_faulting_xgetbv()
+{
+    constexpr std::array<uint8_t, 3> xgetbv{0x0F, 0x01, 0xD0};
+
+    const auto rip = this->emu().read_instruction_pointer();
+
+    std::array<uint8_t, 3> instruction{};
+    if (!this->emu().try_read_memory(rip, instruction.data(), instruction.size()) || instruction != xgetbv)
+    {
+        return false;
+    }
+
+    this->emulate_xgetbv();
+    this->emu().reg(x86_register::rip, rip + instruction.size());
+
+    return true;
+}
+
+// DebugPrint in ntdll issues 'int 2d' with the service in EAX, followed by an 'int 3'.
+// Without a kernel debugger, print requests are consumed and both instructions are skipped.
+bool windows_emulator::handle_debug_service()
+{
+    constexpr auto breakpoint_print = 1;
+    constexpr auto max_debug_print_length = 0x1000;
+
+    auto& emu = this->emu();
+    if (emu.reg<uint32_t>(x86_register::eax) != breakpoint_print)
+    {
+        return false;
+    }
+
+    // Depending on the backend, RIP points to the 'int 2d' or behind it
+    auto next_instruction = emu.read_instruction_pointer();
+
+    std::array<uint8_t, 3> code{};
+    if (!emu.try_read_memory(next_instruction, code.data(), code.size()))
+    {
+        return false;
+    }
+
+    if (code[0] == 0xCD && code[1] == 0x2D)
+    {
+        next_instruction += 2;
+        code[0] = code[2];
+    }
+
+    if (code[0] == 0xCC)
+    {
+        next_instruction += 1;
+    }
+
+    const auto buffer = emu.reg(x86_register::rcx);
+    const auto length = std::min<size_t>(emu.reg<uint16_t>(x86_register::dx), max_debug_print_length);
+
+    this->debug_output.push({
+        .source = debug_output_source::dbg_print,
+        .thread_id = this->current_thread().id,
+        .text = read_debug_string(this->memory, buffer, length),
+    });
+
+    emu.reg(x86_register::rip, next_instruction);
+    return true;
 }
 
 void windows_emulator::setup_hooks()
@@ -447,6 +810,25 @@ void windows_emulator::setup_hooks()
         return instruction_hook_continuation::skip_instruction;
     });
 
+    this->emu().hook_instruction(x86_hookable_instructions::cpuid, [&] {
+        const auto leaf = this->emu().reg<uint32_t>(x86_register::eax);
+        const auto subleaf = this->emu().reg<uint32_t>(x86_register::ecx);
+        this->callbacks.on_cpuid(leaf, subleaf);
+
+        const auto result = this->cpu_profile_.query(leaf, subleaf);
+        this->emu().reg(x86_register::rax, result.eax);
+        this->emu().reg(x86_register::rbx, result.ebx);
+        this->emu().reg(x86_register::rcx, result.ecx);
+        this->emu().reg(x86_register::rdx, result.edx);
+
+        return instruction_hook_continuation::skip_instruction;
+    });
+
+    this->emu().hook_instruction(x86_hookable_instructions::xgetbv, [&] {
+        this->emulate_xgetbv();
+        return instruction_hook_continuation::skip_instruction;
+    });
+
     this->emu().hook_instruction(x86_hookable_instructions::rdtsc, [&] {
         const auto ticks = this->clock_->timestamp_counter();
         this->emu().reg(x86_register::rax, ticks & 0xFFFFFFFF);
@@ -460,7 +842,12 @@ void windows_emulator::setup_hooks()
     });
 
     this->emu().hook_interrupt([&](const int interrupt) {
-        this->callbacks.on_exception();
+        if ((interrupt == 6 && this->emulate_faulting_xgetbv()) || (interrupt == 45 && this->handle_debug_service()))
+        {
+            return;
+        }
+
+        this->callbacks.on_exception(get_interrupt_exception_code(interrupt));
         const auto eflags = this->emu().reg<uint32_t>(x86_register::eflags);
 
         switch (interrupt)
@@ -514,6 +901,7 @@ void windows_emulator::setup_hooks()
 void windows_emulator::start(size_t count)
 {
     this->should_stop = false;
+    this->unpark();
     this->setup_process_if_necessary();
 
     const auto use_count = count > 0;
@@ -549,6 +937,9 @@ void windows_emulator::start(size_t count)
             count = static_cast<size_t>(target_instructions - current_instructions);
         }
     }
+
+    this->debug_output.flush();
+    this->console.flush();
 }
 
 void windows_emulator::stop()
@@ -557,6 +948,11 @@ void windows_emulator::stop()
     this->emu().stop();
 }
 
+void windows_emulator::request_stop()
+{
+    this->should_stop = true;
+}
+
 void windows_emulator::register_factories(utils::buffer_deserializer& buffer)
 {
     buffer.register_factory<memory_manager_wrapper>([this] {
@@ -582,6 +978,10 @@ void windows_emulator::register_factories(utils::buffer_deserializer& buffer)
     buffer.register_factory<socket_factory_wrapper>([this] {
         return socket_factory_wrapper{this->socket_factory()}; //
     });
+
+    buffer.register_factory<file_system_wrapper>([this] {
+        return file_system_wrapper{this->file_sys}; //
+    });
 }
 
 void windows_emulator::serialize(utils::buffer_serializer& buffer) const
@@ -594,8 +994,13 @@ void windows_emulator::serialize(utils::buffer_serializer& buffer) const
     this->emu().serialize_state(buffer, false);
     this->memory.serialize_memory_state(buffer, false);
     this->mod_manager.serialize(buffer);
+    this->file_sys.serialize(buffer);
+    this->registry.serialize(buffer);
     this->process.serialize(buffer);
+    this->console.serialize(buffer);
     this->dispatcher.serialize(buffer);
+    this->faults.serialize(buffer);
+    this->heap.serialize(buffer);
 }
 
 void windows_emulator::deserialize(utils::buffer_deserializer& buffer)
@@ -619,12 +1024,21 @@ void windows_emulator::deserialize(utils::buffer_deserializer& buffer)
     this->emu().deserialize_state(buffer, false);
     this->memory.deserialize_memory_state(buffer, false);
     this->mod_manager.deserialize(buffer);
+    this->file_sys.deserialize(buffer);
+    this->registry.deserialize(buffer);
     this->process.deserialize(buffer);
+    this->console.deserialize(buffer);
     this->dispatcher.deserialize(buffer);
+    this->faults.deserialize(buffer);
+    this->heap.deserialize(buffer);
+
+    this->next_memory_query_ = 0;
 }
 
 void windows_emulator::save_snapshot()
 {
+    this->unpark();
+
     utils::buffer_serializer buffer{};
 
     buffer.write_optional(this->application_settings_);
@@ -634,7 +1048,12 @@ void windows_emulator::save_snapshot()
     this->emu().serialize_state(buffer, true);
     this->memory.serialize_memory_state(buffer, true);
     this->mod_manager.serialize(buffer);
+    this->file_sys.serialize(buffer);
+    this->registry.serialize(buffer);
     this->process.serialize(buffer);
+    this->console.serialize(buffer);
+    this->faults.serialize(buffer);
+    this->heap.serialize(buffer);
 
     this->process_snapshot_ = buffer.move_buffer();
 
@@ -650,6 +1069,8 @@ void windows_emulator::restore_snapshot()
         return;
     }
 
+    this->unpark();
+
     utils::buffer_deserializer buffer{this->process_snapshot_};
 
     this->register_factories(buffer);
@@ -661,6 +1082,64 @@ void windows_emulator::restore_snapshot()
     this->emu().deserialize_state(buffer, true);
     this->memory.deserialize_memory_state(buffer, true);
     this->mod_manager.deserialize(buffer);
+    this->file_sys.deserialize(buffer);
+    this->registry.deserialize(buffer);
     this->process.deserialize(buffer);
+    this->console.deserialize(buffer);
+    this->faults.deserialize(buffer);
+    this->heap.deserialize(buffer);
+
+    this->next_memory_query_ = 0;
     // this->process = *this->process_snapshot_;
 }
+
+parking_stats windows_emulator::park()
+{
+    return this->memory.park_memory();
+}
+
+void windows_emulator::unpark()
+{
+    this->memory.unpark_memory();
+}
+
+void windows_emulator::begin_memory_tracking(const bool keep_contents)
+{
+    this->unpark();
+    this->end_memory_tracking();
+
+    this->memory.begin_change_tracking(keep_contents);
+    const auto mark_dirty = [this](const uint64_t address, const void*, const size_t size) {
+        this->memory.mark_dirty(address, size); //
+    };
+
+    this->memory_write_hook_ = this->emu().hook_memory_write(0, MAX_ALLOCATION_ADDRESS, mark_dirty);
+}
+
+memory_diff windows_emulator::diff_memory(const bool verify_untracked)
+{
+    this->unpark();
+
+    auto diff = this->memory.diff_memory(verify_untracked);
+
+    for (auto& page : diff.pages)
+    {
+        if (const auto* mod = this->mod_manager.find_by_address(page.address))
+        {
+            page.module = mod->name;
+        }
+    }
+
+    return diff;
+}
+
+void windows_emulator::end_memory_tracking()
+{
+    if (this->memory_write_hook_)
+    {
+        this->emu().delete_hook(this->memory_write_hook_);
+        this->memory_write_hook_ = nullptr;
+    }
+
+    this->memory.end_change_tracking();
+}
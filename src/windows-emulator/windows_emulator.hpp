@@ -8,32 +8,43 @@
 #include "syscall_dispatcher.hpp"
 #include "process_context.hpp"
 #include "logger.hpp"
+#include "cpu_profile.hpp"
+#include "console.hpp"
+#include "debug_output.hpp"
+#include "fault_injection.hpp"
+#include "heap_tracker.hpp"
+#include "plugin_manager.hpp"
 #include "file_system.hpp"
 #include "memory_manager.hpp"
 #include "module/module_manager.hpp"
+#include "module/symbol_manager.hpp"
 #include "network/socket_factory.hpp"
 
 struct io_device;
 
-#define opt_func utils::optional_function
+template <typename Signature>
+using event_func = utils::callback_list<Signature>;
 
-struct emulator_callbacks : module_manager::callbacks, process_context::callbacks
+struct emulator_callbacks : module_manager::callbacks, process_context::callbacks, heap_tracker::callbacks
 {
     using continuation = instruction_hook_continuation;
 
-    opt_func<void()> on_exception{};
-
-    opt_func<void(uint64_t address, uint64_t length, memory_permission)> on_memory_protect{};
-    opt_func<void(uint64_t address, uint64_t length, memory_permission, bool commit)> on_memory_allocate{};
-    opt_func<void(uint64_t address, uint64_t length, memory_operation, memory_violation_type type)> on_memory_violate{};
-
-    opt_func<continuation(uint32_t syscall_id, std::string_view syscall_name)> on_syscall{};
-    opt_func<void(std::string_view data)> on_stdout{};
-    opt_func<void(std::string_view type, std::u16string_view name)> on_generic_access{};
-    opt_func<void(std::string_view description)> on_generic_activity{};
-    opt_func<void(std::string_view description)> on_suspicious_activity{};
-    opt_func<void(uint64_t address)> on_instruction{};
-    opt_func<void(io_device& device, std::u16string_view device_name, ULONG code)> on_ioctrl{};
+    event_func<void(NTSTATUS exception_code)> on_exception{};
+
+    event_func<void(uint64_t address, uint64_t length, memory_permission)> on_memory_protect{};
+    event_func<void(uint64_t address, uint64_t length, memory_permission, bool commit)> on_memory_allocate{};
+    event_func<void(uint64_t address, uint64_t length, memory_operation, memory_violation_type type)>
+        on_memory_violate{};
+
+    event_func<continuation(uint32_t syscall_id, std::string_view syscall_name)> on_syscall{};
+    event_func<void(std::string_view data)> on_stdout{};
+    event_func<void(std::string_view type, std::u16string_view name)> on_generic_access{};
+    event_func<void(std::string_view description)> on_generic_activity{};
+    event_func<void(std::string_view description)> on_suspicious_activity{};
+    event_func<void(uint64_t address)> on_instruction{};
+    event_func<void(uint32_t leaf, uint32_t subleaf)> on_cpuid{};
+    event_func<void(const debug_output_message& message)> on_debug_output{};
+    event_func<void(io_device& device, std::u16string_view device_name, ULONG code)> on_ioctrl{};
 };
 
 struct application_settings
@@ -61,9 +72,32 @@ struct emulator_settings
 {
     bool disable_logging{false};
     bool use_relative_time{false};
+    bool use_native_function_lookup{false};
+    // Answers address space sweeps without dispatching NtQueryVirtualMemory, syscall
+    // callbacks and fault injection are still applied
+    bool use_fast_memory_queries{false};
+    bool use_file_overlay{false};
+    bool track_heap_allocations{false};
+
+    std::string cpu_profile{"default"};
+    uint32_t max_debug_messages_per_second{1000};
+
+    // Scripted stdin. When set, the guest reads exactly this input and never blocks on the host.
+    std::optional<std::string> console_input{};
+    console_mode console_input_mode{console_mode::line};
+
+    // Files served from host memory instead of the emulation root, e.g. the application itself.
+    // They are readable through all file syscalls and can be mapped as modules.
+    std::unordered_map<windows_path, std::vector<std::byte>> memory_files{};
+
+    // Deterministic schedule of syscall faults, see fault_injector
+    std::vector<syscall_fault_rule> syscall_faults{};
 
     std::filesystem::path emulation_root{};
     std::filesystem::path registry_directory{"./registry"};
+    // Registry changes of a previous run, applied on top of the hives
+    std::filesystem::path registry_delta{};
+    std::filesystem::path symbol_directory{};
 
     std::unordered_map<uint16_t, uint16_t> port_mappings{};
     std::unordered_map<windows_path, std::filesystem::path> path_mappings{};
@@ -92,8 +126,16 @@ class windows_emulator
     memory_manager memory;
     registry_manager registry{};
     module_manager mod_manager;
+    symbol_manager symbols;
     process_context process;
+    debug_output_stream debug_output;
+    console_device console;
     syscall_dispatcher dispatcher;
+    fault_injector faults{};
+    heap_tracker heap;
+
+    // Declared last, plugins detach before the state they observe goes away
+    plugin_manager plugins;
 
     windows_emulator(std::unique_ptr<x86_64_emulator> emu, const emulator_settings& settings = {},
                      emulator_callbacks callbacks = {}, emulator_interfaces interfaces = {});
@@ -158,12 +200,32 @@ class windows_emulator
     void start(size_t count = 0);
     void stop();
 
+    // Can be called from any thread. Unlike stop, the backend is not touched, the run
+    // ends once the current time slice is used up or the thread waits.
+    void request_stop();
+
     void serialize(utils::buffer_serializer& buffer) const;
     void deserialize(utils::buffer_deserializer& buffer);
 
     void save_snapshot();
     void restore_snapshot();
 
+    // Compresses and deduplicates guest memory of an idle instance and releases the backend
+    // mapping. The next start unparks it, guest memory must not be accessed before.
+    parking_stats park();
+    void unpark();
+
+    bool is_parked() const
+    {
+        return this->memory.is_parked();
+    }
+
+    // Diffs guest memory against the state at the start of tracking. Guest stores are
+    // observed through a write hook, which slows down emulation while tracking is active.
+    void begin_memory_tracking(bool keep_contents = false);
+    memory_diff diff_memory(bool verify_untracked = true);
+    void end_memory_tracking();
+
     uint16_t get_host_port(const uint16_t emulator_port) const
     {
         const auto entry = this->port_mappings_.find(emulator_port);
@@ -210,6 +272,11 @@ class windows_emulator
   private:
     bool switch_thread_{false};
     bool use_relative_time_{false}; // TODO: Get rid of that
+    bool use_native_function_lookup_{false};
+    bool use_fast_memory_queries_{false};
+    uint64_t next_memory_query_{};
+    emulator_hook* memory_write_hook_{};
+    cpu_profile cpu_profile_{};
     std::atomic_bool should_stop{false};
 
     std::unordered_map<uint16_t, uint16_t> port_mappings_{};
@@ -220,6 +287,11 @@ class windows_emulator
     void setup_hooks();
     void setup_process(const application_settings& app_settings);
     void on_instruction_execution(uint64_t address);
+    bool perform_native_function_lookup();
+    bool perform_fast_memory_query();
+    void emulate_xgetbv();
+    bool emulate_faulting_xgetbv();
+    bool handle_debug_service();
 
     void register_factories(utils::buffer_deserializer& buffer);
 };
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "handles.hpp"
+#include "emulator_utils.hpp"
+#include "file_system.hpp"
 
 #include <serialization_helper.hpp>
 #include <utils/file_handle.hpp>
@@ -9,15 +11,59 @@
 struct timer : ref_counted_object
 {
     std::u16string name{};
+    TIMER_TYPE type{NotificationTimer};
+    bool signaled{};
+
+    std::optional<std::chrono::steady_clock::time_point> due_time{};
+    std::chrono::steady_clock::duration period{};
+
+    uint64_t apc_routine{};
+    uint64_t apc_context{};
+    uint32_t apc_thread_id{};
+
+    bool is_signaled()
+    {
+        const auto res = this->signaled;
+
+        if (this->type == SynchronizationTimer)
+        {
+            this->signaled = false;
+        }
+
+        return res;
+    }
+
+    void cancel()
+    {
+        this->due_time = std::nullopt;
+        this->period = {};
+        this->apc_routine = 0;
+        this->apc_context = 0;
+        this->apc_thread_id = 0;
+    }
 
     void serialize_object(utils::buffer_serializer& buffer) const override
     {
         buffer.write(this->name);
+        buffer.write(this->type);
+        buffer.write(this->signaled);
+        buffer.write_optional(this->due_time);
+        buffer.write(this->period);
+        buffer.write(this->apc_routine);
+        buffer.write(this->apc_context);
+        buffer.write(this->apc_thread_id);
     }
 
     void deserialize_object(utils::buffer_deserializer& buffer) override
     {
         buffer.read(this->name);
+        buffer.read(this->type);
+        buffer.read(this->signaled);
+        buffer.read_optional(this->due_time);
+        buffer.read(this->period);
+        buffer.read(this->apc_routine);
+        buffer.read(this->apc_context);
+        buffer.read(this->apc_thread_id);
     }
 };
 
@@ -181,15 +227,34 @@ struct file_enumeration_state
     }
 };
 
+struct pipe_end
+{
+    uint32_t pipe_id{};
+    uint32_t connection{};
+    bool is_server{};
+    bool synchronous{};
+    bool message_read_mode{};
+    bool non_blocking{};
+};
+
 struct file : ref_counted_object
 {
     utils::file_handle handle{};
     std::u16string name{};
     std::optional<file_enumeration_state> enumeration_state{};
+    std::optional<pipe_end> pipe{};
+
+    // Mode the host file was opened with, the handle itself is reopened on deserialization
+    std::u16string host_mode{};
+
+    bool in_overlay{};
+    bool append{};
+    bool delete_on_close{};
+    uint64_t position{};
 
     bool is_file() const
     {
-        return this->handle;
+        return this->handle || this->pipe || this->in_overlay || !this->host_mode.empty();
     }
 
     bool is_directory() const
@@ -199,16 +264,59 @@ struct file : ref_counted_object
 
     void serialize_object(utils::buffer_serializer& buffer) const override
     {
-        // TODO: Serialize handle
         buffer.write(this->name);
         buffer.write_optional(this->enumeration_state);
+        buffer.write_optional(this->pipe);
+        buffer.write(this->host_mode);
+        buffer.write<int64_t>(this->handle ? this->handle.tell() : 0);
+        buffer.write(this->in_overlay);
+        buffer.write(this->append);
+        buffer.write(this->delete_on_close);
+        buffer.write(this->position);
     }
 
     void deserialize_object(utils::buffer_deserializer& buffer) override
     {
         buffer.read(this->name);
         buffer.read_optional(this->enumeration_state);
+        buffer.read_optional(this->pipe);
+        buffer.read(this->host_mode);
+        const auto host_position = buffer.read<int64_t>();
+        buffer.read(this->in_overlay);
+        buffer.read(this->append);
+        buffer.read(this->delete_on_close);
+        buffer.read(this->position);
+
+        const auto& file_sys = buffer.read<file_system_wrapper>().get();
+        this->reopen_host_file(file_sys, host_position);
+    }
+
+  private:
+    // The host file is not part of the state, it stays closed if it disappeared in the meantime
+    void reopen_host_file(const file_system& file_sys, const int64_t position)
+    {
         this->handle = {};
+
+        if (this->host_mode.empty())
+        {
+            return;
+        }
+
+        // The file was created or truncated when it was first opened, which must not happen again
+        auto mode = this->host_mode;
+        if (mode.starts_with(u'w'))
+        {
+            mode = u"r+b";
+        }
+
+        FILE* host_file{};
+        open_unicode(&host_file, file_sys.translate(this->name), mode);
+
+        this->handle = host_file;
+        if (this->handle)
+        {
+            this->handle.seek_to(position);
+        }
     }
 };
 
@@ -307,3 +415,97 @@ struct port : ref_counted_object
         buffer.read(this->view_base);
     }
 };
+
+struct io_completion_packet
+{
+    uint64_t key_context{};
+    uint64_t apc_context{};
+    NTSTATUS status{};
+    uint64_t information{};
+};
+
+// Thread parked on a completion port. Either a single packet is returned through
+// the separate key/apc/status pointers, or up to count packets are written as an array.
+struct io_completion_waiter
+{
+    uint32_t thread_id{};
+    bool array_form{};
+    uint64_t packets{};
+    uint32_t count{};
+    uint64_t removed_count{};
+    uint64_t key_context{};
+    uint64_t apc_context{};
+    uint64_t io_status_block{};
+};
+
+struct io_completion : ref_counted_object
+{
+    std::u16string name{};
+    std::vector<io_completion_packet> packets{};
+    std::vector<io_completion_waiter> waiters{};
+
+    bool is_waiting(const uint32_t thread_id) const
+    {
+        return std::ranges::any_of(this->waiters, [&](const io_completion_waiter& waiter) {
+            return waiter.thread_id == thread_id; //
+        });
+    }
+
+    void serialize_object(utils::buffer_serializer& buffer) const override
+    {
+        buffer.write(this->name);
+        buffer.write_vector(this->packets);
+        buffer.write_vector(this->waiters);
+    }
+
+    void deserialize_object(utils::buffer_deserializer& buffer) override
+    {
+        buffer.read(this->name);
+        buffer.read_vector(this->packets);
+        buffer.read_vector(this->waiters);
+    }
+};
+
+// Spawns worker threads on demand for a completion port. Idle workers park
+// on the port and are handed new packets directly by the posting thread.
+struct worker_factory : ref_counted_object
+{
+    handle completion_port{};
+    uint64_t start_routine{};
+    uint64_t start_parameter{};
+    uint32_t min_threads{};
+    uint32_t max_threads{};
+    uint64_t stack_reserve{};
+    uint64_t stack_commit{};
+    uint32_t starting_workers{};
+    bool shutdown{};
+    std::vector<uint32_t> worker_ids{};
+
+    void serialize_object(utils::buffer_serializer& buffer) const override
+    {
+        buffer.write(this->completion_port);
+        buffer.write(this->start_routine);
+        buffer.write(this->start_parameter);
+        buffer.write(this->min_threads);
+        buffer.write(this->max_threads);
+        buffer.write(this->stack_reserve);
+        buffer.write(this->stack_commit);
+        buffer.write(this->starting_workers);
+        buffer.write(this->shutdown);
+        buffer.write_vector(this->worker_ids);
+    }
+
+    void deserialize_object(utils::buffer_deserializer& buffer) override
+    {
+        buffer.read(this->completion_port);
+        buffer.read(this->start_routine);
+        buffer.read(this->start_parameter);
+        buffer.read(this->min_threads);
+        buffer.read(this->max_threads);
+        buffer.read(this->stack_reserve);
+        buffer.read(this->stack_commit);
+        buffer.read(this->starting_workers);
+        buffer.read(this->shutdown);
+        buffer.read_vector(this->worker_ids);
+    }
+};
@@ -91,7 +91,74 @@ class win_x64_gdb_stub_handler : public x64_gdb_stub_handler
         return static_cast<uint32_t>(*status);
     }
 
+    std::optional<std::string> run_monitor_command(const std::string_view command) override
+    {
+        constexpr std::string_view symbol_command = "sym ";
+        constexpr std::string_view heap_command = "heap";
+        constexpr std::string_view heap_address_command = "heap ";
+
+        if (command.starts_with(symbol_command))
+        {
+            const std::string address_string(command.substr(symbol_command.size()));
+            const auto address = strtoull(address_string.c_str(), nullptr, 16);
+
+            return this->win_emu_->symbols.describe(this->win_emu_->mod_manager, address) + "\n";
+        }
+
+        if (command == heap_command)
+        {
+            return this->describe_heap({});
+        }
+
+        if (command.starts_with(heap_address_command))
+        {
+            return this->describe_heap(command.substr(heap_address_command.size()));
+        }
+
+        return std::nullopt;
+    }
+
   private:
     windows_emulator* win_emu_{};
     utils::optional_function<bool()> should_stop_{};
+
+    // 'heap' prints the statistics, 'heap <address>' the allocation owning the address
+    std::string describe_heap(const std::string_view arguments)
+    {
+        auto& win_emu = *this->win_emu_;
+        if (!win_emu.heap.is_active())
+        {
+            return "Heap tracking is not enabled\n";
+        }
+
+        char buffer[256]{};
+
+        if (arguments.empty())
+        {
+            const auto& statistics = win_emu.heap.get_statistics();
+            snprintf(buffer, sizeof(buffer),
+                     "%zu live blocks, %" PRIu64 " allocations, %" PRIu64 " reallocations, %" PRIu64 " frees\n",
+                     win_emu.heap.get_allocations().size(), statistics.allocations, statistics.reallocations,
+                     statistics.frees);
+            return buffer;
+        }
+
+        const std::string address_string(arguments);
+        const uint64_t address = strtoull(address_string.c_str(), nullptr, 16);
+
+        const auto* allocation = win_emu.heap.find_allocation(address);
+        if (!allocation)
+        {
+            return "Not inside a live heap block\n";
+        }
+
+        const auto caller = win_emu.symbols.describe(win_emu.mod_manager, allocation->caller);
+        snprintf(buffer, sizeof(buffer),
+                 "0x%" PRIx64 " is at offset 0x%" PRIx64 " of block 0x%" PRIx64 " (0x%" PRIx64
+                 " bytes, heap 0x%" PRIx64 ", thread %u) allocated at 0x%" PRIx64 " ",
+                 address, address - allocation->address, allocation->address, allocation->size, allocation->heap,
+                 allocation->thread_id, allocation->caller);
+
+        return buffer + caller + "\n";
+    }
 };